@@ -60,6 +60,8 @@ const char *debug_float4(const float *values) DECLSPEC_HIDDEN;
 
 DXGI_FORMAT dxgi_format_from_wined3dformat(enum wined3d_format_id format) DECLSPEC_HIDDEN;
 enum wined3d_format_id wined3dformat_from_dxgi_format(DXGI_FORMAT format) DECLSPEC_HIDDEN;
+unsigned int dxgi_format_get_block_size(DXGI_FORMAT format, unsigned int *block_width,
+        unsigned int *block_height) DECLSPEC_HIDDEN;
 void d3d11_primitive_topology_from_wined3d_primitive_type(enum wined3d_primitive_type primitive_type,
         unsigned int patch_vertex_count, D3D11_PRIMITIVE_TOPOLOGY *topology) DECLSPEC_HIDDEN;
 void wined3d_primitive_type_from_d3d11_primitive_topology(D3D11_PRIMITIVE_TOPOLOGY topology,
@@ -525,6 +527,74 @@ struct d3d11_immediate_context
     struct wined3d_private_store private_store;
 };
 
+struct d3d11_command_buffer
+{
+    BYTE *data;
+    SIZE_T size;
+    SIZE_T capacity;
+};
+
+/* ID3D11CommandList */
+struct d3d11_command_list
+{
+    ID3D11CommandList ID3D11CommandList_iface;
+    LONG refcount;
+
+    struct wined3d_private_store private_store;
+    struct d3d11_command_buffer buffer;
+    ID3D11Device2 *device;
+};
+
+/* State set on a deferred context, returned by its Get*() methods. */
+struct d3d11_deferred_state
+{
+    IUnknown *shaders[WINED3D_SHADER_TYPE_COUNT];
+    IUnknown *constant_buffers[WINED3D_SHADER_TYPE_COUNT][D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT];
+    IUnknown *shader_resources[WINED3D_SHADER_TYPE_COUNT][D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT];
+    IUnknown *samplers[WINED3D_SHADER_TYPE_COUNT][D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT];
+    IUnknown *cs_uavs[D3D11_PS_CS_UAV_REGISTER_COUNT];
+
+    IUnknown *input_layout;
+    IUnknown *vertex_buffers[D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT];
+    UINT vertex_buffer_strides[D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT];
+    UINT vertex_buffer_offsets[D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT];
+    IUnknown *index_buffer;
+    DXGI_FORMAT index_format;
+    UINT index_offset;
+    D3D11_PRIMITIVE_TOPOLOGY topology;
+
+    IUnknown *render_targets[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT];
+    IUnknown *depth_stencil_view;
+    IUnknown *uavs[D3D11_PS_CS_UAV_REGISTER_COUNT];
+    IUnknown *blend_state;
+    float blend_factor[4];
+    UINT sample_mask;
+    IUnknown *depth_stencil_state;
+    UINT stencil_ref;
+
+    IUnknown *so_targets[D3D11_SO_BUFFER_SLOT_COUNT];
+    IUnknown *rasterizer_state;
+    D3D11_VIEWPORT viewports[WINED3D_MAX_VIEWPORTS];
+    unsigned int viewport_count;
+    D3D11_RECT scissor_rects[WINED3D_MAX_VIEWPORTS];
+    unsigned int scissor_rect_count;
+    IUnknown *predicate;
+    BOOL predicate_value;
+};
+
+/* ID3D11DeviceContext - deferred context */
+struct d3d11_deferred_context
+{
+    ID3D11DeviceContext1 ID3D11DeviceContext1_iface;
+    LONG refcount;
+
+    struct wined3d_private_store private_store;
+    struct d3d11_command_buffer buffer;
+    struct d3d11_deferred_state state;
+    struct list maps;
+    ID3D11Device2 *device;
+};
+
 /* ID3D11Device, ID3D10Device1 */
 struct d3d_device
 {
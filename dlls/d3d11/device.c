@@ -29,280 +29,4566 @@ static const struct wined3d_parent_ops d3d_null_wined3d_parent_ops =
     d3d_null_wined3d_object_destroyed,
 };
 
-/* ID3D11DeviceContext - immediate context methods */
+/* Deferred context calls */
+
+enum d3d11_deferred_call_type
+{
+    DEFERRED_CALL_SET_SHADER,
+    DEFERRED_CALL_SET_CONSTANT_BUFFERS,
+    DEFERRED_CALL_SET_SHADER_RESOURCES,
+    DEFERRED_CALL_SET_SAMPLERS,
+    DEFERRED_CALL_SET_UNORDERED_ACCESS_VIEWS,
+    DEFERRED_CALL_SET_INPUT_LAYOUT,
+    DEFERRED_CALL_SET_VERTEX_BUFFERS,
+    DEFERRED_CALL_SET_INDEX_BUFFER,
+    DEFERRED_CALL_SET_PRIMITIVE_TOPOLOGY,
+    DEFERRED_CALL_SET_RENDER_TARGETS_AND_UAVS,
+    DEFERRED_CALL_SET_BLEND_STATE,
+    DEFERRED_CALL_SET_DEPTH_STENCIL_STATE,
+    DEFERRED_CALL_SET_STREAM_OUTPUT_TARGETS,
+    DEFERRED_CALL_SET_RASTERIZER_STATE,
+    DEFERRED_CALL_SET_VIEWPORTS,
+    DEFERRED_CALL_SET_SCISSOR_RECTS,
+    DEFERRED_CALL_SET_PREDICATION,
+    DEFERRED_CALL_BEGIN,
+    DEFERRED_CALL_END,
+    DEFERRED_CALL_DRAW,
+    DEFERRED_CALL_DRAW_INDEXED,
+    DEFERRED_CALL_DRAW_INSTANCED,
+    DEFERRED_CALL_DRAW_INDEXED_INSTANCED,
+    DEFERRED_CALL_DRAW_AUTO,
+    DEFERRED_CALL_DRAW_INSTANCED_INDIRECT,
+    DEFERRED_CALL_DRAW_INDEXED_INSTANCED_INDIRECT,
+    DEFERRED_CALL_DISPATCH,
+    DEFERRED_CALL_DISPATCH_INDIRECT,
+    DEFERRED_CALL_COPY_SUBRESOURCE_REGION,
+    DEFERRED_CALL_COPY_RESOURCE,
+    DEFERRED_CALL_UPDATE_SUBRESOURCE,
+    DEFERRED_CALL_COPY_STRUCTURE_COUNT,
+    DEFERRED_CALL_CLEAR_RENDER_TARGET_VIEW,
+    DEFERRED_CALL_CLEAR_UNORDERED_ACCESS_VIEW_UINT,
+    DEFERRED_CALL_CLEAR_UNORDERED_ACCESS_VIEW_FLOAT,
+    DEFERRED_CALL_CLEAR_DEPTH_STENCIL_VIEW,
+    DEFERRED_CALL_GENERATE_MIPS,
+    DEFERRED_CALL_SET_RESOURCE_MIN_LOD,
+    DEFERRED_CALL_RESOLVE_SUBRESOURCE,
+    DEFERRED_CALL_UPDATE_MAPPED,
+    DEFERRED_CALL_EXECUTE_COMMAND_LIST,
+    DEFERRED_CALL_CLEAR_STATE,
+};
 
-static inline struct d3d11_immediate_context *impl_from_ID3D11DeviceContext1(ID3D11DeviceContext1 *iface)
+/* Calls are stored back to back in a command buffer. Each call is followed by
+ * "object_count" referenced interface pointers, and then by any variable
+ * sized data the call needs. */
+struct d3d11_deferred_call
 {
-    return CONTAINING_RECORD(iface, struct d3d11_immediate_context, ID3D11DeviceContext1_iface);
-}
+    enum d3d11_deferred_call_type type;
+    unsigned int size;
+    unsigned int object_count;
+    union
+    {
+        struct
+        {
+            enum wined3d_shader_type type;
+            unsigned int start, count;
+        } slots;
+        struct
+        {
+            DXGI_FORMAT format;
+            unsigned int offset;
+        } index_buffer;
+        D3D11_PRIMITIVE_TOPOLOGY topology;
+        struct
+        {
+            unsigned int rtv_count, uav_start, uav_count;
+        } render_targets;
+        struct
+        {
+            float factor[4];
+            unsigned int sample_mask;
+        } blend_state;
+        unsigned int stencil_ref;
+        BOOL predicate_value;
+        struct
+        {
+            unsigned int count, start, instance_count, start_instance;
+            int base_vertex;
+        } draw;
+        unsigned int offset;
+        struct
+        {
+            unsigned int x, y, z;
+        } dispatch;
+        struct
+        {
+            unsigned int dst_idx, dst_x, dst_y, dst_z, src_idx, flags;
+            BOOL has_box;
+            D3D11_BOX box;
+        } copy;
+        struct
+        {
+            unsigned int sub_resource_idx, row_pitch, depth_pitch, flags;
+            BOOL has_box;
+            D3D11_BOX box;
+        } update;
+        float color[4];
+        UINT values[4];
+        struct
+        {
+            unsigned int flags;
+            float depth;
+            UINT8 stencil;
+        } clear_depth_stencil;
+        float min_lod;
+        struct
+        {
+            unsigned int dst_idx, src_idx;
+            DXGI_FORMAT format;
+        } resolve;
+        struct
+        {
+            unsigned int sub_resource_idx;
+            unsigned int row_size, row_count, depth;
+        } map;
+        BOOL restore;
+    } u;
+};
 
-static inline struct d3d_device *device_from_immediate_ID3D11DeviceContext1(ID3D11DeviceContext1 *iface)
+#define D3D11_DEFERRED_CALL_ALIGNMENT 16
+#define D3D11_DEFERRED_CALL_HEADER_SIZE ((sizeof(struct d3d11_deferred_call) \
+        + D3D11_DEFERRED_CALL_ALIGNMENT - 1) & ~(D3D11_DEFERRED_CALL_ALIGNMENT - 1))
+
+static inline IUnknown **d3d11_deferred_call_get_objects(const struct d3d11_deferred_call *call)
 {
-    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
-    return CONTAINING_RECORD(context, struct d3d_device, immediate_context);
+    return (IUnknown **)((BYTE *)call + D3D11_DEFERRED_CALL_HEADER_SIZE);
 }
 
-static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_QueryInterface(ID3D11DeviceContext1 *iface,
-        REFIID iid, void **out)
+static inline void *d3d11_deferred_call_get_data(const struct d3d11_deferred_call *call)
 {
-    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
+    return d3d11_deferred_call_get_objects(call) + call->object_count;
+}
 
-    TRACE("iface %p, iid %s, out %p.\n", iface, debugstr_guid(iid), out);
+static void d3d11_deferred_call_set_objects(struct d3d11_deferred_call *call,
+        unsigned int first, unsigned int count, IUnknown *const *objects)
+{
+    IUnknown **call_objects = d3d11_deferred_call_get_objects(call) + first;
+    unsigned int i;
 
-    if (IsEqualGUID(iid, &IID_ID3D11DeviceContext1)
-            || IsEqualGUID(iid, &IID_ID3D11DeviceContext)
-            || IsEqualGUID(iid, &IID_ID3D11DeviceChild)
-            || IsEqualGUID(iid, &IID_IUnknown))
-    {
-        *out = &context->ID3D11DeviceContext1_iface;
-    }
-    else if (IsEqualGUID(iid, &IID_ID3D11Multithread))
-    {
-        *out = &context->ID3D11Multithread_iface;
-    }
-    else
+    for (i = 0; i < count; ++i)
     {
-        WARN("%s not implemented, returning E_NOINTERFACE.\n", debugstr_guid(iid));
-        *out = NULL;
-        return E_NOINTERFACE;
+        if ((call_objects[i] = objects ? objects[i] : NULL))
+            IUnknown_AddRef(call_objects[i]);
     }
-
-    ID3D11DeviceContext1_AddRef(iface);
-    return S_OK;
 }
 
-static ULONG STDMETHODCALLTYPE d3d11_immediate_context_AddRef(ID3D11DeviceContext1 *iface)
+static BOOL d3d11_command_buffer_reserve(struct d3d11_command_buffer *buffer, SIZE_T size)
 {
-    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    ULONG refcount = InterlockedIncrement(&context->refcount);
+    SIZE_T new_capacity;
+    BYTE *new_data;
 
-    TRACE("%p increasing refcount to %u.\n", context, refcount);
+    if (buffer->size + size <= buffer->capacity)
+        return TRUE;
 
-    if (refcount == 1)
-    {
-        ID3D11Device2_AddRef(&device->ID3D11Device2_iface);
-    }
+    new_capacity = max(buffer->capacity * 2, 4096);
+    while (new_capacity < buffer->size + size)
+        new_capacity *= 2;
+    if (!(new_data = heap_realloc(buffer->data, new_capacity)))
+        return FALSE;
 
-    return refcount;
+    buffer->data = new_data;
+    buffer->capacity = new_capacity;
+    return TRUE;
 }
 
-static ULONG STDMETHODCALLTYPE d3d11_immediate_context_Release(ID3D11DeviceContext1 *iface)
+static struct d3d11_deferred_call *d3d11_command_buffer_add_call(struct d3d11_command_buffer *buffer,
+        enum d3d11_deferred_call_type type, unsigned int object_count, SIZE_T data_size)
 {
-    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    ULONG refcount = InterlockedDecrement(&context->refcount);
-
-    TRACE("%p decreasing refcount to %u.\n", context, refcount);
+    struct d3d11_deferred_call *call;
+    SIZE_T size;
 
-    if (!refcount)
+    size = D3D11_DEFERRED_CALL_HEADER_SIZE + object_count * sizeof(IUnknown *) + data_size;
+    size = (size + D3D11_DEFERRED_CALL_ALIGNMENT - 1) & ~(SIZE_T)(D3D11_DEFERRED_CALL_ALIGNMENT - 1);
+    if (size > ~0u || !d3d11_command_buffer_reserve(buffer, size))
     {
-        ID3D11Device2_Release(&device->ID3D11Device2_iface);
+        ERR("Failed to allocate deferred call %#x.\n", type);
+        return NULL;
     }
 
-    return refcount;
+    call = (struct d3d11_deferred_call *)(buffer->data + buffer->size);
+    memset(call, 0, D3D11_DEFERRED_CALL_HEADER_SIZE + object_count * sizeof(IUnknown *));
+    call->type = type;
+    call->size = size;
+    call->object_count = object_count;
+    buffer->size += size;
+
+    return call;
 }
 
-static void d3d11_immediate_context_get_constant_buffers(ID3D11DeviceContext1 *iface,
-        enum wined3d_shader_type type, UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
+static void d3d11_command_buffer_append_call(struct d3d11_command_buffer *buffer,
+        const struct d3d11_deferred_call *call)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *new_call;
+    IUnknown **objects;
     unsigned int i;
 
-    wined3d_mutex_lock();
-    for (i = 0; i < buffer_count; ++i)
+    if (!d3d11_command_buffer_reserve(buffer, call->size))
     {
-        struct wined3d_buffer *wined3d_buffer;
-        struct d3d_buffer *buffer_impl;
+        ERR("Failed to allocate %u bytes for deferred call %#x.\n", call->size, call->type);
+        return;
+    }
 
-        if (!(wined3d_buffer = wined3d_device_get_constant_buffer(device->wined3d_device,
-                type, start_slot + i)))
-        {
-            buffers[i] = NULL;
-            continue;
-        }
+    new_call = (struct d3d11_deferred_call *)(buffer->data + buffer->size);
+    memcpy(new_call, call, call->size);
+    buffer->size += call->size;
 
-        buffer_impl = wined3d_buffer_get_parent(wined3d_buffer);
-        buffers[i] = &buffer_impl->ID3D11Buffer_iface;
-        ID3D11Buffer_AddRef(buffers[i]);
+    objects = d3d11_deferred_call_get_objects(new_call);
+    for (i = 0; i < new_call->object_count; ++i)
+    {
+        if (objects[i])
+            IUnknown_AddRef(objects[i]);
     }
-    wined3d_mutex_unlock();
 }
 
-static void d3d11_immediate_context_set_constant_buffers(ID3D11DeviceContext1 *iface,
-        enum wined3d_shader_type type, UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+static struct d3d11_deferred_call *d3d11_command_buffer_record_slots(struct d3d11_command_buffer *buffer,
+        enum d3d11_deferred_call_type type, enum wined3d_shader_type shader_type,
+        unsigned int start, unsigned int count, IUnknown *const *objects)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
+    struct d3d11_deferred_call *call;
 
-    wined3d_mutex_lock();
-    for (i = 0; i < buffer_count; ++i)
-    {
-        struct d3d_buffer *buffer = unsafe_impl_from_ID3D11Buffer(buffers[i]);
+    if (!(call = d3d11_command_buffer_add_call(buffer, type, count, 0)))
+        return NULL;
+    call->u.slots.type = shader_type;
+    call->u.slots.start = start;
+    call->u.slots.count = count;
+    d3d11_deferred_call_set_objects(call, 0, count, objects);
 
-        wined3d_device_set_constant_buffer(device->wined3d_device, type, start_slot + i,
-                buffer ? buffer->wined3d_buffer : NULL);
-    }
-    wined3d_mutex_unlock();
+    return call;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_GetDevice(ID3D11DeviceContext1 *iface, ID3D11Device **device)
+static struct d3d11_deferred_call *d3d11_command_buffer_record_object(struct d3d11_command_buffer *buffer,
+        enum d3d11_deferred_call_type type, IUnknown *object)
 {
-    struct d3d_device *device_object = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
 
-    TRACE("iface %p, device %p.\n", iface, device);
+    if (!(call = d3d11_command_buffer_add_call(buffer, type, 1, 0)))
+        return NULL;
+    d3d11_deferred_call_set_objects(call, 0, 1, &object);
 
-    *device = (ID3D11Device *)&device_object->ID3D11Device2_iface;
-    ID3D11Device_AddRef(*device);
+    return call;
 }
 
-static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_GetPrivateData(ID3D11DeviceContext1 *iface, REFGUID guid,
-        UINT *data_size, void *data)
+static void d3d11_command_buffer_reset(struct d3d11_command_buffer *buffer)
 {
-    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
-
-    TRACE("iface %p, guid %s, data_size %p, data %p.\n", iface, debugstr_guid(guid), data_size, data);
+    struct d3d11_deferred_call *call;
+    IUnknown **objects;
+    SIZE_T offset;
+    unsigned int i;
 
-    return d3d_get_private_data(&context->private_store, guid, data_size, data);
+    for (offset = 0; offset < buffer->size; offset += call->size)
+    {
+        call = (struct d3d11_deferred_call *)(buffer->data + offset);
+        objects = d3d11_deferred_call_get_objects(call);
+        for (i = 0; i < call->object_count; ++i)
+        {
+            if (objects[i])
+                IUnknown_Release(objects[i]);
+        }
+    }
+    buffer->size = 0;
 }
 
-static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_SetPrivateData(ID3D11DeviceContext1 *iface, REFGUID guid,
-        UINT data_size, const void *data)
+static void d3d11_command_buffer_cleanup(struct d3d11_command_buffer *buffer)
 {
-    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
+    d3d11_command_buffer_reset(buffer);
+    heap_free(buffer->data);
+    memset(buffer, 0, sizeof(*buffer));
+}
 
-    TRACE("iface %p, guid %s, data_size %u, data %p.\n", iface, debugstr_guid(guid), data_size, data);
+static BOOL d3d11_deferred_call_sets_state(const struct d3d11_deferred_call *call)
+{
+    return call->type <= DEFERRED_CALL_SET_PREDICATION;
+}
 
-    return d3d_set_private_data(&context->private_store, guid, data_size, data);
+static BOOL d3d11_deferred_call_clears_state(const struct d3d11_deferred_call *call)
+{
+    return call->type == DEFERRED_CALL_CLEAR_STATE
+            || (call->type == DEFERRED_CALL_EXECUTE_COMMAND_LIST && !call->u.restore);
 }
 
-static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_SetPrivateDataInterface(ID3D11DeviceContext1 *iface,
-        REFGUID guid, const IUnknown *data)
+/* Returns TRUE if "call" completely replaces the state set by the earlier
+ * call "prev". */
+static BOOL d3d11_deferred_call_overrides(const struct d3d11_deferred_call *call,
+        const struct d3d11_deferred_call *prev)
 {
-    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
+    if (call->type != prev->type)
+        return FALSE;
 
-    TRACE("iface %p, guid %s, data %p.\n", iface, debugstr_guid(guid), data);
+    switch (call->type)
+    {
+        case DEFERRED_CALL_SET_SHADER:
+            return call->u.slots.type == prev->u.slots.type;
 
-    return d3d_set_private_data_interface(&context->private_store, guid, data);
-}
+        case DEFERRED_CALL_SET_CONSTANT_BUFFERS:
+        case DEFERRED_CALL_SET_SHADER_RESOURCES:
+        case DEFERRED_CALL_SET_SAMPLERS:
+            if (call->u.slots.type != prev->u.slots.type)
+                return FALSE;
+            /* Fall through. */
+        case DEFERRED_CALL_SET_UNORDERED_ACCESS_VIEWS:
+        case DEFERRED_CALL_SET_VERTEX_BUFFERS:
+            return call->u.slots.start <= prev->u.slots.start
+                    && call->u.slots.start + call->u.slots.count >= prev->u.slots.start + prev->u.slots.count;
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_VSSetConstantBuffers(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
-{
-    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
-            iface, start_slot, buffer_count, buffers);
+        case DEFERRED_CALL_SET_RENDER_TARGETS_AND_UAVS:
+            return (call->u.render_targets.rtv_count != D3D11_KEEP_RENDER_TARGETS_AND_DEPTH_STENCIL
+                    || prev->u.render_targets.rtv_count == D3D11_KEEP_RENDER_TARGETS_AND_DEPTH_STENCIL)
+                    && (call->u.render_targets.uav_count != D3D11_KEEP_UNORDERED_ACCESS_VIEWS
+                    || prev->u.render_targets.uav_count == D3D11_KEEP_UNORDERED_ACCESS_VIEWS);
 
-    d3d11_immediate_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_VERTEX, start_slot,
-            buffer_count, buffers);
+        default:
+            return TRUE;
+    }
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_PSSetShaderResources(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+/* Append the state setting calls from "src" that are still in effect at the
+ * end of "src" to "dst". */
+static void d3d11_command_buffer_copy_state(struct d3d11_command_buffer *dst,
+        const struct d3d11_command_buffer *src)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
+    const struct d3d11_deferred_call **calls, *call;
+    unsigned int count = 0, i, j;
+    SIZE_T offset;
 
-    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
-            iface, start_slot, view_count, views);
+    if (!src->size)
+        return;
 
-    wined3d_mutex_lock();
-    for (i = 0; i < view_count; ++i)
+    if (!(calls = heap_calloc(src->size / D3D11_DEFERRED_CALL_HEADER_SIZE, sizeof(*calls))))
     {
-        struct d3d_shader_resource_view *view = unsafe_impl_from_ID3D11ShaderResourceView(views[i]);
+        ERR("Failed to allocate state call array.\n");
+        return;
+    }
 
-        wined3d_device_set_ps_resource_view(device->wined3d_device, start_slot + i,
-                view ? view->wined3d_view : NULL);
+    for (offset = 0; offset < src->size; offset += call->size)
+    {
+        call = (const struct d3d11_deferred_call *)(src->data + offset);
+        if (d3d11_deferred_call_clears_state(call))
+            count = 0;
+        else if (d3d11_deferred_call_sets_state(call))
+            calls[count++] = call;
     }
-    wined3d_mutex_unlock();
+
+    for (i = 0; i < count; ++i)
+    {
+        for (j = i + 1; j < count; ++j)
+        {
+            if (d3d11_deferred_call_overrides(calls[j], calls[i]))
+                break;
+        }
+        if (j == count)
+            d3d11_command_buffer_append_call(dst, calls[i]);
+    }
+
+    heap_free(calls);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_PSSetShader(ID3D11DeviceContext1 *iface,
-        ID3D11PixelShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+static void d3d11_deferred_state_set_objects(IUnknown **dst, unsigned int count, IUnknown *const *objects)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_pixel_shader *ps = unsafe_impl_from_ID3D11PixelShader(shader);
+    IUnknown *object;
+    unsigned int i;
 
-    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
-            iface, shader, class_instances, class_instance_count);
+    for (i = 0; i < count; ++i)
+    {
+        if ((object = objects ? objects[i] : NULL))
+            IUnknown_AddRef(object);
+        if (dst[i])
+            IUnknown_Release(dst[i]);
+        dst[i] = object;
+    }
+}
 
-    if (class_instances)
-        FIXME("Dynamic linking is not implemented yet.\n");
+static void d3d11_deferred_state_set_slots(IUnknown **dst, unsigned int size,
+        const struct d3d11_deferred_call *call)
+{
+    unsigned int start = call->u.slots.start, count = call->u.slots.count;
 
-    wined3d_mutex_lock();
-    wined3d_device_set_pixel_shader(device->wined3d_device, ps ? ps->wined3d_shader : NULL);
-    wined3d_mutex_unlock();
+    if (start > size || count > size - start)
+    {
+        WARN("Invalid slot range %u, %u for call %#x.\n", start, count, call->type);
+        return;
+    }
+
+    d3d11_deferred_state_set_objects(&dst[start], count, d3d11_deferred_call_get_objects(call));
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_PSSetSamplers(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+static void d3d11_deferred_state_reset(struct d3d11_deferred_state *state)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    static const float default_blend_factor[] = {1.0f, 1.0f, 1.0f, 1.0f};
     unsigned int i;
 
-    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
-            iface, start_slot, sampler_count, samplers);
-
-    wined3d_mutex_lock();
-    for (i = 0; i < sampler_count; ++i)
+    for (i = 0; i < WINED3D_SHADER_TYPE_COUNT; ++i)
     {
-        struct d3d_sampler_state *sampler = unsafe_impl_from_ID3D11SamplerState(samplers[i]);
+        d3d11_deferred_state_set_objects(state->constant_buffers[i], ARRAY_SIZE(state->constant_buffers[i]), NULL);
+        d3d11_deferred_state_set_objects(state->shader_resources[i], ARRAY_SIZE(state->shader_resources[i]), NULL);
+        d3d11_deferred_state_set_objects(state->samplers[i], ARRAY_SIZE(state->samplers[i]), NULL);
+    }
+    d3d11_deferred_state_set_objects(state->shaders, ARRAY_SIZE(state->shaders), NULL);
+    d3d11_deferred_state_set_objects(state->cs_uavs, ARRAY_SIZE(state->cs_uavs), NULL);
+    d3d11_deferred_state_set_objects(&state->input_layout, 1, NULL);
+    d3d11_deferred_state_set_objects(state->vertex_buffers, ARRAY_SIZE(state->vertex_buffers), NULL);
+    d3d11_deferred_state_set_objects(&state->index_buffer, 1, NULL);
+    d3d11_deferred_state_set_objects(state->render_targets, ARRAY_SIZE(state->render_targets), NULL);
+    d3d11_deferred_state_set_objects(&state->depth_stencil_view, 1, NULL);
+    d3d11_deferred_state_set_objects(state->uavs, ARRAY_SIZE(state->uavs), NULL);
+    d3d11_deferred_state_set_objects(&state->blend_state, 1, NULL);
+    d3d11_deferred_state_set_objects(&state->depth_stencil_state, 1, NULL);
+    d3d11_deferred_state_set_objects(state->so_targets, ARRAY_SIZE(state->so_targets), NULL);
+    d3d11_deferred_state_set_objects(&state->rasterizer_state, 1, NULL);
+    d3d11_deferred_state_set_objects(&state->predicate, 1, NULL);
+
+    memset(state, 0, sizeof(*state));
+    memcpy(state->blend_factor, default_blend_factor, sizeof(state->blend_factor));
+    state->sample_mask = D3D11_DEFAULT_SAMPLE_MASK;
+}
+
+/* Update "state" with the state set by the recorded call "call". */
+static void d3d11_deferred_state_update(struct d3d11_deferred_state *state, const struct d3d11_deferred_call *call)
+{
+    IUnknown **objects = d3d11_deferred_call_get_objects(call);
+    const UINT *data = d3d11_deferred_call_get_data(call);
+    unsigned int start, count;
+
+    switch (call->type)
+    {
+        case DEFERRED_CALL_SET_SHADER:
+            d3d11_deferred_state_set_objects(&state->shaders[call->u.slots.type], 1, objects);
+            break;
+
+        case DEFERRED_CALL_SET_CONSTANT_BUFFERS:
+            d3d11_deferred_state_set_slots(state->constant_buffers[call->u.slots.type],
+                    ARRAY_SIZE(state->constant_buffers[call->u.slots.type]), call);
+            break;
+
+        case DEFERRED_CALL_SET_SHADER_RESOURCES:
+            d3d11_deferred_state_set_slots(state->shader_resources[call->u.slots.type],
+                    ARRAY_SIZE(state->shader_resources[call->u.slots.type]), call);
+            break;
+
+        case DEFERRED_CALL_SET_SAMPLERS:
+            d3d11_deferred_state_set_slots(state->samplers[call->u.slots.type],
+                    ARRAY_SIZE(state->samplers[call->u.slots.type]), call);
+            break;
+
+        case DEFERRED_CALL_SET_UNORDERED_ACCESS_VIEWS:
+            d3d11_deferred_state_set_slots(state->cs_uavs, ARRAY_SIZE(state->cs_uavs), call);
+            break;
+
+        case DEFERRED_CALL_SET_INPUT_LAYOUT:
+            d3d11_deferred_state_set_objects(&state->input_layout, 1, objects);
+            break;
+
+        case DEFERRED_CALL_SET_VERTEX_BUFFERS:
+            start = call->u.slots.start;
+            count = call->u.slots.count;
+            if (start > ARRAY_SIZE(state->vertex_buffers) || count > ARRAY_SIZE(state->vertex_buffers) - start)
+            {
+                WARN("Invalid vertex buffer range %u, %u.\n", start, count);
+                break;
+            }
+            d3d11_deferred_state_set_objects(&state->vertex_buffers[start], count, objects);
+            memcpy(&state->vertex_buffer_strides[start], data, count * sizeof(*data));
+            memcpy(&state->vertex_buffer_offsets[start], data + count, count * sizeof(*data));
+            break;
+
+        case DEFERRED_CALL_SET_INDEX_BUFFER:
+            d3d11_deferred_state_set_objects(&state->index_buffer, 1, objects);
+            state->index_format = call->u.index_buffer.format;
+            state->index_offset = call->u.index_buffer.offset;
+            break;
+
+        case DEFERRED_CALL_SET_PRIMITIVE_TOPOLOGY:
+            state->topology = call->u.topology;
+            break;
+
+        case DEFERRED_CALL_SET_RENDER_TARGETS_AND_UAVS:
+            count = call->u.render_targets.rtv_count;
+            if (count == D3D11_KEEP_RENDER_TARGETS_AND_DEPTH_STENCIL)
+            {
+                ++objects;
+            }
+            else
+            {
+                if (count <= ARRAY_SIZE(state->render_targets))
+                {
+                    d3d11_deferred_state_set_objects(state->render_targets, count, objects);
+                    d3d11_deferred_state_set_objects(&state->render_targets[count],
+                            ARRAY_SIZE(state->render_targets) - count, NULL);
+                }
+                else
+                {
+                    WARN("Invalid render target view count %u.\n", count);
+                }
+                d3d11_deferred_state_set_objects(&state->depth_stencil_view, 1, &objects[count]);
+                objects += count + 1;
+            }
 
-        wined3d_device_set_ps_sampler(device->wined3d_device, start_slot + i,
-                sampler ? sampler->wined3d_sampler : NULL);
+            start = call->u.render_targets.uav_start;
+            count = call->u.render_targets.uav_count;
+            if (count == D3D11_KEEP_UNORDERED_ACCESS_VIEWS)
+                break;
+            if (start > ARRAY_SIZE(state->uavs) || count > ARRAY_SIZE(state->uavs) - start)
+            {
+                WARN("Invalid unordered access view range %u, %u.\n", start, count);
+                break;
+            }
+            d3d11_deferred_state_set_objects(state->uavs, start, NULL);
+            d3d11_deferred_state_set_objects(&state->uavs[start], count, objects);
+            d3d11_deferred_state_set_objects(&state->uavs[start + count],
+                    ARRAY_SIZE(state->uavs) - start - count, NULL);
+            break;
+
+        case DEFERRED_CALL_SET_BLEND_STATE:
+            d3d11_deferred_state_set_objects(&state->blend_state, 1, objects);
+            memcpy(state->blend_factor, call->u.blend_state.factor, sizeof(state->blend_factor));
+            state->sample_mask = call->u.blend_state.sample_mask;
+            break;
+
+        case DEFERRED_CALL_SET_DEPTH_STENCIL_STATE:
+            d3d11_deferred_state_set_objects(&state->depth_stencil_state, 1, objects);
+            state->stencil_ref = call->u.stencil_ref;
+            break;
+
+        case DEFERRED_CALL_SET_STREAM_OUTPUT_TARGETS:
+            count = call->u.slots.count;
+            d3d11_deferred_state_set_objects(state->so_targets, count, objects);
+            d3d11_deferred_state_set_objects(&state->so_targets[count], ARRAY_SIZE(state->so_targets) - count, NULL);
+            break;
+
+        case DEFERRED_CALL_SET_RASTERIZER_STATE:
+            d3d11_deferred_state_set_objects(&state->rasterizer_state, 1, objects);
+            break;
+
+        case DEFERRED_CALL_SET_VIEWPORTS:
+            state->viewport_count = call->u.slots.count;
+            memcpy(state->viewports, data, state->viewport_count * sizeof(*state->viewports));
+            break;
+
+        case DEFERRED_CALL_SET_SCISSOR_RECTS:
+            state->scissor_rect_count = call->u.slots.count;
+            memcpy(state->scissor_rects, data, state->scissor_rect_count * sizeof(*state->scissor_rects));
+            break;
+
+        case DEFERRED_CALL_SET_PREDICATION:
+            d3d11_deferred_state_set_objects(&state->predicate, 1, objects);
+            state->predicate_value = call->u.predicate_value;
+            break;
+
+        default:
+            if (d3d11_deferred_call_clears_state(call))
+                d3d11_deferred_state_reset(state);
+            break;
     }
-    wined3d_mutex_unlock();
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_VSSetShader(ID3D11DeviceContext1 *iface,
-        ID3D11VertexShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+static void d3d11_deferred_state_get_objects(IUnknown *const *src, unsigned int size,
+        unsigned int start, unsigned int count, void *objects)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_vertex_shader *vs = unsafe_impl_from_ID3D11VertexShader(shader);
+    IUnknown **dst = objects;
+    unsigned int i;
 
-    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
-            iface, shader, class_instances, class_instance_count);
+    for (i = 0; i < count; ++i)
+    {
+        if ((dst[i] = start < size && i < size - start ? src[start + i] : NULL))
+            IUnknown_AddRef(dst[i]);
+    }
+}
 
-    if (class_instances)
-        FIXME("Dynamic linking is not implemented yet.\n");
+/* Memory returned by Map() on deferred contexts. The command buffer keeps a
+ * reference to it, and it is only read when the command list is executed. */
+struct d3d11_deferred_mapped_data
+{
+    IUnknown IUnknown_iface;
+    LONG refcount;
+    void *data;
+};
 
-    wined3d_mutex_lock();
-    wined3d_device_set_vertex_shader(device->wined3d_device, vs ? vs->wined3d_shader : NULL);
-    wined3d_mutex_unlock();
+static inline struct d3d11_deferred_mapped_data *mapped_data_from_IUnknown(IUnknown *iface)
+{
+    return CONTAINING_RECORD(iface, struct d3d11_deferred_mapped_data, IUnknown_iface);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DrawIndexed(ID3D11DeviceContext1 *iface,
-        UINT index_count, UINT start_index_location, INT base_vertex_location)
+static HRESULT STDMETHODCALLTYPE d3d11_deferred_mapped_data_QueryInterface(IUnknown *iface, REFIID iid, void **out)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    TRACE("iface %p, iid %s, out %p.\n", iface, debugstr_guid(iid), out);
 
-    TRACE("iface %p, index_count %u, start_index_location %u, base_vertex_location %d.\n",
-            iface, index_count, start_index_location, base_vertex_location);
+    if (IsEqualGUID(iid, &IID_IUnknown))
+    {
+        IUnknown_AddRef(iface);
+        *out = iface;
+        return S_OK;
+    }
 
-    wined3d_mutex_lock();
-    wined3d_device_set_base_vertex_index(device->wined3d_device, base_vertex_location);
-    wined3d_device_draw_indexed_primitive(device->wined3d_device, start_index_location, index_count);
-    wined3d_mutex_unlock();
+    WARN("%s not implemented, returning E_NOINTERFACE.\n", debugstr_guid(iid));
+    *out = NULL;
+    return E_NOINTERFACE;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_Draw(ID3D11DeviceContext1 *iface,
-        UINT vertex_count, UINT start_vertex_location)
+static ULONG STDMETHODCALLTYPE d3d11_deferred_mapped_data_AddRef(IUnknown *iface)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_mapped_data *data = mapped_data_from_IUnknown(iface);
+    ULONG refcount = InterlockedIncrement(&data->refcount);
 
-    TRACE("iface %p, vertex_count %u, start_vertex_location %u.\n",
-            iface, vertex_count, start_vertex_location);
+    TRACE("%p increasing refcount to %u.\n", data, refcount);
 
-    wined3d_mutex_lock();
-    wined3d_device_draw_primitive(device->wined3d_device, start_vertex_location, vertex_count);
-    wined3d_mutex_unlock();
+    return refcount;
 }
 
-static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_Map(ID3D11DeviceContext1 *iface, ID3D11Resource *resource,
-        UINT subresource_idx, D3D11_MAP map_type, UINT map_flags, D3D11_MAPPED_SUBRESOURCE *mapped_subresource)
+static ULONG STDMETHODCALLTYPE d3d11_deferred_mapped_data_Release(IUnknown *iface)
 {
-    struct wined3d_resource *wined3d_resource;
-    struct wined3d_map_desc map_desc;
-    HRESULT hr;
+    struct d3d11_deferred_mapped_data *data = mapped_data_from_IUnknown(iface);
+    ULONG refcount = InterlockedDecrement(&data->refcount);
+
+    TRACE("%p decreasing refcount to %u.\n", data, refcount);
+
+    if (!refcount)
+        heap_free(data);
+
+    return refcount;
+}
+
+static const struct IUnknownVtbl d3d11_deferred_mapped_data_vtbl =
+{
+    d3d11_deferred_mapped_data_QueryInterface,
+    d3d11_deferred_mapped_data_AddRef,
+    d3d11_deferred_mapped_data_Release,
+};
+
+/* D3D11 guarantees 16 byte alignment for mapped memory, which heap_alloc()
+ * doesn't provide on all platforms. */
+#define D3D11_MAPPED_DATA_ALIGNMENT 16
+
+static struct d3d11_deferred_mapped_data *d3d11_deferred_mapped_data_create(SIZE_T size)
+{
+    struct d3d11_deferred_mapped_data *object;
+
+    if (!(object = heap_alloc(sizeof(*object) + size + D3D11_MAPPED_DATA_ALIGNMENT - 1)))
+        return NULL;
+
+    object->IUnknown_iface.lpVtbl = &d3d11_deferred_mapped_data_vtbl;
+    object->refcount = 1;
+    object->data = (void *)(((ULONG_PTR)(object + 1) + D3D11_MAPPED_DATA_ALIGNMENT - 1)
+            & ~(ULONG_PTR)(D3D11_MAPPED_DATA_ALIGNMENT - 1));
+
+    return object;
+}
+
+static void d3d11_device_context_set_shader(ID3D11DeviceContext1 *context,
+        enum wined3d_shader_type type, IUnknown *shader)
+{
+    switch (type)
+    {
+        case WINED3D_SHADER_TYPE_VERTEX:
+            ID3D11DeviceContext1_VSSetShader(context, (ID3D11VertexShader *)shader, NULL, 0);
+            break;
+        case WINED3D_SHADER_TYPE_HULL:
+            ID3D11DeviceContext1_HSSetShader(context, (ID3D11HullShader *)shader, NULL, 0);
+            break;
+        case WINED3D_SHADER_TYPE_DOMAIN:
+            ID3D11DeviceContext1_DSSetShader(context, (ID3D11DomainShader *)shader, NULL, 0);
+            break;
+        case WINED3D_SHADER_TYPE_GEOMETRY:
+            ID3D11DeviceContext1_GSSetShader(context, (ID3D11GeometryShader *)shader, NULL, 0);
+            break;
+        case WINED3D_SHADER_TYPE_PIXEL:
+            ID3D11DeviceContext1_PSSetShader(context, (ID3D11PixelShader *)shader, NULL, 0);
+            break;
+        case WINED3D_SHADER_TYPE_COMPUTE:
+            ID3D11DeviceContext1_CSSetShader(context, (ID3D11ComputeShader *)shader, NULL, 0);
+            break;
+        default:
+            ERR("Invalid shader type %#x.\n", type);
+            break;
+    }
+}
+
+static void d3d11_device_context_set_constant_buffers(ID3D11DeviceContext1 *context,
+        enum wined3d_shader_type type, unsigned int start, unsigned int count, IUnknown *const *buffers)
+{
+    ID3D11Buffer *const *b = (ID3D11Buffer *const *)buffers;
+
+    switch (type)
+    {
+        case WINED3D_SHADER_TYPE_VERTEX:
+            ID3D11DeviceContext1_VSSetConstantBuffers(context, start, count, b);
+            break;
+        case WINED3D_SHADER_TYPE_HULL:
+            ID3D11DeviceContext1_HSSetConstantBuffers(context, start, count, b);
+            break;
+        case WINED3D_SHADER_TYPE_DOMAIN:
+            ID3D11DeviceContext1_DSSetConstantBuffers(context, start, count, b);
+            break;
+        case WINED3D_SHADER_TYPE_GEOMETRY:
+            ID3D11DeviceContext1_GSSetConstantBuffers(context, start, count, b);
+            break;
+        case WINED3D_SHADER_TYPE_PIXEL:
+            ID3D11DeviceContext1_PSSetConstantBuffers(context, start, count, b);
+            break;
+        case WINED3D_SHADER_TYPE_COMPUTE:
+            ID3D11DeviceContext1_CSSetConstantBuffers(context, start, count, b);
+            break;
+        default:
+            ERR("Invalid shader type %#x.\n", type);
+            break;
+    }
+}
+
+static void d3d11_device_context_set_shader_resources(ID3D11DeviceContext1 *context,
+        enum wined3d_shader_type type, unsigned int start, unsigned int count, IUnknown *const *views)
+{
+    ID3D11ShaderResourceView *const *v = (ID3D11ShaderResourceView *const *)views;
+
+    switch (type)
+    {
+        case WINED3D_SHADER_TYPE_VERTEX:
+            ID3D11DeviceContext1_VSSetShaderResources(context, start, count, v);
+            break;
+        case WINED3D_SHADER_TYPE_HULL:
+            ID3D11DeviceContext1_HSSetShaderResources(context, start, count, v);
+            break;
+        case WINED3D_SHADER_TYPE_DOMAIN:
+            ID3D11DeviceContext1_DSSetShaderResources(context, start, count, v);
+            break;
+        case WINED3D_SHADER_TYPE_GEOMETRY:
+            ID3D11DeviceContext1_GSSetShaderResources(context, start, count, v);
+            break;
+        case WINED3D_SHADER_TYPE_PIXEL:
+            ID3D11DeviceContext1_PSSetShaderResources(context, start, count, v);
+            break;
+        case WINED3D_SHADER_TYPE_COMPUTE:
+            ID3D11DeviceContext1_CSSetShaderResources(context, start, count, v);
+            break;
+        default:
+            ERR("Invalid shader type %#x.\n", type);
+            break;
+    }
+}
+
+static void d3d11_device_context_set_samplers(ID3D11DeviceContext1 *context,
+        enum wined3d_shader_type type, unsigned int start, unsigned int count, IUnknown *const *samplers)
+{
+    ID3D11SamplerState *const *s = (ID3D11SamplerState *const *)samplers;
+
+    switch (type)
+    {
+        case WINED3D_SHADER_TYPE_VERTEX:
+            ID3D11DeviceContext1_VSSetSamplers(context, start, count, s);
+            break;
+        case WINED3D_SHADER_TYPE_HULL:
+            ID3D11DeviceContext1_HSSetSamplers(context, start, count, s);
+            break;
+        case WINED3D_SHADER_TYPE_DOMAIN:
+            ID3D11DeviceContext1_DSSetSamplers(context, start, count, s);
+            break;
+        case WINED3D_SHADER_TYPE_GEOMETRY:
+            ID3D11DeviceContext1_GSSetSamplers(context, start, count, s);
+            break;
+        case WINED3D_SHADER_TYPE_PIXEL:
+            ID3D11DeviceContext1_PSSetSamplers(context, start, count, s);
+            break;
+        case WINED3D_SHADER_TYPE_COMPUTE:
+            ID3D11DeviceContext1_CSSetSamplers(context, start, count, s);
+            break;
+        default:
+            ERR("Invalid shader type %#x.\n", type);
+            break;
+    }
+}
+
+static void d3d11_device_context_update_mapped(ID3D11DeviceContext1 *context,
+        const struct d3d11_deferred_call *call)
+{
+    IUnknown **objects = d3d11_deferred_call_get_objects(call);
+    ID3D11Resource *resource = (ID3D11Resource *)objects[0];
+    const BYTE *src = mapped_data_from_IUnknown(objects[1])->data;
+    D3D11_MAPPED_SUBRESOURCE map_desc;
+    unsigned int z, y;
+    BYTE *dst;
+    HRESULT hr;
+
+    if (FAILED(hr = ID3D11DeviceContext1_Map(context, resource, call->u.map.sub_resource_idx,
+            D3D11_MAP_WRITE_DISCARD, 0, &map_desc)))
+    {
+        ERR("Failed to map resource %p, hr %#x.\n", resource, hr);
+        return;
+    }
+
+    for (z = 0; z < call->u.map.depth; ++z)
+    {
+        dst = (BYTE *)map_desc.pData + z * map_desc.DepthPitch;
+        for (y = 0; y < call->u.map.row_count; ++y)
+        {
+            memcpy(dst, src, call->u.map.row_size);
+            dst += map_desc.RowPitch;
+            src += call->u.map.row_size;
+        }
+    }
+
+    ID3D11DeviceContext1_Unmap(context, resource, call->u.map.sub_resource_idx);
+}
+
+/* Replay the calls in "buffer" on "context". The caller is expected to hold
+ * the wined3d mutex. */
+static void d3d11_command_buffer_execute(const struct d3d11_command_buffer *buffer, ID3D11DeviceContext1 *context)
+{
+    const struct d3d11_deferred_call *call;
+    IUnknown **objects;
+    const UINT *data;
+    SIZE_T offset;
+
+    for (offset = 0; offset < buffer->size; offset += call->size)
+    {
+        call = (const struct d3d11_deferred_call *)(buffer->data + offset);
+        objects = d3d11_deferred_call_get_objects(call);
+        data = d3d11_deferred_call_get_data(call);
+
+        switch (call->type)
+        {
+            case DEFERRED_CALL_SET_SHADER:
+                d3d11_device_context_set_shader(context, call->u.slots.type, objects[0]);
+                break;
+
+            case DEFERRED_CALL_SET_CONSTANT_BUFFERS:
+                d3d11_device_context_set_constant_buffers(context, call->u.slots.type,
+                        call->u.slots.start, call->u.slots.count, objects);
+                break;
+
+            case DEFERRED_CALL_SET_SHADER_RESOURCES:
+                d3d11_device_context_set_shader_resources(context, call->u.slots.type,
+                        call->u.slots.start, call->u.slots.count, objects);
+                break;
+
+            case DEFERRED_CALL_SET_SAMPLERS:
+                d3d11_device_context_set_samplers(context, call->u.slots.type,
+                        call->u.slots.start, call->u.slots.count, objects);
+                break;
+
+            case DEFERRED_CALL_SET_UNORDERED_ACCESS_VIEWS:
+                ID3D11DeviceContext1_CSSetUnorderedAccessViews(context, call->u.slots.start, call->u.slots.count,
+                        (ID3D11UnorderedAccessView *const *)objects, data);
+                break;
+
+            case DEFERRED_CALL_SET_INPUT_LAYOUT:
+                ID3D11DeviceContext1_IASetInputLayout(context, (ID3D11InputLayout *)objects[0]);
+                break;
+
+            case DEFERRED_CALL_SET_VERTEX_BUFFERS:
+                ID3D11DeviceContext1_IASetVertexBuffers(context, call->u.slots.start, call->u.slots.count,
+                        (ID3D11Buffer *const *)objects, data, data + call->u.slots.count);
+                break;
+
+            case DEFERRED_CALL_SET_INDEX_BUFFER:
+                ID3D11DeviceContext1_IASetIndexBuffer(context, (ID3D11Buffer *)objects[0],
+                        call->u.index_buffer.format, call->u.index_buffer.offset);
+                break;
+
+            case DEFERRED_CALL_SET_PRIMITIVE_TOPOLOGY:
+                ID3D11DeviceContext1_IASetPrimitiveTopology(context, call->u.topology);
+                break;
+
+            case DEFERRED_CALL_SET_RENDER_TARGETS_AND_UAVS:
+            {
+                unsigned int rtv_count = call->u.render_targets.rtv_count;
+
+                if (rtv_count == D3D11_KEEP_RENDER_TARGETS_AND_DEPTH_STENCIL)
+                    rtv_count = 0;
+                ID3D11DeviceContext1_OMSetRenderTargetsAndUnorderedAccessViews(context,
+                        call->u.render_targets.rtv_count, (ID3D11RenderTargetView *const *)objects,
+                        (ID3D11DepthStencilView *)objects[rtv_count], call->u.render_targets.uav_start,
+                        call->u.render_targets.uav_count,
+                        (ID3D11UnorderedAccessView *const *)&objects[rtv_count + 1], data);
+                break;
+            }
+
+            case DEFERRED_CALL_SET_BLEND_STATE:
+                ID3D11DeviceContext1_OMSetBlendState(context, (ID3D11BlendState *)objects[0],
+                        call->u.blend_state.factor, call->u.blend_state.sample_mask);
+                break;
+
+            case DEFERRED_CALL_SET_DEPTH_STENCIL_STATE:
+                ID3D11DeviceContext1_OMSetDepthStencilState(context,
+                        (ID3D11DepthStencilState *)objects[0], call->u.stencil_ref);
+                break;
+
+            case DEFERRED_CALL_SET_STREAM_OUTPUT_TARGETS:
+                ID3D11DeviceContext1_SOSetTargets(context, call->u.slots.count,
+                        (ID3D11Buffer *const *)objects, data);
+                break;
+
+            case DEFERRED_CALL_SET_RASTERIZER_STATE:
+                ID3D11DeviceContext1_RSSetState(context, (ID3D11RasterizerState *)objects[0]);
+                break;
+
+            case DEFERRED_CALL_SET_VIEWPORTS:
+                ID3D11DeviceContext1_RSSetViewports(context, call->u.slots.count, (const D3D11_VIEWPORT *)data);
+                break;
+
+            case DEFERRED_CALL_SET_SCISSOR_RECTS:
+                ID3D11DeviceContext1_RSSetScissorRects(context, call->u.slots.count, (const D3D11_RECT *)data);
+                break;
+
+            case DEFERRED_CALL_SET_PREDICATION:
+                ID3D11DeviceContext1_SetPredication(context, (ID3D11Predicate *)objects[0],
+                        call->u.predicate_value);
+                break;
+
+            case DEFERRED_CALL_BEGIN:
+                ID3D11DeviceContext1_Begin(context, (ID3D11Asynchronous *)objects[0]);
+                break;
+
+            case DEFERRED_CALL_END:
+                ID3D11DeviceContext1_End(context, (ID3D11Asynchronous *)objects[0]);
+                break;
+
+            case DEFERRED_CALL_DRAW:
+                ID3D11DeviceContext1_Draw(context, call->u.draw.count, call->u.draw.start);
+                break;
+
+            case DEFERRED_CALL_DRAW_INDEXED:
+                ID3D11DeviceContext1_DrawIndexed(context, call->u.draw.count,
+                        call->u.draw.start, call->u.draw.base_vertex);
+                break;
+
+            case DEFERRED_CALL_DRAW_INSTANCED:
+                ID3D11DeviceContext1_DrawInstanced(context, call->u.draw.count, call->u.draw.instance_count,
+                        call->u.draw.start, call->u.draw.start_instance);
+                break;
+
+            case DEFERRED_CALL_DRAW_INDEXED_INSTANCED:
+                ID3D11DeviceContext1_DrawIndexedInstanced(context, call->u.draw.count,
+                        call->u.draw.instance_count, call->u.draw.start, call->u.draw.base_vertex,
+                        call->u.draw.start_instance);
+                break;
+
+            case DEFERRED_CALL_DRAW_AUTO:
+                ID3D11DeviceContext1_DrawAuto(context);
+                break;
+
+            case DEFERRED_CALL_DRAW_INSTANCED_INDIRECT:
+                ID3D11DeviceContext1_DrawInstancedIndirect(context, (ID3D11Buffer *)objects[0], call->u.offset);
+                break;
+
+            case DEFERRED_CALL_DRAW_INDEXED_INSTANCED_INDIRECT:
+                ID3D11DeviceContext1_DrawIndexedInstancedIndirect(context,
+                        (ID3D11Buffer *)objects[0], call->u.offset);
+                break;
+
+            case DEFERRED_CALL_DISPATCH:
+                ID3D11DeviceContext1_Dispatch(context, call->u.dispatch.x, call->u.dispatch.y, call->u.dispatch.z);
+                break;
+
+            case DEFERRED_CALL_DISPATCH_INDIRECT:
+                ID3D11DeviceContext1_DispatchIndirect(context, (ID3D11Buffer *)objects[0], call->u.offset);
+                break;
+
+            case DEFERRED_CALL_COPY_SUBRESOURCE_REGION:
+                ID3D11DeviceContext1_CopySubresourceRegion1(context, (ID3D11Resource *)objects[0],
+                        call->u.copy.dst_idx, call->u.copy.dst_x, call->u.copy.dst_y, call->u.copy.dst_z,
+                        (ID3D11Resource *)objects[1], call->u.copy.src_idx,
+                        call->u.copy.has_box ? &call->u.copy.box : NULL, call->u.copy.flags);
+                break;
+
+            case DEFERRED_CALL_COPY_RESOURCE:
+                ID3D11DeviceContext1_CopyResource(context, (ID3D11Resource *)objects[0],
+                        (ID3D11Resource *)objects[1]);
+                break;
+
+            case DEFERRED_CALL_UPDATE_SUBRESOURCE:
+                ID3D11DeviceContext1_UpdateSubresource1(context, (ID3D11Resource *)objects[0],
+                        call->u.update.sub_resource_idx, call->u.update.has_box ? &call->u.update.box : NULL,
+                        data, call->u.update.row_pitch, call->u.update.depth_pitch, call->u.update.flags);
+                break;
+
+            case DEFERRED_CALL_COPY_STRUCTURE_COUNT:
+                ID3D11DeviceContext1_CopyStructureCount(context, (ID3D11Buffer *)objects[0],
+                        call->u.offset, (ID3D11UnorderedAccessView *)objects[1]);
+                break;
+
+            case DEFERRED_CALL_CLEAR_RENDER_TARGET_VIEW:
+                ID3D11DeviceContext1_ClearRenderTargetView(context,
+                        (ID3D11RenderTargetView *)objects[0], call->u.color);
+                break;
+
+            case DEFERRED_CALL_CLEAR_UNORDERED_ACCESS_VIEW_UINT:
+                ID3D11DeviceContext1_ClearUnorderedAccessViewUint(context,
+                        (ID3D11UnorderedAccessView *)objects[0], call->u.values);
+                break;
+
+            case DEFERRED_CALL_CLEAR_UNORDERED_ACCESS_VIEW_FLOAT:
+                ID3D11DeviceContext1_ClearUnorderedAccessViewFloat(context,
+                        (ID3D11UnorderedAccessView *)objects[0], call->u.color);
+                break;
+
+            case DEFERRED_CALL_CLEAR_DEPTH_STENCIL_VIEW:
+                ID3D11DeviceContext1_ClearDepthStencilView(context, (ID3D11DepthStencilView *)objects[0],
+                        call->u.clear_depth_stencil.flags, call->u.clear_depth_stencil.depth,
+                        call->u.clear_depth_stencil.stencil);
+                break;
+
+            case DEFERRED_CALL_GENERATE_MIPS:
+                ID3D11DeviceContext1_GenerateMips(context, (ID3D11ShaderResourceView *)objects[0]);
+                break;
+
+            case DEFERRED_CALL_SET_RESOURCE_MIN_LOD:
+                ID3D11DeviceContext1_SetResourceMinLOD(context, (ID3D11Resource *)objects[0], call->u.min_lod);
+                break;
+
+            case DEFERRED_CALL_RESOLVE_SUBRESOURCE:
+                ID3D11DeviceContext1_ResolveSubresource(context, (ID3D11Resource *)objects[0],
+                        call->u.resolve.dst_idx, (ID3D11Resource *)objects[1], call->u.resolve.src_idx,
+                        call->u.resolve.format);
+                break;
+
+            case DEFERRED_CALL_UPDATE_MAPPED:
+                d3d11_device_context_update_mapped(context, call);
+                break;
+
+            case DEFERRED_CALL_EXECUTE_COMMAND_LIST:
+                ID3D11DeviceContext1_ExecuteCommandList(context, (ID3D11CommandList *)objects[0], call->u.restore);
+                break;
+
+            case DEFERRED_CALL_CLEAR_STATE:
+                ID3D11DeviceContext1_ClearState(context);
+                break;
+
+            default:
+                ERR("Unhandled deferred call %#x.\n", call->type);
+                break;
+        }
+    }
+}
+
+/* ID3D11CommandList methods */
+
+static inline struct d3d11_command_list *impl_from_ID3D11CommandList(ID3D11CommandList *iface)
+{
+    return CONTAINING_RECORD(iface, struct d3d11_command_list, ID3D11CommandList_iface);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_command_list_QueryInterface(ID3D11CommandList *iface,
+        REFIID iid, void **out)
+{
+    TRACE("iface %p, iid %s, out %p.\n", iface, debugstr_guid(iid), out);
+
+    if (IsEqualGUID(iid, &IID_ID3D11CommandList)
+            || IsEqualGUID(iid, &IID_ID3D11DeviceChild)
+            || IsEqualGUID(iid, &IID_IUnknown))
+    {
+        ID3D11CommandList_AddRef(iface);
+        *out = iface;
+        return S_OK;
+    }
+
+    WARN("%s not implemented, returning E_NOINTERFACE.\n", debugstr_guid(iid));
+    *out = NULL;
+    return E_NOINTERFACE;
+}
+
+static ULONG STDMETHODCALLTYPE d3d11_command_list_AddRef(ID3D11CommandList *iface)
+{
+    struct d3d11_command_list *list = impl_from_ID3D11CommandList(iface);
+    ULONG refcount = InterlockedIncrement(&list->refcount);
+
+    TRACE("%p increasing refcount to %u.\n", list, refcount);
+
+    return refcount;
+}
+
+static ULONG STDMETHODCALLTYPE d3d11_command_list_Release(ID3D11CommandList *iface)
+{
+    struct d3d11_command_list *list = impl_from_ID3D11CommandList(iface);
+    ULONG refcount = InterlockedDecrement(&list->refcount);
+
+    TRACE("%p decreasing refcount to %u.\n", list, refcount);
+
+    if (!refcount)
+    {
+        ID3D11Device2 *device = list->device;
+
+        d3d11_command_buffer_cleanup(&list->buffer);
+        wined3d_private_store_cleanup(&list->private_store);
+        heap_free(list);
+        ID3D11Device2_Release(device);
+    }
+
+    return refcount;
+}
+
+static void STDMETHODCALLTYPE d3d11_command_list_GetDevice(ID3D11CommandList *iface, ID3D11Device **device)
+{
+    struct d3d11_command_list *list = impl_from_ID3D11CommandList(iface);
+
+    TRACE("iface %p, device %p.\n", iface, device);
+
+    *device = (ID3D11Device *)list->device;
+    ID3D11Device_AddRef(*device);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_command_list_GetPrivateData(ID3D11CommandList *iface,
+        REFGUID guid, UINT *data_size, void *data)
+{
+    struct d3d11_command_list *list = impl_from_ID3D11CommandList(iface);
+
+    TRACE("iface %p, guid %s, data_size %p, data %p.\n", iface, debugstr_guid(guid), data_size, data);
+
+    return d3d_get_private_data(&list->private_store, guid, data_size, data);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_command_list_SetPrivateData(ID3D11CommandList *iface,
+        REFGUID guid, UINT data_size, const void *data)
+{
+    struct d3d11_command_list *list = impl_from_ID3D11CommandList(iface);
+
+    TRACE("iface %p, guid %s, data_size %u, data %p.\n", iface, debugstr_guid(guid), data_size, data);
+
+    return d3d_set_private_data(&list->private_store, guid, data_size, data);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_command_list_SetPrivateDataInterface(ID3D11CommandList *iface,
+        REFGUID guid, const IUnknown *data)
+{
+    struct d3d11_command_list *list = impl_from_ID3D11CommandList(iface);
+
+    TRACE("iface %p, guid %s, data %p.\n", iface, debugstr_guid(guid), data);
+
+    return d3d_set_private_data_interface(&list->private_store, guid, data);
+}
+
+static UINT STDMETHODCALLTYPE d3d11_command_list_GetContextFlags(ID3D11CommandList *iface)
+{
+    TRACE("iface %p.\n", iface);
+
+    return 0;
+}
+
+static const struct ID3D11CommandListVtbl d3d11_command_list_vtbl =
+{
+    /* IUnknown methods */
+    d3d11_command_list_QueryInterface,
+    d3d11_command_list_AddRef,
+    d3d11_command_list_Release,
+    /* ID3D11DeviceChild methods */
+    d3d11_command_list_GetDevice,
+    d3d11_command_list_GetPrivateData,
+    d3d11_command_list_SetPrivateData,
+    d3d11_command_list_SetPrivateDataInterface,
+    /* ID3D11CommandList methods */
+    d3d11_command_list_GetContextFlags,
+};
+
+static struct d3d11_command_list *unsafe_impl_from_ID3D11CommandList(ID3D11CommandList *iface)
+{
+    if (!iface)
+        return NULL;
+    assert(iface->lpVtbl == &d3d11_command_list_vtbl);
+
+    return impl_from_ID3D11CommandList(iface);
+}
+
+static HRESULT d3d11_command_list_create(ID3D11Device2 *device, struct d3d11_command_buffer *buffer,
+        struct d3d11_command_list **list)
+{
+    struct d3d11_command_list *object;
+
+    if (!(object = heap_alloc_zero(sizeof(*object))))
+        return E_OUTOFMEMORY;
+
+    object->ID3D11CommandList_iface.lpVtbl = &d3d11_command_list_vtbl;
+    object->refcount = 1;
+    wined3d_private_store_init(&object->private_store);
+    /* Take ownership of the recorded calls. */
+    object->buffer = *buffer;
+    memset(buffer, 0, sizeof(*buffer));
+    ID3D11Device2_AddRef(object->device = device);
+
+    TRACE("Created command list %p.\n", object);
+    *list = object;
+
+    return S_OK;
+}
+
+/* ID3D11DeviceContext - immediate context methods */
+
+static inline struct d3d11_immediate_context *impl_from_ID3D11DeviceContext1(ID3D11DeviceContext1 *iface)
+{
+    return CONTAINING_RECORD(iface, struct d3d11_immediate_context, ID3D11DeviceContext1_iface);
+}
+
+static inline struct d3d_device *device_from_immediate_ID3D11DeviceContext1(ID3D11DeviceContext1 *iface)
+{
+    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
+    return CONTAINING_RECORD(context, struct d3d_device, immediate_context);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_QueryInterface(ID3D11DeviceContext1 *iface,
+        REFIID iid, void **out)
+{
+    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, iid %s, out %p.\n", iface, debugstr_guid(iid), out);
+
+    if (IsEqualGUID(iid, &IID_ID3D11DeviceContext1)
+            || IsEqualGUID(iid, &IID_ID3D11DeviceContext)
+            || IsEqualGUID(iid, &IID_ID3D11DeviceChild)
+            || IsEqualGUID(iid, &IID_IUnknown))
+    {
+        *out = &context->ID3D11DeviceContext1_iface;
+    }
+    else if (IsEqualGUID(iid, &IID_ID3D11Multithread))
+    {
+        *out = &context->ID3D11Multithread_iface;
+    }
+    else
+    {
+        WARN("%s not implemented, returning E_NOINTERFACE.\n", debugstr_guid(iid));
+        *out = NULL;
+        return E_NOINTERFACE;
+    }
+
+    ID3D11DeviceContext1_AddRef(iface);
+    return S_OK;
+}
+
+static ULONG STDMETHODCALLTYPE d3d11_immediate_context_AddRef(ID3D11DeviceContext1 *iface)
+{
+    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    ULONG refcount = InterlockedIncrement(&context->refcount);
+
+    TRACE("%p increasing refcount to %u.\n", context, refcount);
+
+    if (refcount == 1)
+    {
+        ID3D11Device2_AddRef(&device->ID3D11Device2_iface);
+    }
+
+    return refcount;
+}
+
+static ULONG STDMETHODCALLTYPE d3d11_immediate_context_Release(ID3D11DeviceContext1 *iface)
+{
+    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    ULONG refcount = InterlockedDecrement(&context->refcount);
+
+    TRACE("%p decreasing refcount to %u.\n", context, refcount);
+
+    if (!refcount)
+    {
+        ID3D11Device2_Release(&device->ID3D11Device2_iface);
+    }
+
+    return refcount;
+}
+
+static void d3d11_immediate_context_get_constant_buffers(ID3D11DeviceContext1 *iface,
+        enum wined3d_shader_type type, UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    wined3d_mutex_lock();
+    for (i = 0; i < buffer_count; ++i)
+    {
+        struct wined3d_buffer *wined3d_buffer;
+        struct d3d_buffer *buffer_impl;
+
+        if (!(wined3d_buffer = wined3d_device_get_constant_buffer(device->wined3d_device,
+                type, start_slot + i)))
+        {
+            buffers[i] = NULL;
+            continue;
+        }
+
+        buffer_impl = wined3d_buffer_get_parent(wined3d_buffer);
+        buffers[i] = &buffer_impl->ID3D11Buffer_iface;
+        ID3D11Buffer_AddRef(buffers[i]);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void d3d11_immediate_context_set_constant_buffers(ID3D11DeviceContext1 *iface,
+        enum wined3d_shader_type type, UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    wined3d_mutex_lock();
+    for (i = 0; i < buffer_count; ++i)
+    {
+        struct d3d_buffer *buffer = unsafe_impl_from_ID3D11Buffer(buffers[i]);
+
+        wined3d_device_set_constant_buffer(device->wined3d_device, type, start_slot + i,
+                buffer ? buffer->wined3d_buffer : NULL);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_GetDevice(ID3D11DeviceContext1 *iface, ID3D11Device **device)
+{
+    struct d3d_device *device_object = device_from_immediate_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, device %p.\n", iface, device);
+
+    *device = (ID3D11Device *)&device_object->ID3D11Device2_iface;
+    ID3D11Device_AddRef(*device);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_GetPrivateData(ID3D11DeviceContext1 *iface, REFGUID guid,
+        UINT *data_size, void *data)
+{
+    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, guid %s, data_size %p, data %p.\n", iface, debugstr_guid(guid), data_size, data);
+
+    return d3d_get_private_data(&context->private_store, guid, data_size, data);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_SetPrivateData(ID3D11DeviceContext1 *iface, REFGUID guid,
+        UINT data_size, const void *data)
+{
+    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, guid %s, data_size %u, data %p.\n", iface, debugstr_guid(guid), data_size, data);
+
+    return d3d_set_private_data(&context->private_store, guid, data_size, data);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_SetPrivateDataInterface(ID3D11DeviceContext1 *iface,
+        REFGUID guid, const IUnknown *data)
+{
+    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, guid %s, data %p.\n", iface, debugstr_guid(guid), data);
+
+    return d3d_set_private_data_interface(&context->private_store, guid, data);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_VSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_immediate_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_VERTEX, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_PSSetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
+            iface, start_slot, view_count, views);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct d3d_shader_resource_view *view = unsafe_impl_from_ID3D11ShaderResourceView(views[i]);
+
+        wined3d_device_set_ps_resource_view(device->wined3d_device, start_slot + i,
+                view ? view->wined3d_view : NULL);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_PSSetShader(ID3D11DeviceContext1 *iface,
+        ID3D11PixelShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_pixel_shader *ps = unsafe_impl_from_ID3D11PixelShader(shader);
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (class_instances)
+        FIXME("Dynamic linking is not implemented yet.\n");
+
+    wined3d_mutex_lock();
+    wined3d_device_set_pixel_shader(device->wined3d_device, ps ? ps->wined3d_shader : NULL);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_PSSetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < sampler_count; ++i)
+    {
+        struct d3d_sampler_state *sampler = unsafe_impl_from_ID3D11SamplerState(samplers[i]);
+
+        wined3d_device_set_ps_sampler(device->wined3d_device, start_slot + i,
+                sampler ? sampler->wined3d_sampler : NULL);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_VSSetShader(ID3D11DeviceContext1 *iface,
+        ID3D11VertexShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_vertex_shader *vs = unsafe_impl_from_ID3D11VertexShader(shader);
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (class_instances)
+        FIXME("Dynamic linking is not implemented yet.\n");
+
+    wined3d_mutex_lock();
+    wined3d_device_set_vertex_shader(device->wined3d_device, vs ? vs->wined3d_shader : NULL);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DrawIndexed(ID3D11DeviceContext1 *iface,
+        UINT index_count, UINT start_index_location, INT base_vertex_location)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, index_count %u, start_index_location %u, base_vertex_location %d.\n",
+            iface, index_count, start_index_location, base_vertex_location);
+
+    wined3d_mutex_lock();
+    wined3d_device_set_base_vertex_index(device->wined3d_device, base_vertex_location);
+    wined3d_device_draw_indexed_primitive(device->wined3d_device, start_index_location, index_count);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_Draw(ID3D11DeviceContext1 *iface,
+        UINT vertex_count, UINT start_vertex_location)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, vertex_count %u, start_vertex_location %u.\n",
+            iface, vertex_count, start_vertex_location);
+
+    wined3d_mutex_lock();
+    wined3d_device_draw_primitive(device->wined3d_device, start_vertex_location, vertex_count);
+    wined3d_mutex_unlock();
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_Map(ID3D11DeviceContext1 *iface, ID3D11Resource *resource,
+        UINT subresource_idx, D3D11_MAP map_type, UINT map_flags, D3D11_MAPPED_SUBRESOURCE *mapped_subresource)
+{
+    struct wined3d_resource *wined3d_resource;
+    struct wined3d_map_desc map_desc;
+    HRESULT hr;
+
+    TRACE("iface %p, resource %p, subresource_idx %u, map_type %u, map_flags %#x, mapped_subresource %p.\n",
+            iface, resource, subresource_idx, map_type, map_flags, mapped_subresource);
+
+    if (map_flags)
+        FIXME("Ignoring map_flags %#x.\n", map_flags);
+
+    wined3d_resource = wined3d_resource_from_d3d11_resource(resource);
+
+    wined3d_mutex_lock();
+    hr = wined3d_resource_map(wined3d_resource, subresource_idx,
+            &map_desc, NULL, wined3d_map_flags_from_d3d11_map_type(map_type));
+    wined3d_mutex_unlock();
+
+    mapped_subresource->pData = map_desc.data;
+    mapped_subresource->RowPitch = map_desc.row_pitch;
+    mapped_subresource->DepthPitch = map_desc.slice_pitch;
+
+    return hr;
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_Unmap(ID3D11DeviceContext1 *iface, ID3D11Resource *resource,
+        UINT subresource_idx)
+{
+    struct wined3d_resource *wined3d_resource;
+
+    TRACE("iface %p, resource %p, subresource_idx %u.\n", iface, resource, subresource_idx);
+
+    wined3d_resource = wined3d_resource_from_d3d11_resource(resource);
+
+    wined3d_mutex_lock();
+    wined3d_resource_unmap(wined3d_resource, subresource_idx);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_PSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_immediate_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_PIXEL, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_IASetInputLayout(ID3D11DeviceContext1 *iface,
+        ID3D11InputLayout *input_layout)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_input_layout *layout = unsafe_impl_from_ID3D11InputLayout(input_layout);
+
+    TRACE("iface %p, input_layout %p.\n", iface, input_layout);
+
+    wined3d_mutex_lock();
+    wined3d_device_set_vertex_declaration(device->wined3d_device, layout ? layout->wined3d_decl : NULL);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_IASetVertexBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers, const UINT *strides, const UINT *offsets)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p, strides %p, offsets %p.\n",
+            iface, start_slot, buffer_count, buffers, strides, offsets);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < buffer_count; ++i)
+    {
+        struct d3d_buffer *buffer = unsafe_impl_from_ID3D11Buffer(buffers[i]);
+
+        wined3d_device_set_stream_source(device->wined3d_device, start_slot + i,
+                buffer ? buffer->wined3d_buffer : NULL, offsets[i], strides[i]);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_IASetIndexBuffer(ID3D11DeviceContext1 *iface,
+        ID3D11Buffer *buffer, DXGI_FORMAT format, UINT offset)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_buffer *buffer_impl = unsafe_impl_from_ID3D11Buffer(buffer);
+
+    TRACE("iface %p, buffer %p, format %s, offset %u.\n",
+            iface, buffer, debug_dxgi_format(format), offset);
+
+    wined3d_mutex_lock();
+    wined3d_device_set_index_buffer(device->wined3d_device,
+            buffer_impl ? buffer_impl->wined3d_buffer : NULL,
+            wined3dformat_from_dxgi_format(format), offset);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DrawIndexedInstanced(ID3D11DeviceContext1 *iface,
+        UINT instance_index_count, UINT instance_count, UINT start_index_location, INT base_vertex_location,
+        UINT start_instance_location)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, instance_index_count %u, instance_count %u, start_index_location %u, "
+            "base_vertex_location %d, start_instance_location %u.\n",
+            iface, instance_index_count, instance_count, start_index_location,
+            base_vertex_location, start_instance_location);
+
+    wined3d_mutex_lock();
+    wined3d_device_set_base_vertex_index(device->wined3d_device, base_vertex_location);
+    wined3d_device_draw_indexed_primitive_instanced(device->wined3d_device, start_index_location,
+            instance_index_count, start_instance_location, instance_count);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DrawInstanced(ID3D11DeviceContext1 *iface,
+        UINT instance_vertex_count, UINT instance_count, UINT start_vertex_location, UINT start_instance_location)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, instance_vertex_count %u, instance_count %u, start_vertex_location %u, "
+            "start_instance_location %u.\n",
+            iface, instance_vertex_count, instance_count, start_vertex_location,
+            start_instance_location);
+
+    wined3d_mutex_lock();
+    wined3d_device_draw_primitive_instanced(device->wined3d_device, start_vertex_location,
+            instance_vertex_count, start_instance_location, instance_count);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_GSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_immediate_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_GEOMETRY, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_GSSetShader(ID3D11DeviceContext1 *iface,
+        ID3D11GeometryShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_geometry_shader *gs = unsafe_impl_from_ID3D11GeometryShader(shader);
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (class_instances)
+        FIXME("Dynamic linking is not implemented yet.\n");
+
+    wined3d_mutex_lock();
+    wined3d_device_set_geometry_shader(device->wined3d_device, gs ? gs->wined3d_shader : NULL);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_IASetPrimitiveTopology(ID3D11DeviceContext1 *iface,
+        D3D11_PRIMITIVE_TOPOLOGY topology)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    enum wined3d_primitive_type primitive_type;
+    unsigned int patch_vertex_count;
+
+    TRACE("iface %p, topology %#x.\n", iface, topology);
+
+    wined3d_primitive_type_from_d3d11_primitive_topology(topology, &primitive_type, &patch_vertex_count);
+
+    wined3d_mutex_lock();
+    wined3d_device_set_primitive_type(device->wined3d_device, primitive_type, patch_vertex_count);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_VSSetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct d3d_shader_resource_view *view = unsafe_impl_from_ID3D11ShaderResourceView(views[i]);
+
+        wined3d_device_set_vs_resource_view(device->wined3d_device, start_slot + i,
+                view ? view->wined3d_view : NULL);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_VSSetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < sampler_count; ++i)
+    {
+        struct d3d_sampler_state *sampler = unsafe_impl_from_ID3D11SamplerState(samplers[i]);
+
+        wined3d_device_set_vs_sampler(device->wined3d_device, start_slot + i,
+                sampler ? sampler->wined3d_sampler : NULL);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_Begin(ID3D11DeviceContext1 *iface,
+        ID3D11Asynchronous *asynchronous)
+{
+    struct d3d_query *query = unsafe_impl_from_ID3D11Asynchronous(asynchronous);
+    HRESULT hr;
+
+    TRACE("iface %p, asynchronous %p.\n", iface, asynchronous);
+
+    wined3d_mutex_lock();
+    if (FAILED(hr = wined3d_query_issue(query->wined3d_query, WINED3DISSUE_BEGIN)))
+        ERR("Failed to issue query, hr %#x.\n", hr);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_End(ID3D11DeviceContext1 *iface,
+        ID3D11Asynchronous *asynchronous)
+{
+    struct d3d_query *query = unsafe_impl_from_ID3D11Asynchronous(asynchronous);
+    HRESULT hr;
+
+    TRACE("iface %p, asynchronous %p.\n", iface, asynchronous);
+
+    wined3d_mutex_lock();
+    if (FAILED(hr = wined3d_query_issue(query->wined3d_query, WINED3DISSUE_END)))
+        ERR("Failed to issue query, hr %#x.\n", hr);
+    wined3d_mutex_unlock();
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_GetData(ID3D11DeviceContext1 *iface,
+        ID3D11Asynchronous *asynchronous, void *data, UINT data_size, UINT data_flags)
+{
+    struct d3d_query *query = unsafe_impl_from_ID3D11Asynchronous(asynchronous);
+    unsigned int wined3d_flags;
+    HRESULT hr;
+
+    TRACE("iface %p, asynchronous %p, data %p, data_size %u, data_flags %#x.\n",
+            iface, asynchronous, data, data_size, data_flags);
+
+    if (!data && data_size)
+        return E_INVALIDARG;
+
+    wined3d_flags = wined3d_getdata_flags_from_d3d11_async_getdata_flags(data_flags);
+
+    wined3d_mutex_lock();
+    if (!data_size || wined3d_query_get_data_size(query->wined3d_query) == data_size)
+    {
+        hr = wined3d_query_get_data(query->wined3d_query, data, data_size, wined3d_flags);
+        if (hr == WINED3DERR_INVALIDCALL)
+            hr = DXGI_ERROR_INVALID_CALL;
+    }
+    else
+    {
+        WARN("Invalid data size %u.\n", data_size);
+        hr = E_INVALIDARG;
+    }
+    wined3d_mutex_unlock();
+
+    return hr;
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_SetPredication(ID3D11DeviceContext1 *iface,
+        ID3D11Predicate *predicate, BOOL value)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_query *query;
+
+    TRACE("iface %p, predicate %p, value %#x.\n", iface, predicate, value);
+
+    query = unsafe_impl_from_ID3D11Query((ID3D11Query *)predicate);
+
+    wined3d_mutex_lock();
+    wined3d_device_set_predication(device->wined3d_device, query ? query->wined3d_query : NULL, value);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_GSSetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct d3d_shader_resource_view *view = unsafe_impl_from_ID3D11ShaderResourceView(views[i]);
+
+        wined3d_device_set_gs_resource_view(device->wined3d_device, start_slot + i,
+                view ? view->wined3d_view : NULL);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_GSSetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < sampler_count; ++i)
+    {
+        struct d3d_sampler_state *sampler = unsafe_impl_from_ID3D11SamplerState(samplers[i]);
+
+        wined3d_device_set_gs_sampler(device->wined3d_device, start_slot + i,
+                sampler ? sampler->wined3d_sampler : NULL);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_OMSetRenderTargets(ID3D11DeviceContext1 *iface,
+        UINT render_target_view_count, ID3D11RenderTargetView *const *render_target_views,
+        ID3D11DepthStencilView *depth_stencil_view)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_depthstencil_view *dsv;
+    unsigned int i;
+
+    TRACE("iface %p, render_target_view_count %u, render_target_views %p, depth_stencil_view %p.\n",
+            iface, render_target_view_count, render_target_views, depth_stencil_view);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < render_target_view_count; ++i)
+    {
+        struct d3d_rendertarget_view *rtv = unsafe_impl_from_ID3D11RenderTargetView(render_target_views[i]);
+        wined3d_device_set_rendertarget_view(device->wined3d_device, i, rtv ? rtv->wined3d_view : NULL, FALSE);
+    }
+    for (; i < D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT; ++i)
+    {
+        wined3d_device_set_rendertarget_view(device->wined3d_device, i, NULL, FALSE);
+    }
+
+    dsv = unsafe_impl_from_ID3D11DepthStencilView(depth_stencil_view);
+    wined3d_device_set_depth_stencil_view(device->wined3d_device, dsv ? dsv->wined3d_view : NULL);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_OMSetRenderTargetsAndUnorderedAccessViews(
+        ID3D11DeviceContext1 *iface, UINT render_target_view_count,
+        ID3D11RenderTargetView *const *render_target_views, ID3D11DepthStencilView *depth_stencil_view,
+        UINT unordered_access_view_start_slot, UINT unordered_access_view_count,
+        ID3D11UnorderedAccessView *const *unordered_access_views, const UINT *initial_counts)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, render_target_view_count %u, render_target_views %p, depth_stencil_view %p, "
+            "unordered_access_view_start_slot %u, unordered_access_view_count %u, unordered_access_views %p, "
+            "initial_counts %p.\n",
+            iface, render_target_view_count, render_target_views, depth_stencil_view,
+            unordered_access_view_start_slot, unordered_access_view_count, unordered_access_views,
+            initial_counts);
+
+    if (render_target_view_count != D3D11_KEEP_RENDER_TARGETS_AND_DEPTH_STENCIL)
+    {
+        d3d11_immediate_context_OMSetRenderTargets(iface, render_target_view_count, render_target_views,
+                depth_stencil_view);
+    }
+
+    if (unordered_access_view_count != D3D11_KEEP_UNORDERED_ACCESS_VIEWS)
+    {
+        wined3d_mutex_lock();
+        for (i = 0; i < unordered_access_view_start_slot; ++i)
+        {
+            wined3d_device_set_unordered_access_view(device->wined3d_device, i, NULL, ~0u);
+        }
+        for (i = 0; i < unordered_access_view_count; ++i)
+        {
+            struct d3d11_unordered_access_view *view
+                    = unsafe_impl_from_ID3D11UnorderedAccessView(unordered_access_views[i]);
+
+            wined3d_device_set_unordered_access_view(device->wined3d_device,
+                    unordered_access_view_start_slot + i,
+                    view ? view->wined3d_view : NULL, initial_counts ? initial_counts[i] : ~0u);
+        }
+        for (; unordered_access_view_start_slot + i < D3D11_PS_CS_UAV_REGISTER_COUNT; ++i)
+        {
+            wined3d_device_set_unordered_access_view(device->wined3d_device,
+                    unordered_access_view_start_slot + i, NULL, ~0u);
+        }
+        wined3d_mutex_unlock();
+    }
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_OMSetBlendState(ID3D11DeviceContext1 *iface,
+        ID3D11BlendState *blend_state, const float blend_factor[4], UINT sample_mask)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    static const float default_blend_factor[] = {1.0f, 1.0f, 1.0f, 1.0f};
+    struct d3d_blend_state *blend_state_impl;
+
+    TRACE("iface %p, blend_state %p, blend_factor %s, sample_mask 0x%08x.\n",
+            iface, blend_state, debug_float4(blend_factor), sample_mask);
+
+    if (!blend_factor)
+        blend_factor = default_blend_factor;
+
+    wined3d_mutex_lock();
+    if (!(blend_state_impl = unsafe_impl_from_ID3D11BlendState(blend_state)))
+        wined3d_device_set_blend_state(device->wined3d_device, NULL,
+                (const struct wined3d_color *)blend_factor, sample_mask);
+    else
+        wined3d_device_set_blend_state(device->wined3d_device, blend_state_impl->wined3d_state,
+                (const struct wined3d_color *)blend_factor, sample_mask);
+    wined3d_mutex_unlock();
+}
+
+static void set_default_depth_stencil_state(struct wined3d_device *wined3d_device)
+{
+    wined3d_device_set_render_state(wined3d_device, WINED3D_RS_ZENABLE, TRUE);
+    wined3d_device_set_render_state(wined3d_device, WINED3D_RS_ZWRITEENABLE, D3D11_DEPTH_WRITE_MASK_ALL);
+    wined3d_device_set_render_state(wined3d_device, WINED3D_RS_ZFUNC, WINED3D_CMP_LESS);
+    wined3d_device_set_render_state(wined3d_device, WINED3D_RS_STENCILENABLE, FALSE);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_OMSetDepthStencilState(ID3D11DeviceContext1 *iface,
+        ID3D11DepthStencilState *depth_stencil_state, UINT stencil_ref)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    const D3D11_DEPTH_STENCILOP_DESC *front, *back;
+    const D3D11_DEPTH_STENCIL_DESC *desc;
+
+    TRACE("iface %p, depth_stencil_state %p, stencil_ref %u.\n",
+            iface, depth_stencil_state, stencil_ref);
+
+    wined3d_mutex_lock();
+    device->stencil_ref = stencil_ref;
+    if (!(device->depth_stencil_state = unsafe_impl_from_ID3D11DepthStencilState(depth_stencil_state)))
+    {
+        set_default_depth_stencil_state(device->wined3d_device);
+        wined3d_mutex_unlock();
+        return;
+    }
+
+    desc = &device->depth_stencil_state->desc;
+
+    front = &desc->FrontFace;
+    back = &desc->BackFace;
+
+    wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_ZENABLE, desc->DepthEnable);
+    if (desc->DepthEnable)
+    {
+        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_ZWRITEENABLE, desc->DepthWriteMask);
+        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_ZFUNC, desc->DepthFunc);
+    }
+
+    wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILENABLE, desc->StencilEnable);
+    if (desc->StencilEnable)
+    {
+        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILMASK, desc->StencilReadMask);
+        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILWRITEMASK, desc->StencilWriteMask);
+        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILREF, stencil_ref);
+
+        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILFAIL, front->StencilFailOp);
+        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILZFAIL, front->StencilDepthFailOp);
+        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILPASS, front->StencilPassOp);
+        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILFUNC, front->StencilFunc);
+        if (front->StencilFailOp != back->StencilFailOp
+                || front->StencilDepthFailOp != back->StencilDepthFailOp
+                || front->StencilPassOp != back->StencilPassOp
+                || front->StencilFunc != back->StencilFunc)
+        {
+            wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_TWOSIDEDSTENCILMODE, TRUE);
+            wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_BACK_STENCILFAIL, back->StencilFailOp);
+            wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_BACK_STENCILZFAIL,
+                    back->StencilDepthFailOp);
+            wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_BACK_STENCILPASS, back->StencilPassOp);
+            wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_BACK_STENCILFUNC, back->StencilFunc);
+        }
+        else
+        {
+            wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_TWOSIDEDSTENCILMODE, FALSE);
+        }
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_SOSetTargets(ID3D11DeviceContext1 *iface, UINT buffer_count,
+        ID3D11Buffer *const *buffers, const UINT *offsets)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int count, i;
+
+    TRACE("iface %p, buffer_count %u, buffers %p, offsets %p.\n", iface, buffer_count, buffers, offsets);
+
+    count = min(buffer_count, D3D11_SO_BUFFER_SLOT_COUNT);
+    wined3d_mutex_lock();
+    for (i = 0; i < count; ++i)
+    {
+        struct d3d_buffer *buffer = unsafe_impl_from_ID3D11Buffer(buffers[i]);
+
+        wined3d_device_set_stream_output(device->wined3d_device, i,
+                buffer ? buffer->wined3d_buffer : NULL, offsets ? offsets[i] : 0);
+    }
+    for (; i < D3D11_SO_BUFFER_SLOT_COUNT; ++i)
+    {
+        wined3d_device_set_stream_output(device->wined3d_device, i, NULL, 0);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DrawAuto(ID3D11DeviceContext1 *iface)
+{
+    FIXME("iface %p stub!\n", iface);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DrawIndexedInstancedIndirect(ID3D11DeviceContext1 *iface,
+        ID3D11Buffer *buffer, UINT offset)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_buffer *d3d_buffer;
+
+    TRACE("iface %p, buffer %p, offset %u.\n", iface, buffer, offset);
+
+    d3d_buffer = unsafe_impl_from_ID3D11Buffer(buffer);
+
+    wined3d_mutex_lock();
+    wined3d_device_draw_indexed_primitive_instanced_indirect(device->wined3d_device,
+            d3d_buffer->wined3d_buffer, offset);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DrawInstancedIndirect(ID3D11DeviceContext1 *iface,
+        ID3D11Buffer *buffer, UINT offset)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_buffer *d3d_buffer;
+
+    TRACE("iface %p, buffer %p, offset %u.\n", iface, buffer, offset);
+
+    d3d_buffer = unsafe_impl_from_ID3D11Buffer(buffer);
+
+    wined3d_mutex_lock();
+    wined3d_device_draw_primitive_instanced_indirect(device->wined3d_device,
+            d3d_buffer->wined3d_buffer, offset);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_Dispatch(ID3D11DeviceContext1 *iface,
+        UINT thread_group_count_x, UINT thread_group_count_y, UINT thread_group_count_z)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, thread_group_count_x %u, thread_group_count_y %u, thread_group_count_z %u.\n",
+            iface, thread_group_count_x, thread_group_count_y, thread_group_count_z);
+
+    wined3d_mutex_lock();
+    wined3d_device_dispatch_compute(device->wined3d_device,
+            thread_group_count_x, thread_group_count_y, thread_group_count_z);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DispatchIndirect(ID3D11DeviceContext1 *iface,
+        ID3D11Buffer *buffer, UINT offset)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_buffer *buffer_impl;
+
+    TRACE("iface %p, buffer %p, offset %u.\n", iface, buffer, offset);
+
+    buffer_impl = unsafe_impl_from_ID3D11Buffer(buffer);
+
+    wined3d_mutex_lock();
+    wined3d_device_dispatch_compute_indirect(device->wined3d_device,
+            buffer_impl->wined3d_buffer, offset);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_RSSetState(ID3D11DeviceContext1 *iface,
+        ID3D11RasterizerState *rasterizer_state)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_rasterizer_state *rasterizer_state_impl;
+    const D3D11_RASTERIZER_DESC *desc;
+
+    TRACE("iface %p, rasterizer_state %p.\n", iface, rasterizer_state);
+
+    wined3d_mutex_lock();
+    if (!(rasterizer_state_impl = unsafe_impl_from_ID3D11RasterizerState(rasterizer_state)))
+    {
+        wined3d_device_set_rasterizer_state(device->wined3d_device, NULL);
+        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_MULTISAMPLEANTIALIAS, FALSE);
+        wined3d_mutex_unlock();
+        return;
+    }
+
+    wined3d_device_set_rasterizer_state(device->wined3d_device, rasterizer_state_impl->wined3d_state);
+
+    desc = &rasterizer_state_impl->desc;
+    wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_MULTISAMPLEANTIALIAS, desc->MultisampleEnable);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_RSSetViewports(ID3D11DeviceContext1 *iface,
+        UINT viewport_count, const D3D11_VIEWPORT *viewports)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_viewport wined3d_vp[WINED3D_MAX_VIEWPORTS];
+    unsigned int i;
+
+    TRACE("iface %p, viewport_count %u, viewports %p.\n", iface, viewport_count, viewports);
+
+    if (viewport_count > ARRAY_SIZE(wined3d_vp))
+        return;
+
+    for (i = 0; i < viewport_count; ++i)
+    {
+        wined3d_vp[i].x = viewports[i].TopLeftX;
+        wined3d_vp[i].y = viewports[i].TopLeftY;
+        wined3d_vp[i].width = viewports[i].Width;
+        wined3d_vp[i].height = viewports[i].Height;
+        wined3d_vp[i].min_z = viewports[i].MinDepth;
+        wined3d_vp[i].max_z = viewports[i].MaxDepth;
+    }
+
+    wined3d_mutex_lock();
+    wined3d_device_set_viewports(device->wined3d_device, viewport_count, wined3d_vp);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_RSSetScissorRects(ID3D11DeviceContext1 *iface,
+        UINT rect_count, const D3D11_RECT *rects)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, rect_count %u, rects %p.\n", iface, rect_count, rects);
+
+    if (rect_count > WINED3D_MAX_VIEWPORTS)
+        return;
+
+    wined3d_mutex_lock();
+    wined3d_device_set_scissor_rects(device->wined3d_device, rect_count, rects);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CopySubresourceRegion(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *dst_resource, UINT dst_subresource_idx, UINT dst_x, UINT dst_y, UINT dst_z,
+        ID3D11Resource *src_resource, UINT src_subresource_idx, const D3D11_BOX *src_box)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_resource *wined3d_dst_resource, *wined3d_src_resource;
+    struct wined3d_box wined3d_src_box;
+
+    TRACE("iface %p, dst_resource %p, dst_subresource_idx %u, dst_x %u, dst_y %u, dst_z %u, "
+            "src_resource %p, src_subresource_idx %u, src_box %p.\n",
+            iface, dst_resource, dst_subresource_idx, dst_x, dst_y, dst_z,
+            src_resource, src_subresource_idx, src_box);
+
+    if (src_box)
+        wined3d_box_set(&wined3d_src_box, src_box->left, src_box->top,
+                src_box->right, src_box->bottom, src_box->front, src_box->back);
+
+    wined3d_dst_resource = wined3d_resource_from_d3d11_resource(dst_resource);
+    wined3d_src_resource = wined3d_resource_from_d3d11_resource(src_resource);
+    wined3d_mutex_lock();
+    wined3d_device_copy_sub_resource_region(device->wined3d_device, wined3d_dst_resource, dst_subresource_idx,
+            dst_x, dst_y, dst_z, wined3d_src_resource, src_subresource_idx, src_box ? &wined3d_src_box : NULL, 0);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CopyResource(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *dst_resource, ID3D11Resource *src_resource)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_resource *wined3d_dst_resource, *wined3d_src_resource;
+
+    TRACE("iface %p, dst_resource %p, src_resource %p.\n", iface, dst_resource, src_resource);
+
+    wined3d_dst_resource = wined3d_resource_from_d3d11_resource(dst_resource);
+    wined3d_src_resource = wined3d_resource_from_d3d11_resource(src_resource);
+    wined3d_mutex_lock();
+    wined3d_device_copy_resource(device->wined3d_device, wined3d_dst_resource, wined3d_src_resource);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_UpdateSubresource(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *resource, UINT subresource_idx, const D3D11_BOX *box,
+        const void *data, UINT row_pitch, UINT depth_pitch)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_resource *wined3d_resource;
+    struct wined3d_box wined3d_box;
+
+    TRACE("iface %p, resource %p, subresource_idx %u, box %p, data %p, row_pitch %u, depth_pitch %u.\n",
+            iface, resource, subresource_idx, box, data, row_pitch, depth_pitch);
+
+    if (box)
+        wined3d_box_set(&wined3d_box, box->left, box->top, box->right, box->bottom, box->front, box->back);
+
+    wined3d_resource = wined3d_resource_from_d3d11_resource(resource);
+    wined3d_mutex_lock();
+    wined3d_device_update_sub_resource(device->wined3d_device, wined3d_resource,
+            subresource_idx, box ? &wined3d_box : NULL, data, row_pitch, depth_pitch, 0);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CopyStructureCount(ID3D11DeviceContext1 *iface,
+        ID3D11Buffer *dst_buffer, UINT dst_offset, ID3D11UnorderedAccessView *src_view)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_unordered_access_view *uav;
+    struct d3d_buffer *buffer_impl;
+
+    TRACE("iface %p, dst_buffer %p, dst_offset %u, src_view %p.\n",
+            iface, dst_buffer, dst_offset, src_view);
+
+    buffer_impl = unsafe_impl_from_ID3D11Buffer(dst_buffer);
+    uav = unsafe_impl_from_ID3D11UnorderedAccessView(src_view);
+
+    wined3d_mutex_lock();
+    wined3d_device_copy_uav_counter(device->wined3d_device,
+            buffer_impl->wined3d_buffer, dst_offset, uav->wined3d_view);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_ClearRenderTargetView(ID3D11DeviceContext1 *iface,
+        ID3D11RenderTargetView *render_target_view, const float color_rgba[4])
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_rendertarget_view *view = unsafe_impl_from_ID3D11RenderTargetView(render_target_view);
+    const struct wined3d_color color = {color_rgba[0], color_rgba[1], color_rgba[2], color_rgba[3]};
+    HRESULT hr;
+
+    TRACE("iface %p, render_target_view %p, color_rgba %s.\n",
+            iface, render_target_view, debug_float4(color_rgba));
+
+    if (!view)
+        return;
+
+    wined3d_mutex_lock();
+    if (FAILED(hr = wined3d_device_clear_rendertarget_view(device->wined3d_device, view->wined3d_view, NULL,
+            WINED3DCLEAR_TARGET, &color, 0.0f, 0)))
+        ERR("Failed to clear view, hr %#x.\n", hr);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_ClearUnorderedAccessViewUint(ID3D11DeviceContext1 *iface,
+        ID3D11UnorderedAccessView *unordered_access_view, const UINT values[4])
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_unordered_access_view *view;
+
+    TRACE("iface %p, unordered_access_view %p, values {%u, %u, %u, %u}.\n",
+            iface, unordered_access_view, values[0], values[1], values[2], values[3]);
+
+    view = unsafe_impl_from_ID3D11UnorderedAccessView(unordered_access_view);
+    wined3d_mutex_lock();
+    wined3d_device_clear_unordered_access_view_uint(device->wined3d_device,
+            view->wined3d_view, (const struct wined3d_uvec4 *)values);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_ClearUnorderedAccessViewFloat(ID3D11DeviceContext1 *iface,
+        ID3D11UnorderedAccessView *unordered_access_view, const float values[4])
+{
+    FIXME("iface %p, unordered_access_view %p, values %s stub!\n",
+            iface, unordered_access_view, debug_float4(values));
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_ClearDepthStencilView(ID3D11DeviceContext1 *iface,
+        ID3D11DepthStencilView *depth_stencil_view, UINT flags, FLOAT depth, UINT8 stencil)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_depthstencil_view *view = unsafe_impl_from_ID3D11DepthStencilView(depth_stencil_view);
+    DWORD wined3d_flags;
+    HRESULT hr;
+
+    TRACE("iface %p, depth_stencil_view %p, flags %#x, depth %.8e, stencil %u.\n",
+            iface, depth_stencil_view, flags, depth, stencil);
+
+    if (!view)
+        return;
+
+    wined3d_flags = wined3d_clear_flags_from_d3d11_clear_flags(flags);
+
+    wined3d_mutex_lock();
+    if (FAILED(hr = wined3d_device_clear_rendertarget_view(device->wined3d_device, view->wined3d_view, NULL,
+            wined3d_flags, NULL, depth, stencil)))
+        ERR("Failed to clear view, hr %#x.\n", hr);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_GenerateMips(ID3D11DeviceContext1 *iface,
+        ID3D11ShaderResourceView *view)
+{
+    struct d3d_shader_resource_view *srv = unsafe_impl_from_ID3D11ShaderResourceView(view);
+
+    TRACE("iface %p, view %p.\n", iface, view);
+
+    wined3d_mutex_lock();
+    wined3d_shader_resource_view_generate_mipmaps(srv->wined3d_view);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_SetResourceMinLOD(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *resource, FLOAT min_lod)
+{
+    FIXME("iface %p, resource %p, min_lod %f stub!\n", iface, resource, min_lod);
+}
+
+static FLOAT STDMETHODCALLTYPE d3d11_immediate_context_GetResourceMinLOD(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *resource)
+{
+    FIXME("iface %p, resource %p stub!\n", iface, resource);
+
+    return 0.0f;
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_ResolveSubresource(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *dst_resource, UINT dst_subresource_idx,
+        ID3D11Resource *src_resource, UINT src_subresource_idx,
+        DXGI_FORMAT format)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_resource *wined3d_dst_resource, *wined3d_src_resource;
+    enum wined3d_format_id wined3d_format;
+
+    TRACE("iface %p, dst_resource %p, dst_subresource_idx %u, "
+            "src_resource %p, src_subresource_idx %u, format %s.\n",
+            iface, dst_resource, dst_subresource_idx,
+            src_resource, src_subresource_idx, debug_dxgi_format(format));
+
+    wined3d_dst_resource = wined3d_resource_from_d3d11_resource(dst_resource);
+    wined3d_src_resource = wined3d_resource_from_d3d11_resource(src_resource);
+    wined3d_format = wined3dformat_from_dxgi_format(format);
+    wined3d_mutex_lock();
+    wined3d_device_resolve_sub_resource(device->wined3d_device,
+            wined3d_dst_resource, dst_subresource_idx,
+            wined3d_src_resource, src_subresource_idx, wined3d_format);
+    wined3d_mutex_unlock();
+}
+
+static void d3d11_immediate_context_capture_shader_state(ID3D11DeviceContext1 *iface,
+        struct d3d11_command_buffer *buffer, enum wined3d_shader_type type)
+{
+    ID3D11ShaderResourceView *views[D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT];
+    ID3D11Buffer *constant_buffers[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT];
+    ID3D11SamplerState *samplers[D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT];
+    IUnknown *shader;
+    unsigned int i;
+
+    switch (type)
+    {
+        case WINED3D_SHADER_TYPE_VERTEX:
+            ID3D11DeviceContext1_VSGetShader(iface, (ID3D11VertexShader **)&shader, NULL, NULL);
+            ID3D11DeviceContext1_VSGetConstantBuffers(iface, 0, ARRAY_SIZE(constant_buffers), constant_buffers);
+            ID3D11DeviceContext1_VSGetShaderResources(iface, 0, ARRAY_SIZE(views), views);
+            ID3D11DeviceContext1_VSGetSamplers(iface, 0, ARRAY_SIZE(samplers), samplers);
+            break;
+        case WINED3D_SHADER_TYPE_HULL:
+            ID3D11DeviceContext1_HSGetShader(iface, (ID3D11HullShader **)&shader, NULL, NULL);
+            ID3D11DeviceContext1_HSGetConstantBuffers(iface, 0, ARRAY_SIZE(constant_buffers), constant_buffers);
+            ID3D11DeviceContext1_HSGetShaderResources(iface, 0, ARRAY_SIZE(views), views);
+            ID3D11DeviceContext1_HSGetSamplers(iface, 0, ARRAY_SIZE(samplers), samplers);
+            break;
+        case WINED3D_SHADER_TYPE_DOMAIN:
+            ID3D11DeviceContext1_DSGetShader(iface, (ID3D11DomainShader **)&shader, NULL, NULL);
+            ID3D11DeviceContext1_DSGetConstantBuffers(iface, 0, ARRAY_SIZE(constant_buffers), constant_buffers);
+            ID3D11DeviceContext1_DSGetShaderResources(iface, 0, ARRAY_SIZE(views), views);
+            ID3D11DeviceContext1_DSGetSamplers(iface, 0, ARRAY_SIZE(samplers), samplers);
+            break;
+        case WINED3D_SHADER_TYPE_GEOMETRY:
+            ID3D11DeviceContext1_GSGetShader(iface, (ID3D11GeometryShader **)&shader, NULL, NULL);
+            ID3D11DeviceContext1_GSGetConstantBuffers(iface, 0, ARRAY_SIZE(constant_buffers), constant_buffers);
+            ID3D11DeviceContext1_GSGetShaderResources(iface, 0, ARRAY_SIZE(views), views);
+            ID3D11DeviceContext1_GSGetSamplers(iface, 0, ARRAY_SIZE(samplers), samplers);
+            break;
+        case WINED3D_SHADER_TYPE_PIXEL:
+            ID3D11DeviceContext1_PSGetShader(iface, (ID3D11PixelShader **)&shader, NULL, NULL);
+            ID3D11DeviceContext1_PSGetConstantBuffers(iface, 0, ARRAY_SIZE(constant_buffers), constant_buffers);
+            ID3D11DeviceContext1_PSGetShaderResources(iface, 0, ARRAY_SIZE(views), views);
+            ID3D11DeviceContext1_PSGetSamplers(iface, 0, ARRAY_SIZE(samplers), samplers);
+            break;
+        case WINED3D_SHADER_TYPE_COMPUTE:
+            ID3D11DeviceContext1_CSGetShader(iface, (ID3D11ComputeShader **)&shader, NULL, NULL);
+            ID3D11DeviceContext1_CSGetConstantBuffers(iface, 0, ARRAY_SIZE(constant_buffers), constant_buffers);
+            ID3D11DeviceContext1_CSGetShaderResources(iface, 0, ARRAY_SIZE(views), views);
+            ID3D11DeviceContext1_CSGetSamplers(iface, 0, ARRAY_SIZE(samplers), samplers);
+            break;
+        default:
+            ERR("Invalid shader type %#x.\n", type);
+            return;
+    }
+
+    d3d11_command_buffer_record_slots(buffer, DEFERRED_CALL_SET_SHADER, type, 0, 1, &shader);
+    d3d11_command_buffer_record_slots(buffer, DEFERRED_CALL_SET_CONSTANT_BUFFERS, type,
+            0, ARRAY_SIZE(constant_buffers), (IUnknown **)constant_buffers);
+    d3d11_command_buffer_record_slots(buffer, DEFERRED_CALL_SET_SHADER_RESOURCES, type,
+            0, ARRAY_SIZE(views), (IUnknown **)views);
+    d3d11_command_buffer_record_slots(buffer, DEFERRED_CALL_SET_SAMPLERS, type,
+            0, ARRAY_SIZE(samplers), (IUnknown **)samplers);
+
+    if (shader)
+        IUnknown_Release(shader);
+    for (i = 0; i < ARRAY_SIZE(constant_buffers); ++i)
+    {
+        if (constant_buffers[i])
+            ID3D11Buffer_Release(constant_buffers[i]);
+    }
+    for (i = 0; i < ARRAY_SIZE(views); ++i)
+    {
+        if (views[i])
+            ID3D11ShaderResourceView_Release(views[i]);
+    }
+    for (i = 0; i < ARRAY_SIZE(samplers); ++i)
+    {
+        if (samplers[i])
+            ID3D11SamplerState_Release(samplers[i]);
+    }
+}
+
+/* Record the current state of the immediate context as a sequence of state
+ * setting calls, so that it can be restored after executing a command list. */
+static void d3d11_immediate_context_capture_state(ID3D11DeviceContext1 *iface,
+        struct d3d11_command_buffer *buffer)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    ID3D11Buffer *vertex_buffers[D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT];
+    UINT strides[D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT];
+    UINT offsets[D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT];
+    IUnknown *views[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT + 1 + D3D11_PS_CS_UAV_REGISTER_COUNT];
+    ID3D11UnorderedAccessView *cs_uavs[D3D11_PS_CS_UAV_REGISTER_COUNT];
+    ID3D11Buffer *so_buffers[D3D11_SO_BUFFER_SLOT_COUNT];
+    D3D11_VIEWPORT viewports[D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
+    D3D11_RECT rects[D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
+    D3D11_PRIMITIVE_TOPOLOGY topology;
+    struct d3d11_deferred_call *call;
+    unsigned int i, count;
+    IUnknown *object;
+    DXGI_FORMAT format;
+    UINT offset;
+    UINT *data;
+
+    for (i = 0; i < WINED3D_SHADER_TYPE_COUNT; ++i)
+        d3d11_immediate_context_capture_shader_state(iface, buffer, i);
+
+    ID3D11DeviceContext1_IAGetInputLayout(iface, (ID3D11InputLayout **)&object);
+    d3d11_command_buffer_record_object(buffer, DEFERRED_CALL_SET_INPUT_LAYOUT, object);
+    if (object)
+        IUnknown_Release(object);
+
+    ID3D11DeviceContext1_IAGetVertexBuffers(iface, 0, ARRAY_SIZE(vertex_buffers), vertex_buffers, strides, offsets);
+    if ((call = d3d11_command_buffer_add_call(buffer, DEFERRED_CALL_SET_VERTEX_BUFFERS,
+            ARRAY_SIZE(vertex_buffers), sizeof(strides) + sizeof(offsets))))
+    {
+        call->u.slots.count = ARRAY_SIZE(vertex_buffers);
+        d3d11_deferred_call_set_objects(call, 0, ARRAY_SIZE(vertex_buffers), (IUnknown **)vertex_buffers);
+        data = d3d11_deferred_call_get_data(call);
+        memcpy(data, strides, sizeof(strides));
+        memcpy(data + ARRAY_SIZE(strides), offsets, sizeof(offsets));
+    }
+    for (i = 0; i < ARRAY_SIZE(vertex_buffers); ++i)
+    {
+        if (vertex_buffers[i])
+            ID3D11Buffer_Release(vertex_buffers[i]);
+    }
+
+    ID3D11DeviceContext1_IAGetIndexBuffer(iface, (ID3D11Buffer **)&object, &format, &offset);
+    if ((call = d3d11_command_buffer_add_call(buffer, DEFERRED_CALL_SET_INDEX_BUFFER, 1, 0)))
+    {
+        call->u.index_buffer.format = format;
+        call->u.index_buffer.offset = offset;
+        d3d11_deferred_call_set_objects(call, 0, 1, &object);
+    }
+    if (object)
+        IUnknown_Release(object);
+
+    ID3D11DeviceContext1_IAGetPrimitiveTopology(iface, &topology);
+    if ((call = d3d11_command_buffer_add_call(buffer, DEFERRED_CALL_SET_PRIMITIVE_TOPOLOGY, 0, 0)))
+        call->u.topology = topology;
+
+    ID3D11DeviceContext1_OMGetRenderTargetsAndUnorderedAccessViews(iface, D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT,
+            (ID3D11RenderTargetView **)views, (ID3D11DepthStencilView **)&views[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT],
+            0, D3D11_PS_CS_UAV_REGISTER_COUNT,
+            (ID3D11UnorderedAccessView **)&views[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT + 1]);
+    if ((call = d3d11_command_buffer_add_call(buffer, DEFERRED_CALL_SET_RENDER_TARGETS_AND_UAVS,
+            ARRAY_SIZE(views), D3D11_PS_CS_UAV_REGISTER_COUNT * sizeof(UINT))))
+    {
+        call->u.render_targets.rtv_count = D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT;
+        call->u.render_targets.uav_start = 0;
+        call->u.render_targets.uav_count = D3D11_PS_CS_UAV_REGISTER_COUNT;
+        d3d11_deferred_call_set_objects(call, 0, ARRAY_SIZE(views), views);
+        memset(d3d11_deferred_call_get_data(call), 0xff, D3D11_PS_CS_UAV_REGISTER_COUNT * sizeof(UINT));
+    }
+    for (i = 0; i < ARRAY_SIZE(views); ++i)
+    {
+        if (views[i])
+            IUnknown_Release(views[i]);
+    }
+
+    ID3D11DeviceContext1_CSGetUnorderedAccessViews(iface, 0, ARRAY_SIZE(cs_uavs), cs_uavs);
+    if ((call = d3d11_command_buffer_add_call(buffer, DEFERRED_CALL_SET_UNORDERED_ACCESS_VIEWS,
+            ARRAY_SIZE(cs_uavs), sizeof(UINT) * ARRAY_SIZE(cs_uavs))))
+    {
+        call->u.slots.count = ARRAY_SIZE(cs_uavs);
+        d3d11_deferred_call_set_objects(call, 0, ARRAY_SIZE(cs_uavs), (IUnknown **)cs_uavs);
+        memset(d3d11_deferred_call_get_data(call), 0xff, sizeof(UINT) * ARRAY_SIZE(cs_uavs));
+    }
+    for (i = 0; i < ARRAY_SIZE(cs_uavs); ++i)
+    {
+        if (cs_uavs[i])
+            ID3D11UnorderedAccessView_Release(cs_uavs[i]);
+    }
+
+    if ((call = d3d11_command_buffer_add_call(buffer, DEFERRED_CALL_SET_BLEND_STATE, 1, 0)))
+    {
+        ID3D11DeviceContext1_OMGetBlendState(iface, (ID3D11BlendState **)&object,
+                call->u.blend_state.factor, &call->u.blend_state.sample_mask);
+        d3d11_deferred_call_get_objects(call)[0] = object;
+    }
+
+    if ((call = d3d11_command_buffer_add_call(buffer, DEFERRED_CALL_SET_DEPTH_STENCIL_STATE, 1, 0)))
+    {
+        ID3D11DeviceContext1_OMGetDepthStencilState(iface, (ID3D11DepthStencilState **)&object,
+                &call->u.stencil_ref);
+        d3d11_deferred_call_get_objects(call)[0] = object;
+    }
+
+    ID3D11DeviceContext1_SOGetTargets(iface, ARRAY_SIZE(so_buffers), so_buffers);
+    if ((call = d3d11_command_buffer_add_call(buffer, DEFERRED_CALL_SET_STREAM_OUTPUT_TARGETS,
+            ARRAY_SIZE(so_buffers), sizeof(UINT) * ARRAY_SIZE(so_buffers))))
+    {
+        call->u.slots.count = ARRAY_SIZE(so_buffers);
+        d3d11_deferred_call_set_objects(call, 0, ARRAY_SIZE(so_buffers), (IUnknown **)so_buffers);
+        data = d3d11_deferred_call_get_data(call);
+        for (i = 0; i < ARRAY_SIZE(so_buffers); ++i)
+            wined3d_device_get_stream_output(device->wined3d_device, i, &data[i]);
+    }
+    for (i = 0; i < ARRAY_SIZE(so_buffers); ++i)
+    {
+        if (so_buffers[i])
+            ID3D11Buffer_Release(so_buffers[i]);
+    }
+
+    ID3D11DeviceContext1_RSGetState(iface, (ID3D11RasterizerState **)&object);
+    d3d11_command_buffer_record_object(buffer, DEFERRED_CALL_SET_RASTERIZER_STATE, object);
+    if (object)
+        IUnknown_Release(object);
+
+    count = ARRAY_SIZE(viewports);
+    ID3D11DeviceContext1_RSGetViewports(iface, &count, viewports);
+    if ((call = d3d11_command_buffer_add_call(buffer, DEFERRED_CALL_SET_VIEWPORTS, 0, count * sizeof(*viewports))))
+    {
+        call->u.slots.count = count;
+        memcpy(d3d11_deferred_call_get_data(call), viewports, count * sizeof(*viewports));
+    }
+
+    count = ARRAY_SIZE(rects);
+    ID3D11DeviceContext1_RSGetScissorRects(iface, &count, rects);
+    if ((call = d3d11_command_buffer_add_call(buffer, DEFERRED_CALL_SET_SCISSOR_RECTS, 0, count * sizeof(*rects))))
+    {
+        call->u.slots.count = count;
+        memcpy(d3d11_deferred_call_get_data(call), rects, count * sizeof(*rects));
+    }
+
+    if ((call = d3d11_command_buffer_add_call(buffer, DEFERRED_CALL_SET_PREDICATION, 1, 0)))
+    {
+        ID3D11DeviceContext1_GetPredication(iface, (ID3D11Predicate **)&object, &call->u.predicate_value);
+        d3d11_deferred_call_get_objects(call)[0] = object;
+    }
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_ExecuteCommandList(ID3D11DeviceContext1 *iface,
+        ID3D11CommandList *command_list, BOOL restore_state)
+{
+    struct d3d11_command_list *list = unsafe_impl_from_ID3D11CommandList(command_list);
+    struct d3d11_command_buffer state = {0};
+
+    TRACE("iface %p, command_list %p, restore_state %#x.\n", iface, command_list, restore_state);
+
+    wined3d_mutex_lock();
+    if (restore_state)
+        d3d11_immediate_context_capture_state(iface, &state);
+
+    /* Command lists always start from the default state, and leave the
+     * context in the default state unless the previous state is restored. */
+    ID3D11DeviceContext1_ClearState(iface);
+    d3d11_command_buffer_execute(&list->buffer, iface);
+    ID3D11DeviceContext1_ClearState(iface);
+
+    if (restore_state)
+    {
+        d3d11_command_buffer_execute(&state, iface);
+        d3d11_command_buffer_cleanup(&state);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_HSSetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
+            iface, start_slot, view_count, views);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct d3d_shader_resource_view *view = unsafe_impl_from_ID3D11ShaderResourceView(views[i]);
+
+        wined3d_device_set_hs_resource_view(device->wined3d_device, start_slot + i,
+                view ? view->wined3d_view : NULL);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_HSSetShader(ID3D11DeviceContext1 *iface,
+        ID3D11HullShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_hull_shader *hs = unsafe_impl_from_ID3D11HullShader(shader);
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (class_instances)
+        FIXME("Dynamic linking is not implemented yet.\n");
+
+    wined3d_mutex_lock();
+    wined3d_device_set_hull_shader(device->wined3d_device, hs ? hs->wined3d_shader : NULL);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_HSSetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < sampler_count; ++i)
+    {
+        struct d3d_sampler_state *sampler = unsafe_impl_from_ID3D11SamplerState(samplers[i]);
+
+        wined3d_device_set_hs_sampler(device->wined3d_device, start_slot + i,
+                sampler ? sampler->wined3d_sampler : NULL);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_HSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_immediate_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_HULL, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DSSetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
+            iface, start_slot, view_count, views);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct d3d_shader_resource_view *view = unsafe_impl_from_ID3D11ShaderResourceView(views[i]);
+
+        wined3d_device_set_ds_resource_view(device->wined3d_device, start_slot + i,
+                view ? view->wined3d_view : NULL);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DSSetShader(ID3D11DeviceContext1 *iface,
+        ID3D11DomainShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_domain_shader *ds = unsafe_impl_from_ID3D11DomainShader(shader);
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (class_instances)
+        FIXME("Dynamic linking is not implemented yet.\n");
+
+    wined3d_mutex_lock();
+    wined3d_device_set_domain_shader(device->wined3d_device, ds ? ds->wined3d_shader : NULL);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DSSetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < sampler_count; ++i)
+    {
+        struct d3d_sampler_state *sampler = unsafe_impl_from_ID3D11SamplerState(samplers[i]);
+
+        wined3d_device_set_ds_sampler(device->wined3d_device, start_slot + i,
+                sampler ? sampler->wined3d_sampler : NULL);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_immediate_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_DOMAIN, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CSSetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
+            iface, start_slot, view_count, views);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct d3d_shader_resource_view *view = unsafe_impl_from_ID3D11ShaderResourceView(views[i]);
+
+        wined3d_device_set_cs_resource_view(device->wined3d_device, start_slot + i,
+                view ? view->wined3d_view : NULL);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CSSetUnorderedAccessViews(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11UnorderedAccessView *const *views, const UINT *initial_counts)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p, initial_counts %p.\n",
+            iface, start_slot, view_count, views, initial_counts);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct d3d11_unordered_access_view *view = unsafe_impl_from_ID3D11UnorderedAccessView(views[i]);
+
+        wined3d_device_set_cs_uav(device->wined3d_device, start_slot + i,
+                view ? view->wined3d_view : NULL, initial_counts ? initial_counts[i] : ~0u);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CSSetShader(ID3D11DeviceContext1 *iface,
+        ID3D11ComputeShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_compute_shader *cs = unsafe_impl_from_ID3D11ComputeShader(shader);
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (class_instances)
+        FIXME("Dynamic linking is not implemented yet.\n");
+
+    wined3d_mutex_lock();
+    wined3d_device_set_compute_shader(device->wined3d_device, cs ? cs->wined3d_shader : NULL);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CSSetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < sampler_count; ++i)
+    {
+        struct d3d_sampler_state *sampler = unsafe_impl_from_ID3D11SamplerState(samplers[i]);
+
+        wined3d_device_set_cs_sampler(device->wined3d_device, start_slot + i,
+                sampler ? sampler->wined3d_sampler : NULL);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_immediate_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_COMPUTE, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_VSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_immediate_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_VERTEX, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_PSGetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
+            iface, start_slot, view_count, views);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct wined3d_shader_resource_view *wined3d_view;
+        struct d3d_shader_resource_view *view_impl;
+
+        if (!(wined3d_view = wined3d_device_get_ps_resource_view(device->wined3d_device, start_slot + i)))
+        {
+            views[i] = NULL;
+            continue;
+        }
+
+        view_impl = wined3d_shader_resource_view_get_parent(wined3d_view);
+        views[i] = &view_impl->ID3D11ShaderResourceView_iface;
+        ID3D11ShaderResourceView_AddRef(views[i]);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_PSGetShader(ID3D11DeviceContext1 *iface,
+        ID3D11PixelShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_shader *wined3d_shader;
+    struct d3d_pixel_shader *shader_impl;
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %p.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (class_instances || class_instance_count)
+        FIXME("Dynamic linking not implemented yet.\n");
+    if (class_instance_count)
+        *class_instance_count = 0;
+
+    wined3d_mutex_lock();
+    if (!(wined3d_shader = wined3d_device_get_pixel_shader(device->wined3d_device)))
+    {
+        wined3d_mutex_unlock();
+        *shader = NULL;
+        return;
+    }
+
+    shader_impl = wined3d_shader_get_parent(wined3d_shader);
+    wined3d_mutex_unlock();
+    *shader = &shader_impl->ID3D11PixelShader_iface;
+    ID3D11PixelShader_AddRef(*shader);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_PSGetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < sampler_count; ++i)
+    {
+        struct wined3d_sampler *wined3d_sampler;
+        struct d3d_sampler_state *sampler_impl;
+
+        if (!(wined3d_sampler = wined3d_device_get_ps_sampler(device->wined3d_device, start_slot + i)))
+        {
+            samplers[i] = NULL;
+            continue;
+        }
+
+        sampler_impl = wined3d_sampler_get_parent(wined3d_sampler);
+        samplers[i] = &sampler_impl->ID3D11SamplerState_iface;
+        ID3D11SamplerState_AddRef(samplers[i]);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_VSGetShader(ID3D11DeviceContext1 *iface,
+        ID3D11VertexShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_vertex_shader *shader_impl;
+    struct wined3d_shader *wined3d_shader;
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %p.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (class_instances || class_instance_count)
+        FIXME("Dynamic linking not implemented yet.\n");
+    if (class_instance_count)
+        *class_instance_count = 0;
+
+    wined3d_mutex_lock();
+    if (!(wined3d_shader = wined3d_device_get_vertex_shader(device->wined3d_device)))
+    {
+        wined3d_mutex_unlock();
+        *shader = NULL;
+        return;
+    }
+
+    shader_impl = wined3d_shader_get_parent(wined3d_shader);
+    wined3d_mutex_unlock();
+    *shader = &shader_impl->ID3D11VertexShader_iface;
+    ID3D11VertexShader_AddRef(*shader);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_PSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_immediate_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_PIXEL, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_IAGetInputLayout(ID3D11DeviceContext1 *iface,
+        ID3D11InputLayout **input_layout)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_vertex_declaration *wined3d_declaration;
+    struct d3d_input_layout *input_layout_impl;
+
+    TRACE("iface %p, input_layout %p.\n", iface, input_layout);
+
+    wined3d_mutex_lock();
+    if (!(wined3d_declaration = wined3d_device_get_vertex_declaration(device->wined3d_device)))
+    {
+        wined3d_mutex_unlock();
+        *input_layout = NULL;
+        return;
+    }
+
+    input_layout_impl = wined3d_vertex_declaration_get_parent(wined3d_declaration);
+    wined3d_mutex_unlock();
+    *input_layout = &input_layout_impl->ID3D11InputLayout_iface;
+    ID3D11InputLayout_AddRef(*input_layout);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_IAGetVertexBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *strides, UINT *offsets)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p, strides %p, offsets %p.\n",
+            iface, start_slot, buffer_count, buffers, strides, offsets);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < buffer_count; ++i)
+    {
+        struct wined3d_buffer *wined3d_buffer = NULL;
+        struct d3d_buffer *buffer_impl;
+
+        if (FAILED(wined3d_device_get_stream_source(device->wined3d_device, start_slot + i,
+                &wined3d_buffer, &offsets[i], &strides[i])))
+        {
+            FIXME("Failed to get vertex buffer %u.\n", start_slot + i);
+            if (strides)
+                strides[i] = 0;
+            if (offsets)
+                offsets[i] = 0;
+        }
+
+        if (!wined3d_buffer)
+        {
+            buffers[i] = NULL;
+            continue;
+        }
+
+        buffer_impl = wined3d_buffer_get_parent(wined3d_buffer);
+        ID3D11Buffer_AddRef(buffers[i] = &buffer_impl->ID3D11Buffer_iface);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_IAGetIndexBuffer(ID3D11DeviceContext1 *iface,
+        ID3D11Buffer **buffer, DXGI_FORMAT *format, UINT *offset)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    enum wined3d_format_id wined3d_format;
+    struct wined3d_buffer *wined3d_buffer;
+    struct d3d_buffer *buffer_impl;
+
+    TRACE("iface %p, buffer %p, format %p, offset %p.\n", iface, buffer, format, offset);
+
+    wined3d_mutex_lock();
+    wined3d_buffer = wined3d_device_get_index_buffer(device->wined3d_device, &wined3d_format, offset);
+    *format = dxgi_format_from_wined3dformat(wined3d_format);
+    if (!wined3d_buffer)
+    {
+        wined3d_mutex_unlock();
+        *buffer = NULL;
+        return;
+    }
+
+    buffer_impl = wined3d_buffer_get_parent(wined3d_buffer);
+    wined3d_mutex_unlock();
+    ID3D11Buffer_AddRef(*buffer = &buffer_impl->ID3D11Buffer_iface);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_GSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_immediate_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_GEOMETRY, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_GSGetShader(ID3D11DeviceContext1 *iface,
+        ID3D11GeometryShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_geometry_shader *shader_impl;
+    struct wined3d_shader *wined3d_shader;
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %p.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (class_instances || class_instance_count)
+        FIXME("Dynamic linking not implemented yet.\n");
+    if (class_instance_count)
+        *class_instance_count = 0;
+
+    wined3d_mutex_lock();
+    if (!(wined3d_shader = wined3d_device_get_geometry_shader(device->wined3d_device)))
+    {
+        wined3d_mutex_unlock();
+        *shader = NULL;
+        return;
+    }
+
+    shader_impl = wined3d_shader_get_parent(wined3d_shader);
+    wined3d_mutex_unlock();
+    *shader = &shader_impl->ID3D11GeometryShader_iface;
+    ID3D11GeometryShader_AddRef(*shader);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_IAGetPrimitiveTopology(ID3D11DeviceContext1 *iface,
+        D3D11_PRIMITIVE_TOPOLOGY *topology)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    enum wined3d_primitive_type primitive_type;
+    unsigned int patch_vertex_count;
+
+    TRACE("iface %p, topology %p.\n", iface, topology);
+
+    wined3d_mutex_lock();
+    wined3d_device_get_primitive_type(device->wined3d_device, &primitive_type, &patch_vertex_count);
+    wined3d_mutex_unlock();
+
+    d3d11_primitive_topology_from_wined3d_primitive_type(primitive_type, patch_vertex_count, topology);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_VSGetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct wined3d_shader_resource_view *wined3d_view;
+        struct d3d_shader_resource_view *view_impl;
+
+        if (!(wined3d_view = wined3d_device_get_vs_resource_view(device->wined3d_device, start_slot + i)))
+        {
+            views[i] = NULL;
+            continue;
+        }
+
+        view_impl = wined3d_shader_resource_view_get_parent(wined3d_view);
+        views[i] = &view_impl->ID3D11ShaderResourceView_iface;
+        ID3D11ShaderResourceView_AddRef(views[i]);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_VSGetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < sampler_count; ++i)
+    {
+        struct wined3d_sampler *wined3d_sampler;
+        struct d3d_sampler_state *sampler_impl;
+
+        if (!(wined3d_sampler = wined3d_device_get_vs_sampler(device->wined3d_device, start_slot + i)))
+        {
+            samplers[i] = NULL;
+            continue;
+        }
+
+        sampler_impl = wined3d_sampler_get_parent(wined3d_sampler);
+        samplers[i] = &sampler_impl->ID3D11SamplerState_iface;
+        ID3D11SamplerState_AddRef(samplers[i]);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_GetPredication(ID3D11DeviceContext1 *iface,
+        ID3D11Predicate **predicate, BOOL *value)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_query *wined3d_predicate;
+    struct d3d_query *predicate_impl;
+
+    TRACE("iface %p, predicate %p, value %p.\n", iface, predicate, value);
+
+    wined3d_mutex_lock();
+    if (!(wined3d_predicate = wined3d_device_get_predication(device->wined3d_device, value)))
+    {
+        wined3d_mutex_unlock();
+        *predicate = NULL;
+        return;
+    }
+
+    predicate_impl = wined3d_query_get_parent(wined3d_predicate);
+    wined3d_mutex_unlock();
+    *predicate = (ID3D11Predicate *)&predicate_impl->ID3D11Query_iface;
+    ID3D11Predicate_AddRef(*predicate);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_GSGetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct wined3d_shader_resource_view *wined3d_view;
+        struct d3d_shader_resource_view *view_impl;
+
+        if (!(wined3d_view = wined3d_device_get_gs_resource_view(device->wined3d_device, start_slot + i)))
+        {
+            views[i] = NULL;
+            continue;
+        }
+
+        view_impl = wined3d_shader_resource_view_get_parent(wined3d_view);
+        views[i] = &view_impl->ID3D11ShaderResourceView_iface;
+        ID3D11ShaderResourceView_AddRef(views[i]);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_GSGetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < sampler_count; ++i)
+    {
+        struct d3d_sampler_state *sampler_impl;
+        struct wined3d_sampler *wined3d_sampler;
+
+        if (!(wined3d_sampler = wined3d_device_get_gs_sampler(device->wined3d_device, start_slot + i)))
+        {
+            samplers[i] = NULL;
+            continue;
+        }
+
+        sampler_impl = wined3d_sampler_get_parent(wined3d_sampler);
+        samplers[i] = &sampler_impl->ID3D11SamplerState_iface;
+        ID3D11SamplerState_AddRef(samplers[i]);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_OMGetRenderTargets(ID3D11DeviceContext1 *iface,
+        UINT render_target_view_count, ID3D11RenderTargetView **render_target_views,
+        ID3D11DepthStencilView **depth_stencil_view)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_rendertarget_view *wined3d_view;
+
+    TRACE("iface %p, render_target_view_count %u, render_target_views %p, depth_stencil_view %p.\n",
+            iface, render_target_view_count, render_target_views, depth_stencil_view);
+
+    wined3d_mutex_lock();
+    if (render_target_views)
+    {
+        struct d3d_rendertarget_view *view_impl;
+        unsigned int i;
+
+        for (i = 0; i < render_target_view_count; ++i)
+        {
+            if (!(wined3d_view = wined3d_device_get_rendertarget_view(device->wined3d_device, i))
+                    || !(view_impl = wined3d_rendertarget_view_get_parent(wined3d_view)))
+            {
+                render_target_views[i] = NULL;
+                continue;
+            }
+
+            render_target_views[i] = &view_impl->ID3D11RenderTargetView_iface;
+            ID3D11RenderTargetView_AddRef(render_target_views[i]);
+        }
+    }
+
+    if (depth_stencil_view)
+    {
+        struct d3d_depthstencil_view *view_impl;
+
+        if (!(wined3d_view = wined3d_device_get_depth_stencil_view(device->wined3d_device))
+                || !(view_impl = wined3d_rendertarget_view_get_parent(wined3d_view)))
+        {
+            *depth_stencil_view = NULL;
+        }
+        else
+        {
+            *depth_stencil_view = &view_impl->ID3D11DepthStencilView_iface;
+            ID3D11DepthStencilView_AddRef(*depth_stencil_view);
+        }
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_OMGetRenderTargetsAndUnorderedAccessViews(
+        ID3D11DeviceContext1 *iface,
+        UINT render_target_view_count, ID3D11RenderTargetView **render_target_views,
+        ID3D11DepthStencilView **depth_stencil_view,
+        UINT unordered_access_view_start_slot, UINT unordered_access_view_count,
+        ID3D11UnorderedAccessView **unordered_access_views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_unordered_access_view *wined3d_view;
+    struct d3d11_unordered_access_view *view_impl;
+    unsigned int i;
+
+    TRACE("iface %p, render_target_view_count %u, render_target_views %p, depth_stencil_view %p, "
+            "unordered_access_view_start_slot %u, unordered_access_view_count %u, "
+            "unordered_access_views %p.\n",
+            iface, render_target_view_count, render_target_views, depth_stencil_view,
+            unordered_access_view_start_slot, unordered_access_view_count, unordered_access_views);
+
+    if (render_target_views || depth_stencil_view)
+        d3d11_immediate_context_OMGetRenderTargets(iface, render_target_view_count,
+                render_target_views, depth_stencil_view);
+
+    if (unordered_access_views)
+    {
+        wined3d_mutex_lock();
+        for (i = 0; i < unordered_access_view_count; ++i)
+        {
+            if (!(wined3d_view = wined3d_device_get_unordered_access_view(device->wined3d_device,
+                    unordered_access_view_start_slot + i)))
+            {
+                unordered_access_views[i] = NULL;
+                continue;
+            }
+
+            view_impl = wined3d_unordered_access_view_get_parent(wined3d_view);
+            unordered_access_views[i] = &view_impl->ID3D11UnorderedAccessView_iface;
+            ID3D11UnorderedAccessView_AddRef(unordered_access_views[i]);
+        }
+        wined3d_mutex_unlock();
+    }
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_OMGetBlendState(ID3D11DeviceContext1 *iface,
+        ID3D11BlendState **blend_state, FLOAT blend_factor[4], UINT *sample_mask)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_blend_state *wined3d_state;
+    struct d3d_blend_state *blend_state_impl;
+
+    TRACE("iface %p, blend_state %p, blend_factor %p, sample_mask %p.\n",
+            iface, blend_state, blend_factor, sample_mask);
+
+    wined3d_mutex_lock();
+    if ((wined3d_state = wined3d_device_get_blend_state(device->wined3d_device,
+            (struct wined3d_color *)blend_factor, sample_mask)))
+    {
+        blend_state_impl = wined3d_blend_state_get_parent(wined3d_state);
+        ID3D11BlendState_AddRef(*blend_state = &blend_state_impl->ID3D11BlendState_iface);
+    }
+    else
+    {
+        *blend_state = NULL;
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_OMGetDepthStencilState(ID3D11DeviceContext1 *iface,
+        ID3D11DepthStencilState **depth_stencil_state, UINT *stencil_ref)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, depth_stencil_state %p, stencil_ref %p.\n",
+            iface, depth_stencil_state, stencil_ref);
+
+    if ((*depth_stencil_state = device->depth_stencil_state
+            ? &device->depth_stencil_state->ID3D11DepthStencilState_iface : NULL))
+        ID3D11DepthStencilState_AddRef(*depth_stencil_state);
+    *stencil_ref = device->stencil_ref;
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_SOGetTargets(ID3D11DeviceContext1 *iface,
+        UINT buffer_count, ID3D11Buffer **buffers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, buffer_count %u, buffers %p.\n", iface, buffer_count, buffers);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < buffer_count; ++i)
+    {
+        struct wined3d_buffer *wined3d_buffer;
+        struct d3d_buffer *buffer_impl;
+
+        if (!(wined3d_buffer = wined3d_device_get_stream_output(device->wined3d_device, i, NULL)))
+        {
+            buffers[i] = NULL;
+            continue;
+        }
+
+        buffer_impl = wined3d_buffer_get_parent(wined3d_buffer);
+        buffers[i] = &buffer_impl->ID3D11Buffer_iface;
+        ID3D11Buffer_AddRef(buffers[i]);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_RSGetState(ID3D11DeviceContext1 *iface,
+        ID3D11RasterizerState **rasterizer_state)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_rasterizer_state *rasterizer_state_impl;
+    struct wined3d_rasterizer_state *wined3d_state;
+
+    TRACE("iface %p, rasterizer_state %p.\n", iface, rasterizer_state);
+
+    wined3d_mutex_lock();
+    if ((wined3d_state = wined3d_device_get_rasterizer_state(device->wined3d_device)))
+    {
+        rasterizer_state_impl = wined3d_rasterizer_state_get_parent(wined3d_state);
+        ID3D11RasterizerState_AddRef(*rasterizer_state = &rasterizer_state_impl->ID3D11RasterizerState_iface);
+    }
+    else
+    {
+        *rasterizer_state = NULL;
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_RSGetViewports(ID3D11DeviceContext1 *iface,
+        UINT *viewport_count, D3D11_VIEWPORT *viewports)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_viewport wined3d_vp[WINED3D_MAX_VIEWPORTS];
+    unsigned int actual_count = ARRAY_SIZE(wined3d_vp), i;
+
+    TRACE("iface %p, viewport_count %p, viewports %p.\n", iface, viewport_count, viewports);
+
+    if (!viewport_count)
+        return;
+
+    wined3d_mutex_lock();
+    wined3d_device_get_viewports(device->wined3d_device, &actual_count, viewports ? wined3d_vp : NULL);
+    wined3d_mutex_unlock();
+
+    if (!viewports)
+    {
+        *viewport_count = actual_count;
+        return;
+    }
+
+    if (*viewport_count > actual_count)
+        memset(&viewports[actual_count], 0, (*viewport_count - actual_count) * sizeof(*viewports));
+
+    *viewport_count = min(actual_count, *viewport_count);
+    for (i = 0; i < *viewport_count; ++i)
+    {
+        viewports[i].TopLeftX = wined3d_vp[i].x;
+        viewports[i].TopLeftY = wined3d_vp[i].y;
+        viewports[i].Width = wined3d_vp[i].width;
+        viewports[i].Height = wined3d_vp[i].height;
+        viewports[i].MinDepth = wined3d_vp[i].min_z;
+        viewports[i].MaxDepth = wined3d_vp[i].max_z;
+    }
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_RSGetScissorRects(ID3D11DeviceContext1 *iface,
+        UINT *rect_count, D3D11_RECT *rects)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int actual_count;
+
+    TRACE("iface %p, rect_count %p, rects %p.\n", iface, rect_count, rects);
+
+    if (!rect_count)
+        return;
+
+    actual_count = *rect_count;
+
+    wined3d_mutex_lock();
+    wined3d_device_get_scissor_rects(device->wined3d_device, &actual_count, rects);
+    wined3d_mutex_unlock();
+
+    if (!rects)
+    {
+        *rect_count = actual_count;
+        return;
+    }
+
+    if (*rect_count > actual_count)
+        memset(&rects[actual_count], 0, (*rect_count - actual_count) * sizeof(*rects));
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_HSGetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct wined3d_shader_resource_view *wined3d_view;
+        struct d3d_shader_resource_view *view_impl;
+
+        if (!(wined3d_view = wined3d_device_get_hs_resource_view(device->wined3d_device, start_slot + i)))
+        {
+            views[i] = NULL;
+            continue;
+        }
+
+        view_impl = wined3d_shader_resource_view_get_parent(wined3d_view);
+        ID3D11ShaderResourceView_AddRef(views[i] = &view_impl->ID3D11ShaderResourceView_iface);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_HSGetShader(ID3D11DeviceContext1 *iface,
+        ID3D11HullShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_hull_shader *shader_impl;
+    struct wined3d_shader *wined3d_shader;
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %p.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (class_instances || class_instance_count)
+        FIXME("Dynamic linking not implemented yet.\n");
+    if (class_instance_count)
+        *class_instance_count = 0;
+
+    wined3d_mutex_lock();
+    if (!(wined3d_shader = wined3d_device_get_hull_shader(device->wined3d_device)))
+    {
+        wined3d_mutex_unlock();
+        *shader = NULL;
+        return;
+    }
+
+    shader_impl = wined3d_shader_get_parent(wined3d_shader);
+    wined3d_mutex_unlock();
+    ID3D11HullShader_AddRef(*shader = &shader_impl->ID3D11HullShader_iface);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_HSGetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < sampler_count; ++i)
+    {
+        struct wined3d_sampler *wined3d_sampler;
+        struct d3d_sampler_state *sampler_impl;
+
+        if (!(wined3d_sampler = wined3d_device_get_hs_sampler(device->wined3d_device, start_slot + i)))
+        {
+            samplers[i] = NULL;
+            continue;
+        }
+
+        sampler_impl = wined3d_sampler_get_parent(wined3d_sampler);
+        ID3D11SamplerState_AddRef(samplers[i] = &sampler_impl->ID3D11SamplerState_iface);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_HSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_immediate_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_HULL, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DSGetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
+            iface, start_slot, view_count, views);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct wined3d_shader_resource_view *wined3d_view;
+        struct d3d_shader_resource_view *view_impl;
+
+        if (!(wined3d_view = wined3d_device_get_ds_resource_view(device->wined3d_device, start_slot + i)))
+        {
+            views[i] = NULL;
+            continue;
+        }
+
+        view_impl = wined3d_shader_resource_view_get_parent(wined3d_view);
+        ID3D11ShaderResourceView_AddRef(views[i] = &view_impl->ID3D11ShaderResourceView_iface);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DSGetShader(ID3D11DeviceContext1 *iface,
+        ID3D11DomainShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_domain_shader *shader_impl;
+    struct wined3d_shader *wined3d_shader;
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %p.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (class_instances || class_instance_count)
+        FIXME("Dynamic linking not implemented yet.\n");
+    if (class_instance_count)
+        *class_instance_count = 0;
+
+    wined3d_mutex_lock();
+    if (!(wined3d_shader = wined3d_device_get_domain_shader(device->wined3d_device)))
+    {
+        wined3d_mutex_unlock();
+        *shader = NULL;
+        return;
+    }
+
+    shader_impl = wined3d_shader_get_parent(wined3d_shader);
+    wined3d_mutex_unlock();
+    ID3D11DomainShader_AddRef(*shader = &shader_impl->ID3D11DomainShader_iface);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DSGetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < sampler_count; ++i)
+    {
+        struct wined3d_sampler *wined3d_sampler;
+        struct d3d_sampler_state *sampler_impl;
+
+        if (!(wined3d_sampler = wined3d_device_get_ds_sampler(device->wined3d_device, start_slot + i)))
+        {
+            samplers[i] = NULL;
+            continue;
+        }
+
+        sampler_impl = wined3d_sampler_get_parent(wined3d_sampler);
+        ID3D11SamplerState_AddRef(samplers[i] = &sampler_impl->ID3D11SamplerState_iface);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_immediate_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_DOMAIN, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CSGetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct wined3d_shader_resource_view *wined3d_view;
+        struct d3d_shader_resource_view *view_impl;
+
+        if (!(wined3d_view = wined3d_device_get_cs_resource_view(device->wined3d_device, start_slot + i)))
+        {
+            views[i] = NULL;
+            continue;
+        }
+
+        view_impl = wined3d_shader_resource_view_get_parent(wined3d_view);
+        ID3D11ShaderResourceView_AddRef(views[i] = &view_impl->ID3D11ShaderResourceView_iface);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CSGetUnorderedAccessViews(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11UnorderedAccessView **views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct wined3d_unordered_access_view *wined3d_view;
+        struct d3d11_unordered_access_view *view_impl;
+
+        if (!(wined3d_view = wined3d_device_get_cs_uav(device->wined3d_device, start_slot + i)))
+        {
+            views[i] = NULL;
+            continue;
+        }
+
+        view_impl = wined3d_unordered_access_view_get_parent(wined3d_view);
+        ID3D11UnorderedAccessView_AddRef(views[i] = &view_impl->ID3D11UnorderedAccessView_iface);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CSGetShader(ID3D11DeviceContext1 *iface,
+        ID3D11ComputeShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_compute_shader *shader_impl;
+    struct wined3d_shader *wined3d_shader;
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %p.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (class_instances || class_instance_count)
+        FIXME("Dynamic linking not implemented yet.\n");
+    if (class_instance_count)
+        *class_instance_count = 0;
+
+    wined3d_mutex_lock();
+    if (!(wined3d_shader = wined3d_device_get_compute_shader(device->wined3d_device)))
+    {
+        wined3d_mutex_unlock();
+        *shader = NULL;
+        return;
+    }
+
+    shader_impl = wined3d_shader_get_parent(wined3d_shader);
+    wined3d_mutex_unlock();
+    ID3D11ComputeShader_AddRef(*shader = &shader_impl->ID3D11ComputeShader_iface);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CSGetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < sampler_count; ++i)
+    {
+        struct wined3d_sampler *wined3d_sampler;
+        struct d3d_sampler_state *sampler_impl;
+
+        if (!(wined3d_sampler = wined3d_device_get_cs_sampler(device->wined3d_device, start_slot + i)))
+        {
+            samplers[i] = NULL;
+            continue;
+        }
+
+        sampler_impl = wined3d_sampler_get_parent(wined3d_sampler);
+        ID3D11SamplerState_AddRef(samplers[i] = &sampler_impl->ID3D11SamplerState_iface);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_immediate_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_COMPUTE, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_ClearState(ID3D11DeviceContext1 *iface)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    static const float blend_factor[] = {1.0f, 1.0f, 1.0f, 1.0f};
+    unsigned int i, j;
+
+    TRACE("iface %p.\n", iface);
+
+    wined3d_mutex_lock();
+    wined3d_device_set_vertex_shader(device->wined3d_device, NULL);
+    wined3d_device_set_hull_shader(device->wined3d_device, NULL);
+    wined3d_device_set_domain_shader(device->wined3d_device, NULL);
+    wined3d_device_set_geometry_shader(device->wined3d_device, NULL);
+    wined3d_device_set_pixel_shader(device->wined3d_device, NULL);
+    wined3d_device_set_compute_shader(device->wined3d_device, NULL);
+    for (i = 0; i < D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT; ++i)
+    {
+        wined3d_device_set_vs_sampler(device->wined3d_device, i, NULL);
+        wined3d_device_set_hs_sampler(device->wined3d_device, i, NULL);
+        wined3d_device_set_ds_sampler(device->wined3d_device, i, NULL);
+        wined3d_device_set_gs_sampler(device->wined3d_device, i, NULL);
+        wined3d_device_set_ps_sampler(device->wined3d_device, i, NULL);
+        wined3d_device_set_cs_sampler(device->wined3d_device, i, NULL);
+    }
+    for (i = 0; i < D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT; ++i)
+    {
+        wined3d_device_set_vs_resource_view(device->wined3d_device, i, NULL);
+        wined3d_device_set_hs_resource_view(device->wined3d_device, i, NULL);
+        wined3d_device_set_ds_resource_view(device->wined3d_device, i, NULL);
+        wined3d_device_set_gs_resource_view(device->wined3d_device, i, NULL);
+        wined3d_device_set_ps_resource_view(device->wined3d_device, i, NULL);
+        wined3d_device_set_cs_resource_view(device->wined3d_device, i, NULL);
+    }
+    for (i = 0; i < WINED3D_SHADER_TYPE_COUNT; ++i)
+    {
+        for (j = 0; j < D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT; ++j)
+            wined3d_device_set_constant_buffer(device->wined3d_device, i, j, NULL);
+    }
+    for (i = 0; i < D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT; ++i)
+    {
+        wined3d_device_set_stream_source(device->wined3d_device, i, NULL, 0, 0);
+    }
+    wined3d_device_set_index_buffer(device->wined3d_device, NULL, WINED3DFMT_UNKNOWN, 0);
+    wined3d_device_set_vertex_declaration(device->wined3d_device, NULL);
+    wined3d_device_set_primitive_type(device->wined3d_device, WINED3D_PT_UNDEFINED, 0);
+    for (i = 0; i < D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT; ++i)
+    {
+        wined3d_device_set_rendertarget_view(device->wined3d_device, i, NULL, FALSE);
+    }
+    wined3d_device_set_depth_stencil_view(device->wined3d_device, NULL);
+    for (i = 0; i < D3D11_PS_CS_UAV_REGISTER_COUNT; ++i)
+    {
+        wined3d_device_set_unordered_access_view(device->wined3d_device, i, NULL, ~0u);
+        wined3d_device_set_cs_uav(device->wined3d_device, i, NULL, ~0u);
+    }
+    ID3D11DeviceContext1_OMSetDepthStencilState(iface, NULL, 0);
+    ID3D11DeviceContext1_OMSetBlendState(iface, NULL, blend_factor, D3D11_DEFAULT_SAMPLE_MASK);
+    ID3D11DeviceContext1_RSSetViewports(iface, 0, NULL);
+    ID3D11DeviceContext1_RSSetScissorRects(iface, 0, NULL);
+    ID3D11DeviceContext1_RSSetState(iface, NULL);
+    for (i = 0; i < D3D11_SO_BUFFER_SLOT_COUNT; ++i)
+    {
+        wined3d_device_set_stream_output(device->wined3d_device, i, NULL, 0);
+    }
+    wined3d_device_set_predication(device->wined3d_device, NULL, FALSE);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_Flush(ID3D11DeviceContext1 *iface)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p.\n", iface);
+
+    wined3d_mutex_lock();
+    wined3d_device_flush(device->wined3d_device);
+    wined3d_mutex_unlock();
+}
+
+static D3D11_DEVICE_CONTEXT_TYPE STDMETHODCALLTYPE d3d11_immediate_context_GetType(ID3D11DeviceContext1 *iface)
+{
+    TRACE("iface %p.\n", iface);
+
+    return D3D11_DEVICE_CONTEXT_IMMEDIATE;
+}
+
+static UINT STDMETHODCALLTYPE d3d11_immediate_context_GetContextFlags(ID3D11DeviceContext1 *iface)
+{
+    TRACE("iface %p.\n", iface);
+
+    return 0;
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_FinishCommandList(ID3D11DeviceContext1 *iface,
+        BOOL restore, ID3D11CommandList **command_list)
+{
+    TRACE("iface %p, restore %#x, command_list %p.\n", iface, restore, command_list);
+
+    return DXGI_ERROR_INVALID_CALL;
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CopySubresourceRegion1(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *dst_resource, UINT dst_subresource_idx, UINT dst_x, UINT dst_y, UINT dst_z,
+        ID3D11Resource *src_resource, UINT src_subresource_idx, const D3D11_BOX *src_box, UINT flags)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_resource *wined3d_dst_resource, *wined3d_src_resource;
+    struct wined3d_box wined3d_src_box;
+
+    TRACE("iface %p, dst_resource %p, dst_subresource_idx %u, dst_x %u, dst_y %u, dst_z %u, "
+            "src_resource %p, src_subresource_idx %u, src_box %p, flags %#x.\n",
+            iface, dst_resource, dst_subresource_idx, dst_x, dst_y, dst_z,
+            src_resource, src_subresource_idx, src_box, flags);
+
+    if (src_box)
+        wined3d_box_set(&wined3d_src_box, src_box->left, src_box->top,
+                src_box->right, src_box->bottom, src_box->front, src_box->back);
+
+    wined3d_dst_resource = wined3d_resource_from_d3d11_resource(dst_resource);
+    wined3d_src_resource = wined3d_resource_from_d3d11_resource(src_resource);
+    wined3d_mutex_lock();
+    wined3d_device_copy_sub_resource_region(device->wined3d_device, wined3d_dst_resource, dst_subresource_idx,
+            dst_x, dst_y, dst_z, wined3d_src_resource, src_subresource_idx, src_box ? &wined3d_src_box : NULL, flags);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_UpdateSubresource1(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *resource, UINT subresource_idx, const D3D11_BOX *box, const void *data,
+        UINT row_pitch, UINT depth_pitch, UINT flags)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_resource *wined3d_resource;
+    struct wined3d_box wined3d_box;
+
+    TRACE("iface %p, resource %p, subresource_idx %u, box %p, data %p, row_pitch %u, depth_pitch %u, flags %#x.\n",
+            iface, resource, subresource_idx, box, data, row_pitch, depth_pitch, flags);
+
+    if (box)
+        wined3d_box_set(&wined3d_box, box->left, box->top, box->right, box->bottom,
+                box->front, box->back);
+
+    wined3d_resource = wined3d_resource_from_d3d11_resource(resource);
+    wined3d_mutex_lock();
+    wined3d_device_update_sub_resource(device->wined3d_device, wined3d_resource, subresource_idx,
+            box ? &wined3d_box : NULL, data, row_pitch, depth_pitch, flags);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DiscardResource(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *resource)
+{
+    FIXME("iface %p, resource %p stub!\n", iface, resource);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DiscardView(ID3D11DeviceContext1 *iface, ID3D11View *view)
+{
+    FIXME("iface %p, view %p stub!\n", iface, view);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_VSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
+        const UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_HSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
+        const UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
+        const UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_GSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
+        const UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_PSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
+        const UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
+        const UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_VSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_HSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_GSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_PSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_SwapDeviceContextState(ID3D11DeviceContext1 *iface,
+        ID3DDeviceContextState *state, ID3DDeviceContextState **prev_state)
+{
+    FIXME("iface %p, state %p, prev_state %p stub!\n", iface, state, prev_state);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_ClearView(ID3D11DeviceContext1 *iface, ID3D11View *view,
+        const FLOAT color[4], const D3D11_RECT *rect, UINT num_rects)
+{
+    FIXME("iface %p, view %p, color %p, rect %p, num_rects %u stub!\n", iface, view, color, rect, num_rects);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DiscardView1(ID3D11DeviceContext1 *iface, ID3D11View *view,
+        const D3D11_RECT *rects, UINT num_rects)
+{
+    FIXME("iface %p, view %p, rects %p, num_rects %u stub!\n", iface, view, rects, num_rects);
+}
+
+static const struct ID3D11DeviceContext1Vtbl d3d11_immediate_context_vtbl =
+{
+    /* IUnknown methods */
+    d3d11_immediate_context_QueryInterface,
+    d3d11_immediate_context_AddRef,
+    d3d11_immediate_context_Release,
+    /* ID3D11DeviceChild methods */
+    d3d11_immediate_context_GetDevice,
+    d3d11_immediate_context_GetPrivateData,
+    d3d11_immediate_context_SetPrivateData,
+    d3d11_immediate_context_SetPrivateDataInterface,
+    /* ID3D11DeviceContext methods */
+    d3d11_immediate_context_VSSetConstantBuffers,
+    d3d11_immediate_context_PSSetShaderResources,
+    d3d11_immediate_context_PSSetShader,
+    d3d11_immediate_context_PSSetSamplers,
+    d3d11_immediate_context_VSSetShader,
+    d3d11_immediate_context_DrawIndexed,
+    d3d11_immediate_context_Draw,
+    d3d11_immediate_context_Map,
+    d3d11_immediate_context_Unmap,
+    d3d11_immediate_context_PSSetConstantBuffers,
+    d3d11_immediate_context_IASetInputLayout,
+    d3d11_immediate_context_IASetVertexBuffers,
+    d3d11_immediate_context_IASetIndexBuffer,
+    d3d11_immediate_context_DrawIndexedInstanced,
+    d3d11_immediate_context_DrawInstanced,
+    d3d11_immediate_context_GSSetConstantBuffers,
+    d3d11_immediate_context_GSSetShader,
+    d3d11_immediate_context_IASetPrimitiveTopology,
+    d3d11_immediate_context_VSSetShaderResources,
+    d3d11_immediate_context_VSSetSamplers,
+    d3d11_immediate_context_Begin,
+    d3d11_immediate_context_End,
+    d3d11_immediate_context_GetData,
+    d3d11_immediate_context_SetPredication,
+    d3d11_immediate_context_GSSetShaderResources,
+    d3d11_immediate_context_GSSetSamplers,
+    d3d11_immediate_context_OMSetRenderTargets,
+    d3d11_immediate_context_OMSetRenderTargetsAndUnorderedAccessViews,
+    d3d11_immediate_context_OMSetBlendState,
+    d3d11_immediate_context_OMSetDepthStencilState,
+    d3d11_immediate_context_SOSetTargets,
+    d3d11_immediate_context_DrawAuto,
+    d3d11_immediate_context_DrawIndexedInstancedIndirect,
+    d3d11_immediate_context_DrawInstancedIndirect,
+    d3d11_immediate_context_Dispatch,
+    d3d11_immediate_context_DispatchIndirect,
+    d3d11_immediate_context_RSSetState,
+    d3d11_immediate_context_RSSetViewports,
+    d3d11_immediate_context_RSSetScissorRects,
+    d3d11_immediate_context_CopySubresourceRegion,
+    d3d11_immediate_context_CopyResource,
+    d3d11_immediate_context_UpdateSubresource,
+    d3d11_immediate_context_CopyStructureCount,
+    d3d11_immediate_context_ClearRenderTargetView,
+    d3d11_immediate_context_ClearUnorderedAccessViewUint,
+    d3d11_immediate_context_ClearUnorderedAccessViewFloat,
+    d3d11_immediate_context_ClearDepthStencilView,
+    d3d11_immediate_context_GenerateMips,
+    d3d11_immediate_context_SetResourceMinLOD,
+    d3d11_immediate_context_GetResourceMinLOD,
+    d3d11_immediate_context_ResolveSubresource,
+    d3d11_immediate_context_ExecuteCommandList,
+    d3d11_immediate_context_HSSetShaderResources,
+    d3d11_immediate_context_HSSetShader,
+    d3d11_immediate_context_HSSetSamplers,
+    d3d11_immediate_context_HSSetConstantBuffers,
+    d3d11_immediate_context_DSSetShaderResources,
+    d3d11_immediate_context_DSSetShader,
+    d3d11_immediate_context_DSSetSamplers,
+    d3d11_immediate_context_DSSetConstantBuffers,
+    d3d11_immediate_context_CSSetShaderResources,
+    d3d11_immediate_context_CSSetUnorderedAccessViews,
+    d3d11_immediate_context_CSSetShader,
+    d3d11_immediate_context_CSSetSamplers,
+    d3d11_immediate_context_CSSetConstantBuffers,
+    d3d11_immediate_context_VSGetConstantBuffers,
+    d3d11_immediate_context_PSGetShaderResources,
+    d3d11_immediate_context_PSGetShader,
+    d3d11_immediate_context_PSGetSamplers,
+    d3d11_immediate_context_VSGetShader,
+    d3d11_immediate_context_PSGetConstantBuffers,
+    d3d11_immediate_context_IAGetInputLayout,
+    d3d11_immediate_context_IAGetVertexBuffers,
+    d3d11_immediate_context_IAGetIndexBuffer,
+    d3d11_immediate_context_GSGetConstantBuffers,
+    d3d11_immediate_context_GSGetShader,
+    d3d11_immediate_context_IAGetPrimitiveTopology,
+    d3d11_immediate_context_VSGetShaderResources,
+    d3d11_immediate_context_VSGetSamplers,
+    d3d11_immediate_context_GetPredication,
+    d3d11_immediate_context_GSGetShaderResources,
+    d3d11_immediate_context_GSGetSamplers,
+    d3d11_immediate_context_OMGetRenderTargets,
+    d3d11_immediate_context_OMGetRenderTargetsAndUnorderedAccessViews,
+    d3d11_immediate_context_OMGetBlendState,
+    d3d11_immediate_context_OMGetDepthStencilState,
+    d3d11_immediate_context_SOGetTargets,
+    d3d11_immediate_context_RSGetState,
+    d3d11_immediate_context_RSGetViewports,
+    d3d11_immediate_context_RSGetScissorRects,
+    d3d11_immediate_context_HSGetShaderResources,
+    d3d11_immediate_context_HSGetShader,
+    d3d11_immediate_context_HSGetSamplers,
+    d3d11_immediate_context_HSGetConstantBuffers,
+    d3d11_immediate_context_DSGetShaderResources,
+    d3d11_immediate_context_DSGetShader,
+    d3d11_immediate_context_DSGetSamplers,
+    d3d11_immediate_context_DSGetConstantBuffers,
+    d3d11_immediate_context_CSGetShaderResources,
+    d3d11_immediate_context_CSGetUnorderedAccessViews,
+    d3d11_immediate_context_CSGetShader,
+    d3d11_immediate_context_CSGetSamplers,
+    d3d11_immediate_context_CSGetConstantBuffers,
+    d3d11_immediate_context_ClearState,
+    d3d11_immediate_context_Flush,
+    d3d11_immediate_context_GetType,
+    d3d11_immediate_context_GetContextFlags,
+    d3d11_immediate_context_FinishCommandList,
+    /* ID3D11DeviceContext1 methods */
+    d3d11_immediate_context_CopySubresourceRegion1,
+    d3d11_immediate_context_UpdateSubresource1,
+    d3d11_immediate_context_DiscardResource,
+    d3d11_immediate_context_DiscardView,
+    d3d11_immediate_context_VSSetConstantBuffers1,
+    d3d11_immediate_context_HSSetConstantBuffers1,
+    d3d11_immediate_context_DSSetConstantBuffers1,
+    d3d11_immediate_context_GSSetConstantBuffers1,
+    d3d11_immediate_context_PSSetConstantBuffers1,
+    d3d11_immediate_context_CSSetConstantBuffers1,
+    d3d11_immediate_context_VSGetConstantBuffers1,
+    d3d11_immediate_context_HSGetConstantBuffers1,
+    d3d11_immediate_context_DSGetConstantBuffers1,
+    d3d11_immediate_context_GSGetConstantBuffers1,
+    d3d11_immediate_context_PSGetConstantBuffers1,
+    d3d11_immediate_context_CSGetConstantBuffers1,
+    d3d11_immediate_context_SwapDeviceContextState,
+    d3d11_immediate_context_ClearView,
+    d3d11_immediate_context_DiscardView1,
+};
+
+/* ID3D11Multithread methods */
+
+static inline struct d3d11_immediate_context *impl_from_ID3D11Multithread(ID3D11Multithread *iface)
+{
+    return CONTAINING_RECORD(iface, struct d3d11_immediate_context, ID3D11Multithread_iface);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_multithread_QueryInterface(ID3D11Multithread *iface,
+        REFIID iid, void **out)
+{
+    struct d3d11_immediate_context *context = impl_from_ID3D11Multithread(iface);
+
+    TRACE("iface %p, iid %s, out %p.\n", iface, debugstr_guid(iid), out);
+
+    return d3d11_immediate_context_QueryInterface(&context->ID3D11DeviceContext1_iface, iid, out);
+}
+
+static ULONG STDMETHODCALLTYPE d3d11_multithread_AddRef(ID3D11Multithread *iface)
+{
+    struct d3d11_immediate_context *context = impl_from_ID3D11Multithread(iface);
+
+    TRACE("iface %p.\n", iface);
+
+    return d3d11_immediate_context_AddRef(&context->ID3D11DeviceContext1_iface);
+}
+
+static ULONG STDMETHODCALLTYPE d3d11_multithread_Release(ID3D11Multithread *iface)
+{
+    struct d3d11_immediate_context *context = impl_from_ID3D11Multithread(iface);
+
+    TRACE("iface %p.\n", iface);
+
+    return d3d11_immediate_context_Release(&context->ID3D11DeviceContext1_iface);
+}
+
+static void STDMETHODCALLTYPE d3d11_multithread_Enter(ID3D11Multithread *iface)
+{
+    TRACE("iface %p.\n", iface);
+
+    wined3d_mutex_lock();
+}
+
+static void STDMETHODCALLTYPE d3d11_multithread_Leave(ID3D11Multithread *iface)
+{
+    TRACE("iface %p.\n", iface);
+
+    wined3d_mutex_unlock();
+}
+
+static BOOL STDMETHODCALLTYPE d3d11_multithread_SetMultithreadProtected(
+        ID3D11Multithread *iface, BOOL enable)
+{
+    FIXME("iface %p, enable %#x stub!\n", iface, enable);
+
+    return TRUE;
+}
+
+static BOOL STDMETHODCALLTYPE d3d11_multithread_GetMultithreadProtected(ID3D11Multithread *iface)
+{
+    FIXME("iface %p stub!\n", iface);
+
+    return TRUE;
+}
+
+static const struct ID3D11MultithreadVtbl d3d11_multithread_vtbl =
+{
+    d3d11_multithread_QueryInterface,
+    d3d11_multithread_AddRef,
+    d3d11_multithread_Release,
+    d3d11_multithread_Enter,
+    d3d11_multithread_Leave,
+    d3d11_multithread_SetMultithreadProtected,
+    d3d11_multithread_GetMultithreadProtected,
+};
+
+static void d3d11_immediate_context_init(struct d3d11_immediate_context *context, struct d3d_device *device)
+{
+    context->ID3D11DeviceContext1_iface.lpVtbl = &d3d11_immediate_context_vtbl;
+    context->ID3D11Multithread_iface.lpVtbl = &d3d11_multithread_vtbl;
+    context->refcount = 1;
+
+    ID3D11Device2_AddRef(&device->ID3D11Device2_iface);
+
+    wined3d_private_store_init(&context->private_store);
+}
+
+static void d3d11_immediate_context_destroy(struct d3d11_immediate_context *context)
+{
+    wined3d_private_store_cleanup(&context->private_store);
+}
+
+/* ID3D11DeviceContext - deferred context methods */
+
+struct d3d11_deferred_map
+{
+    struct list entry;
+    ID3D11Resource *resource;
+    unsigned int sub_resource_idx;
+    unsigned int row_size, row_count, depth;
+    D3D11_MAP map_type;
+    struct d3d11_deferred_mapped_data *data;
+};
+
+static inline struct d3d11_deferred_context *impl_from_deferred_ID3D11DeviceContext1(ID3D11DeviceContext1 *iface)
+{
+    return CONTAINING_RECORD(iface, struct d3d11_deferred_context, ID3D11DeviceContext1_iface);
+}
+
+static void d3d11_deferred_context_clear_maps(struct d3d11_deferred_context *context)
+{
+    struct d3d11_deferred_map *map, *next;
+
+    LIST_FOR_EACH_ENTRY_SAFE(map, next, &context->maps, struct d3d11_deferred_map, entry)
+    {
+        list_remove(&map->entry);
+        ID3D11Resource_Release(map->resource);
+        if (map->data)
+            IUnknown_Release(&map->data->IUnknown_iface);
+        heap_free(map);
+    }
+}
+
+static struct d3d11_deferred_map *d3d11_deferred_context_find_map(struct d3d11_deferred_context *context,
+        ID3D11Resource *resource, unsigned int sub_resource_idx)
+{
+    struct d3d11_deferred_map *map;
+
+    LIST_FOR_EACH_ENTRY(map, &context->maps, struct d3d11_deferred_map, entry)
+    {
+        if (map->resource == resource && map->sub_resource_idx == sub_resource_idx)
+            return map;
+    }
+
+    return NULL;
+}
+
+/* Returns the layout of the data needed to update "box" of the given
+ * sub-resource, in rows of blocks. */
+static HRESULT d3d11_get_sub_resource_layout(ID3D11Resource *resource, unsigned int sub_resource_idx,
+        const D3D11_BOX *box, unsigned int *row_size, unsigned int *row_count, unsigned int *depth)
+{
+    unsigned int width, height, block_width, block_height, block_size;
+    struct wined3d_sub_resource_desc sub_resource_desc;
+    struct wined3d_resource *wined3d_resource;
+    struct wined3d_resource_desc desc;
+    HRESULT hr;
+
+    wined3d_resource = wined3d_resource_from_d3d11_resource(resource);
+    wined3d_resource_get_desc(wined3d_resource, &desc);
+    if (desc.resource_type == WINED3D_RTYPE_BUFFER)
+    {
+        *row_size = box ? box->right - box->left : desc.size;
+        *row_count = *depth = 1;
+        return S_OK;
+    }
+
+    if (FAILED(hr = wined3d_texture_get_sub_resource_desc(wined3d_texture_from_resource(wined3d_resource),
+            sub_resource_idx, &sub_resource_desc)))
+        return hr;
+
+    if (!(block_size = dxgi_format_get_block_size(dxgi_format_from_wined3dformat(sub_resource_desc.format),
+            &block_width, &block_height)))
+        return E_NOTIMPL;
+
+    width = box ? box->right - box->left : sub_resource_desc.width;
+    height = box ? box->bottom - box->top : sub_resource_desc.height;
+    *depth = box ? box->back - box->front : sub_resource_desc.depth;
+    *row_size = (width + block_width - 1) / block_width * block_size;
+    *row_count = (height + block_height - 1) / block_height;
+
+    return S_OK;
+}
+
+static void d3d11_deferred_context_set_shader(ID3D11DeviceContext1 *iface,
+        enum wined3d_shader_type type, IUnknown *shader, ID3D11ClassInstance *const *class_instances)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
+
+    if (class_instances)
+        FIXME("Dynamic linking is not implemented yet.\n");
+
+    if ((call = d3d11_command_buffer_record_slots(&context->buffer, DEFERRED_CALL_SET_SHADER, type, 0, 1, &shader)))
+        d3d11_deferred_state_update(&context->state, call);
+}
+
+static void d3d11_deferred_context_set_slots(ID3D11DeviceContext1 *iface, enum d3d11_deferred_call_type call,
+        enum wined3d_shader_type type, UINT start_slot, UINT count, IUnknown *const *objects)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *deferred_call;
+
+    if ((deferred_call = d3d11_command_buffer_record_slots(&context->buffer, call, type, start_slot, count, objects)))
+        d3d11_deferred_state_update(&context->state, deferred_call);
+}
+
+static void d3d11_deferred_context_get_slots(ID3D11DeviceContext1 *iface, enum d3d11_deferred_call_type call,
+        enum wined3d_shader_type type, UINT start_slot, UINT count, void *objects)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_state *state = &context->state;
+
+    switch (call)
+    {
+        case DEFERRED_CALL_SET_CONSTANT_BUFFERS:
+            d3d11_deferred_state_get_objects(state->constant_buffers[type],
+                    ARRAY_SIZE(state->constant_buffers[type]), start_slot, count, objects);
+            break;
+
+        case DEFERRED_CALL_SET_SHADER_RESOURCES:
+            d3d11_deferred_state_get_objects(state->shader_resources[type],
+                    ARRAY_SIZE(state->shader_resources[type]), start_slot, count, objects);
+            break;
+
+        case DEFERRED_CALL_SET_SAMPLERS:
+            d3d11_deferred_state_get_objects(state->samplers[type],
+                    ARRAY_SIZE(state->samplers[type]), start_slot, count, objects);
+            break;
+
+        case DEFERRED_CALL_SET_UNORDERED_ACCESS_VIEWS:
+            d3d11_deferred_state_get_objects(state->cs_uavs, ARRAY_SIZE(state->cs_uavs), start_slot, count, objects);
+            break;
+
+        default:
+            ERR("Invalid call %#x.\n", call);
+            break;
+    }
+}
+
+static void d3d11_deferred_context_get_shader(ID3D11DeviceContext1 *iface, enum wined3d_shader_type type,
+        void *shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+
+    if (class_instances || class_instance_count)
+        FIXME("Dynamic linking is not implemented yet.\n");
+    if (class_instance_count)
+        *class_instance_count = 0;
+
+    d3d11_deferred_state_get_objects(context->state.shaders, ARRAY_SIZE(context->state.shaders), type, 1, shader);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_deferred_context_QueryInterface(ID3D11DeviceContext1 *iface,
+        REFIID iid, void **out)
+{
+    TRACE("iface %p, iid %s, out %p.\n", iface, debugstr_guid(iid), out);
+
+    if (IsEqualGUID(iid, &IID_ID3D11DeviceContext1)
+            || IsEqualGUID(iid, &IID_ID3D11DeviceContext)
+            || IsEqualGUID(iid, &IID_ID3D11DeviceChild)
+            || IsEqualGUID(iid, &IID_IUnknown))
+    {
+        ID3D11DeviceContext1_AddRef(iface);
+        *out = iface;
+        return S_OK;
+    }
+
+    WARN("%s not implemented, returning E_NOINTERFACE.\n", debugstr_guid(iid));
+    *out = NULL;
+    return E_NOINTERFACE;
+}
+
+static ULONG STDMETHODCALLTYPE d3d11_deferred_context_AddRef(ID3D11DeviceContext1 *iface)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    ULONG refcount = InterlockedIncrement(&context->refcount);
+
+    TRACE("%p increasing refcount to %u.\n", context, refcount);
+
+    return refcount;
+}
+
+static ULONG STDMETHODCALLTYPE d3d11_deferred_context_Release(ID3D11DeviceContext1 *iface)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    ULONG refcount = InterlockedDecrement(&context->refcount);
+
+    TRACE("%p decreasing refcount to %u.\n", context, refcount);
+
+    if (!refcount)
+    {
+        ID3D11Device2 *device = context->device;
+
+        d3d11_deferred_context_clear_maps(context);
+        d3d11_deferred_state_reset(&context->state);
+        d3d11_command_buffer_cleanup(&context->buffer);
+        wined3d_private_store_cleanup(&context->private_store);
+        heap_free(context);
+        ID3D11Device2_Release(device);
+    }
+
+    return refcount;
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_GetDevice(ID3D11DeviceContext1 *iface, ID3D11Device **device)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, device %p.\n", iface, device);
+
+    *device = (ID3D11Device *)context->device;
+    ID3D11Device_AddRef(*device);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_deferred_context_GetPrivateData(ID3D11DeviceContext1 *iface, REFGUID guid,
+        UINT *data_size, void *data)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, guid %s, data_size %p, data %p.\n", iface, debugstr_guid(guid), data_size, data);
+
+    return d3d_get_private_data(&context->private_store, guid, data_size, data);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_deferred_context_SetPrivateData(ID3D11DeviceContext1 *iface, REFGUID guid,
+        UINT data_size, const void *data)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, guid %s, data_size %u, data %p.\n", iface, debugstr_guid(guid), data_size, data);
+
+    return d3d_set_private_data(&context->private_store, guid, data_size, data);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_deferred_context_SetPrivateDataInterface(ID3D11DeviceContext1 *iface,
+        REFGUID guid, const IUnknown *data)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, guid %s, data %p.\n", iface, debugstr_guid(guid), data);
+
+    return d3d_set_private_data_interface(&context->private_store, guid, data);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_deferred_context_set_slots(iface, DEFERRED_CALL_SET_CONSTANT_BUFFERS,
+            WINED3D_SHADER_TYPE_VERTEX, start_slot, buffer_count, (IUnknown *const *)buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSSetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+{
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
+            iface, start_slot, view_count, views);
+
+    d3d11_deferred_context_set_slots(iface, DEFERRED_CALL_SET_SHADER_RESOURCES,
+            WINED3D_SHADER_TYPE_PIXEL, start_slot, view_count, (IUnknown *const *)views);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSSetShader(ID3D11DeviceContext1 *iface,
+        ID3D11PixelShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+{
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    d3d11_deferred_context_set_shader(iface, WINED3D_SHADER_TYPE_PIXEL, (IUnknown *)shader, class_instances);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSSetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+{
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    d3d11_deferred_context_set_slots(iface, DEFERRED_CALL_SET_SAMPLERS,
+            WINED3D_SHADER_TYPE_PIXEL, start_slot, sampler_count, (IUnknown *const *)samplers);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSSetShader(ID3D11DeviceContext1 *iface,
+        ID3D11VertexShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+{
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    d3d11_deferred_context_set_shader(iface, WINED3D_SHADER_TYPE_VERTEX, (IUnknown *)shader, class_instances);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_DrawIndexed(ID3D11DeviceContext1 *iface,
+        UINT index_count, UINT start_index_location, INT base_vertex_location)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
+
+    TRACE("iface %p, index_count %u, start_index_location %u, base_vertex_location %d.\n",
+            iface, index_count, start_index_location, base_vertex_location);
+
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_DRAW_INDEXED, 0, 0)))
+        return;
+    call->u.draw.count = index_count;
+    call->u.draw.start = start_index_location;
+    call->u.draw.base_vertex = base_vertex_location;
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_Draw(ID3D11DeviceContext1 *iface,
+        UINT vertex_count, UINT start_vertex_location)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
+
+    TRACE("iface %p, vertex_count %u, start_vertex_location %u.\n",
+            iface, vertex_count, start_vertex_location);
+
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_DRAW, 0, 0)))
+        return;
+    call->u.draw.count = vertex_count;
+    call->u.draw.start = start_vertex_location;
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_deferred_context_Map(ID3D11DeviceContext1 *iface, ID3D11Resource *resource,
+        UINT subresource_idx, D3D11_MAP map_type, UINT map_flags, D3D11_MAPPED_SUBRESOURCE *mapped_subresource)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_mapped_data *data;
+    struct d3d11_deferred_map *map;
+    HRESULT hr;
 
     TRACE("iface %p, resource %p, subresource_idx %u, map_type %u, map_flags %#x, mapped_subresource %p.\n",
             iface, resource, subresource_idx, map_type, map_flags, mapped_subresource);
@@ -310,358 +4596,320 @@ static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_Map(ID3D11DeviceContext
     if (map_flags)
         FIXME("Ignoring map_flags %#x.\n", map_flags);
 
-    wined3d_resource = wined3d_resource_from_d3d11_resource(resource);
+    /* Maps on deferred contexts are write-only. D3D11_MAP_WRITE_DISCARD
+     * maps get new memory, which is written to the resource when the command
+     * list executes. D3D11_MAP_WRITE_NO_OVERWRITE maps return the memory of
+     * the previous D3D11_MAP_WRITE_DISCARD map in the same command list. */
+    if (map_type != D3D11_MAP_WRITE_DISCARD && map_type != D3D11_MAP_WRITE_NO_OVERWRITE)
+    {
+        WARN("Invalid map type %#x.\n", map_type);
+        return E_INVALIDARG;
+    }
+
+    map = d3d11_deferred_context_find_map(context, resource, subresource_idx);
+    if (map_type == D3D11_MAP_WRITE_NO_OVERWRITE && (!map || !map->data))
+    {
+        WARN("Resource %p was not mapped with D3D11_MAP_WRITE_DISCARD before.\n", resource);
+        return E_INVALIDARG;
+    }
+
+    if (!map)
+    {
+        if (!(map = heap_alloc_zero(sizeof(*map))))
+            return E_OUTOFMEMORY;
+        if (FAILED(hr = d3d11_get_sub_resource_layout(resource, subresource_idx, NULL,
+                &map->row_size, &map->row_count, &map->depth)))
+        {
+            FIXME("Failed to get layout of resource %p, sub-resource %u, hr %#x.\n",
+                    resource, subresource_idx, hr);
+            heap_free(map);
+            return hr;
+        }
+        ID3D11Resource_AddRef(map->resource = resource);
+        map->sub_resource_idx = subresource_idx;
+        list_add_head(&context->maps, &map->entry);
+    }
 
-    wined3d_mutex_lock();
-    hr = wined3d_resource_map(wined3d_resource, subresource_idx,
-            &map_desc, NULL, wined3d_map_flags_from_d3d11_map_type(map_type));
-    wined3d_mutex_unlock();
+    if (map_type == D3D11_MAP_WRITE_DISCARD)
+    {
+        if (!(data = d3d11_deferred_mapped_data_create(map->row_size * map->row_count * map->depth)))
+            return E_OUTOFMEMORY;
+        if (map->data)
+            IUnknown_Release(&map->data->IUnknown_iface);
+        map->data = data;
+    }
+    map->map_type = map_type;
 
-    mapped_subresource->pData = map_desc.data;
-    mapped_subresource->RowPitch = map_desc.row_pitch;
-    mapped_subresource->DepthPitch = map_desc.slice_pitch;
+    mapped_subresource->pData = map->data->data;
+    mapped_subresource->RowPitch = map->row_size;
+    mapped_subresource->DepthPitch = map->row_size * map->row_count;
 
-    return hr;
+    return S_OK;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_Unmap(ID3D11DeviceContext1 *iface, ID3D11Resource *resource,
+static void STDMETHODCALLTYPE d3d11_deferred_context_Unmap(ID3D11DeviceContext1 *iface, ID3D11Resource *resource,
         UINT subresource_idx)
 {
-    struct wined3d_resource *wined3d_resource;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
+    struct d3d11_deferred_map *map;
+    IUnknown *data;
 
     TRACE("iface %p, resource %p, subresource_idx %u.\n", iface, resource, subresource_idx);
 
-    wined3d_resource = wined3d_resource_from_d3d11_resource(resource);
+    if (!(map = d3d11_deferred_context_find_map(context, resource, subresource_idx)) || !map->data)
+    {
+        WARN("Resource %p, sub-resource %u is not mapped.\n", resource, subresource_idx);
+        return;
+    }
 
-    wined3d_mutex_lock();
-    wined3d_resource_unmap(wined3d_resource, subresource_idx);
-    wined3d_mutex_unlock();
+    /* Data written through D3D11_MAP_WRITE_NO_OVERWRITE maps goes to the
+     * memory referenced by the update recorded for the preceding
+     * D3D11_MAP_WRITE_DISCARD map, which is only read when the command list
+     * executes. Applications may only write to ranges that aren't used by
+     * the calls recorded in between, so nothing needs to be recorded here. */
+    if (map->map_type == D3D11_MAP_WRITE_NO_OVERWRITE)
+        return;
+
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_UPDATE_MAPPED, 2, 0)))
+        return;
+    call->u.map.sub_resource_idx = subresource_idx;
+    call->u.map.row_size = map->row_size;
+    call->u.map.row_count = map->row_count;
+    call->u.map.depth = map->depth;
+    data = &map->data->IUnknown_iface;
+    d3d11_deferred_call_set_objects(call, 0, 1, (IUnknown **)&resource);
+    d3d11_deferred_call_set_objects(call, 1, 1, &data);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_PSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSSetConstantBuffers(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
 {
     TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
             iface, start_slot, buffer_count, buffers);
 
-    d3d11_immediate_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_PIXEL, start_slot,
-            buffer_count, buffers);
+    d3d11_deferred_context_set_slots(iface, DEFERRED_CALL_SET_CONSTANT_BUFFERS,
+            WINED3D_SHADER_TYPE_PIXEL, start_slot, buffer_count, (IUnknown *const *)buffers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_IASetInputLayout(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_IASetInputLayout(ID3D11DeviceContext1 *iface,
         ID3D11InputLayout *input_layout)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_input_layout *layout = unsafe_impl_from_ID3D11InputLayout(input_layout);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
 
     TRACE("iface %p, input_layout %p.\n", iface, input_layout);
 
-    wined3d_mutex_lock();
-    wined3d_device_set_vertex_declaration(device->wined3d_device, layout ? layout->wined3d_decl : NULL);
-    wined3d_mutex_unlock();
+    if ((call = d3d11_command_buffer_record_object(&context->buffer,
+            DEFERRED_CALL_SET_INPUT_LAYOUT, (IUnknown *)input_layout)))
+        d3d11_deferred_state_update(&context->state, call);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_IASetVertexBuffers(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_IASetVertexBuffers(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers, const UINT *strides, const UINT *offsets)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
+    UINT *data;
 
     TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p, strides %p, offsets %p.\n",
             iface, start_slot, buffer_count, buffers, strides, offsets);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < buffer_count; ++i)
-    {
-        struct d3d_buffer *buffer = unsafe_impl_from_ID3D11Buffer(buffers[i]);
-
-        wined3d_device_set_stream_source(device->wined3d_device, start_slot + i,
-                buffer ? buffer->wined3d_buffer : NULL, offsets[i], strides[i]);
-    }
-    wined3d_mutex_unlock();
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_SET_VERTEX_BUFFERS,
+            buffer_count, 2 * buffer_count * sizeof(*data))))
+        return;
+    call->u.slots.start = start_slot;
+    call->u.slots.count = buffer_count;
+    d3d11_deferred_call_set_objects(call, 0, buffer_count, (IUnknown *const *)buffers);
+    data = d3d11_deferred_call_get_data(call);
+    memcpy(data, strides, buffer_count * sizeof(*data));
+    memcpy(data + buffer_count, offsets, buffer_count * sizeof(*data));
+    d3d11_deferred_state_update(&context->state, call);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_IASetIndexBuffer(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_IASetIndexBuffer(ID3D11DeviceContext1 *iface,
         ID3D11Buffer *buffer, DXGI_FORMAT format, UINT offset)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_buffer *buffer_impl = unsafe_impl_from_ID3D11Buffer(buffer);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
 
-    TRACE("iface %p, buffer %p, format %s, offset %u.\n",
-            iface, buffer, debug_dxgi_format(format), offset);
+    TRACE("iface %p, buffer %p, format %s, offset %u.\n", iface, buffer, debug_dxgi_format(format), offset);
 
-    wined3d_mutex_lock();
-    wined3d_device_set_index_buffer(device->wined3d_device,
-            buffer_impl ? buffer_impl->wined3d_buffer : NULL,
-            wined3dformat_from_dxgi_format(format), offset);
-    wined3d_mutex_unlock();
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_SET_INDEX_BUFFER, 1, 0)))
+        return;
+    call->u.index_buffer.format = format;
+    call->u.index_buffer.offset = offset;
+    d3d11_deferred_call_set_objects(call, 0, 1, (IUnknown **)&buffer);
+    d3d11_deferred_state_update(&context->state, call);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DrawIndexedInstanced(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_DrawIndexedInstanced(ID3D11DeviceContext1 *iface,
         UINT instance_index_count, UINT instance_count, UINT start_index_location, INT base_vertex_location,
         UINT start_instance_location)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
 
     TRACE("iface %p, instance_index_count %u, instance_count %u, start_index_location %u, "
             "base_vertex_location %d, start_instance_location %u.\n",
             iface, instance_index_count, instance_count, start_index_location,
             base_vertex_location, start_instance_location);
 
-    wined3d_mutex_lock();
-    wined3d_device_set_base_vertex_index(device->wined3d_device, base_vertex_location);
-    wined3d_device_draw_indexed_primitive_instanced(device->wined3d_device, start_index_location,
-            instance_index_count, start_instance_location, instance_count);
-    wined3d_mutex_unlock();
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_DRAW_INDEXED_INSTANCED, 0, 0)))
+        return;
+    call->u.draw.count = instance_index_count;
+    call->u.draw.instance_count = instance_count;
+    call->u.draw.start = start_index_location;
+    call->u.draw.base_vertex = base_vertex_location;
+    call->u.draw.start_instance = start_instance_location;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DrawInstanced(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_DrawInstanced(ID3D11DeviceContext1 *iface,
         UINT instance_vertex_count, UINT instance_count, UINT start_vertex_location, UINT start_instance_location)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
 
     TRACE("iface %p, instance_vertex_count %u, instance_count %u, start_vertex_location %u, "
             "start_instance_location %u.\n",
             iface, instance_vertex_count, instance_count, start_vertex_location,
             start_instance_location);
 
-    wined3d_mutex_lock();
-    wined3d_device_draw_primitive_instanced(device->wined3d_device, start_vertex_location,
-            instance_vertex_count, start_instance_location, instance_count);
-    wined3d_mutex_unlock();
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_DRAW_INSTANCED, 0, 0)))
+        return;
+    call->u.draw.count = instance_vertex_count;
+    call->u.draw.instance_count = instance_count;
+    call->u.draw.start = start_vertex_location;
+    call->u.draw.start_instance = start_instance_location;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_GSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSSetConstantBuffers(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
 {
     TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
             iface, start_slot, buffer_count, buffers);
 
-    d3d11_immediate_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_GEOMETRY, start_slot,
-            buffer_count, buffers);
+    d3d11_deferred_context_set_slots(iface, DEFERRED_CALL_SET_CONSTANT_BUFFERS,
+            WINED3D_SHADER_TYPE_GEOMETRY, start_slot, buffer_count, (IUnknown *const *)buffers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_GSSetShader(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSSetShader(ID3D11DeviceContext1 *iface,
         ID3D11GeometryShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_geometry_shader *gs = unsafe_impl_from_ID3D11GeometryShader(shader);
-
     TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
             iface, shader, class_instances, class_instance_count);
 
-    if (class_instances)
-        FIXME("Dynamic linking is not implemented yet.\n");
-
-    wined3d_mutex_lock();
-    wined3d_device_set_geometry_shader(device->wined3d_device, gs ? gs->wined3d_shader : NULL);
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_set_shader(iface, WINED3D_SHADER_TYPE_GEOMETRY, (IUnknown *)shader, class_instances);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_IASetPrimitiveTopology(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_IASetPrimitiveTopology(ID3D11DeviceContext1 *iface,
         D3D11_PRIMITIVE_TOPOLOGY topology)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    enum wined3d_primitive_type primitive_type;
-    unsigned int patch_vertex_count;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
 
     TRACE("iface %p, topology %#x.\n", iface, topology);
 
-    wined3d_primitive_type_from_d3d11_primitive_topology(topology, &primitive_type, &patch_vertex_count);
-
-    wined3d_mutex_lock();
-    wined3d_device_set_primitive_type(device->wined3d_device, primitive_type, patch_vertex_count);
-    wined3d_mutex_unlock();
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_SET_PRIMITIVE_TOPOLOGY, 0, 0)))
+        return;
+    call->u.topology = topology;
+    d3d11_deferred_state_update(&context->state, call);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_VSSetShaderResources(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSSetShaderResources(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
-    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
-
-    wined3d_mutex_lock();
-    for (i = 0; i < view_count; ++i)
-    {
-        struct d3d_shader_resource_view *view = unsafe_impl_from_ID3D11ShaderResourceView(views[i]);
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
+            iface, start_slot, view_count, views);
 
-        wined3d_device_set_vs_resource_view(device->wined3d_device, start_slot + i,
-                view ? view->wined3d_view : NULL);
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_set_slots(iface, DEFERRED_CALL_SET_SHADER_RESOURCES,
+            WINED3D_SHADER_TYPE_VERTEX, start_slot, view_count, (IUnknown *const *)views);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_VSSetSamplers(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSSetSamplers(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
     TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
             iface, start_slot, sampler_count, samplers);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < sampler_count; ++i)
-    {
-        struct d3d_sampler_state *sampler = unsafe_impl_from_ID3D11SamplerState(samplers[i]);
-
-        wined3d_device_set_vs_sampler(device->wined3d_device, start_slot + i,
-                sampler ? sampler->wined3d_sampler : NULL);
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_set_slots(iface, DEFERRED_CALL_SET_SAMPLERS,
+            WINED3D_SHADER_TYPE_VERTEX, start_slot, sampler_count, (IUnknown *const *)samplers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_Begin(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_Begin(ID3D11DeviceContext1 *iface,
         ID3D11Asynchronous *asynchronous)
 {
-    struct d3d_query *query = unsafe_impl_from_ID3D11Asynchronous(asynchronous);
-    HRESULT hr;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
     TRACE("iface %p, asynchronous %p.\n", iface, asynchronous);
 
-    wined3d_mutex_lock();
-    if (FAILED(hr = wined3d_query_issue(query->wined3d_query, WINED3DISSUE_BEGIN)))
-        ERR("Failed to issue query, hr %#x.\n", hr);
-    wined3d_mutex_unlock();
+    d3d11_command_buffer_record_object(&context->buffer, DEFERRED_CALL_BEGIN, (IUnknown *)asynchronous);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_End(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_End(ID3D11DeviceContext1 *iface,
         ID3D11Asynchronous *asynchronous)
 {
-    struct d3d_query *query = unsafe_impl_from_ID3D11Asynchronous(asynchronous);
-    HRESULT hr;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
     TRACE("iface %p, asynchronous %p.\n", iface, asynchronous);
 
-    wined3d_mutex_lock();
-    if (FAILED(hr = wined3d_query_issue(query->wined3d_query, WINED3DISSUE_END)))
-        ERR("Failed to issue query, hr %#x.\n", hr);
-    wined3d_mutex_unlock();
+    d3d11_command_buffer_record_object(&context->buffer, DEFERRED_CALL_END, (IUnknown *)asynchronous);
 }
 
-static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_GetData(ID3D11DeviceContext1 *iface,
+static HRESULT STDMETHODCALLTYPE d3d11_deferred_context_GetData(ID3D11DeviceContext1 *iface,
         ID3D11Asynchronous *asynchronous, void *data, UINT data_size, UINT data_flags)
 {
-    struct d3d_query *query = unsafe_impl_from_ID3D11Asynchronous(asynchronous);
-    unsigned int wined3d_flags;
-    HRESULT hr;
-
     TRACE("iface %p, asynchronous %p, data %p, data_size %u, data_flags %#x.\n",
             iface, asynchronous, data, data_size, data_flags);
 
-    if (!data && data_size)
-        return E_INVALIDARG;
-
-    wined3d_flags = wined3d_getdata_flags_from_d3d11_async_getdata_flags(data_flags);
-
-    wined3d_mutex_lock();
-    if (!data_size || wined3d_query_get_data_size(query->wined3d_query) == data_size)
-    {
-        hr = wined3d_query_get_data(query->wined3d_query, data, data_size, wined3d_flags);
-        if (hr == WINED3DERR_INVALIDCALL)
-            hr = DXGI_ERROR_INVALID_CALL;
-    }
-    else
-    {
-        WARN("Invalid data size %u.\n", data_size);
-        hr = E_INVALIDARG;
-    }
-    wined3d_mutex_unlock();
-
-    return hr;
+    return DXGI_ERROR_INVALID_CALL;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_SetPredication(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_SetPredication(ID3D11DeviceContext1 *iface,
         ID3D11Predicate *predicate, BOOL value)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_query *query;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
 
     TRACE("iface %p, predicate %p, value %#x.\n", iface, predicate, value);
 
-    query = unsafe_impl_from_ID3D11Query((ID3D11Query *)predicate);
-
-    wined3d_mutex_lock();
-    wined3d_device_set_predication(device->wined3d_device, query ? query->wined3d_query : NULL, value);
-    wined3d_mutex_unlock();
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_SET_PREDICATION, 1, 0)))
+        return;
+    call->u.predicate_value = value;
+    d3d11_deferred_call_set_objects(call, 0, 1, (IUnknown **)&predicate);
+    d3d11_deferred_state_update(&context->state, call);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_GSSetShaderResources(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSSetShaderResources(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
-    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
-
-    wined3d_mutex_lock();
-    for (i = 0; i < view_count; ++i)
-    {
-        struct d3d_shader_resource_view *view = unsafe_impl_from_ID3D11ShaderResourceView(views[i]);
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
+            iface, start_slot, view_count, views);
 
-        wined3d_device_set_gs_resource_view(device->wined3d_device, start_slot + i,
-                view ? view->wined3d_view : NULL);
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_set_slots(iface, DEFERRED_CALL_SET_SHADER_RESOURCES,
+            WINED3D_SHADER_TYPE_GEOMETRY, start_slot, view_count, (IUnknown *const *)views);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_GSSetSamplers(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSSetSamplers(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
     TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
             iface, start_slot, sampler_count, samplers);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < sampler_count; ++i)
-    {
-        struct d3d_sampler_state *sampler = unsafe_impl_from_ID3D11SamplerState(samplers[i]);
-
-        wined3d_device_set_gs_sampler(device->wined3d_device, start_slot + i,
-                sampler ? sampler->wined3d_sampler : NULL);
-    }
-    wined3d_mutex_unlock();
-}
-
-static void STDMETHODCALLTYPE d3d11_immediate_context_OMSetRenderTargets(ID3D11DeviceContext1 *iface,
-        UINT render_target_view_count, ID3D11RenderTargetView *const *render_target_views,
-        ID3D11DepthStencilView *depth_stencil_view)
-{
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_depthstencil_view *dsv;
-    unsigned int i;
-
-    TRACE("iface %p, render_target_view_count %u, render_target_views %p, depth_stencil_view %p.\n",
-            iface, render_target_view_count, render_target_views, depth_stencil_view);
-
-    wined3d_mutex_lock();
-    for (i = 0; i < render_target_view_count; ++i)
-    {
-        struct d3d_rendertarget_view *rtv = unsafe_impl_from_ID3D11RenderTargetView(render_target_views[i]);
-        wined3d_device_set_rendertarget_view(device->wined3d_device, i, rtv ? rtv->wined3d_view : NULL, FALSE);
-    }
-    for (; i < D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT; ++i)
-    {
-        wined3d_device_set_rendertarget_view(device->wined3d_device, i, NULL, FALSE);
-    }
-
-    dsv = unsafe_impl_from_ID3D11DepthStencilView(depth_stencil_view);
-    wined3d_device_set_depth_stencil_view(device->wined3d_device, dsv ? dsv->wined3d_view : NULL);
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_set_slots(iface, DEFERRED_CALL_SET_SAMPLERS,
+            WINED3D_SHADER_TYPE_GEOMETRY, start_slot, sampler_count, (IUnknown *const *)samplers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_OMSetRenderTargetsAndUnorderedAccessViews(
+static void STDMETHODCALLTYPE d3d11_deferred_context_OMSetRenderTargetsAndUnorderedAccessViews(
         ID3D11DeviceContext1 *iface, UINT render_target_view_count,
         ID3D11RenderTargetView *const *render_target_views, ID3D11DepthStencilView *depth_stencil_view,
         UINT unordered_access_view_start_slot, UINT unordered_access_view_count,
         ID3D11UnorderedAccessView *const *unordered_access_views, const UINT *initial_counts)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    unsigned int rtv_count = 0, uav_count = 0, i;
+    struct d3d11_deferred_call *call;
+    UINT *data;
 
     TRACE("iface %p, render_target_view_count %u, render_target_views %p, depth_stencil_view %p, "
             "unordered_access_view_start_slot %u, unordered_access_view_count %u, unordered_access_views %p, "
@@ -671,42 +4919,43 @@ static void STDMETHODCALLTYPE d3d11_immediate_context_OMSetRenderTargetsAndUnord
             initial_counts);
 
     if (render_target_view_count != D3D11_KEEP_RENDER_TARGETS_AND_DEPTH_STENCIL)
-    {
-        d3d11_immediate_context_OMSetRenderTargets(iface, render_target_view_count, render_target_views,
-                depth_stencil_view);
-    }
-
+        rtv_count = render_target_view_count;
     if (unordered_access_view_count != D3D11_KEEP_UNORDERED_ACCESS_VIEWS)
-    {
-        wined3d_mutex_lock();
-        for (i = 0; i < unordered_access_view_start_slot; ++i)
-        {
-            wined3d_device_set_unordered_access_view(device->wined3d_device, i, NULL, ~0u);
-        }
-        for (i = 0; i < unordered_access_view_count; ++i)
-        {
-            struct d3d11_unordered_access_view *view
-                    = unsafe_impl_from_ID3D11UnorderedAccessView(unordered_access_views[i]);
+        uav_count = unordered_access_view_count;
+
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_SET_RENDER_TARGETS_AND_UAVS,
+            rtv_count + 1 + uav_count, uav_count * sizeof(*data))))
+        return;
+    call->u.render_targets.rtv_count = render_target_view_count;
+    call->u.render_targets.uav_start = unordered_access_view_start_slot;
+    call->u.render_targets.uav_count = unordered_access_view_count;
+    d3d11_deferred_call_set_objects(call, 0, rtv_count, (IUnknown *const *)render_target_views);
+    if (render_target_view_count != D3D11_KEEP_RENDER_TARGETS_AND_DEPTH_STENCIL)
+        d3d11_deferred_call_set_objects(call, rtv_count, 1, (IUnknown **)&depth_stencil_view);
+    d3d11_deferred_call_set_objects(call, rtv_count + 1, uav_count, (IUnknown *const *)unordered_access_views);
+    data = d3d11_deferred_call_get_data(call);
+    for (i = 0; i < uav_count; ++i)
+        data[i] = initial_counts ? initial_counts[i] : ~0u;
+    d3d11_deferred_state_update(&context->state, call);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_OMSetRenderTargets(ID3D11DeviceContext1 *iface,
+        UINT render_target_view_count, ID3D11RenderTargetView *const *render_target_views,
+        ID3D11DepthStencilView *depth_stencil_view)
+{
+    TRACE("iface %p, render_target_view_count %u, render_target_views %p, depth_stencil_view %p.\n",
+            iface, render_target_view_count, render_target_views, depth_stencil_view);
 
-            wined3d_device_set_unordered_access_view(device->wined3d_device,
-                    unordered_access_view_start_slot + i,
-                    view ? view->wined3d_view : NULL, initial_counts ? initial_counts[i] : ~0u);
-        }
-        for (; unordered_access_view_start_slot + i < D3D11_PS_CS_UAV_REGISTER_COUNT; ++i)
-        {
-            wined3d_device_set_unordered_access_view(device->wined3d_device,
-                    unordered_access_view_start_slot + i, NULL, ~0u);
-        }
-        wined3d_mutex_unlock();
-    }
+    d3d11_deferred_context_OMSetRenderTargetsAndUnorderedAccessViews(iface, render_target_view_count,
+            render_target_views, depth_stencil_view, 0, D3D11_KEEP_UNORDERED_ACCESS_VIEWS, NULL, NULL);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_OMSetBlendState(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_OMSetBlendState(ID3D11DeviceContext1 *iface,
         ID3D11BlendState *blend_state, const float blend_factor[4], UINT sample_mask)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
     static const float default_blend_factor[] = {1.0f, 1.0f, 1.0f, 1.0f};
-    struct d3d_blend_state *blend_state_impl;
+    struct d3d11_deferred_call *call;
 
     TRACE("iface %p, blend_state %p, blend_factor %s, sample_mask 0x%08x.\n",
             iface, blend_state, debug_float4(blend_factor), sample_mask);
@@ -714,410 +4963,386 @@ static void STDMETHODCALLTYPE d3d11_immediate_context_OMSetBlendState(ID3D11Devi
     if (!blend_factor)
         blend_factor = default_blend_factor;
 
-    wined3d_mutex_lock();
-    if (!(blend_state_impl = unsafe_impl_from_ID3D11BlendState(blend_state)))
-        wined3d_device_set_blend_state(device->wined3d_device, NULL,
-                (const struct wined3d_color *)blend_factor, sample_mask);
-    else
-        wined3d_device_set_blend_state(device->wined3d_device, blend_state_impl->wined3d_state,
-                (const struct wined3d_color *)blend_factor, sample_mask);
-    wined3d_mutex_unlock();
-}
-
-static void set_default_depth_stencil_state(struct wined3d_device *wined3d_device)
-{
-    wined3d_device_set_render_state(wined3d_device, WINED3D_RS_ZENABLE, TRUE);
-    wined3d_device_set_render_state(wined3d_device, WINED3D_RS_ZWRITEENABLE, D3D11_DEPTH_WRITE_MASK_ALL);
-    wined3d_device_set_render_state(wined3d_device, WINED3D_RS_ZFUNC, WINED3D_CMP_LESS);
-    wined3d_device_set_render_state(wined3d_device, WINED3D_RS_STENCILENABLE, FALSE);
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_SET_BLEND_STATE, 1, 0)))
+        return;
+    memcpy(call->u.blend_state.factor, blend_factor, sizeof(call->u.blend_state.factor));
+    call->u.blend_state.sample_mask = sample_mask;
+    d3d11_deferred_call_set_objects(call, 0, 1, (IUnknown **)&blend_state);
+    d3d11_deferred_state_update(&context->state, call);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_OMSetDepthStencilState(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_OMSetDepthStencilState(ID3D11DeviceContext1 *iface,
         ID3D11DepthStencilState *depth_stencil_state, UINT stencil_ref)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    const D3D11_DEPTH_STENCILOP_DESC *front, *back;
-    const D3D11_DEPTH_STENCIL_DESC *desc;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
 
     TRACE("iface %p, depth_stencil_state %p, stencil_ref %u.\n",
             iface, depth_stencil_state, stencil_ref);
 
-    wined3d_mutex_lock();
-    device->stencil_ref = stencil_ref;
-    if (!(device->depth_stencil_state = unsafe_impl_from_ID3D11DepthStencilState(depth_stencil_state)))
-    {
-        set_default_depth_stencil_state(device->wined3d_device);
-        wined3d_mutex_unlock();
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_SET_DEPTH_STENCIL_STATE, 1, 0)))
         return;
-    }
-
-    desc = &device->depth_stencil_state->desc;
-
-    front = &desc->FrontFace;
-    back = &desc->BackFace;
-
-    wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_ZENABLE, desc->DepthEnable);
-    if (desc->DepthEnable)
-    {
-        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_ZWRITEENABLE, desc->DepthWriteMask);
-        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_ZFUNC, desc->DepthFunc);
-    }
-
-    wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILENABLE, desc->StencilEnable);
-    if (desc->StencilEnable)
-    {
-        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILMASK, desc->StencilReadMask);
-        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILWRITEMASK, desc->StencilWriteMask);
-        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILREF, stencil_ref);
-
-        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILFAIL, front->StencilFailOp);
-        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILZFAIL, front->StencilDepthFailOp);
-        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILPASS, front->StencilPassOp);
-        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILFUNC, front->StencilFunc);
-        if (front->StencilFailOp != back->StencilFailOp
-                || front->StencilDepthFailOp != back->StencilDepthFailOp
-                || front->StencilPassOp != back->StencilPassOp
-                || front->StencilFunc != back->StencilFunc)
-        {
-            wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_TWOSIDEDSTENCILMODE, TRUE);
-            wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_BACK_STENCILFAIL, back->StencilFailOp);
-            wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_BACK_STENCILZFAIL,
-                    back->StencilDepthFailOp);
-            wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_BACK_STENCILPASS, back->StencilPassOp);
-            wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_BACK_STENCILFUNC, back->StencilFunc);
-        }
-        else
-        {
-            wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_TWOSIDEDSTENCILMODE, FALSE);
-        }
-    }
-    wined3d_mutex_unlock();
+    call->u.stencil_ref = stencil_ref;
+    d3d11_deferred_call_set_objects(call, 0, 1, (IUnknown **)&depth_stencil_state);
+    d3d11_deferred_state_update(&context->state, call);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_SOSetTargets(ID3D11DeviceContext1 *iface, UINT buffer_count,
+static void STDMETHODCALLTYPE d3d11_deferred_context_SOSetTargets(ID3D11DeviceContext1 *iface, UINT buffer_count,
         ID3D11Buffer *const *buffers, const UINT *offsets)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
     unsigned int count, i;
+    UINT *data;
 
     TRACE("iface %p, buffer_count %u, buffers %p, offsets %p.\n", iface, buffer_count, buffers, offsets);
 
     count = min(buffer_count, D3D11_SO_BUFFER_SLOT_COUNT);
-    wined3d_mutex_lock();
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_SET_STREAM_OUTPUT_TARGETS,
+            count, count * sizeof(*data))))
+        return;
+    call->u.slots.count = count;
+    d3d11_deferred_call_set_objects(call, 0, count, (IUnknown *const *)buffers);
+    data = d3d11_deferred_call_get_data(call);
     for (i = 0; i < count; ++i)
-    {
-        struct d3d_buffer *buffer = unsafe_impl_from_ID3D11Buffer(buffers[i]);
-
-        wined3d_device_set_stream_output(device->wined3d_device, i,
-                buffer ? buffer->wined3d_buffer : NULL, offsets ? offsets[i] : 0);
-    }
-    for (; i < D3D11_SO_BUFFER_SLOT_COUNT; ++i)
-    {
-        wined3d_device_set_stream_output(device->wined3d_device, i, NULL, 0);
-    }
-    wined3d_mutex_unlock();
+        data[i] = offsets ? offsets[i] : 0;
+    d3d11_deferred_state_update(&context->state, call);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DrawAuto(ID3D11DeviceContext1 *iface)
+static void STDMETHODCALLTYPE d3d11_deferred_context_DrawAuto(ID3D11DeviceContext1 *iface)
 {
-    FIXME("iface %p stub!\n", iface);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p.\n", iface);
+
+    d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_DRAW_AUTO, 0, 0);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DrawIndexedInstancedIndirect(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_DrawIndexedInstancedIndirect(ID3D11DeviceContext1 *iface,
         ID3D11Buffer *buffer, UINT offset)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_buffer *d3d_buffer;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
 
     TRACE("iface %p, buffer %p, offset %u.\n", iface, buffer, offset);
 
-    d3d_buffer = unsafe_impl_from_ID3D11Buffer(buffer);
-
-    wined3d_mutex_lock();
-    wined3d_device_draw_indexed_primitive_instanced_indirect(device->wined3d_device,
-            d3d_buffer->wined3d_buffer, offset);
-    wined3d_mutex_unlock();
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer,
+            DEFERRED_CALL_DRAW_INDEXED_INSTANCED_INDIRECT, 1, 0)))
+        return;
+    call->u.offset = offset;
+    d3d11_deferred_call_set_objects(call, 0, 1, (IUnknown **)&buffer);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DrawInstancedIndirect(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_DrawInstancedIndirect(ID3D11DeviceContext1 *iface,
         ID3D11Buffer *buffer, UINT offset)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_buffer *d3d_buffer;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
 
     TRACE("iface %p, buffer %p, offset %u.\n", iface, buffer, offset);
 
-    d3d_buffer = unsafe_impl_from_ID3D11Buffer(buffer);
-
-    wined3d_mutex_lock();
-    wined3d_device_draw_primitive_instanced_indirect(device->wined3d_device,
-            d3d_buffer->wined3d_buffer, offset);
-    wined3d_mutex_unlock();
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_DRAW_INSTANCED_INDIRECT, 1, 0)))
+        return;
+    call->u.offset = offset;
+    d3d11_deferred_call_set_objects(call, 0, 1, (IUnknown **)&buffer);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_Dispatch(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_Dispatch(ID3D11DeviceContext1 *iface,
         UINT thread_group_count_x, UINT thread_group_count_y, UINT thread_group_count_z)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
 
     TRACE("iface %p, thread_group_count_x %u, thread_group_count_y %u, thread_group_count_z %u.\n",
             iface, thread_group_count_x, thread_group_count_y, thread_group_count_z);
 
-    wined3d_mutex_lock();
-    wined3d_device_dispatch_compute(device->wined3d_device,
-            thread_group_count_x, thread_group_count_y, thread_group_count_z);
-    wined3d_mutex_unlock();
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_DISPATCH, 0, 0)))
+        return;
+    call->u.dispatch.x = thread_group_count_x;
+    call->u.dispatch.y = thread_group_count_y;
+    call->u.dispatch.z = thread_group_count_z;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DispatchIndirect(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_DispatchIndirect(ID3D11DeviceContext1 *iface,
         ID3D11Buffer *buffer, UINT offset)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_buffer *buffer_impl;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
 
     TRACE("iface %p, buffer %p, offset %u.\n", iface, buffer, offset);
 
-    buffer_impl = unsafe_impl_from_ID3D11Buffer(buffer);
-
-    wined3d_mutex_lock();
-    wined3d_device_dispatch_compute_indirect(device->wined3d_device,
-            buffer_impl->wined3d_buffer, offset);
-    wined3d_mutex_unlock();
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_DISPATCH_INDIRECT, 1, 0)))
+        return;
+    call->u.offset = offset;
+    d3d11_deferred_call_set_objects(call, 0, 1, (IUnknown **)&buffer);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_RSSetState(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_RSSetState(ID3D11DeviceContext1 *iface,
         ID3D11RasterizerState *rasterizer_state)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_rasterizer_state *rasterizer_state_impl;
-    const D3D11_RASTERIZER_DESC *desc;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
 
     TRACE("iface %p, rasterizer_state %p.\n", iface, rasterizer_state);
 
-    wined3d_mutex_lock();
-    if (!(rasterizer_state_impl = unsafe_impl_from_ID3D11RasterizerState(rasterizer_state)))
-    {
-        wined3d_device_set_rasterizer_state(device->wined3d_device, NULL);
-        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_MULTISAMPLEANTIALIAS, FALSE);
-        wined3d_mutex_unlock();
-        return;
-    }
-
-    wined3d_device_set_rasterizer_state(device->wined3d_device, rasterizer_state_impl->wined3d_state);
-
-    desc = &rasterizer_state_impl->desc;
-    wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_MULTISAMPLEANTIALIAS, desc->MultisampleEnable);
-    wined3d_mutex_unlock();
+    if ((call = d3d11_command_buffer_record_object(&context->buffer, DEFERRED_CALL_SET_RASTERIZER_STATE,
+            (IUnknown *)rasterizer_state)))
+        d3d11_deferred_state_update(&context->state, call);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_RSSetViewports(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_RSSetViewports(ID3D11DeviceContext1 *iface,
         UINT viewport_count, const D3D11_VIEWPORT *viewports)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_viewport wined3d_vp[WINED3D_MAX_VIEWPORTS];
-    unsigned int i;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
 
     TRACE("iface %p, viewport_count %u, viewports %p.\n", iface, viewport_count, viewports);
 
-    if (viewport_count > ARRAY_SIZE(wined3d_vp))
+    if (viewport_count > WINED3D_MAX_VIEWPORTS)
         return;
 
-    for (i = 0; i < viewport_count; ++i)
-    {
-        wined3d_vp[i].x = viewports[i].TopLeftX;
-        wined3d_vp[i].y = viewports[i].TopLeftY;
-        wined3d_vp[i].width = viewports[i].Width;
-        wined3d_vp[i].height = viewports[i].Height;
-        wined3d_vp[i].min_z = viewports[i].MinDepth;
-        wined3d_vp[i].max_z = viewports[i].MaxDepth;
-    }
-
-    wined3d_mutex_lock();
-    wined3d_device_set_viewports(device->wined3d_device, viewport_count, wined3d_vp);
-    wined3d_mutex_unlock();
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_SET_VIEWPORTS,
+            0, viewport_count * sizeof(*viewports))))
+        return;
+    call->u.slots.count = viewport_count;
+    memcpy(d3d11_deferred_call_get_data(call), viewports, viewport_count * sizeof(*viewports));
+    d3d11_deferred_state_update(&context->state, call);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_RSSetScissorRects(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_RSSetScissorRects(ID3D11DeviceContext1 *iface,
         UINT rect_count, const D3D11_RECT *rects)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
 
     TRACE("iface %p, rect_count %u, rects %p.\n", iface, rect_count, rects);
 
     if (rect_count > WINED3D_MAX_VIEWPORTS)
         return;
 
-    wined3d_mutex_lock();
-    wined3d_device_set_scissor_rects(device->wined3d_device, rect_count, rects);
-    wined3d_mutex_unlock();
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_SET_SCISSOR_RECTS,
+            0, rect_count * sizeof(*rects))))
+        return;
+    call->u.slots.count = rect_count;
+    memcpy(d3d11_deferred_call_get_data(call), rects, rect_count * sizeof(*rects));
+    d3d11_deferred_state_update(&context->state, call);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CopySubresourceRegion(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_CopySubresourceRegion1(ID3D11DeviceContext1 *iface,
         ID3D11Resource *dst_resource, UINT dst_subresource_idx, UINT dst_x, UINT dst_y, UINT dst_z,
-        ID3D11Resource *src_resource, UINT src_subresource_idx, const D3D11_BOX *src_box)
+        ID3D11Resource *src_resource, UINT src_subresource_idx, const D3D11_BOX *src_box, UINT flags)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_resource *wined3d_dst_resource, *wined3d_src_resource;
-    struct wined3d_box wined3d_src_box;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
 
+    TRACE("iface %p, dst_resource %p, dst_subresource_idx %u, dst_x %u, dst_y %u, dst_z %u, "
+            "src_resource %p, src_subresource_idx %u, src_box %p, flags %#x.\n",
+            iface, dst_resource, dst_subresource_idx, dst_x, dst_y, dst_z,
+            src_resource, src_subresource_idx, src_box, flags);
+
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_COPY_SUBRESOURCE_REGION, 2, 0)))
+        return;
+    call->u.copy.dst_idx = dst_subresource_idx;
+    call->u.copy.dst_x = dst_x;
+    call->u.copy.dst_y = dst_y;
+    call->u.copy.dst_z = dst_z;
+    call->u.copy.src_idx = src_subresource_idx;
+    call->u.copy.flags = flags;
+    if ((call->u.copy.has_box = !!src_box))
+        call->u.copy.box = *src_box;
+    d3d11_deferred_call_set_objects(call, 0, 1, (IUnknown **)&dst_resource);
+    d3d11_deferred_call_set_objects(call, 1, 1, (IUnknown **)&src_resource);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_CopySubresourceRegion(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *dst_resource, UINT dst_subresource_idx, UINT dst_x, UINT dst_y, UINT dst_z,
+        ID3D11Resource *src_resource, UINT src_subresource_idx, const D3D11_BOX *src_box)
+{
     TRACE("iface %p, dst_resource %p, dst_subresource_idx %u, dst_x %u, dst_y %u, dst_z %u, "
             "src_resource %p, src_subresource_idx %u, src_box %p.\n",
             iface, dst_resource, dst_subresource_idx, dst_x, dst_y, dst_z,
             src_resource, src_subresource_idx, src_box);
 
-    if (src_box)
-        wined3d_box_set(&wined3d_src_box, src_box->left, src_box->top,
-                src_box->right, src_box->bottom, src_box->front, src_box->back);
-
-    wined3d_dst_resource = wined3d_resource_from_d3d11_resource(dst_resource);
-    wined3d_src_resource = wined3d_resource_from_d3d11_resource(src_resource);
-    wined3d_mutex_lock();
-    wined3d_device_copy_sub_resource_region(device->wined3d_device, wined3d_dst_resource, dst_subresource_idx,
-            dst_x, dst_y, dst_z, wined3d_src_resource, src_subresource_idx, src_box ? &wined3d_src_box : NULL, 0);
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_CopySubresourceRegion1(iface, dst_resource, dst_subresource_idx,
+            dst_x, dst_y, dst_z, src_resource, src_subresource_idx, src_box, 0);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CopyResource(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_CopyResource(ID3D11DeviceContext1 *iface,
         ID3D11Resource *dst_resource, ID3D11Resource *src_resource)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_resource *wined3d_dst_resource, *wined3d_src_resource;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
 
     TRACE("iface %p, dst_resource %p, src_resource %p.\n", iface, dst_resource, src_resource);
 
-    wined3d_dst_resource = wined3d_resource_from_d3d11_resource(dst_resource);
-    wined3d_src_resource = wined3d_resource_from_d3d11_resource(src_resource);
-    wined3d_mutex_lock();
-    wined3d_device_copy_resource(device->wined3d_device, wined3d_dst_resource, wined3d_src_resource);
-    wined3d_mutex_unlock();
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_COPY_RESOURCE, 2, 0)))
+        return;
+    d3d11_deferred_call_set_objects(call, 0, 1, (IUnknown **)&dst_resource);
+    d3d11_deferred_call_set_objects(call, 1, 1, (IUnknown **)&src_resource);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_UpdateSubresource(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_UpdateSubresource1(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *resource, UINT subresource_idx, const D3D11_BOX *box, const void *data,
+        UINT row_pitch, UINT depth_pitch, UINT flags)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    unsigned int row_size, row_count, depth, y, z;
+    struct d3d11_deferred_call *call;
+    const BYTE *src;
+    BYTE *dst;
+    HRESULT hr;
+
+    TRACE("iface %p, resource %p, subresource_idx %u, box %p, data %p, row_pitch %u, depth_pitch %u, flags %#x.\n",
+            iface, resource, subresource_idx, box, data, row_pitch, depth_pitch, flags);
+
+    if (FAILED(hr = d3d11_get_sub_resource_layout(resource, subresource_idx, box, &row_size, &row_count, &depth)))
+    {
+        FIXME("Failed to get layout of resource %p, sub-resource %u, hr %#x.\n", resource, subresource_idx, hr);
+        return;
+    }
+
+    /* The source data has to be copied now, since the application is free to
+     * reuse it as soon as this call returns. It is stored tightly packed. */
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_UPDATE_SUBRESOURCE,
+            1, row_size * row_count * depth)))
+        return;
+    call->u.update.sub_resource_idx = subresource_idx;
+    call->u.update.row_pitch = row_size;
+    call->u.update.depth_pitch = row_size * row_count;
+    call->u.update.flags = flags;
+    if ((call->u.update.has_box = !!box))
+        call->u.update.box = *box;
+    d3d11_deferred_call_set_objects(call, 0, 1, (IUnknown **)&resource);
+
+    dst = d3d11_deferred_call_get_data(call);
+    for (z = 0; z < depth; ++z)
+    {
+        src = (const BYTE *)data + z * depth_pitch;
+        for (y = 0; y < row_count; ++y)
+        {
+            memcpy(dst, src, row_size);
+            dst += row_size;
+            src += row_pitch;
+        }
+    }
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_UpdateSubresource(ID3D11DeviceContext1 *iface,
         ID3D11Resource *resource, UINT subresource_idx, const D3D11_BOX *box,
         const void *data, UINT row_pitch, UINT depth_pitch)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_resource *wined3d_resource;
-    struct wined3d_box wined3d_box;
-
     TRACE("iface %p, resource %p, subresource_idx %u, box %p, data %p, row_pitch %u, depth_pitch %u.\n",
             iface, resource, subresource_idx, box, data, row_pitch, depth_pitch);
 
-    if (box)
-        wined3d_box_set(&wined3d_box, box->left, box->top, box->right, box->bottom, box->front, box->back);
-
-    wined3d_resource = wined3d_resource_from_d3d11_resource(resource);
-    wined3d_mutex_lock();
-    wined3d_device_update_sub_resource(device->wined3d_device, wined3d_resource,
-            subresource_idx, box ? &wined3d_box : NULL, data, row_pitch, depth_pitch, 0);
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_UpdateSubresource1(iface, resource, subresource_idx, box, data,
+            row_pitch, depth_pitch, 0);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CopyStructureCount(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_CopyStructureCount(ID3D11DeviceContext1 *iface,
         ID3D11Buffer *dst_buffer, UINT dst_offset, ID3D11UnorderedAccessView *src_view)
-{
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d11_unordered_access_view *uav;
-    struct d3d_buffer *buffer_impl;
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
 
     TRACE("iface %p, dst_buffer %p, dst_offset %u, src_view %p.\n",
             iface, dst_buffer, dst_offset, src_view);
 
-    buffer_impl = unsafe_impl_from_ID3D11Buffer(dst_buffer);
-    uav = unsafe_impl_from_ID3D11UnorderedAccessView(src_view);
-
-    wined3d_mutex_lock();
-    wined3d_device_copy_uav_counter(device->wined3d_device,
-            buffer_impl->wined3d_buffer, dst_offset, uav->wined3d_view);
-    wined3d_mutex_unlock();
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_COPY_STRUCTURE_COUNT, 2, 0)))
+        return;
+    call->u.offset = dst_offset;
+    d3d11_deferred_call_set_objects(call, 0, 1, (IUnknown **)&dst_buffer);
+    d3d11_deferred_call_set_objects(call, 1, 1, (IUnknown **)&src_view);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_ClearRenderTargetView(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_ClearRenderTargetView(ID3D11DeviceContext1 *iface,
         ID3D11RenderTargetView *render_target_view, const float color_rgba[4])
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_rendertarget_view *view = unsafe_impl_from_ID3D11RenderTargetView(render_target_view);
-    const struct wined3d_color color = {color_rgba[0], color_rgba[1], color_rgba[2], color_rgba[3]};
-    HRESULT hr;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
 
     TRACE("iface %p, render_target_view %p, color_rgba %s.\n",
             iface, render_target_view, debug_float4(color_rgba));
 
-    if (!view)
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_CLEAR_RENDER_TARGET_VIEW, 1, 0)))
         return;
-
-    wined3d_mutex_lock();
-    if (FAILED(hr = wined3d_device_clear_rendertarget_view(device->wined3d_device, view->wined3d_view, NULL,
-            WINED3DCLEAR_TARGET, &color, 0.0f, 0)))
-        ERR("Failed to clear view, hr %#x.\n", hr);
-    wined3d_mutex_unlock();
+    memcpy(call->u.color, color_rgba, sizeof(call->u.color));
+    d3d11_deferred_call_set_objects(call, 0, 1, (IUnknown **)&render_target_view);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_ClearUnorderedAccessViewUint(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_ClearUnorderedAccessViewUint(ID3D11DeviceContext1 *iface,
         ID3D11UnorderedAccessView *unordered_access_view, const UINT values[4])
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d11_unordered_access_view *view;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
 
     TRACE("iface %p, unordered_access_view %p, values {%u, %u, %u, %u}.\n",
             iface, unordered_access_view, values[0], values[1], values[2], values[3]);
 
-    view = unsafe_impl_from_ID3D11UnorderedAccessView(unordered_access_view);
-    wined3d_mutex_lock();
-    wined3d_device_clear_unordered_access_view_uint(device->wined3d_device,
-            view->wined3d_view, (const struct wined3d_uvec4 *)values);
-    wined3d_mutex_unlock();
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer,
+            DEFERRED_CALL_CLEAR_UNORDERED_ACCESS_VIEW_UINT, 1, 0)))
+        return;
+    memcpy(call->u.values, values, sizeof(call->u.values));
+    d3d11_deferred_call_set_objects(call, 0, 1, (IUnknown **)&unordered_access_view);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_ClearUnorderedAccessViewFloat(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_ClearUnorderedAccessViewFloat(ID3D11DeviceContext1 *iface,
         ID3D11UnorderedAccessView *unordered_access_view, const float values[4])
 {
-    FIXME("iface %p, unordered_access_view %p, values %s stub!\n",
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
+
+    TRACE("iface %p, unordered_access_view %p, values %s.\n",
             iface, unordered_access_view, debug_float4(values));
+
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer,
+            DEFERRED_CALL_CLEAR_UNORDERED_ACCESS_VIEW_FLOAT, 1, 0)))
+        return;
+    memcpy(call->u.color, values, sizeof(call->u.color));
+    d3d11_deferred_call_set_objects(call, 0, 1, (IUnknown **)&unordered_access_view);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_ClearDepthStencilView(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_ClearDepthStencilView(ID3D11DeviceContext1 *iface,
         ID3D11DepthStencilView *depth_stencil_view, UINT flags, FLOAT depth, UINT8 stencil)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_depthstencil_view *view = unsafe_impl_from_ID3D11DepthStencilView(depth_stencil_view);
-    DWORD wined3d_flags;
-    HRESULT hr;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
 
     TRACE("iface %p, depth_stencil_view %p, flags %#x, depth %.8e, stencil %u.\n",
             iface, depth_stencil_view, flags, depth, stencil);
 
-    if (!view)
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_CLEAR_DEPTH_STENCIL_VIEW, 1, 0)))
         return;
-
-    wined3d_flags = wined3d_clear_flags_from_d3d11_clear_flags(flags);
-
-    wined3d_mutex_lock();
-    if (FAILED(hr = wined3d_device_clear_rendertarget_view(device->wined3d_device, view->wined3d_view, NULL,
-            wined3d_flags, NULL, depth, stencil)))
-        ERR("Failed to clear view, hr %#x.\n", hr);
-    wined3d_mutex_unlock();
+    call->u.clear_depth_stencil.flags = flags;
+    call->u.clear_depth_stencil.depth = depth;
+    call->u.clear_depth_stencil.stencil = stencil;
+    d3d11_deferred_call_set_objects(call, 0, 1, (IUnknown **)&depth_stencil_view);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_GenerateMips(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_GenerateMips(ID3D11DeviceContext1 *iface,
         ID3D11ShaderResourceView *view)
 {
-    struct d3d_shader_resource_view *srv = unsafe_impl_from_ID3D11ShaderResourceView(view);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
     TRACE("iface %p, view %p.\n", iface, view);
 
-    wined3d_mutex_lock();
-    wined3d_shader_resource_view_generate_mipmaps(srv->wined3d_view);
-    wined3d_mutex_unlock();
+    d3d11_command_buffer_record_object(&context->buffer, DEFERRED_CALL_GENERATE_MIPS, (IUnknown *)view);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_SetResourceMinLOD(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_SetResourceMinLOD(ID3D11DeviceContext1 *iface,
         ID3D11Resource *resource, FLOAT min_lod)
 {
-    FIXME("iface %p, resource %p, min_lod %f stub!\n", iface, resource, min_lod);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
+
+    TRACE("iface %p, resource %p, min_lod %f.\n", iface, resource, min_lod);
+
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_SET_RESOURCE_MIN_LOD, 1, 0)))
+        return;
+    call->u.min_lod = min_lod;
+    d3d11_deferred_call_set_objects(call, 0, 1, (IUnknown **)&resource);
 }
 
-static FLOAT STDMETHODCALLTYPE d3d11_immediate_context_GetResourceMinLOD(ID3D11DeviceContext1 *iface,
+static FLOAT STDMETHODCALLTYPE d3d11_deferred_context_GetResourceMinLOD(ID3D11DeviceContext1 *iface,
         ID3D11Resource *resource)
 {
     FIXME("iface %p, resource %p stub!\n", iface, resource);
@@ -1125,723 +5350,400 @@ static FLOAT STDMETHODCALLTYPE d3d11_immediate_context_GetResourceMinLOD(ID3D11D
     return 0.0f;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_ResolveSubresource(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_ResolveSubresource(ID3D11DeviceContext1 *iface,
         ID3D11Resource *dst_resource, UINT dst_subresource_idx,
         ID3D11Resource *src_resource, UINT src_subresource_idx,
         DXGI_FORMAT format)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_resource *wined3d_dst_resource, *wined3d_src_resource;
-    enum wined3d_format_id wined3d_format;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
 
     TRACE("iface %p, dst_resource %p, dst_subresource_idx %u, "
             "src_resource %p, src_subresource_idx %u, format %s.\n",
             iface, dst_resource, dst_subresource_idx,
             src_resource, src_subresource_idx, debug_dxgi_format(format));
 
-    wined3d_dst_resource = wined3d_resource_from_d3d11_resource(dst_resource);
-    wined3d_src_resource = wined3d_resource_from_d3d11_resource(src_resource);
-    wined3d_format = wined3dformat_from_dxgi_format(format);
-    wined3d_mutex_lock();
-    wined3d_device_resolve_sub_resource(device->wined3d_device,
-            wined3d_dst_resource, dst_subresource_idx,
-            wined3d_src_resource, src_subresource_idx, wined3d_format);
-    wined3d_mutex_unlock();
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_RESOLVE_SUBRESOURCE, 2, 0)))
+        return;
+    call->u.resolve.dst_idx = dst_subresource_idx;
+    call->u.resolve.src_idx = src_subresource_idx;
+    call->u.resolve.format = format;
+    d3d11_deferred_call_set_objects(call, 0, 1, (IUnknown **)&dst_resource);
+    d3d11_deferred_call_set_objects(call, 1, 1, (IUnknown **)&src_resource);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_ExecuteCommandList(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_ExecuteCommandList(ID3D11DeviceContext1 *iface,
         ID3D11CommandList *command_list, BOOL restore_state)
 {
-    FIXME("iface %p, command_list %p, restore_state %#x stub!\n", iface, command_list, restore_state);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
+
+    TRACE("iface %p, command_list %p, restore_state %#x.\n", iface, command_list, restore_state);
+
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_EXECUTE_COMMAND_LIST, 1, 0)))
+        return;
+    call->u.restore = restore_state;
+    d3d11_deferred_call_set_objects(call, 0, 1, (IUnknown **)&command_list);
+    d3d11_deferred_state_update(&context->state, call);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_HSSetShaderResources(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSSetShaderResources(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
     TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
             iface, start_slot, view_count, views);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < view_count; ++i)
-    {
-        struct d3d_shader_resource_view *view = unsafe_impl_from_ID3D11ShaderResourceView(views[i]);
-
-        wined3d_device_set_hs_resource_view(device->wined3d_device, start_slot + i,
-                view ? view->wined3d_view : NULL);
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_set_slots(iface, DEFERRED_CALL_SET_SHADER_RESOURCES,
+            WINED3D_SHADER_TYPE_HULL, start_slot, view_count, (IUnknown *const *)views);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_HSSetShader(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSSetShader(ID3D11DeviceContext1 *iface,
         ID3D11HullShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d11_hull_shader *hs = unsafe_impl_from_ID3D11HullShader(shader);
-
     TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
             iface, shader, class_instances, class_instance_count);
 
-    if (class_instances)
-        FIXME("Dynamic linking is not implemented yet.\n");
-
-    wined3d_mutex_lock();
-    wined3d_device_set_hull_shader(device->wined3d_device, hs ? hs->wined3d_shader : NULL);
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_set_shader(iface, WINED3D_SHADER_TYPE_HULL, (IUnknown *)shader, class_instances);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_HSSetSamplers(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSSetSamplers(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
     TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
             iface, start_slot, sampler_count, samplers);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < sampler_count; ++i)
-    {
-        struct d3d_sampler_state *sampler = unsafe_impl_from_ID3D11SamplerState(samplers[i]);
-
-        wined3d_device_set_hs_sampler(device->wined3d_device, start_slot + i,
-                sampler ? sampler->wined3d_sampler : NULL);
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_set_slots(iface, DEFERRED_CALL_SET_SAMPLERS,
+            WINED3D_SHADER_TYPE_HULL, start_slot, sampler_count, (IUnknown *const *)samplers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_HSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSSetConstantBuffers(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
 {
     TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
             iface, start_slot, buffer_count, buffers);
 
-    d3d11_immediate_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_HULL, start_slot,
-            buffer_count, buffers);
+    d3d11_deferred_context_set_slots(iface, DEFERRED_CALL_SET_CONSTANT_BUFFERS,
+            WINED3D_SHADER_TYPE_HULL, start_slot, buffer_count, (IUnknown *const *)buffers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DSSetShaderResources(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSSetShaderResources(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
     TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
             iface, start_slot, view_count, views);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < view_count; ++i)
-    {
-        struct d3d_shader_resource_view *view = unsafe_impl_from_ID3D11ShaderResourceView(views[i]);
-
-        wined3d_device_set_ds_resource_view(device->wined3d_device, start_slot + i,
-                view ? view->wined3d_view : NULL);
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_set_slots(iface, DEFERRED_CALL_SET_SHADER_RESOURCES,
+            WINED3D_SHADER_TYPE_DOMAIN, start_slot, view_count, (IUnknown *const *)views);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DSSetShader(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSSetShader(ID3D11DeviceContext1 *iface,
         ID3D11DomainShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d11_domain_shader *ds = unsafe_impl_from_ID3D11DomainShader(shader);
-
     TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
             iface, shader, class_instances, class_instance_count);
 
-    if (class_instances)
-        FIXME("Dynamic linking is not implemented yet.\n");
-
-    wined3d_mutex_lock();
-    wined3d_device_set_domain_shader(device->wined3d_device, ds ? ds->wined3d_shader : NULL);
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_set_shader(iface, WINED3D_SHADER_TYPE_DOMAIN, (IUnknown *)shader, class_instances);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DSSetSamplers(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSSetSamplers(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
     TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
             iface, start_slot, sampler_count, samplers);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < sampler_count; ++i)
-    {
-        struct d3d_sampler_state *sampler = unsafe_impl_from_ID3D11SamplerState(samplers[i]);
-
-        wined3d_device_set_ds_sampler(device->wined3d_device, start_slot + i,
-                sampler ? sampler->wined3d_sampler : NULL);
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_set_slots(iface, DEFERRED_CALL_SET_SAMPLERS,
+            WINED3D_SHADER_TYPE_DOMAIN, start_slot, sampler_count, (IUnknown *const *)samplers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSSetConstantBuffers(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
 {
     TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
             iface, start_slot, buffer_count, buffers);
 
-    d3d11_immediate_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_DOMAIN, start_slot,
-            buffer_count, buffers);
+    d3d11_deferred_context_set_slots(iface, DEFERRED_CALL_SET_CONSTANT_BUFFERS,
+            WINED3D_SHADER_TYPE_DOMAIN, start_slot, buffer_count, (IUnknown *const *)buffers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CSSetShaderResources(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSSetShaderResources(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
     TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
             iface, start_slot, view_count, views);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < view_count; ++i)
-    {
-        struct d3d_shader_resource_view *view = unsafe_impl_from_ID3D11ShaderResourceView(views[i]);
-
-        wined3d_device_set_cs_resource_view(device->wined3d_device, start_slot + i,
-                view ? view->wined3d_view : NULL);
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_set_slots(iface, DEFERRED_CALL_SET_SHADER_RESOURCES,
+            WINED3D_SHADER_TYPE_COMPUTE, start_slot, view_count, (IUnknown *const *)views);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CSSetUnorderedAccessViews(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSSetUnorderedAccessViews(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT view_count, ID3D11UnorderedAccessView *const *views, const UINT *initial_counts)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
     unsigned int i;
+    UINT *data;
 
     TRACE("iface %p, start_slot %u, view_count %u, views %p, initial_counts %p.\n",
             iface, start_slot, view_count, views, initial_counts);
 
-    wined3d_mutex_lock();
+    if (!(call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_SET_UNORDERED_ACCESS_VIEWS,
+            view_count, view_count * sizeof(*data))))
+        return;
+    call->u.slots.start = start_slot;
+    call->u.slots.count = view_count;
+    d3d11_deferred_call_set_objects(call, 0, view_count, (IUnknown *const *)views);
+    data = d3d11_deferred_call_get_data(call);
     for (i = 0; i < view_count; ++i)
-    {
-        struct d3d11_unordered_access_view *view = unsafe_impl_from_ID3D11UnorderedAccessView(views[i]);
-
-        wined3d_device_set_cs_uav(device->wined3d_device, start_slot + i,
-                view ? view->wined3d_view : NULL, initial_counts ? initial_counts[i] : ~0u);
-    }
-    wined3d_mutex_unlock();
+        data[i] = initial_counts ? initial_counts[i] : ~0u;
+    d3d11_deferred_state_update(&context->state, call);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CSSetShader(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSSetShader(ID3D11DeviceContext1 *iface,
         ID3D11ComputeShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d11_compute_shader *cs = unsafe_impl_from_ID3D11ComputeShader(shader);
-
     TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
             iface, shader, class_instances, class_instance_count);
 
-    if (class_instances)
-        FIXME("Dynamic linking is not implemented yet.\n");
-
-    wined3d_mutex_lock();
-    wined3d_device_set_compute_shader(device->wined3d_device, cs ? cs->wined3d_shader : NULL);
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_set_shader(iface, WINED3D_SHADER_TYPE_COMPUTE, (IUnknown *)shader, class_instances);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CSSetSamplers(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSSetSamplers(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
     TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
             iface, start_slot, sampler_count, samplers);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < sampler_count; ++i)
-    {
-        struct d3d_sampler_state *sampler = unsafe_impl_from_ID3D11SamplerState(samplers[i]);
-
-        wined3d_device_set_cs_sampler(device->wined3d_device, start_slot + i,
-                sampler ? sampler->wined3d_sampler : NULL);
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_set_slots(iface, DEFERRED_CALL_SET_SAMPLERS,
+            WINED3D_SHADER_TYPE_COMPUTE, start_slot, sampler_count, (IUnknown *const *)samplers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSSetConstantBuffers(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
 {
     TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
             iface, start_slot, buffer_count, buffers);
 
-    d3d11_immediate_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_COMPUTE, start_slot,
-            buffer_count, buffers);
+    d3d11_deferred_context_set_slots(iface, DEFERRED_CALL_SET_CONSTANT_BUFFERS,
+            WINED3D_SHADER_TYPE_COMPUTE, start_slot, buffer_count, (IUnknown *const *)buffers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_VSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSGetConstantBuffers(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
 {
     TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
             iface, start_slot, buffer_count, buffers);
 
-    d3d11_immediate_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_VERTEX, start_slot,
-            buffer_count, buffers);
+    d3d11_deferred_context_get_slots(iface, DEFERRED_CALL_SET_CONSTANT_BUFFERS,
+            WINED3D_SHADER_TYPE_VERTEX, start_slot, buffer_count, buffers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_PSGetShaderResources(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSGetShaderResources(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
-    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
-            iface, start_slot, view_count, views);
-
-    wined3d_mutex_lock();
-    for (i = 0; i < view_count; ++i)
-    {
-        struct wined3d_shader_resource_view *wined3d_view;
-        struct d3d_shader_resource_view *view_impl;
-
-        if (!(wined3d_view = wined3d_device_get_ps_resource_view(device->wined3d_device, start_slot + i)))
-        {
-            views[i] = NULL;
-            continue;
-        }
-
-        view_impl = wined3d_shader_resource_view_get_parent(wined3d_view);
-        views[i] = &view_impl->ID3D11ShaderResourceView_iface;
-        ID3D11ShaderResourceView_AddRef(views[i]);
-    }
-    wined3d_mutex_unlock();
-}
-
-static void STDMETHODCALLTYPE d3d11_immediate_context_PSGetShader(ID3D11DeviceContext1 *iface,
-        ID3D11PixelShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
-{
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_shader *wined3d_shader;
-    struct d3d_pixel_shader *shader_impl;
-
-    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %p.\n",
-            iface, shader, class_instances, class_instance_count);
-
-    if (class_instances || class_instance_count)
-        FIXME("Dynamic linking not implemented yet.\n");
-    if (class_instance_count)
-        *class_instance_count = 0;
-
-    wined3d_mutex_lock();
-    if (!(wined3d_shader = wined3d_device_get_pixel_shader(device->wined3d_device)))
-    {
-        wined3d_mutex_unlock();
-        *shader = NULL;
-        return;
-    }
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
+            iface, start_slot, view_count, views);
 
-    shader_impl = wined3d_shader_get_parent(wined3d_shader);
-    wined3d_mutex_unlock();
-    *shader = &shader_impl->ID3D11PixelShader_iface;
-    ID3D11PixelShader_AddRef(*shader);
+    d3d11_deferred_context_get_slots(iface, DEFERRED_CALL_SET_SHADER_RESOURCES,
+            WINED3D_SHADER_TYPE_PIXEL, start_slot, view_count, views);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_PSGetSamplers(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSGetShader(ID3D11DeviceContext1 *iface,
+        ID3D11PixelShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %p.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    d3d11_deferred_context_get_shader(iface, WINED3D_SHADER_TYPE_PIXEL,
+            shader, class_instances, class_instance_count);
+}
 
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSGetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
+{
     TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
             iface, start_slot, sampler_count, samplers);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < sampler_count; ++i)
-    {
-        struct wined3d_sampler *wined3d_sampler;
-        struct d3d_sampler_state *sampler_impl;
-
-        if (!(wined3d_sampler = wined3d_device_get_ps_sampler(device->wined3d_device, start_slot + i)))
-        {
-            samplers[i] = NULL;
-            continue;
-        }
-
-        sampler_impl = wined3d_sampler_get_parent(wined3d_sampler);
-        samplers[i] = &sampler_impl->ID3D11SamplerState_iface;
-        ID3D11SamplerState_AddRef(samplers[i]);
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_get_slots(iface, DEFERRED_CALL_SET_SAMPLERS,
+            WINED3D_SHADER_TYPE_PIXEL, start_slot, sampler_count, samplers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_VSGetShader(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSGetShader(ID3D11DeviceContext1 *iface,
         ID3D11VertexShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_vertex_shader *shader_impl;
-    struct wined3d_shader *wined3d_shader;
-
     TRACE("iface %p, shader %p, class_instances %p, class_instance_count %p.\n",
             iface, shader, class_instances, class_instance_count);
 
-    if (class_instances || class_instance_count)
-        FIXME("Dynamic linking not implemented yet.\n");
-    if (class_instance_count)
-        *class_instance_count = 0;
-
-    wined3d_mutex_lock();
-    if (!(wined3d_shader = wined3d_device_get_vertex_shader(device->wined3d_device)))
-    {
-        wined3d_mutex_unlock();
-        *shader = NULL;
-        return;
-    }
-
-    shader_impl = wined3d_shader_get_parent(wined3d_shader);
-    wined3d_mutex_unlock();
-    *shader = &shader_impl->ID3D11VertexShader_iface;
-    ID3D11VertexShader_AddRef(*shader);
+    d3d11_deferred_context_get_shader(iface, WINED3D_SHADER_TYPE_VERTEX,
+            shader, class_instances, class_instance_count);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_PSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSGetConstantBuffers(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
 {
     TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
             iface, start_slot, buffer_count, buffers);
 
-    d3d11_immediate_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_PIXEL, start_slot,
-            buffer_count, buffers);
+    d3d11_deferred_context_get_slots(iface, DEFERRED_CALL_SET_CONSTANT_BUFFERS,
+            WINED3D_SHADER_TYPE_PIXEL, start_slot, buffer_count, buffers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_IAGetInputLayout(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_IAGetInputLayout(ID3D11DeviceContext1 *iface,
         ID3D11InputLayout **input_layout)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_vertex_declaration *wined3d_declaration;
-    struct d3d_input_layout *input_layout_impl;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_state *state = &context->state;
 
     TRACE("iface %p, input_layout %p.\n", iface, input_layout);
 
-    wined3d_mutex_lock();
-    if (!(wined3d_declaration = wined3d_device_get_vertex_declaration(device->wined3d_device)))
-    {
-        wined3d_mutex_unlock();
-        *input_layout = NULL;
-        return;
-    }
-
-    input_layout_impl = wined3d_vertex_declaration_get_parent(wined3d_declaration);
-    wined3d_mutex_unlock();
-    *input_layout = &input_layout_impl->ID3D11InputLayout_iface;
-    ID3D11InputLayout_AddRef(*input_layout);
+    d3d11_deferred_state_get_objects(&state->input_layout, 1, 0, 1, input_layout);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_IAGetVertexBuffers(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_IAGetVertexBuffers(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *strides, UINT *offsets)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_state *state = &context->state;
     unsigned int i;
 
     TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p, strides %p, offsets %p.\n",
             iface, start_slot, buffer_count, buffers, strides, offsets);
 
-    wined3d_mutex_lock();
+    d3d11_deferred_state_get_objects(state->vertex_buffers, ARRAY_SIZE(state->vertex_buffers),
+            start_slot, buffer_count, buffers);
     for (i = 0; i < buffer_count; ++i)
     {
-        struct wined3d_buffer *wined3d_buffer = NULL;
-        struct d3d_buffer *buffer_impl;
-
-        if (FAILED(wined3d_device_get_stream_source(device->wined3d_device, start_slot + i,
-                &wined3d_buffer, &offsets[i], &strides[i])))
-        {
-            FIXME("Failed to get vertex buffer %u.\n", start_slot + i);
-            if (strides)
-                strides[i] = 0;
-            if (offsets)
-                offsets[i] = 0;
-        }
-
-        if (!wined3d_buffer)
-        {
-            buffers[i] = NULL;
-            continue;
-        }
+        BOOL valid = start_slot < ARRAY_SIZE(state->vertex_buffers)
+                && i < ARRAY_SIZE(state->vertex_buffers) - start_slot;
 
-        buffer_impl = wined3d_buffer_get_parent(wined3d_buffer);
-        ID3D11Buffer_AddRef(buffers[i] = &buffer_impl->ID3D11Buffer_iface);
+        if (strides)
+            strides[i] = valid ? state->vertex_buffer_strides[start_slot + i] : 0;
+        if (offsets)
+            offsets[i] = valid ? state->vertex_buffer_offsets[start_slot + i] : 0;
     }
-    wined3d_mutex_unlock();
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_IAGetIndexBuffer(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_IAGetIndexBuffer(ID3D11DeviceContext1 *iface,
         ID3D11Buffer **buffer, DXGI_FORMAT *format, UINT *offset)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    enum wined3d_format_id wined3d_format;
-    struct wined3d_buffer *wined3d_buffer;
-    struct d3d_buffer *buffer_impl;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_state *state = &context->state;
 
     TRACE("iface %p, buffer %p, format %p, offset %p.\n", iface, buffer, format, offset);
 
-    wined3d_mutex_lock();
-    wined3d_buffer = wined3d_device_get_index_buffer(device->wined3d_device, &wined3d_format, offset);
-    *format = dxgi_format_from_wined3dformat(wined3d_format);
-    if (!wined3d_buffer)
-    {
-        wined3d_mutex_unlock();
-        *buffer = NULL;
-        return;
-    }
-
-    buffer_impl = wined3d_buffer_get_parent(wined3d_buffer);
-    wined3d_mutex_unlock();
-    ID3D11Buffer_AddRef(*buffer = &buffer_impl->ID3D11Buffer_iface);
+    d3d11_deferred_state_get_objects(&state->index_buffer, 1, 0, 1, buffer);
+    *format = state->index_format;
+    *offset = state->index_offset;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_GSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSGetConstantBuffers(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
 {
     TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
             iface, start_slot, buffer_count, buffers);
 
-    d3d11_immediate_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_GEOMETRY, start_slot,
-            buffer_count, buffers);
+    d3d11_deferred_context_get_slots(iface, DEFERRED_CALL_SET_CONSTANT_BUFFERS,
+            WINED3D_SHADER_TYPE_GEOMETRY, start_slot, buffer_count, buffers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_GSGetShader(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSGetShader(ID3D11DeviceContext1 *iface,
         ID3D11GeometryShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_geometry_shader *shader_impl;
-    struct wined3d_shader *wined3d_shader;
-
     TRACE("iface %p, shader %p, class_instances %p, class_instance_count %p.\n",
             iface, shader, class_instances, class_instance_count);
 
-    if (class_instances || class_instance_count)
-        FIXME("Dynamic linking not implemented yet.\n");
-    if (class_instance_count)
-        *class_instance_count = 0;
-
-    wined3d_mutex_lock();
-    if (!(wined3d_shader = wined3d_device_get_geometry_shader(device->wined3d_device)))
-    {
-        wined3d_mutex_unlock();
-        *shader = NULL;
-        return;
-    }
-
-    shader_impl = wined3d_shader_get_parent(wined3d_shader);
-    wined3d_mutex_unlock();
-    *shader = &shader_impl->ID3D11GeometryShader_iface;
-    ID3D11GeometryShader_AddRef(*shader);
+    d3d11_deferred_context_get_shader(iface, WINED3D_SHADER_TYPE_GEOMETRY,
+            shader, class_instances, class_instance_count);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_IAGetPrimitiveTopology(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_IAGetPrimitiveTopology(ID3D11DeviceContext1 *iface,
         D3D11_PRIMITIVE_TOPOLOGY *topology)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    enum wined3d_primitive_type primitive_type;
-    unsigned int patch_vertex_count;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
     TRACE("iface %p, topology %p.\n", iface, topology);
 
-    wined3d_mutex_lock();
-    wined3d_device_get_primitive_type(device->wined3d_device, &primitive_type, &patch_vertex_count);
-    wined3d_mutex_unlock();
-
-    d3d11_primitive_topology_from_wined3d_primitive_type(primitive_type, patch_vertex_count, topology);
+    *topology = context->state.topology;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_VSGetShaderResources(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSGetShaderResources(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
-    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
-
-    wined3d_mutex_lock();
-    for (i = 0; i < view_count; ++i)
-    {
-        struct wined3d_shader_resource_view *wined3d_view;
-        struct d3d_shader_resource_view *view_impl;
-
-        if (!(wined3d_view = wined3d_device_get_vs_resource_view(device->wined3d_device, start_slot + i)))
-        {
-            views[i] = NULL;
-            continue;
-        }
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
+            iface, start_slot, view_count, views);
 
-        view_impl = wined3d_shader_resource_view_get_parent(wined3d_view);
-        views[i] = &view_impl->ID3D11ShaderResourceView_iface;
-        ID3D11ShaderResourceView_AddRef(views[i]);
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_get_slots(iface, DEFERRED_CALL_SET_SHADER_RESOURCES,
+            WINED3D_SHADER_TYPE_VERTEX, start_slot, view_count, views);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_VSGetSamplers(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSGetSamplers(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
     TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
             iface, start_slot, sampler_count, samplers);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < sampler_count; ++i)
-    {
-        struct wined3d_sampler *wined3d_sampler;
-        struct d3d_sampler_state *sampler_impl;
-
-        if (!(wined3d_sampler = wined3d_device_get_vs_sampler(device->wined3d_device, start_slot + i)))
-        {
-            samplers[i] = NULL;
-            continue;
-        }
-
-        sampler_impl = wined3d_sampler_get_parent(wined3d_sampler);
-        samplers[i] = &sampler_impl->ID3D11SamplerState_iface;
-        ID3D11SamplerState_AddRef(samplers[i]);
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_get_slots(iface, DEFERRED_CALL_SET_SAMPLERS,
+            WINED3D_SHADER_TYPE_VERTEX, start_slot, sampler_count, samplers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_GetPredication(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_GetPredication(ID3D11DeviceContext1 *iface,
         ID3D11Predicate **predicate, BOOL *value)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_query *wined3d_predicate;
-    struct d3d_query *predicate_impl;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_state *state = &context->state;
 
     TRACE("iface %p, predicate %p, value %p.\n", iface, predicate, value);
 
-    wined3d_mutex_lock();
-    if (!(wined3d_predicate = wined3d_device_get_predication(device->wined3d_device, value)))
-    {
-        wined3d_mutex_unlock();
-        *predicate = NULL;
-        return;
-    }
-
-    predicate_impl = wined3d_query_get_parent(wined3d_predicate);
-    wined3d_mutex_unlock();
-    *predicate = (ID3D11Predicate *)&predicate_impl->ID3D11Query_iface;
-    ID3D11Predicate_AddRef(*predicate);
+    d3d11_deferred_state_get_objects(&state->predicate, 1, 0, 1, predicate);
+    if (value)
+        *value = state->predicate_value;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_GSGetShaderResources(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSGetShaderResources(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
-    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
-
-    wined3d_mutex_lock();
-    for (i = 0; i < view_count; ++i)
-    {
-        struct wined3d_shader_resource_view *wined3d_view;
-        struct d3d_shader_resource_view *view_impl;
-
-        if (!(wined3d_view = wined3d_device_get_gs_resource_view(device->wined3d_device, start_slot + i)))
-        {
-            views[i] = NULL;
-            continue;
-        }
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
+            iface, start_slot, view_count, views);
 
-        view_impl = wined3d_shader_resource_view_get_parent(wined3d_view);
-        views[i] = &view_impl->ID3D11ShaderResourceView_iface;
-        ID3D11ShaderResourceView_AddRef(views[i]);
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_get_slots(iface, DEFERRED_CALL_SET_SHADER_RESOURCES,
+            WINED3D_SHADER_TYPE_GEOMETRY, start_slot, view_count, views);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_GSGetSamplers(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
-{
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
-    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
-            iface, start_slot, sampler_count, samplers);
-
-    wined3d_mutex_lock();
-    for (i = 0; i < sampler_count; ++i)
-    {
-        struct d3d_sampler_state *sampler_impl;
-        struct wined3d_sampler *wined3d_sampler;
-
-        if (!(wined3d_sampler = wined3d_device_get_gs_sampler(device->wined3d_device, start_slot + i)))
-        {
-            samplers[i] = NULL;
-            continue;
-        }
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSGetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
+{
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
 
-        sampler_impl = wined3d_sampler_get_parent(wined3d_sampler);
-        samplers[i] = &sampler_impl->ID3D11SamplerState_iface;
-        ID3D11SamplerState_AddRef(samplers[i]);
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_get_slots(iface, DEFERRED_CALL_SET_SAMPLERS,
+            WINED3D_SHADER_TYPE_GEOMETRY, start_slot, sampler_count, samplers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_OMGetRenderTargets(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_OMGetRenderTargets(ID3D11DeviceContext1 *iface,
         UINT render_target_view_count, ID3D11RenderTargetView **render_target_views,
         ID3D11DepthStencilView **depth_stencil_view)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_rendertarget_view *wined3d_view;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_state *state = &context->state;
 
     TRACE("iface %p, render_target_view_count %u, render_target_views %p, depth_stencil_view %p.\n",
             iface, render_target_view_count, render_target_views, depth_stencil_view);
 
-    wined3d_mutex_lock();
     if (render_target_views)
-    {
-        struct d3d_rendertarget_view *view_impl;
-        unsigned int i;
-
-        for (i = 0; i < render_target_view_count; ++i)
-        {
-            if (!(wined3d_view = wined3d_device_get_rendertarget_view(device->wined3d_device, i))
-                    || !(view_impl = wined3d_rendertarget_view_get_parent(wined3d_view)))
-            {
-                render_target_views[i] = NULL;
-                continue;
-            }
-
-            render_target_views[i] = &view_impl->ID3D11RenderTargetView_iface;
-            ID3D11RenderTargetView_AddRef(render_target_views[i]);
-        }
-    }
-
+        d3d11_deferred_state_get_objects(state->render_targets, ARRAY_SIZE(state->render_targets),
+                0, render_target_view_count, render_target_views);
     if (depth_stencil_view)
-    {
-        struct d3d_depthstencil_view *view_impl;
-
-        if (!(wined3d_view = wined3d_device_get_depth_stencil_view(device->wined3d_device))
-                || !(view_impl = wined3d_rendertarget_view_get_parent(wined3d_view)))
-        {
-            *depth_stencil_view = NULL;
-        }
-        else
-        {
-            *depth_stencil_view = &view_impl->ID3D11DepthStencilView_iface;
-            ID3D11DepthStencilView_AddRef(*depth_stencil_view);
-        }
-    }
-    wined3d_mutex_unlock();
+        d3d11_deferred_state_get_objects(&state->depth_stencil_view, 1, 0, 1, depth_stencil_view);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_OMGetRenderTargetsAndUnorderedAccessViews(
+static void STDMETHODCALLTYPE d3d11_deferred_context_OMGetRenderTargetsAndUnorderedAccessViews(
         ID3D11DeviceContext1 *iface,
         UINT render_target_view_count, ID3D11RenderTargetView **render_target_views,
         ID3D11DepthStencilView **depth_stencil_view,
         UINT unordered_access_view_start_slot, UINT unordered_access_view_count,
         ID3D11UnorderedAccessView **unordered_access_views)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_unordered_access_view *wined3d_view;
-    struct d3d11_unordered_access_view *view_impl;
-    unsigned int i;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_state *state = &context->state;
 
     TRACE("iface %p, render_target_view_count %u, render_target_views %p, depth_stencil_view %p, "
             "unordered_access_view_start_slot %u, unordered_access_view_count %u, "
@@ -1850,640 +5752,314 @@ static void STDMETHODCALLTYPE d3d11_immediate_context_OMGetRenderTargetsAndUnord
             unordered_access_view_start_slot, unordered_access_view_count, unordered_access_views);
 
     if (render_target_views || depth_stencil_view)
-        d3d11_immediate_context_OMGetRenderTargets(iface, render_target_view_count,
+        d3d11_deferred_context_OMGetRenderTargets(iface, render_target_view_count,
                 render_target_views, depth_stencil_view);
-
     if (unordered_access_views)
-    {
-        wined3d_mutex_lock();
-        for (i = 0; i < unordered_access_view_count; ++i)
-        {
-            if (!(wined3d_view = wined3d_device_get_unordered_access_view(device->wined3d_device,
-                    unordered_access_view_start_slot + i)))
-            {
-                unordered_access_views[i] = NULL;
-                continue;
-            }
-
-            view_impl = wined3d_unordered_access_view_get_parent(wined3d_view);
-            unordered_access_views[i] = &view_impl->ID3D11UnorderedAccessView_iface;
-            ID3D11UnorderedAccessView_AddRef(unordered_access_views[i]);
-        }
-        wined3d_mutex_unlock();
-    }
+        d3d11_deferred_state_get_objects(state->uavs, ARRAY_SIZE(state->uavs),
+                unordered_access_view_start_slot, unordered_access_view_count, unordered_access_views);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_OMGetBlendState(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_OMGetBlendState(ID3D11DeviceContext1 *iface,
         ID3D11BlendState **blend_state, FLOAT blend_factor[4], UINT *sample_mask)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_blend_state *wined3d_state;
-    struct d3d_blend_state *blend_state_impl;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_state *state = &context->state;
 
     TRACE("iface %p, blend_state %p, blend_factor %p, sample_mask %p.\n",
             iface, blend_state, blend_factor, sample_mask);
 
-    wined3d_mutex_lock();
-    if ((wined3d_state = wined3d_device_get_blend_state(device->wined3d_device,
-            (struct wined3d_color *)blend_factor, sample_mask)))
-    {
-        blend_state_impl = wined3d_blend_state_get_parent(wined3d_state);
-        ID3D11BlendState_AddRef(*blend_state = &blend_state_impl->ID3D11BlendState_iface);
-    }
-    else
-    {
-        *blend_state = NULL;
-    }
-    wined3d_mutex_unlock();
+    if (blend_state)
+        d3d11_deferred_state_get_objects(&state->blend_state, 1, 0, 1, blend_state);
+    if (blend_factor)
+        memcpy(blend_factor, state->blend_factor, sizeof(state->blend_factor));
+    if (sample_mask)
+        *sample_mask = state->sample_mask;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_OMGetDepthStencilState(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_OMGetDepthStencilState(ID3D11DeviceContext1 *iface,
         ID3D11DepthStencilState **depth_stencil_state, UINT *stencil_ref)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_state *state = &context->state;
 
-    TRACE("iface %p, depth_stencil_state %p, stencil_ref %p.\n",
-            iface, depth_stencil_state, stencil_ref);
+    TRACE("iface %p, depth_stencil_state %p, stencil_ref %p.\n", iface, depth_stencil_state, stencil_ref);
 
-    if ((*depth_stencil_state = device->depth_stencil_state
-            ? &device->depth_stencil_state->ID3D11DepthStencilState_iface : NULL))
-        ID3D11DepthStencilState_AddRef(*depth_stencil_state);
-    *stencil_ref = device->stencil_ref;
+    if (depth_stencil_state)
+        d3d11_deferred_state_get_objects(&state->depth_stencil_state, 1, 0, 1, depth_stencil_state);
+    if (stencil_ref)
+        *stencil_ref = state->stencil_ref;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_SOGetTargets(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_SOGetTargets(ID3D11DeviceContext1 *iface,
         UINT buffer_count, ID3D11Buffer **buffers)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_state *state = &context->state;
 
     TRACE("iface %p, buffer_count %u, buffers %p.\n", iface, buffer_count, buffers);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < buffer_count; ++i)
-    {
-        struct wined3d_buffer *wined3d_buffer;
-        struct d3d_buffer *buffer_impl;
-
-        if (!(wined3d_buffer = wined3d_device_get_stream_output(device->wined3d_device, i, NULL)))
-        {
-            buffers[i] = NULL;
-            continue;
-        }
-
-        buffer_impl = wined3d_buffer_get_parent(wined3d_buffer);
-        buffers[i] = &buffer_impl->ID3D11Buffer_iface;
-        ID3D11Buffer_AddRef(buffers[i]);
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_state_get_objects(state->so_targets, ARRAY_SIZE(state->so_targets), 0, buffer_count, buffers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_RSGetState(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_RSGetState(ID3D11DeviceContext1 *iface,
         ID3D11RasterizerState **rasterizer_state)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_rasterizer_state *rasterizer_state_impl;
-    struct wined3d_rasterizer_state *wined3d_state;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
     TRACE("iface %p, rasterizer_state %p.\n", iface, rasterizer_state);
 
-    wined3d_mutex_lock();
-    if ((wined3d_state = wined3d_device_get_rasterizer_state(device->wined3d_device)))
-    {
-        rasterizer_state_impl = wined3d_rasterizer_state_get_parent(wined3d_state);
-        ID3D11RasterizerState_AddRef(*rasterizer_state = &rasterizer_state_impl->ID3D11RasterizerState_iface);
-    }
-    else
-    {
-        *rasterizer_state = NULL;
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_state_get_objects(&context->state.rasterizer_state, 1, 0, 1, rasterizer_state);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_RSGetViewports(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_RSGetViewports(ID3D11DeviceContext1 *iface,
         UINT *viewport_count, D3D11_VIEWPORT *viewports)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_viewport wined3d_vp[WINED3D_MAX_VIEWPORTS];
-    unsigned int actual_count = ARRAY_SIZE(wined3d_vp), i;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_state *state = &context->state;
+    unsigned int count;
 
     TRACE("iface %p, viewport_count %p, viewports %p.\n", iface, viewport_count, viewports);
 
     if (!viewport_count)
         return;
 
-    wined3d_mutex_lock();
-    wined3d_device_get_viewports(device->wined3d_device, &actual_count, viewports ? wined3d_vp : NULL);
-    wined3d_mutex_unlock();
-
     if (!viewports)
     {
-        *viewport_count = actual_count;
+        *viewport_count = state->viewport_count;
         return;
     }
 
-    if (*viewport_count > actual_count)
-        memset(&viewports[actual_count], 0, (*viewport_count - actual_count) * sizeof(*viewports));
-
-    *viewport_count = min(actual_count, *viewport_count);
-    for (i = 0; i < *viewport_count; ++i)
-    {
-        viewports[i].TopLeftX = wined3d_vp[i].x;
-        viewports[i].TopLeftY = wined3d_vp[i].y;
-        viewports[i].Width = wined3d_vp[i].width;
-        viewports[i].Height = wined3d_vp[i].height;
-        viewports[i].MinDepth = wined3d_vp[i].min_z;
-        viewports[i].MaxDepth = wined3d_vp[i].max_z;
-    }
+    count = min(*viewport_count, state->viewport_count);
+    memcpy(viewports, state->viewports, count * sizeof(*viewports));
+    if (*viewport_count > count)
+        memset(&viewports[count], 0, (*viewport_count - count) * sizeof(*viewports));
+    *viewport_count = count;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_RSGetScissorRects(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_RSGetScissorRects(ID3D11DeviceContext1 *iface,
         UINT *rect_count, D3D11_RECT *rects)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int actual_count;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_state *state = &context->state;
+    unsigned int count;
 
     TRACE("iface %p, rect_count %p, rects %p.\n", iface, rect_count, rects);
 
     if (!rect_count)
         return;
 
-    actual_count = *rect_count;
-
-    wined3d_mutex_lock();
-    wined3d_device_get_scissor_rects(device->wined3d_device, &actual_count, rects);
-    wined3d_mutex_unlock();
-
     if (!rects)
     {
-        *rect_count = actual_count;
+        *rect_count = state->scissor_rect_count;
         return;
     }
 
-    if (*rect_count > actual_count)
-        memset(&rects[actual_count], 0, (*rect_count - actual_count) * sizeof(*rects));
+    count = min(*rect_count, state->scissor_rect_count);
+    memcpy(rects, state->scissor_rects, count * sizeof(*rects));
+    if (*rect_count > count)
+        memset(&rects[count], 0, (*rect_count - count) * sizeof(*rects));
+    *rect_count = count;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_HSGetShaderResources(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSGetShaderResources(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
-    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
-
-    wined3d_mutex_lock();
-    for (i = 0; i < view_count; ++i)
-    {
-        struct wined3d_shader_resource_view *wined3d_view;
-        struct d3d_shader_resource_view *view_impl;
-
-        if (!(wined3d_view = wined3d_device_get_hs_resource_view(device->wined3d_device, start_slot + i)))
-        {
-            views[i] = NULL;
-            continue;
-        }
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
+            iface, start_slot, view_count, views);
 
-        view_impl = wined3d_shader_resource_view_get_parent(wined3d_view);
-        ID3D11ShaderResourceView_AddRef(views[i] = &view_impl->ID3D11ShaderResourceView_iface);
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_get_slots(iface, DEFERRED_CALL_SET_SHADER_RESOURCES,
+            WINED3D_SHADER_TYPE_HULL, start_slot, view_count, views);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_HSGetShader(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSGetShader(ID3D11DeviceContext1 *iface,
         ID3D11HullShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d11_hull_shader *shader_impl;
-    struct wined3d_shader *wined3d_shader;
-
     TRACE("iface %p, shader %p, class_instances %p, class_instance_count %p.\n",
             iface, shader, class_instances, class_instance_count);
 
-    if (class_instances || class_instance_count)
-        FIXME("Dynamic linking not implemented yet.\n");
-    if (class_instance_count)
-        *class_instance_count = 0;
-
-    wined3d_mutex_lock();
-    if (!(wined3d_shader = wined3d_device_get_hull_shader(device->wined3d_device)))
-    {
-        wined3d_mutex_unlock();
-        *shader = NULL;
-        return;
-    }
-
-    shader_impl = wined3d_shader_get_parent(wined3d_shader);
-    wined3d_mutex_unlock();
-    ID3D11HullShader_AddRef(*shader = &shader_impl->ID3D11HullShader_iface);
+    d3d11_deferred_context_get_shader(iface, WINED3D_SHADER_TYPE_HULL,
+            shader, class_instances, class_instance_count);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_HSGetSamplers(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSGetSamplers(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
     TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
             iface, start_slot, sampler_count, samplers);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < sampler_count; ++i)
-    {
-        struct wined3d_sampler *wined3d_sampler;
-        struct d3d_sampler_state *sampler_impl;
-
-        if (!(wined3d_sampler = wined3d_device_get_hs_sampler(device->wined3d_device, start_slot + i)))
-        {
-            samplers[i] = NULL;
-            continue;
-        }
-
-        sampler_impl = wined3d_sampler_get_parent(wined3d_sampler);
-        ID3D11SamplerState_AddRef(samplers[i] = &sampler_impl->ID3D11SamplerState_iface);
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_get_slots(iface, DEFERRED_CALL_SET_SAMPLERS,
+            WINED3D_SHADER_TYPE_HULL, start_slot, sampler_count, samplers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_HSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSGetConstantBuffers(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
 {
     TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
             iface, start_slot, buffer_count, buffers);
 
-    d3d11_immediate_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_HULL, start_slot,
-            buffer_count, buffers);
+    d3d11_deferred_context_get_slots(iface, DEFERRED_CALL_SET_CONSTANT_BUFFERS,
+            WINED3D_SHADER_TYPE_HULL, start_slot, buffer_count, buffers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DSGetShaderResources(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSGetShaderResources(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
     TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
             iface, start_slot, view_count, views);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < view_count; ++i)
-    {
-        struct wined3d_shader_resource_view *wined3d_view;
-        struct d3d_shader_resource_view *view_impl;
-
-        if (!(wined3d_view = wined3d_device_get_ds_resource_view(device->wined3d_device, start_slot + i)))
-        {
-            views[i] = NULL;
-            continue;
-        }
-
-        view_impl = wined3d_shader_resource_view_get_parent(wined3d_view);
-        ID3D11ShaderResourceView_AddRef(views[i] = &view_impl->ID3D11ShaderResourceView_iface);
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_get_slots(iface, DEFERRED_CALL_SET_SHADER_RESOURCES,
+            WINED3D_SHADER_TYPE_DOMAIN, start_slot, view_count, views);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DSGetShader(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSGetShader(ID3D11DeviceContext1 *iface,
         ID3D11DomainShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
-{
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d11_domain_shader *shader_impl;
-    struct wined3d_shader *wined3d_shader;
-
+{
     TRACE("iface %p, shader %p, class_instances %p, class_instance_count %p.\n",
             iface, shader, class_instances, class_instance_count);
 
-    if (class_instances || class_instance_count)
-        FIXME("Dynamic linking not implemented yet.\n");
-    if (class_instance_count)
-        *class_instance_count = 0;
-
-    wined3d_mutex_lock();
-    if (!(wined3d_shader = wined3d_device_get_domain_shader(device->wined3d_device)))
-    {
-        wined3d_mutex_unlock();
-        *shader = NULL;
-        return;
-    }
-
-    shader_impl = wined3d_shader_get_parent(wined3d_shader);
-    wined3d_mutex_unlock();
-    ID3D11DomainShader_AddRef(*shader = &shader_impl->ID3D11DomainShader_iface);
+    d3d11_deferred_context_get_shader(iface, WINED3D_SHADER_TYPE_DOMAIN,
+            shader, class_instances, class_instance_count);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DSGetSamplers(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSGetSamplers(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
     TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
             iface, start_slot, sampler_count, samplers);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < sampler_count; ++i)
-    {
-        struct wined3d_sampler *wined3d_sampler;
-        struct d3d_sampler_state *sampler_impl;
-
-        if (!(wined3d_sampler = wined3d_device_get_ds_sampler(device->wined3d_device, start_slot + i)))
-        {
-            samplers[i] = NULL;
-            continue;
-        }
-
-        sampler_impl = wined3d_sampler_get_parent(wined3d_sampler);
-        ID3D11SamplerState_AddRef(samplers[i] = &sampler_impl->ID3D11SamplerState_iface);
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_get_slots(iface, DEFERRED_CALL_SET_SAMPLERS,
+            WINED3D_SHADER_TYPE_DOMAIN, start_slot, sampler_count, samplers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSGetConstantBuffers(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
 {
     TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
             iface, start_slot, buffer_count, buffers);
 
-    d3d11_immediate_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_DOMAIN, start_slot,
-            buffer_count, buffers);
+    d3d11_deferred_context_get_slots(iface, DEFERRED_CALL_SET_CONSTANT_BUFFERS,
+            WINED3D_SHADER_TYPE_DOMAIN, start_slot, buffer_count, buffers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CSGetShaderResources(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSGetShaderResources(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
-    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
-
-    wined3d_mutex_lock();
-    for (i = 0; i < view_count; ++i)
-    {
-        struct wined3d_shader_resource_view *wined3d_view;
-        struct d3d_shader_resource_view *view_impl;
-
-        if (!(wined3d_view = wined3d_device_get_cs_resource_view(device->wined3d_device, start_slot + i)))
-        {
-            views[i] = NULL;
-            continue;
-        }
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
+            iface, start_slot, view_count, views);
 
-        view_impl = wined3d_shader_resource_view_get_parent(wined3d_view);
-        ID3D11ShaderResourceView_AddRef(views[i] = &view_impl->ID3D11ShaderResourceView_iface);
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_get_slots(iface, DEFERRED_CALL_SET_SHADER_RESOURCES,
+            WINED3D_SHADER_TYPE_COMPUTE, start_slot, view_count, views);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CSGetUnorderedAccessViews(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSGetUnorderedAccessViews(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT view_count, ID3D11UnorderedAccessView **views)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
     TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < view_count; ++i)
-    {
-        struct wined3d_unordered_access_view *wined3d_view;
-        struct d3d11_unordered_access_view *view_impl;
-
-        if (!(wined3d_view = wined3d_device_get_cs_uav(device->wined3d_device, start_slot + i)))
-        {
-            views[i] = NULL;
-            continue;
-        }
-
-        view_impl = wined3d_unordered_access_view_get_parent(wined3d_view);
-        ID3D11UnorderedAccessView_AddRef(views[i] = &view_impl->ID3D11UnorderedAccessView_iface);
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_get_slots(iface, DEFERRED_CALL_SET_UNORDERED_ACCESS_VIEWS,
+            WINED3D_SHADER_TYPE_COMPUTE, start_slot, view_count, views);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CSGetShader(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSGetShader(ID3D11DeviceContext1 *iface,
         ID3D11ComputeShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d11_compute_shader *shader_impl;
-    struct wined3d_shader *wined3d_shader;
-
     TRACE("iface %p, shader %p, class_instances %p, class_instance_count %p.\n",
             iface, shader, class_instances, class_instance_count);
 
-    if (class_instances || class_instance_count)
-        FIXME("Dynamic linking not implemented yet.\n");
-    if (class_instance_count)
-        *class_instance_count = 0;
-
-    wined3d_mutex_lock();
-    if (!(wined3d_shader = wined3d_device_get_compute_shader(device->wined3d_device)))
-    {
-        wined3d_mutex_unlock();
-        *shader = NULL;
-        return;
-    }
-
-    shader_impl = wined3d_shader_get_parent(wined3d_shader);
-    wined3d_mutex_unlock();
-    ID3D11ComputeShader_AddRef(*shader = &shader_impl->ID3D11ComputeShader_iface);
+    d3d11_deferred_context_get_shader(iface, WINED3D_SHADER_TYPE_COMPUTE,
+            shader, class_instances, class_instance_count);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CSGetSamplers(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSGetSamplers(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
     TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
             iface, start_slot, sampler_count, samplers);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < sampler_count; ++i)
-    {
-        struct wined3d_sampler *wined3d_sampler;
-        struct d3d_sampler_state *sampler_impl;
-
-        if (!(wined3d_sampler = wined3d_device_get_cs_sampler(device->wined3d_device, start_slot + i)))
-        {
-            samplers[i] = NULL;
-            continue;
-        }
-
-        sampler_impl = wined3d_sampler_get_parent(wined3d_sampler);
-        ID3D11SamplerState_AddRef(samplers[i] = &sampler_impl->ID3D11SamplerState_iface);
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_get_slots(iface, DEFERRED_CALL_SET_SAMPLERS,
+            WINED3D_SHADER_TYPE_COMPUTE, start_slot, sampler_count, samplers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSGetConstantBuffers(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
 {
     TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
             iface, start_slot, buffer_count, buffers);
 
-    d3d11_immediate_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_COMPUTE, start_slot,
-            buffer_count, buffers);
+    d3d11_deferred_context_get_slots(iface, DEFERRED_CALL_SET_CONSTANT_BUFFERS,
+            WINED3D_SHADER_TYPE_COMPUTE, start_slot, buffer_count, buffers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_ClearState(ID3D11DeviceContext1 *iface)
+static void STDMETHODCALLTYPE d3d11_deferred_context_ClearState(ID3D11DeviceContext1 *iface)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    static const float blend_factor[] = {1.0f, 1.0f, 1.0f, 1.0f};
-    unsigned int i, j;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_call *call;
 
     TRACE("iface %p.\n", iface);
 
-    wined3d_mutex_lock();
-    wined3d_device_set_vertex_shader(device->wined3d_device, NULL);
-    wined3d_device_set_hull_shader(device->wined3d_device, NULL);
-    wined3d_device_set_domain_shader(device->wined3d_device, NULL);
-    wined3d_device_set_geometry_shader(device->wined3d_device, NULL);
-    wined3d_device_set_pixel_shader(device->wined3d_device, NULL);
-    wined3d_device_set_compute_shader(device->wined3d_device, NULL);
-    for (i = 0; i < D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT; ++i)
-    {
-        wined3d_device_set_vs_sampler(device->wined3d_device, i, NULL);
-        wined3d_device_set_hs_sampler(device->wined3d_device, i, NULL);
-        wined3d_device_set_ds_sampler(device->wined3d_device, i, NULL);
-        wined3d_device_set_gs_sampler(device->wined3d_device, i, NULL);
-        wined3d_device_set_ps_sampler(device->wined3d_device, i, NULL);
-        wined3d_device_set_cs_sampler(device->wined3d_device, i, NULL);
-    }
-    for (i = 0; i < D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT; ++i)
-    {
-        wined3d_device_set_vs_resource_view(device->wined3d_device, i, NULL);
-        wined3d_device_set_hs_resource_view(device->wined3d_device, i, NULL);
-        wined3d_device_set_ds_resource_view(device->wined3d_device, i, NULL);
-        wined3d_device_set_gs_resource_view(device->wined3d_device, i, NULL);
-        wined3d_device_set_ps_resource_view(device->wined3d_device, i, NULL);
-        wined3d_device_set_cs_resource_view(device->wined3d_device, i, NULL);
-    }
-    for (i = 0; i < WINED3D_SHADER_TYPE_COUNT; ++i)
-    {
-        for (j = 0; j < D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT; ++j)
-            wined3d_device_set_constant_buffer(device->wined3d_device, i, j, NULL);
-    }
-    for (i = 0; i < D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT; ++i)
-    {
-        wined3d_device_set_stream_source(device->wined3d_device, i, NULL, 0, 0);
-    }
-    wined3d_device_set_index_buffer(device->wined3d_device, NULL, WINED3DFMT_UNKNOWN, 0);
-    wined3d_device_set_vertex_declaration(device->wined3d_device, NULL);
-    wined3d_device_set_primitive_type(device->wined3d_device, WINED3D_PT_UNDEFINED, 0);
-    for (i = 0; i < D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT; ++i)
-    {
-        wined3d_device_set_rendertarget_view(device->wined3d_device, i, NULL, FALSE);
-    }
-    wined3d_device_set_depth_stencil_view(device->wined3d_device, NULL);
-    for (i = 0; i < D3D11_PS_CS_UAV_REGISTER_COUNT; ++i)
-    {
-        wined3d_device_set_unordered_access_view(device->wined3d_device, i, NULL, ~0u);
-        wined3d_device_set_cs_uav(device->wined3d_device, i, NULL, ~0u);
-    }
-    ID3D11DeviceContext1_OMSetDepthStencilState(iface, NULL, 0);
-    ID3D11DeviceContext1_OMSetBlendState(iface, NULL, blend_factor, D3D11_DEFAULT_SAMPLE_MASK);
-    ID3D11DeviceContext1_RSSetViewports(iface, 0, NULL);
-    ID3D11DeviceContext1_RSSetScissorRects(iface, 0, NULL);
-    ID3D11DeviceContext1_RSSetState(iface, NULL);
-    for (i = 0; i < D3D11_SO_BUFFER_SLOT_COUNT; ++i)
-    {
-        wined3d_device_set_stream_output(device->wined3d_device, i, NULL, 0);
-    }
-    wined3d_device_set_predication(device->wined3d_device, NULL, FALSE);
-    wined3d_mutex_unlock();
+    if ((call = d3d11_command_buffer_add_call(&context->buffer, DEFERRED_CALL_CLEAR_STATE, 0, 0)))
+        d3d11_deferred_state_update(&context->state, call);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_Flush(ID3D11DeviceContext1 *iface)
+static void STDMETHODCALLTYPE d3d11_deferred_context_Flush(ID3D11DeviceContext1 *iface)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-
-    TRACE("iface %p.\n", iface);
-
-    wined3d_mutex_lock();
-    wined3d_device_flush(device->wined3d_device);
-    wined3d_mutex_unlock();
+    WARN("iface %p, flushing a deferred context has no effect.\n", iface);
 }
 
-static D3D11_DEVICE_CONTEXT_TYPE STDMETHODCALLTYPE d3d11_immediate_context_GetType(ID3D11DeviceContext1 *iface)
+static D3D11_DEVICE_CONTEXT_TYPE STDMETHODCALLTYPE d3d11_deferred_context_GetType(ID3D11DeviceContext1 *iface)
 {
     TRACE("iface %p.\n", iface);
 
-    return D3D11_DEVICE_CONTEXT_IMMEDIATE;
+    return D3D11_DEVICE_CONTEXT_DEFERRED;
 }
 
-static UINT STDMETHODCALLTYPE d3d11_immediate_context_GetContextFlags(ID3D11DeviceContext1 *iface)
+static UINT STDMETHODCALLTYPE d3d11_deferred_context_GetContextFlags(ID3D11DeviceContext1 *iface)
 {
     TRACE("iface %p.\n", iface);
 
     return 0;
 }
 
-static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_FinishCommandList(ID3D11DeviceContext1 *iface,
+static HRESULT STDMETHODCALLTYPE d3d11_deferred_context_FinishCommandList(ID3D11DeviceContext1 *iface,
         BOOL restore, ID3D11CommandList **command_list)
 {
-    TRACE("iface %p, restore %#x, command_list %p.\n", iface, restore, command_list);
-
-    return DXGI_ERROR_INVALID_CALL;
-}
-
-static void STDMETHODCALLTYPE d3d11_immediate_context_CopySubresourceRegion1(ID3D11DeviceContext1 *iface,
-        ID3D11Resource *dst_resource, UINT dst_subresource_idx, UINT dst_x, UINT dst_y, UINT dst_z,
-        ID3D11Resource *src_resource, UINT src_subresource_idx, const D3D11_BOX *src_box, UINT flags)
-{
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_resource *wined3d_dst_resource, *wined3d_src_resource;
-    struct wined3d_box wined3d_src_box;
-
-    TRACE("iface %p, dst_resource %p, dst_subresource_idx %u, dst_x %u, dst_y %u, dst_z %u, "
-            "src_resource %p, src_subresource_idx %u, src_box %p, flags %#x.\n",
-            iface, dst_resource, dst_subresource_idx, dst_x, dst_y, dst_z,
-            src_resource, src_subresource_idx, src_box, flags);
-
-    if (src_box)
-        wined3d_box_set(&wined3d_src_box, src_box->left, src_box->top,
-                src_box->right, src_box->bottom, src_box->front, src_box->back);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_command_list *object;
+    HRESULT hr;
 
-    wined3d_dst_resource = wined3d_resource_from_d3d11_resource(dst_resource);
-    wined3d_src_resource = wined3d_resource_from_d3d11_resource(src_resource);
-    wined3d_mutex_lock();
-    wined3d_device_copy_sub_resource_region(device->wined3d_device, wined3d_dst_resource, dst_subresource_idx,
-            dst_x, dst_y, dst_z, wined3d_src_resource, src_subresource_idx, src_box ? &wined3d_src_box : NULL, flags);
-    wined3d_mutex_unlock();
-}
+    TRACE("iface %p, restore %#x, command_list %p.\n", iface, restore, command_list);
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_UpdateSubresource1(ID3D11DeviceContext1 *iface,
-        ID3D11Resource *resource, UINT subresource_idx, const D3D11_BOX *box, const void *data,
-        UINT row_pitch, UINT depth_pitch, UINT flags)
-{
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_resource *wined3d_resource;
-    struct wined3d_box wined3d_box;
+    if (FAILED(hr = d3d11_command_list_create(context->device, &context->buffer, &object)))
+    {
+        *command_list = NULL;
+        return hr;
+    }
 
-    TRACE("iface %p, resource %p, subresource_idx %u, box %p, data %p, row_pitch %u, depth_pitch %u, flags %#x.\n",
-            iface, resource, subresource_idx, box, data, row_pitch, depth_pitch, flags);
+    /* Recording continues with the state the command list ended with, or
+     * with the default state. */
+    if (restore)
+        d3d11_command_buffer_copy_state(&context->buffer, &object->buffer);
+    else
+        d3d11_deferred_state_reset(&context->state);
+    d3d11_deferred_context_clear_maps(context);
 
-    if (box)
-        wined3d_box_set(&wined3d_box, box->left, box->top, box->right, box->bottom,
-                box->front, box->back);
+    *command_list = &object->ID3D11CommandList_iface;
 
-    wined3d_resource = wined3d_resource_from_d3d11_resource(resource);
-    wined3d_mutex_lock();
-    wined3d_device_update_sub_resource(device->wined3d_device, wined3d_resource, subresource_idx,
-            box ? &wined3d_box : NULL, data, row_pitch, depth_pitch, flags);
-    wined3d_mutex_unlock();
+    return S_OK;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DiscardResource(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_DiscardResource(ID3D11DeviceContext1 *iface,
         ID3D11Resource *resource)
 {
     FIXME("iface %p, resource %p stub!\n", iface, resource);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DiscardView(ID3D11DeviceContext1 *iface, ID3D11View *view)
+static void STDMETHODCALLTYPE d3d11_deferred_context_DiscardView(ID3D11DeviceContext1 *iface, ID3D11View *view)
 {
     FIXME("iface %p, view %p stub!\n", iface, view);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_VSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
         const UINT *num_constants)
 {
@@ -2491,7 +6067,7 @@ static void STDMETHODCALLTYPE d3d11_immediate_context_VSSetConstantBuffers1(ID3D
             iface, start_slot, buffer_count, buffers, first_constant, num_constants);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_HSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
         const UINT *num_constants)
 {
@@ -2499,7 +6075,7 @@ static void STDMETHODCALLTYPE d3d11_immediate_context_HSSetConstantBuffers1(ID3D
             iface, start_slot, buffer_count, buffers, first_constant, num_constants);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
         const UINT *num_constants)
 {
@@ -2507,7 +6083,7 @@ static void STDMETHODCALLTYPE d3d11_immediate_context_DSSetConstantBuffers1(ID3D
             iface, start_slot, buffer_count, buffers, first_constant, num_constants);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_GSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
         const UINT *num_constants)
 {
@@ -2515,7 +6091,7 @@ static void STDMETHODCALLTYPE d3d11_immediate_context_GSSetConstantBuffers1(ID3D
             iface, start_slot, buffer_count, buffers, first_constant, num_constants);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_PSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
         const UINT *num_constants)
 {
@@ -2523,7 +6099,7 @@ static void STDMETHODCALLTYPE d3d11_immediate_context_PSSetConstantBuffers1(ID3D
             iface, start_slot, buffer_count, buffers, first_constant, num_constants);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
         const UINT *num_constants)
 {
@@ -2531,297 +6107,230 @@ static void STDMETHODCALLTYPE d3d11_immediate_context_CSSetConstantBuffers1(ID3D
             iface, start_slot, buffer_count, buffers, first_constant, num_constants);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_VSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
 {
     FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
             iface, start_slot, buffer_count, buffers, first_constant, num_constants);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_HSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
 {
     FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
             iface, start_slot, buffer_count, buffers, first_constant, num_constants);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
 {
     FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
             iface, start_slot, buffer_count, buffers, first_constant, num_constants);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_GSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
 {
     FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
             iface, start_slot, buffer_count, buffers, first_constant, num_constants);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_PSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
 {
     FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
             iface, start_slot, buffer_count, buffers, first_constant, num_constants);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
 {
     FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
             iface, start_slot, buffer_count, buffers, first_constant, num_constants);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_SwapDeviceContextState(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_SwapDeviceContextState(ID3D11DeviceContext1 *iface,
         ID3DDeviceContextState *state, ID3DDeviceContextState **prev_state)
 {
     FIXME("iface %p, state %p, prev_state %p stub!\n", iface, state, prev_state);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_ClearView(ID3D11DeviceContext1 *iface, ID3D11View *view,
+static void STDMETHODCALLTYPE d3d11_deferred_context_ClearView(ID3D11DeviceContext1 *iface, ID3D11View *view,
         const FLOAT color[4], const D3D11_RECT *rect, UINT num_rects)
 {
     FIXME("iface %p, view %p, color %p, rect %p, num_rects %u stub!\n", iface, view, color, rect, num_rects);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DiscardView1(ID3D11DeviceContext1 *iface, ID3D11View *view,
+static void STDMETHODCALLTYPE d3d11_deferred_context_DiscardView1(ID3D11DeviceContext1 *iface, ID3D11View *view,
         const D3D11_RECT *rects, UINT num_rects)
 {
     FIXME("iface %p, view %p, rects %p, num_rects %u stub!\n", iface, view, rects, num_rects);
 }
 
-static const struct ID3D11DeviceContext1Vtbl d3d11_immediate_context_vtbl =
+static const struct ID3D11DeviceContext1Vtbl d3d11_deferred_context_vtbl =
 {
     /* IUnknown methods */
-    d3d11_immediate_context_QueryInterface,
-    d3d11_immediate_context_AddRef,
-    d3d11_immediate_context_Release,
+    d3d11_deferred_context_QueryInterface,
+    d3d11_deferred_context_AddRef,
+    d3d11_deferred_context_Release,
     /* ID3D11DeviceChild methods */
-    d3d11_immediate_context_GetDevice,
-    d3d11_immediate_context_GetPrivateData,
-    d3d11_immediate_context_SetPrivateData,
-    d3d11_immediate_context_SetPrivateDataInterface,
+    d3d11_deferred_context_GetDevice,
+    d3d11_deferred_context_GetPrivateData,
+    d3d11_deferred_context_SetPrivateData,
+    d3d11_deferred_context_SetPrivateDataInterface,
     /* ID3D11DeviceContext methods */
-    d3d11_immediate_context_VSSetConstantBuffers,
-    d3d11_immediate_context_PSSetShaderResources,
-    d3d11_immediate_context_PSSetShader,
-    d3d11_immediate_context_PSSetSamplers,
-    d3d11_immediate_context_VSSetShader,
-    d3d11_immediate_context_DrawIndexed,
-    d3d11_immediate_context_Draw,
-    d3d11_immediate_context_Map,
-    d3d11_immediate_context_Unmap,
-    d3d11_immediate_context_PSSetConstantBuffers,
-    d3d11_immediate_context_IASetInputLayout,
-    d3d11_immediate_context_IASetVertexBuffers,
-    d3d11_immediate_context_IASetIndexBuffer,
-    d3d11_immediate_context_DrawIndexedInstanced,
-    d3d11_immediate_context_DrawInstanced,
-    d3d11_immediate_context_GSSetConstantBuffers,
-    d3d11_immediate_context_GSSetShader,
-    d3d11_immediate_context_IASetPrimitiveTopology,
-    d3d11_immediate_context_VSSetShaderResources,
-    d3d11_immediate_context_VSSetSamplers,
-    d3d11_immediate_context_Begin,
-    d3d11_immediate_context_End,
-    d3d11_immediate_context_GetData,
-    d3d11_immediate_context_SetPredication,
-    d3d11_immediate_context_GSSetShaderResources,
-    d3d11_immediate_context_GSSetSamplers,
-    d3d11_immediate_context_OMSetRenderTargets,
-    d3d11_immediate_context_OMSetRenderTargetsAndUnorderedAccessViews,
-    d3d11_immediate_context_OMSetBlendState,
-    d3d11_immediate_context_OMSetDepthStencilState,
-    d3d11_immediate_context_SOSetTargets,
-    d3d11_immediate_context_DrawAuto,
-    d3d11_immediate_context_DrawIndexedInstancedIndirect,
-    d3d11_immediate_context_DrawInstancedIndirect,
-    d3d11_immediate_context_Dispatch,
-    d3d11_immediate_context_DispatchIndirect,
-    d3d11_immediate_context_RSSetState,
-    d3d11_immediate_context_RSSetViewports,
-    d3d11_immediate_context_RSSetScissorRects,
-    d3d11_immediate_context_CopySubresourceRegion,
-    d3d11_immediate_context_CopyResource,
-    d3d11_immediate_context_UpdateSubresource,
-    d3d11_immediate_context_CopyStructureCount,
-    d3d11_immediate_context_ClearRenderTargetView,
-    d3d11_immediate_context_ClearUnorderedAccessViewUint,
-    d3d11_immediate_context_ClearUnorderedAccessViewFloat,
-    d3d11_immediate_context_ClearDepthStencilView,
-    d3d11_immediate_context_GenerateMips,
-    d3d11_immediate_context_SetResourceMinLOD,
-    d3d11_immediate_context_GetResourceMinLOD,
-    d3d11_immediate_context_ResolveSubresource,
-    d3d11_immediate_context_ExecuteCommandList,
-    d3d11_immediate_context_HSSetShaderResources,
-    d3d11_immediate_context_HSSetShader,
-    d3d11_immediate_context_HSSetSamplers,
-    d3d11_immediate_context_HSSetConstantBuffers,
-    d3d11_immediate_context_DSSetShaderResources,
-    d3d11_immediate_context_DSSetShader,
-    d3d11_immediate_context_DSSetSamplers,
-    d3d11_immediate_context_DSSetConstantBuffers,
-    d3d11_immediate_context_CSSetShaderResources,
-    d3d11_immediate_context_CSSetUnorderedAccessViews,
-    d3d11_immediate_context_CSSetShader,
-    d3d11_immediate_context_CSSetSamplers,
-    d3d11_immediate_context_CSSetConstantBuffers,
-    d3d11_immediate_context_VSGetConstantBuffers,
-    d3d11_immediate_context_PSGetShaderResources,
-    d3d11_immediate_context_PSGetShader,
-    d3d11_immediate_context_PSGetSamplers,
-    d3d11_immediate_context_VSGetShader,
-    d3d11_immediate_context_PSGetConstantBuffers,
-    d3d11_immediate_context_IAGetInputLayout,
-    d3d11_immediate_context_IAGetVertexBuffers,
-    d3d11_immediate_context_IAGetIndexBuffer,
-    d3d11_immediate_context_GSGetConstantBuffers,
-    d3d11_immediate_context_GSGetShader,
-    d3d11_immediate_context_IAGetPrimitiveTopology,
-    d3d11_immediate_context_VSGetShaderResources,
-    d3d11_immediate_context_VSGetSamplers,
-    d3d11_immediate_context_GetPredication,
-    d3d11_immediate_context_GSGetShaderResources,
-    d3d11_immediate_context_GSGetSamplers,
-    d3d11_immediate_context_OMGetRenderTargets,
-    d3d11_immediate_context_OMGetRenderTargetsAndUnorderedAccessViews,
-    d3d11_immediate_context_OMGetBlendState,
-    d3d11_immediate_context_OMGetDepthStencilState,
-    d3d11_immediate_context_SOGetTargets,
-    d3d11_immediate_context_RSGetState,
-    d3d11_immediate_context_RSGetViewports,
-    d3d11_immediate_context_RSGetScissorRects,
-    d3d11_immediate_context_HSGetShaderResources,
-    d3d11_immediate_context_HSGetShader,
-    d3d11_immediate_context_HSGetSamplers,
-    d3d11_immediate_context_HSGetConstantBuffers,
-    d3d11_immediate_context_DSGetShaderResources,
-    d3d11_immediate_context_DSGetShader,
-    d3d11_immediate_context_DSGetSamplers,
-    d3d11_immediate_context_DSGetConstantBuffers,
-    d3d11_immediate_context_CSGetShaderResources,
-    d3d11_immediate_context_CSGetUnorderedAccessViews,
-    d3d11_immediate_context_CSGetShader,
-    d3d11_immediate_context_CSGetSamplers,
-    d3d11_immediate_context_CSGetConstantBuffers,
-    d3d11_immediate_context_ClearState,
-    d3d11_immediate_context_Flush,
-    d3d11_immediate_context_GetType,
-    d3d11_immediate_context_GetContextFlags,
-    d3d11_immediate_context_FinishCommandList,
+    d3d11_deferred_context_VSSetConstantBuffers,
+    d3d11_deferred_context_PSSetShaderResources,
+    d3d11_deferred_context_PSSetShader,
+    d3d11_deferred_context_PSSetSamplers,
+    d3d11_deferred_context_VSSetShader,
+    d3d11_deferred_context_DrawIndexed,
+    d3d11_deferred_context_Draw,
+    d3d11_deferred_context_Map,
+    d3d11_deferred_context_Unmap,
+    d3d11_deferred_context_PSSetConstantBuffers,
+    d3d11_deferred_context_IASetInputLayout,
+    d3d11_deferred_context_IASetVertexBuffers,
+    d3d11_deferred_context_IASetIndexBuffer,
+    d3d11_deferred_context_DrawIndexedInstanced,
+    d3d11_deferred_context_DrawInstanced,
+    d3d11_deferred_context_GSSetConstantBuffers,
+    d3d11_deferred_context_GSSetShader,
+    d3d11_deferred_context_IASetPrimitiveTopology,
+    d3d11_deferred_context_VSSetShaderResources,
+    d3d11_deferred_context_VSSetSamplers,
+    d3d11_deferred_context_Begin,
+    d3d11_deferred_context_End,
+    d3d11_deferred_context_GetData,
+    d3d11_deferred_context_SetPredication,
+    d3d11_deferred_context_GSSetShaderResources,
+    d3d11_deferred_context_GSSetSamplers,
+    d3d11_deferred_context_OMSetRenderTargets,
+    d3d11_deferred_context_OMSetRenderTargetsAndUnorderedAccessViews,
+    d3d11_deferred_context_OMSetBlendState,
+    d3d11_deferred_context_OMSetDepthStencilState,
+    d3d11_deferred_context_SOSetTargets,
+    d3d11_deferred_context_DrawAuto,
+    d3d11_deferred_context_DrawIndexedInstancedIndirect,
+    d3d11_deferred_context_DrawInstancedIndirect,
+    d3d11_deferred_context_Dispatch,
+    d3d11_deferred_context_DispatchIndirect,
+    d3d11_deferred_context_RSSetState,
+    d3d11_deferred_context_RSSetViewports,
+    d3d11_deferred_context_RSSetScissorRects,
+    d3d11_deferred_context_CopySubresourceRegion,
+    d3d11_deferred_context_CopyResource,
+    d3d11_deferred_context_UpdateSubresource,
+    d3d11_deferred_context_CopyStructureCount,
+    d3d11_deferred_context_ClearRenderTargetView,
+    d3d11_deferred_context_ClearUnorderedAccessViewUint,
+    d3d11_deferred_context_ClearUnorderedAccessViewFloat,
+    d3d11_deferred_context_ClearDepthStencilView,
+    d3d11_deferred_context_GenerateMips,
+    d3d11_deferred_context_SetResourceMinLOD,
+    d3d11_deferred_context_GetResourceMinLOD,
+    d3d11_deferred_context_ResolveSubresource,
+    d3d11_deferred_context_ExecuteCommandList,
+    d3d11_deferred_context_HSSetShaderResources,
+    d3d11_deferred_context_HSSetShader,
+    d3d11_deferred_context_HSSetSamplers,
+    d3d11_deferred_context_HSSetConstantBuffers,
+    d3d11_deferred_context_DSSetShaderResources,
+    d3d11_deferred_context_DSSetShader,
+    d3d11_deferred_context_DSSetSamplers,
+    d3d11_deferred_context_DSSetConstantBuffers,
+    d3d11_deferred_context_CSSetShaderResources,
+    d3d11_deferred_context_CSSetUnorderedAccessViews,
+    d3d11_deferred_context_CSSetShader,
+    d3d11_deferred_context_CSSetSamplers,
+    d3d11_deferred_context_CSSetConstantBuffers,
+    d3d11_deferred_context_VSGetConstantBuffers,
+    d3d11_deferred_context_PSGetShaderResources,
+    d3d11_deferred_context_PSGetShader,
+    d3d11_deferred_context_PSGetSamplers,
+    d3d11_deferred_context_VSGetShader,
+    d3d11_deferred_context_PSGetConstantBuffers,
+    d3d11_deferred_context_IAGetInputLayout,
+    d3d11_deferred_context_IAGetVertexBuffers,
+    d3d11_deferred_context_IAGetIndexBuffer,
+    d3d11_deferred_context_GSGetConstantBuffers,
+    d3d11_deferred_context_GSGetShader,
+    d3d11_deferred_context_IAGetPrimitiveTopology,
+    d3d11_deferred_context_VSGetShaderResources,
+    d3d11_deferred_context_VSGetSamplers,
+    d3d11_deferred_context_GetPredication,
+    d3d11_deferred_context_GSGetShaderResources,
+    d3d11_deferred_context_GSGetSamplers,
+    d3d11_deferred_context_OMGetRenderTargets,
+    d3d11_deferred_context_OMGetRenderTargetsAndUnorderedAccessViews,
+    d3d11_deferred_context_OMGetBlendState,
+    d3d11_deferred_context_OMGetDepthStencilState,
+    d3d11_deferred_context_SOGetTargets,
+    d3d11_deferred_context_RSGetState,
+    d3d11_deferred_context_RSGetViewports,
+    d3d11_deferred_context_RSGetScissorRects,
+    d3d11_deferred_context_HSGetShaderResources,
+    d3d11_deferred_context_HSGetShader,
+    d3d11_deferred_context_HSGetSamplers,
+    d3d11_deferred_context_HSGetConstantBuffers,
+    d3d11_deferred_context_DSGetShaderResources,
+    d3d11_deferred_context_DSGetShader,
+    d3d11_deferred_context_DSGetSamplers,
+    d3d11_deferred_context_DSGetConstantBuffers,
+    d3d11_deferred_context_CSGetShaderResources,
+    d3d11_deferred_context_CSGetUnorderedAccessViews,
+    d3d11_deferred_context_CSGetShader,
+    d3d11_deferred_context_CSGetSamplers,
+    d3d11_deferred_context_CSGetConstantBuffers,
+    d3d11_deferred_context_ClearState,
+    d3d11_deferred_context_Flush,
+    d3d11_deferred_context_GetType,
+    d3d11_deferred_context_GetContextFlags,
+    d3d11_deferred_context_FinishCommandList,
     /* ID3D11DeviceContext1 methods */
-    d3d11_immediate_context_CopySubresourceRegion1,
-    d3d11_immediate_context_UpdateSubresource1,
-    d3d11_immediate_context_DiscardResource,
-    d3d11_immediate_context_DiscardView,
-    d3d11_immediate_context_VSSetConstantBuffers1,
-    d3d11_immediate_context_HSSetConstantBuffers1,
-    d3d11_immediate_context_DSSetConstantBuffers1,
-    d3d11_immediate_context_GSSetConstantBuffers1,
-    d3d11_immediate_context_PSSetConstantBuffers1,
-    d3d11_immediate_context_CSSetConstantBuffers1,
-    d3d11_immediate_context_VSGetConstantBuffers1,
-    d3d11_immediate_context_HSGetConstantBuffers1,
-    d3d11_immediate_context_DSGetConstantBuffers1,
-    d3d11_immediate_context_GSGetConstantBuffers1,
-    d3d11_immediate_context_PSGetConstantBuffers1,
-    d3d11_immediate_context_CSGetConstantBuffers1,
-    d3d11_immediate_context_SwapDeviceContextState,
-    d3d11_immediate_context_ClearView,
-    d3d11_immediate_context_DiscardView1,
+    d3d11_deferred_context_CopySubresourceRegion1,
+    d3d11_deferred_context_UpdateSubresource1,
+    d3d11_deferred_context_DiscardResource,
+    d3d11_deferred_context_DiscardView,
+    d3d11_deferred_context_VSSetConstantBuffers1,
+    d3d11_deferred_context_HSSetConstantBuffers1,
+    d3d11_deferred_context_DSSetConstantBuffers1,
+    d3d11_deferred_context_GSSetConstantBuffers1,
+    d3d11_deferred_context_PSSetConstantBuffers1,
+    d3d11_deferred_context_CSSetConstantBuffers1,
+    d3d11_deferred_context_VSGetConstantBuffers1,
+    d3d11_deferred_context_HSGetConstantBuffers1,
+    d3d11_deferred_context_DSGetConstantBuffers1,
+    d3d11_deferred_context_GSGetConstantBuffers1,
+    d3d11_deferred_context_PSGetConstantBuffers1,
+    d3d11_deferred_context_CSGetConstantBuffers1,
+    d3d11_deferred_context_SwapDeviceContextState,
+    d3d11_deferred_context_ClearView,
+    d3d11_deferred_context_DiscardView1,
 };
 
-/* ID3D11Multithread methods */
-
-static inline struct d3d11_immediate_context *impl_from_ID3D11Multithread(ID3D11Multithread *iface)
-{
-    return CONTAINING_RECORD(iface, struct d3d11_immediate_context, ID3D11Multithread_iface);
-}
-
-static HRESULT STDMETHODCALLTYPE d3d11_multithread_QueryInterface(ID3D11Multithread *iface,
-        REFIID iid, void **out)
-{
-    struct d3d11_immediate_context *context = impl_from_ID3D11Multithread(iface);
-
-    TRACE("iface %p, iid %s, out %p.\n", iface, debugstr_guid(iid), out);
-
-    return d3d11_immediate_context_QueryInterface(&context->ID3D11DeviceContext1_iface, iid, out);
-}
-
-static ULONG STDMETHODCALLTYPE d3d11_multithread_AddRef(ID3D11Multithread *iface)
-{
-    struct d3d11_immediate_context *context = impl_from_ID3D11Multithread(iface);
-
-    TRACE("iface %p.\n", iface);
-
-    return d3d11_immediate_context_AddRef(&context->ID3D11DeviceContext1_iface);
-}
-
-static ULONG STDMETHODCALLTYPE d3d11_multithread_Release(ID3D11Multithread *iface)
-{
-    struct d3d11_immediate_context *context = impl_from_ID3D11Multithread(iface);
-
-    TRACE("iface %p.\n", iface);
-
-    return d3d11_immediate_context_Release(&context->ID3D11DeviceContext1_iface);
-}
-
-static void STDMETHODCALLTYPE d3d11_multithread_Enter(ID3D11Multithread *iface)
-{
-    TRACE("iface %p.\n", iface);
-
-    wined3d_mutex_lock();
-}
-
-static void STDMETHODCALLTYPE d3d11_multithread_Leave(ID3D11Multithread *iface)
-{
-    TRACE("iface %p.\n", iface);
-
-    wined3d_mutex_unlock();
-}
-
-static BOOL STDMETHODCALLTYPE d3d11_multithread_SetMultithreadProtected(
-        ID3D11Multithread *iface, BOOL enable)
-{
-    FIXME("iface %p, enable %#x stub!\n", iface, enable);
-
-    return TRUE;
-}
-
-static BOOL STDMETHODCALLTYPE d3d11_multithread_GetMultithreadProtected(ID3D11Multithread *iface)
+static HRESULT d3d11_deferred_context_create(struct d3d_device *device, UINT flags,
+        struct d3d11_deferred_context **context)
 {
-    FIXME("iface %p stub!\n", iface);
+    struct d3d11_deferred_context *object;
 
-    return TRUE;
-}
-
-static const struct ID3D11MultithreadVtbl d3d11_multithread_vtbl =
-{
-    d3d11_multithread_QueryInterface,
-    d3d11_multithread_AddRef,
-    d3d11_multithread_Release,
-    d3d11_multithread_Enter,
-    d3d11_multithread_Leave,
-    d3d11_multithread_SetMultithreadProtected,
-    d3d11_multithread_GetMultithreadProtected,
-};
+    if (flags)
+        FIXME("Ignoring flags %#x.\n", flags);
 
-static void d3d11_immediate_context_init(struct d3d11_immediate_context *context, struct d3d_device *device)
-{
-    context->ID3D11DeviceContext1_iface.lpVtbl = &d3d11_immediate_context_vtbl;
-    context->ID3D11Multithread_iface.lpVtbl = &d3d11_multithread_vtbl;
-    context->refcount = 1;
+    if (!(object = heap_alloc_zero(sizeof(*object))))
+        return E_OUTOFMEMORY;
 
-    ID3D11Device2_AddRef(&device->ID3D11Device2_iface);
+    object->ID3D11DeviceContext1_iface.lpVtbl = &d3d11_deferred_context_vtbl;
+    object->refcount = 1;
+    wined3d_private_store_init(&object->private_store);
+    d3d11_deferred_state_reset(&object->state);
+    list_init(&object->maps);
+    ID3D11Device2_AddRef(object->device = &device->ID3D11Device2_iface);
 
-    wined3d_private_store_init(&context->private_store);
-}
+    TRACE("Created deferred context %p.\n", object);
+    *context = object;
 
-static void d3d11_immediate_context_destroy(struct d3d11_immediate_context *context)
-{
-    wined3d_private_store_cleanup(&context->private_store);
+    return S_OK;
 }
 
 /* ID3D11Device methods */
@@ -3303,10 +6812,21 @@ static HRESULT STDMETHODCALLTYPE d3d11_device_CreateCounter(ID3D11Device2 *iface
 static HRESULT STDMETHODCALLTYPE d3d11_device_CreateDeferredContext(ID3D11Device2 *iface, UINT flags,
         ID3D11DeviceContext **context)
 {
-    FIXME("iface %p, flags %#x, context %p stub!\n", iface, flags, context);
+    struct d3d_device *device = impl_from_ID3D11Device2(iface);
+    struct d3d11_deferred_context *object;
+    HRESULT hr;
 
-    *context = NULL;
-    return E_NOTIMPL;
+    TRACE("iface %p, flags %#x, context %p.\n", iface, flags, context);
+
+    if (FAILED(hr = d3d11_deferred_context_create(device, flags, &object)))
+    {
+        *context = NULL;
+        return hr;
+    }
+
+    *context = (ID3D11DeviceContext *)&object->ID3D11DeviceContext1_iface;
+
+    return S_OK;
 }
 
 static HRESULT STDMETHODCALLTYPE d3d11_device_OpenSharedResource(ID3D11Device2 *iface, HANDLE resource, REFIID iid,
@@ -3720,9 +7240,21 @@ static void STDMETHODCALLTYPE d3d11_device_GetImmediateContext1(ID3D11Device2 *i
 static HRESULT STDMETHODCALLTYPE d3d11_device_CreateDeferredContext1(ID3D11Device2 *iface, UINT flags,
         ID3D11DeviceContext1 **context)
 {
-    FIXME("iface %p, flags %#x, context %p stub!\n", iface, flags, context);
+    struct d3d_device *device = impl_from_ID3D11Device2(iface);
+    struct d3d11_deferred_context *object;
+    HRESULT hr;
 
-    return E_NOTIMPL;
+    TRACE("iface %p, flags %#x, context %p.\n", iface, flags, context);
+
+    if (FAILED(hr = d3d11_deferred_context_create(device, flags, &object)))
+    {
+        *context = NULL;
+        return hr;
+    }
+
+    *context = &object->ID3D11DeviceContext1_iface;
+
+    return S_OK;
 }
 
 static HRESULT STDMETHODCALLTYPE d3d11_device_CreateBlendState1(ID3D11Device2 *iface,
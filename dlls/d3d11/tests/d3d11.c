@@ -2259,6 +2259,8 @@ static void test_create_deferred_context(void)
 
     hr = ID3D11Device_CreateDeferredContext(device, 0, &context);
     todo_wine ok(hr == DXGI_ERROR_INVALID_CALL, "Failed to create deferred context, hr %#x.\n", hr);
+    if (SUCCEEDED(hr))
+        ID3D11DeviceContext_Release(context);
 
     refcount = ID3D11Device_Release(device);
     ok(!refcount, "Device has %u references left.\n", refcount);
@@ -2271,7 +2273,7 @@ static void test_create_deferred_context(void)
 
     expected_refcount = get_refcount(device) + 1;
     hr = ID3D11Device_CreateDeferredContext(device, 0, &context);
-    todo_wine ok(hr == S_OK, "Failed to create deferred context, hr %#x.\n", hr);
+    ok(hr == S_OK, "Failed to create deferred context, hr %#x.\n", hr);
     if (FAILED(hr))
         goto done;
     refcount = get_refcount(device);
@@ -2292,6 +2294,182 @@ done:
     ok(!refcount, "Device has %u references left.\n", refcount);
 }
 
+static void test_deferred_context_execute(void)
+{
+    static const float green[] = {0.0f, 1.0f, 0.0f, 1.0f};
+    static const float red[] = {1.0f, 0.0f, 0.0f, 1.0f};
+    struct d3d11_test_context test_context;
+    ID3D11DeviceContext *deferred;
+    ID3D11CommandList *list;
+    ID3D11Device *device;
+    ULONG refcount;
+    HRESULT hr;
+
+    if (!init_test_context(&test_context, NULL))
+        return;
+    device = test_context.device;
+
+    hr = ID3D11Device_CreateDeferredContext(device, 0, &deferred);
+    ok(hr == S_OK, "Failed to create deferred context, hr %#x.\n", hr);
+    ok(ID3D11DeviceContext_GetType(deferred) == D3D11_DEVICE_CONTEXT_DEFERRED,
+            "Got unexpected context type %#x.\n", ID3D11DeviceContext_GetType(deferred));
+
+    ID3D11DeviceContext_ClearRenderTargetView(test_context.immediate_context, test_context.backbuffer_rtv, red);
+    ID3D11DeviceContext_ClearRenderTargetView(deferred, test_context.backbuffer_rtv, green);
+    check_texture_color(test_context.backbuffer, 0xff0000ff, 0);
+
+    hr = ID3D11DeviceContext_FinishCommandList(deferred, FALSE, &list);
+    ok(hr == S_OK, "Failed to finish command list, hr %#x.\n", hr);
+    ok(ID3D11CommandList_GetContextFlags(list) == 0, "Got unexpected context flags %#x.\n",
+            ID3D11CommandList_GetContextFlags(list));
+
+    ID3D11DeviceContext_ExecuteCommandList(test_context.immediate_context, list, FALSE);
+    check_texture_color(test_context.backbuffer, 0xff00ff00, 0);
+
+    ID3D11DeviceContext_ClearRenderTargetView(test_context.immediate_context, test_context.backbuffer_rtv, red);
+    ID3D11DeviceContext_ExecuteCommandList(test_context.immediate_context, list, TRUE);
+    check_texture_color(test_context.backbuffer, 0xff00ff00, 0);
+
+    refcount = ID3D11CommandList_Release(list);
+    ok(!refcount, "Got unexpected refcount %u.\n", refcount);
+    refcount = ID3D11DeviceContext_Release(deferred);
+    ok(!refcount, "Got unexpected refcount %u.\n", refcount);
+    release_test_context(&test_context);
+}
+
+static void test_deferred_context_map(void)
+{
+    struct d3d11_test_context test_context;
+    D3D11_MAPPED_SUBRESOURCE map_desc;
+    D3D11_BUFFER_DESC buffer_desc;
+    struct resource_readback rb;
+    ID3D11DeviceContext *deferred;
+    ID3D11CommandList *list;
+    ID3D11Buffer *buffer;
+    ID3D11Device *device;
+    unsigned int i;
+    DWORD *data;
+    HRESULT hr;
+
+    if (!init_test_context(&test_context, NULL))
+        return;
+    device = test_context.device;
+
+    hr = ID3D11Device_CreateDeferredContext(device, 0, &deferred);
+    ok(hr == S_OK, "Failed to create deferred context, hr %#x.\n", hr);
+
+    buffer_desc.ByteWidth = 64 * sizeof(*data);
+    buffer_desc.Usage = D3D11_USAGE_DYNAMIC;
+    buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    buffer_desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    buffer_desc.MiscFlags = 0;
+    buffer_desc.StructureByteStride = 0;
+    hr = ID3D11Device_CreateBuffer(device, &buffer_desc, NULL, &buffer);
+    ok(hr == S_OK, "Failed to create buffer, hr %#x.\n", hr);
+
+    hr = ID3D11DeviceContext_Map(deferred, (ID3D11Resource *)buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &map_desc);
+    ok(hr == S_OK, "Failed to map buffer, hr %#x.\n", hr);
+    ok(!((ULONG_PTR)map_desc.pData & 15), "Got unaligned pointer %p.\n", map_desc.pData);
+    data = map_desc.pData;
+    for (i = 0; i < 32; ++i)
+        data[i] = i;
+    ID3D11DeviceContext_Unmap(deferred, (ID3D11Resource *)buffer, 0);
+
+    hr = ID3D11DeviceContext_Map(deferred, (ID3D11Resource *)buffer, 0,
+            D3D11_MAP_WRITE_NO_OVERWRITE, 0, &map_desc);
+    ok(hr == S_OK, "Failed to map buffer, hr %#x.\n", hr);
+    ok(!((ULONG_PTR)map_desc.pData & 15), "Got unaligned pointer %p.\n", map_desc.pData);
+    data = map_desc.pData;
+    for (i = 32; i < 64; ++i)
+        data[i] = i;
+    ID3D11DeviceContext_Unmap(deferred, (ID3D11Resource *)buffer, 0);
+
+    hr = ID3D11DeviceContext_FinishCommandList(deferred, FALSE, &list);
+    ok(hr == S_OK, "Failed to finish command list, hr %#x.\n", hr);
+    ID3D11DeviceContext_ExecuteCommandList(test_context.immediate_context, list, FALSE);
+
+    get_buffer_readback(buffer, &rb);
+    for (i = 0; i < 64; ++i)
+    {
+        DWORD value = get_readback_u32(&rb, i, 0, 0);
+        ok(value == i, "Got unexpected value %#x at %u.\n", value, i);
+    }
+    release_resource_readback(&rb);
+
+    ID3D11CommandList_Release(list);
+    ID3D11Buffer_Release(buffer);
+    ID3D11DeviceContext_Release(deferred);
+    release_test_context(&test_context);
+}
+
+static void test_deferred_context_state(void)
+{
+    static const D3D11_VIEWPORT viewport = {1.0f, 2.0f, 64.0f, 32.0f, 0.0f, 1.0f};
+    D3D11_PRIMITIVE_TOPOLOGY topology;
+    ID3D11Buffer *buffer, *ret_buffer;
+    struct d3d11_test_context test_context;
+    ID3D11DeviceContext *deferred;
+    D3D11_VIEWPORT ret_viewport;
+    ID3D11CommandList *list;
+    unsigned int count;
+    ID3D11Device *device;
+    HRESULT hr;
+
+    if (!init_test_context(&test_context, NULL))
+        return;
+    device = test_context.device;
+
+    hr = ID3D11Device_CreateDeferredContext(device, 0, &deferred);
+    ok(hr == S_OK, "Failed to create deferred context, hr %#x.\n", hr);
+
+    buffer = create_buffer(device, D3D11_BIND_CONSTANT_BUFFER, 16, NULL);
+
+    ID3D11DeviceContext_VSSetConstantBuffers(deferred, 1, 1, &buffer);
+    ID3D11DeviceContext_IASetPrimitiveTopology(deferred, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    ID3D11DeviceContext_RSSetViewports(deferred, 1, &viewport);
+
+    ID3D11DeviceContext_VSGetConstantBuffers(deferred, 1, 1, &ret_buffer);
+    ok(ret_buffer == buffer, "Got unexpected buffer %p, expected %p.\n", ret_buffer, buffer);
+    ID3D11Buffer_Release(ret_buffer);
+    ID3D11DeviceContext_VSGetConstantBuffers(deferred, 0, 1, &ret_buffer);
+    ok(!ret_buffer, "Got unexpected buffer %p.\n", ret_buffer);
+    ID3D11DeviceContext_IAGetPrimitiveTopology(deferred, &topology);
+    ok(topology == D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, "Got unexpected topology %#x.\n", topology);
+    count = 1;
+    ID3D11DeviceContext_RSGetViewports(deferred, &count, &ret_viewport);
+    ok(count == 1, "Got unexpected viewport count %u.\n", count);
+    ok(!memcmp(&ret_viewport, &viewport, sizeof(viewport)), "Got unexpected viewport.\n");
+
+    hr = ID3D11DeviceContext_FinishCommandList(deferred, TRUE, &list);
+    ok(hr == S_OK, "Failed to finish command list, hr %#x.\n", hr);
+    ID3D11CommandList_Release(list);
+
+    ID3D11DeviceContext_VSGetConstantBuffers(deferred, 1, 1, &ret_buffer);
+    ok(ret_buffer == buffer, "Got unexpected buffer %p, expected %p.\n", ret_buffer, buffer);
+    ID3D11Buffer_Release(ret_buffer);
+
+    ID3D11DeviceContext_ClearState(deferred);
+    ID3D11DeviceContext_VSGetConstantBuffers(deferred, 1, 1, &ret_buffer);
+    ok(!ret_buffer, "Got unexpected buffer %p.\n", ret_buffer);
+    ID3D11DeviceContext_IAGetPrimitiveTopology(deferred, &topology);
+    ok(topology == D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED, "Got unexpected topology %#x.\n", topology);
+    count = 0;
+    ID3D11DeviceContext_RSGetViewports(deferred, &count, NULL);
+    ok(!count, "Got unexpected viewport count %u.\n", count);
+
+    ID3D11DeviceContext_VSSetConstantBuffers(deferred, 1, 1, &buffer);
+    hr = ID3D11DeviceContext_FinishCommandList(deferred, FALSE, &list);
+    ok(hr == S_OK, "Failed to finish command list, hr %#x.\n", hr);
+    ID3D11CommandList_Release(list);
+
+    ID3D11DeviceContext_VSGetConstantBuffers(deferred, 1, 1, &ret_buffer);
+    ok(!ret_buffer, "Got unexpected buffer %p.\n", ret_buffer);
+
+    ID3D11DeviceContext_Release(deferred);
+    ID3D11Buffer_Release(buffer);
+    release_test_context(&test_context);
+}
+
 static void test_create_texture1d(void)
 {
     ULONG refcount, expected_refcount;
@@ -30124,6 +30302,9 @@ START_TEST(d3d11)
     queue_for_each_feature_level(test_device_interfaces);
     queue_test(test_immediate_context);
     queue_test(test_create_deferred_context);
+    queue_test(test_deferred_context_execute);
+    queue_test(test_deferred_context_map);
+    queue_test(test_deferred_context_state);
     queue_test(test_create_texture1d);
     queue_test(test_texture1d_interfaces);
     queue_test(test_create_texture2d);
@@ -1136,6 +1136,7 @@ void secondarybuffer_destroy(IDirectSoundBufferImpl *This)
 
     HeapFree(GetProcessHeap(), 0, This->notifies);
     HeapFree(GetProcessHeap(), 0, This->pwfx);
+    HeapFree(GetProcessHeap(), 0, This->fir_table);
 
     if (This->filters) {
         int i;
@@ -1192,6 +1193,8 @@ HRESULT IDirectSoundBufferImpl_Duplicate(
     dsb->sec_mixpos = 0;
     dsb->notifies = NULL;
     dsb->nrofnotifies = 0;
+    dsb->fir_table = NULL;
+    dsb->fir_table_step = 0;
     dsb->device = device;
     DSOUND_RecalcFormat(dsb);
 
@@ -325,6 +325,10 @@ void put_quad2stereo(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel
 void mixieee32(float *src, float *dst, unsigned samples)
 {
     TRACE("%p - %p %d\n", src, dst, samples);
+#ifdef __SSE2__
+    for (; samples >= 4; samples -= 4, src += 4, dst += 4)
+        *(v4sf *)dst += *(const v4sf *)src;
+#endif
     while (samples--)
         *(dst++) += *(src++);
 }
@@ -34,6 +34,13 @@
 
 #define DS_MAX_CHANNELS 6
 
+#ifdef __SSE2__
+/* Four floats with no alignment requirement. This uses compiler vector
+ * extensions rather than intrinsics, since system headers can't be used
+ * with msvcrt. */
+typedef float v4sf __attribute__((vector_size(16), aligned(4), may_alias));
+#endif
+
 extern int ds_hel_buflen DECLSPEC_HIDDEN;
 
 /*****************************************************************************
@@ -149,6 +156,9 @@ struct IDirectSoundBufferImpl
     ULONG                       freqneeded;
     DWORD                       firstep;
     float                       firgain;
+    /* polyphase FIR coefficients for firstep, see cp_fields_resample() */
+    float                      *fir_table;
+    DWORD                       fir_table_step;
     LONG64                      freqAdjustNum,freqAdjustDen;
     LONG64                      freqAccNum;
     /* used for mixing */
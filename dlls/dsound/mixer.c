@@ -295,6 +295,85 @@ static UINT cp_fields_noresample(IDirectSoundBufferImpl *dsb, UINT count)
     return count;
 }
 
+/**
+ * Rearrange the FIR for the current firstep, so that the taps used for one
+ * output sample are contiguous. Each of the firstep phases stores the taps
+ * followed by their difference to the next FIR point, used for the linear
+ * interpolation between two phases. Taps past the end of the FIR are zero.
+ */
+static const float *get_fir_table(IDirectSoundBufferImpl *dsb, UINT taps)
+{
+    UINT step = dsb->firstep, phase, j;
+    float *table;
+
+    if (dsb->fir_table_step == step)
+        return dsb->fir_table;
+
+    HeapFree(GetProcessHeap(), 0, dsb->fir_table);
+    dsb->fir_table = NULL;
+    dsb->fir_table_step = 0;
+
+    /* Very low frequencies use few taps from a large number of phases. */
+    if (step > fir_len)
+        return NULL;
+
+    if (!(table = HeapAlloc(GetProcessHeap(), 0, step * taps * 2 * sizeof(float))))
+        return NULL;
+
+    for (phase = 0; phase < step; ++phase)
+    {
+        float *coef = table + phase * taps * 2, *delta = coef + taps;
+
+        for (j = 0; j < taps; ++j)
+        {
+            UINT idx = phase + j * step;
+
+            if (idx < fir_len - 1)
+            {
+                coef[j] = fir[idx];
+                delta[j] = fir[idx + 1] - fir[idx];
+            }
+            else
+                coef[j] = delta[j] = 0.0f;
+        }
+    }
+
+    dsb->fir_table = table;
+    dsb->fir_table_step = step;
+    return table;
+}
+
+static void fir_interpolate(float *dst, const float *coef, const float *delta, float rem, UINT count)
+{
+    UINT i = 0;
+
+#ifdef __SSE2__
+    v4sf r = {rem, rem, rem, rem};
+
+    for (; i + 4 <= count; i += 4)
+        *(v4sf *)(dst + i) = *(const v4sf *)(coef + i) + *(const v4sf *)(delta + i) * r;
+#endif
+    for (; i < count; ++i)
+        dst[i] = coef[i] + delta[i] * rem;
+}
+
+static float fir_dot(const float *coef, const float *samples, UINT count)
+{
+    float sum = 0.0f;
+    UINT i = 0;
+
+#ifdef __SSE2__
+    v4sf acc = {0.0f, 0.0f, 0.0f, 0.0f};
+
+    for (; i + 4 <= count; i += 4)
+        acc += *(const v4sf *)(coef + i) * *(const v4sf *)(samples + i);
+    sum = (acc[0] + acc[2]) + (acc[1] + acc[3]);
+#endif
+    for (; i < count; ++i)
+        sum += coef[i] * samples[i];
+    return sum;
+}
+
 static UINT cp_fields_resample(IDirectSoundBufferImpl *dsb, UINT count, LONG64 *freqAccNum)
 {
     UINT i, channel;
@@ -309,6 +388,7 @@ static UINT cp_fields_resample(IDirectSoundBufferImpl *dsb, UINT count, LONG64 *
 
     UINT fir_cachesize = (fir_len + dsbfirstep - 2) / dsbfirstep;
     UINT required_input = max_ipos + fir_cachesize;
+    const float *fir_table = get_fir_table(dsb, fir_cachesize);
     float *intermediate, *fir_copy, *itmp;
 
     DWORD len = required_input * channels;
@@ -346,20 +426,22 @@ static UINT cp_fields_resample(IDirectSoundBufferImpl *dsb, UINT count, LONG64 *
         float rem = int_fir_steps + 1.0 - total_fir_steps;
 
         int fir_used = 0;
-        while (idx < fir_len - 1) {
-            fir_copy[fir_used++] = fir[idx] * (1.0 - rem) + fir[idx + 1] * rem;
-            idx += dsb->firstep;
+        if (fir_table) {
+            const float *coef = fir_table + idx * fir_cachesize * 2;
+            fir_interpolate(fir_copy, coef, coef + fir_cachesize, rem, fir_cachesize);
+            fir_used = fir_cachesize;
+        } else {
+            while (idx < fir_len - 1) {
+                fir_copy[fir_used++] = fir[idx] * (1.0 - rem) + fir[idx + 1] * rem;
+                idx += dsb->firstep;
+            }
         }
 
         assert(fir_used <= fir_cachesize);
         assert(ipos + fir_used <= required_input);
 
         for (channel = 0; channel < dsb->mix_channels; channel++) {
-            int j;
-            float sum = 0.0;
-            float* cache = &intermediate[channel * required_input + ipos];
-            for (j = 0; j < fir_used; j++)
-                sum += fir_copy[j] * cache[j];
+            float sum = fir_dot(fir_copy, &intermediate[channel * required_input + ipos], fir_used);
             dsb->put(dsb, i * ostride, channel, sum * dsb->firgain);
         }
     }
@@ -453,9 +535,10 @@ static void DSOUND_MixToTemporary(IDirectSoundBufferImpl *dsb, DWORD frames)
 
 static void DSOUND_MixerVol(const IDirectSoundBufferImpl *dsb, INT frames)
 {
-	INT	i;
-	float vols[DS_MAX_CHANNELS];
-	UINT channels = dsb->device->pwfx->nChannels, chan;
+	UINT	i, total;
+	float vols[DS_MAX_CHANNELS * 4];
+	UINT channels = dsb->device->pwfx->nChannels;
+	float *buf = dsb->device->tmp_buffer;
 
 	TRACE("(%p,%d)\n",dsb,frames);
 	TRACE("left = %x, right = %x\n", dsb->volpan.dwTotalAmpFactor[0],
@@ -472,14 +555,23 @@ static void DSOUND_MixerVol(const IDirectSoundBufferImpl *dsb, INT frames)
 		return;
 	}
 
-	for (i = 0; i < channels; ++i)
-		vols[i] = dsb->volpan.dwTotalAmpFactor[i] / ((float)0xFFFF);
+	/* Four frames worth of volumes, a multiple of both the channel count
+	 * and the vector size. */
+	for (i = 0; i < channels * 4; ++i)
+		vols[i] = dsb->volpan.dwTotalAmpFactor[i % channels] / ((float)0xFFFF);
 
-	for(i = 0; i < frames; ++i){
-		for(chan = 0; chan < channels; ++chan){
-			dsb->device->tmp_buffer[i * channels + chan] *= vols[chan];
-		}
+	total = frames * channels;
+	i = 0;
+#ifdef __SSE2__
+	for (; i + channels * 4 <= total; i += channels * 4)
+	{
+		UINT j;
+		for (j = 0; j < channels * 4; j += 4)
+			*(v4sf *)(buf + i + j) *= *(const v4sf *)(vols + j);
 	}
+#endif
+	for (; i < total; ++i)
+		buf[i] *= vols[i % channels];
 }
 
 /**
@@ -353,6 +353,39 @@ extern float fontface_get_scaled_design_advance(struct dwrite_fontface *fontface
         float emsize, float ppdip, const DWRITE_MATRIX *transform, UINT16 glyph, BOOL is_sideways) DECLSPEC_HIDDEN;
 extern struct dwrite_fontface *unsafe_impl_from_IDWriteFontFace(IDWriteFontFace *iface) DECLSPEC_HIDDEN;
 
+/* Shaping results cached by the factory that owns the font face. */
+struct shaped_run_key
+{
+    IDWriteFontFace *fontface;
+    const WCHAR *text;
+    UINT32 length;
+    const WCHAR *locale;
+    DWRITE_SCRIPT_ANALYSIS sa;
+    BOOL is_sideways;
+    BOOL is_rtl;
+    float emsize;
+    /* Only used for GDI compatible placements. */
+    BOOL gdi_compatible;
+    BOOL use_gdi_natural;
+    float ppdip;
+    DWRITE_MATRIX transform;
+};
+
+struct shaped_run
+{
+    UINT16 *clustermap;
+    UINT16 *glyphs;
+    float *advances;
+    DWRITE_GLYPH_OFFSET *offsets;
+    UINT32 glyph_count;
+};
+
+extern BOOL factory_get_shaped_run(IDWriteFactory7 *factory, const struct shaped_run_key *key,
+        struct shaped_run *run) DECLSPEC_HIDDEN;
+extern void factory_cache_shaped_run(IDWriteFactory7 *factory, const struct shaped_run_key *key,
+        const struct shaped_run *run) DECLSPEC_HIDDEN;
+extern void factory_release_shaped_runs(IDWriteFactory7 *factory, IDWriteFontFace *fontface) DECLSPEC_HIDDEN;
+
 /* Opentype font table functions */
 struct dwrite_font_props
 {
@@ -619,6 +619,7 @@ static ULONG WINAPI dwritefontface_Release(IDWriteFontFace5 *iface)
         freetype_notify_cacheremove(iface);
 
         dwrite_cmap_release(&fontface->cmap);
+        factory_release_shaped_runs(fontface->factory, (IDWriteFontFace *)iface);
         IDWriteFactory7_Release(fontface->factory);
         heap_free(fontface);
     }
@@ -3883,7 +3884,8 @@ static BOOL font_apply_differentiation_rules(struct dwrite_font_data *font, WCHA
     return TRUE;
 }
 
-static HRESULT init_font_data(const struct fontface_desc *desc, struct dwrite_font_data **ret)
+/* Static axis values use the weight and stretch from the font file, not the differentiated ones. */
+static void init_font_data_axes(struct dwrite_font_data *data, DWRITE_FONT_WEIGHT weight, DWRITE_FONT_STRETCH stretch)
 {
     static const float width_axis_values[] =
     {
@@ -3899,8 +3901,21 @@ static HRESULT init_font_data(const struct fontface_desc *desc, struct dwrite_fo
         200.0f, /* DWRITE_FONT_STRETCH_ULTRA_EXPANDED */
     };
 
+    init_font_prop_vec(data->weight, data->stretch, data->style, &data->propvec);
+
+    data->axis[0].axisTag = DWRITE_FONT_AXIS_TAG_WEIGHT;
+    data->axis[0].value = weight;
+    data->axis[1].axisTag = DWRITE_FONT_AXIS_TAG_WIDTH;
+    data->axis[1].value = width_axis_values[stretch];
+    data->axis[2].axisTag = DWRITE_FONT_AXIS_TAG_ITALIC;
+    data->axis[2].value = data->style == DWRITE_FONT_STYLE_ITALIC ? 1.0f : 0.0f;
+}
+
+/* Font properties as read from the file are returned in props. */
+static HRESULT init_font_data_props(const struct fontface_desc *desc, struct dwrite_font_props *props,
+        struct dwrite_font_data **ret)
+{
     struct file_stream_desc stream_desc;
-    struct dwrite_font_props props;
     struct dwrite_font_data *data;
     WCHAR familyW[255], faceW[255];
     HRESULT hr;
@@ -3923,9 +3938,9 @@ static HRESULT init_font_data(const struct fontface_desc *desc, struct dwrite_fo
     stream_desc.stream = desc->stream;
     stream_desc.face_type = desc->face_type;
     stream_desc.face_index = desc->index;
-    opentype_get_font_properties(&stream_desc, &props);
+    opentype_get_font_properties(&stream_desc, props);
     opentype_get_font_metrics(&stream_desc, &data->metrics, NULL);
-    opentype_get_font_facename(&stream_desc, props.lf.lfFaceName, &data->names);
+    opentype_get_font_facename(&stream_desc, props->lf.lfFaceName, &data->names);
 
     /* get family name from font file */
     hr = opentype_get_font_familyname(&stream_desc, &data->family_names);
@@ -3935,13 +3950,13 @@ static HRESULT init_font_data(const struct fontface_desc *desc, struct dwrite_fo
         return hr;
     }
 
-    data->style = props.style;
-    data->stretch = props.stretch;
-    data->weight = props.weight;
-    data->panose = props.panose;
-    data->fontsig = props.fontsig;
-    data->lf = props.lf;
-    data->flags = props.flags;
+    data->style = props->style;
+    data->stretch = props->stretch;
+    data->weight = props->weight;
+    data->panose = props->panose;
+    data->fontsig = props->fontsig;
+    data->lf = props->lf;
+    data->flags = props->flags;
 
     fontstrings_get_en_string(data->family_names, familyW, ARRAY_SIZE(familyW));
     fontstrings_get_en_string(data->names, faceW, ARRAY_SIZE(faceW));
@@ -3950,19 +3965,19 @@ static HRESULT init_font_data(const struct fontface_desc *desc, struct dwrite_fo
         set_en_localizedstring(data->names, faceW);
     }
 
-    init_font_prop_vec(data->weight, data->stretch, data->style, &data->propvec);
-
-    data->axis[0].axisTag = DWRITE_FONT_AXIS_TAG_WEIGHT;
-    data->axis[0].value = props.weight;
-    data->axis[1].axisTag = DWRITE_FONT_AXIS_TAG_WIDTH;
-    data->axis[1].value = width_axis_values[props.stretch];
-    data->axis[2].axisTag = DWRITE_FONT_AXIS_TAG_ITALIC;
-    data->axis[2].value = data->style == DWRITE_FONT_STYLE_ITALIC ? 1.0f : 0.0f;
+    init_font_data_axes(data, props->weight, props->stretch);
 
     *ret = data;
     return S_OK;
 }
 
+static HRESULT init_font_data(const struct fontface_desc *desc, struct dwrite_font_data **ret)
+{
+    struct dwrite_font_props props;
+
+    return init_font_data_props(desc, &props, ret);
+}
+
 static HRESULT init_font_data_from_font(const struct dwrite_font_data *src, DWRITE_FONT_SIMULATIONS sim,
         const WCHAR *facenameW, struct dwrite_font_data **ret)
 {
@@ -4237,6 +4252,556 @@ static void fontcollection_add_replacements(struct dwrite_fontcollection *collec
     RegCloseKey(hkey);
 }
 
+static HRESULT fontcollection_add_font_data(struct dwrite_fontcollection *collection, struct dwrite_font_data *font_data)
+{
+    struct dwrite_fontfamily_data *family_data;
+    WCHAR familyW[255];
+    UINT32 index;
+    HRESULT hr;
+
+    fontstrings_get_en_string(font_data->family_names, familyW, ARRAY_SIZE(familyW));
+
+    /* ignore dot named faces */
+    if (familyW[0] == '.')
+    {
+        WARN("Ignoring face %s\n", debugstr_w(familyW));
+        release_font_data(font_data);
+        return S_OK;
+    }
+
+    index = collection_find_family(collection, familyW);
+    if (index != ~0u)
+        return fontfamily_add_font(collection->family_data[index], font_data);
+
+    /* create and init new family */
+    hr = init_fontfamily_data(font_data->family_names, &family_data);
+    if (hr == S_OK) {
+        /* add font to family, family - to collection */
+        hr = fontfamily_add_font(family_data, font_data);
+        if (hr == S_OK)
+            hr = fontcollection_add_family(collection, family_data);
+
+        if (FAILED(hr))
+            release_fontfamily_data(family_data);
+    }
+
+    return hr;
+}
+
+/* Index of the system font files, saved across processes so that the system
+ * collection can be built without opening and parsing every font file. File
+ * entries are validated against the write time recorded in the local file
+ * reference, so only new or modified files are parsed again. */
+#define FONTSET_CACHE_MAGIC   0x53465744 /* "DWFS" */
+#define FONTSET_CACHE_VERSION 2
+
+struct fontset_cache_header
+{
+    UINT32 magic;
+    UINT32 version;
+    UINT32 size;
+    UINT32 file_count;
+};
+
+/* Followed by the path and face_count faces. */
+struct fontset_cache_file
+{
+    FILETIME writetime;
+    UINT32 face_type;
+    UINT32 face_count;
+};
+
+/* Followed by the family and face names. */
+struct fontset_cache_face
+{
+    UINT32 index;
+    UINT32 style;
+    UINT32 stretch;
+    UINT32 weight;
+    UINT32 axis_stretch; /* properties from the file, before differentiation */
+    UINT32 axis_weight;
+    UINT32 flags;
+    DWRITE_PANOSE panose;
+    FONTSIGNATURE fontsig;
+    DWRITE_FONT_METRICS1 metrics;
+    LOGFONTW lf;
+};
+
+struct fontset_cache_entry
+{
+    const WCHAR *path;
+    const struct fontset_cache_file *file;
+    const BYTE *faces;
+    const BYTE *end;
+};
+
+struct fontset_cache
+{
+    BYTE *data;
+    struct fontset_cache_entry *entries;
+    size_t count;
+
+    /* index being built for the current collection */
+    BYTE *buffer;
+    size_t size;
+    size_t capacity;
+    UINT32 file_count;
+    BOOL modified;
+    BOOL failed;
+};
+
+static WCHAR *get_fontset_cache_path(void)
+{
+    static const WCHAR cachenameW[] = {'\\','d','w','f','o','n','t','s','e','t','.','d','a','t',0};
+    WCHAR path[MAX_PATH];
+    UINT len;
+
+    len = GetSystemDirectoryW(path, ARRAY_SIZE(path));
+    if (!len || len + ARRAY_SIZE(cachenameW) > ARRAY_SIZE(path))
+        return NULL;
+    strcatW(path, cachenameW);
+    return heap_strdupW(path);
+}
+
+/* Variable sized data is padded to keep the records aligned. */
+static const void *fontset_cache_read(const BYTE **ptr, const BYTE *end, size_t size)
+{
+    const BYTE *data = *ptr;
+
+    size = (size + 3) & ~3;
+    if ((size_t)(end - data) < size)
+        return NULL;
+    *ptr += size;
+    return data;
+}
+
+static const WCHAR *fontset_cache_read_string(const BYTE **ptr, const BYTE *end)
+{
+    const UINT32 *length;
+    const WCHAR *str;
+
+    if (!(length = fontset_cache_read(ptr, end, sizeof(*length))) || !*length)
+        return NULL;
+    if (!(str = fontset_cache_read(ptr, end, *length * sizeof(WCHAR))) || str[*length - 1])
+        return NULL;
+    return str;
+}
+
+static const BYTE *fontset_cache_skip_names(const BYTE *ptr, const BYTE *end)
+{
+    const UINT32 *count;
+    UINT32 i;
+
+    if (!(count = fontset_cache_read(&ptr, end, sizeof(*count))))
+        return NULL;
+    for (i = 0; i < *count * 2; ++i)
+    {
+        if (!fontset_cache_read_string(&ptr, end))
+            return NULL;
+    }
+    return ptr;
+}
+
+static int fontset_cache_entry_compare(const void *a, const void *b)
+{
+    const struct fontset_cache_entry *left = a, *right = b;
+    return strcmpiW(left->path, right->path);
+}
+
+static void fontset_cache_load(struct fontset_cache *cache)
+{
+    const struct fontset_cache_header *header;
+    const BYTE *ptr, *end;
+    LARGE_INTEGER size;
+    HANDLE file;
+    WCHAR *path;
+    DWORD count;
+    UINT32 i, j;
+
+    memset(cache, 0, sizeof(*cache));
+
+    if (!(path = get_fontset_cache_path()))
+        return;
+    file = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, 0, NULL);
+    heap_free(path);
+    if (file == INVALID_HANDLE_VALUE)
+        return;
+
+    if (!GetFileSizeEx(file, &size) || size.QuadPart < sizeof(*header) || size.QuadPart > 256 * 1024 * 1024
+            || !(cache->data = heap_alloc(size.u.LowPart))
+            || !ReadFile(file, cache->data, size.u.LowPart, &count, NULL) || count != size.u.LowPart)
+    {
+        CloseHandle(file);
+        goto failed;
+    }
+    CloseHandle(file);
+
+    header = (const struct fontset_cache_header *)cache->data;
+    if (header->magic != FONTSET_CACHE_MAGIC || header->version != FONTSET_CACHE_VERSION
+            || header->size != size.u.LowPart)
+    {
+        TRACE("Ignoring invalid font set cache.\n");
+        goto failed;
+    }
+
+    if (!(cache->entries = heap_calloc(header->file_count, sizeof(*cache->entries))))
+        goto failed;
+
+    ptr = (const BYTE *)(header + 1);
+    end = cache->data + header->size;
+    for (i = 0; i < header->file_count; ++i)
+    {
+        struct fontset_cache_entry *entry = &cache->entries[i];
+
+        if (!(entry->file = fontset_cache_read(&ptr, end, sizeof(*entry->file)))
+                || !(entry->path = fontset_cache_read_string(&ptr, end)))
+            goto failed;
+
+        entry->faces = ptr;
+        for (j = 0; j < entry->file->face_count; ++j)
+        {
+            if (!fontset_cache_read(&ptr, end, sizeof(struct fontset_cache_face))
+                    || !(ptr = fontset_cache_skip_names(ptr, end))
+                    || !(ptr = fontset_cache_skip_names(ptr, end)))
+                goto failed;
+        }
+        entry->end = ptr;
+    }
+
+    cache->count = header->file_count;
+    qsort(cache->entries, cache->count, sizeof(*cache->entries), fontset_cache_entry_compare);
+    TRACE("Loaded font set cache with %u files.\n", header->file_count);
+    return;
+
+failed:
+    heap_free(cache->entries);
+    heap_free(cache->data);
+    cache->entries = NULL;
+    cache->data = NULL;
+}
+
+static void fontset_cache_release(struct fontset_cache *cache)
+{
+    heap_free(cache->entries);
+    heap_free(cache->data);
+    heap_free(cache->buffer);
+}
+
+/* Write errors are sticky, an incomplete index is never saved. */
+static void fontset_cache_write(struct fontset_cache *cache, const void *data, size_t size)
+{
+    size_t padded = (size + 3) & ~3;
+
+    if (cache->failed)
+        return;
+
+    if (!dwrite_array_reserve((void **)&cache->buffer, &cache->capacity, cache->size + padded, 1))
+    {
+        cache->failed = TRUE;
+        return;
+    }
+    memcpy(cache->buffer + cache->size, data, size);
+    memset(cache->buffer + cache->size + size, 0, padded - size);
+    cache->size += padded;
+}
+
+static void fontset_cache_write_string(struct fontset_cache *cache, const WCHAR *str)
+{
+    UINT32 length = strlenW(str) + 1;
+
+    fontset_cache_write(cache, &length, sizeof(length));
+    fontset_cache_write(cache, str, length * sizeof(*str));
+}
+
+static void fontset_cache_write_names(struct fontset_cache *cache, IDWriteLocalizedStrings *strings)
+{
+    UINT32 count = IDWriteLocalizedStrings_GetCount(strings), i, length;
+    WCHAR locale[LOCALE_NAME_MAX_LENGTH], *str;
+
+    fontset_cache_write(cache, &count, sizeof(count));
+
+    for (i = 0; i < count; ++i)
+    {
+        if (FAILED(IDWriteLocalizedStrings_GetLocaleName(strings, i, locale, ARRAY_SIZE(locale)))
+                || FAILED(IDWriteLocalizedStrings_GetStringLength(strings, i, &length))
+                || !(str = heap_alloc((length + 1) * sizeof(*str))))
+        {
+            cache->failed = TRUE;
+            return;
+        }
+
+        if (FAILED(IDWriteLocalizedStrings_GetString(strings, i, str, length + 1)))
+            cache->failed = TRUE;
+        fontset_cache_write_string(cache, locale);
+        fontset_cache_write_string(cache, str);
+        heap_free(str);
+    }
+}
+
+static IDWriteLocalizedStrings *fontset_cache_read_names(const BYTE **ptr, const BYTE *end)
+{
+    IDWriteLocalizedStrings *strings;
+    const WCHAR *locale, *str;
+    const UINT32 *count;
+    UINT32 i;
+
+    if (!(count = fontset_cache_read(ptr, end, sizeof(*count))))
+        return NULL;
+    if (FAILED(create_localizedstrings(&strings)))
+        return NULL;
+
+    for (i = 0; i < *count; ++i)
+    {
+        locale = fontset_cache_read_string(ptr, end);
+        str = fontset_cache_read_string(ptr, end);
+        if (!locale || !str || FAILED(add_localizedstring(strings, locale, str)))
+        {
+            IDWriteLocalizedStrings_Release(strings);
+            return NULL;
+        }
+    }
+
+    return strings;
+}
+
+static BOOL get_local_file_info(IDWriteFontFile *file, WCHAR **path, FILETIME *writetime)
+{
+    IDWriteLocalFontFileLoader *local_loader;
+    IDWriteFontFileLoader *loader;
+    UINT32 key_size, length;
+    const void *key;
+    HRESULT hr;
+
+    *path = NULL;
+
+    if (FAILED(IDWriteFontFile_GetLoader(file, &loader)))
+        return FALSE;
+    hr = IDWriteFontFileLoader_QueryInterface(loader, &IID_IDWriteLocalFontFileLoader, (void **)&local_loader);
+    IDWriteFontFileLoader_Release(loader);
+    if (FAILED(hr))
+        return FALSE;
+
+    if (SUCCEEDED(hr = IDWriteFontFile_GetReferenceKey(file, &key, &key_size))
+            && SUCCEEDED(hr = IDWriteLocalFontFileLoader_GetFilePathLengthFromKey(local_loader, key, key_size, &length))
+            && SUCCEEDED(hr = IDWriteLocalFontFileLoader_GetLastWriteTimeFromKey(local_loader, key, key_size, writetime)))
+    {
+        if (!(*path = heap_alloc((length + 1) * sizeof(**path))))
+            hr = E_OUTOFMEMORY;
+        else if (FAILED(hr = IDWriteLocalFontFileLoader_GetFilePathFromKey(local_loader, key, key_size, *path, length + 1)))
+        {
+            heap_free(*path);
+            *path = NULL;
+        }
+    }
+
+    IDWriteLocalFontFileLoader_Release(local_loader);
+    return SUCCEEDED(hr);
+}
+
+static const struct fontset_cache_entry *fontset_cache_find_file(const struct fontset_cache *cache,
+        const WCHAR *path, const FILETIME *writetime)
+{
+    struct fontset_cache_entry key, *entry;
+
+    if (!cache->count)
+        return NULL;
+
+    key.path = path;
+    if (!(entry = bsearch(&key, cache->entries, cache->count, sizeof(*cache->entries), fontset_cache_entry_compare)))
+        return NULL;
+
+    if (CompareFileTime(&entry->file->writetime, writetime))
+        return NULL;
+
+    return entry;
+}
+
+/* Start a new file record, faces are appended with fontset_cache_add_face(). */
+static void fontset_cache_add_file(struct fontset_cache *cache, const WCHAR *path, const FILETIME *writetime,
+        DWRITE_FONT_FACE_TYPE face_type, UINT32 face_count)
+{
+    struct fontset_cache_file file;
+
+    file.writetime = *writetime;
+    file.face_type = face_type;
+    file.face_count = face_count;
+
+    cache->file_count++;
+    cache->modified = TRUE;
+    fontset_cache_write(cache, &file, sizeof(file));
+    fontset_cache_write_string(cache, path);
+}
+
+static void fontset_cache_add_face(struct fontset_cache *cache, size_t file_offset,
+        const struct dwrite_font_data *data, const struct dwrite_font_props *props)
+{
+    struct fontset_cache_face face;
+
+    memset(&face, 0, sizeof(face));
+    face.index = data->face_index;
+    face.style = data->style;
+    face.stretch = data->stretch;
+    face.weight = data->weight;
+    face.axis_stretch = props->stretch;
+    face.axis_weight = props->weight;
+    face.flags = data->flags;
+    face.panose = data->panose;
+    face.fontsig = data->fontsig;
+    face.metrics = data->metrics;
+    face.lf = data->lf;
+
+    fontset_cache_write(cache, &face, sizeof(face));
+    fontset_cache_write_names(cache, data->family_names);
+    fontset_cache_write_names(cache, data->names);
+
+    if (!cache->failed)
+        ((struct fontset_cache_file *)(cache->buffer + file_offset))->face_count++;
+}
+
+/* Copy an up to date entry as is to the new index. */
+static void fontset_cache_copy_file(struct fontset_cache *cache, const struct fontset_cache_entry *entry)
+{
+    cache->file_count++;
+    fontset_cache_write(cache, entry->file, entry->end - (const BYTE *)entry->file);
+}
+
+static HRESULT init_font_data_from_cache(IDWriteFontFile *file, DWRITE_FONT_FACE_TYPE face_type,
+        const BYTE **ptr, const BYTE *end, struct dwrite_font_data **ret)
+{
+    const struct fontset_cache_face *face;
+    struct dwrite_font_data *data;
+
+    *ret = NULL;
+
+    if (!(face = fontset_cache_read(ptr, end, sizeof(*face))) || face->stretch > DWRITE_FONT_STRETCH_ULTRA_EXPANDED
+            || face->axis_stretch > DWRITE_FONT_STRETCH_ULTRA_EXPANDED)
+        return E_FAIL;
+
+    if (!(data = heap_alloc_zero(sizeof(*data))))
+        return E_OUTOFMEMORY;
+
+    data->ref = 1;
+    data->file = file;
+    data->face_index = face->index;
+    data->face_type = face_type;
+    data->simulations = DWRITE_FONT_SIMULATIONS_NONE;
+    IDWriteFontFile_AddRef(data->file);
+
+    data->style = face->style;
+    data->stretch = face->stretch;
+    data->weight = face->weight;
+    data->flags = face->flags;
+    data->panose = face->panose;
+    data->fontsig = face->fontsig;
+    data->metrics = face->metrics;
+    data->lf = face->lf;
+
+    if (!(data->family_names = fontset_cache_read_names(ptr, end))
+            || !(data->names = fontset_cache_read_names(ptr, end)))
+    {
+        release_font_data(data);
+        return E_FAIL;
+    }
+
+    init_font_data_axes(data, face->axis_weight, face->axis_stretch);
+
+    *ret = data;
+    return S_OK;
+}
+
+/* Add all faces of a file that has an up to date cache entry. Returns S_FALSE if
+ * the entry is corrupt, in which case nothing is added and the file has to be parsed. */
+static HRESULT fontcollection_add_cached_file(struct dwrite_fontcollection *collection, struct fontset_cache *cache,
+        const struct fontset_cache_entry *entry, IDWriteFontFile *file)
+{
+    UINT32 face_count = entry->file->face_count, count, i;
+    struct dwrite_font_data **font_data;
+    const BYTE *ptr = entry->faces;
+    HRESULT hr = S_OK;
+
+    if (face_count > (entry->end - ptr) / sizeof(struct fontset_cache_face))
+        return S_FALSE;
+
+    if (!(font_data = heap_calloc(face_count, sizeof(*font_data))))
+        return E_OUTOFMEMORY;
+
+    for (count = 0; count < face_count; ++count)
+    {
+        if (FAILED(hr = init_font_data_from_cache(file, entry->file->face_type, &ptr, entry->end, &font_data[count])))
+            break;
+    }
+
+    if (FAILED(hr))
+    {
+        for (i = 0; i < count; ++i)
+            release_font_data(font_data[i]);
+        heap_free(font_data);
+        return hr == E_OUTOFMEMORY ? hr : S_FALSE;
+    }
+
+    for (i = 0; i < face_count; ++i)
+    {
+        if (SUCCEEDED(hr))
+            hr = fontcollection_add_font_data(collection, font_data[i]);
+        else
+            release_font_data(font_data[i]);
+    }
+    heap_free(font_data);
+
+    fontset_cache_copy_file(cache, entry);
+
+    return hr;
+}
+
+static void fontset_cache_save(struct fontset_cache *cache)
+{
+    struct fontset_cache_header *header;
+    WCHAR *path, *tmp_path;
+    DWORD count;
+    HANDLE file;
+    BOOL ret;
+
+    if (cache->failed || (!cache->modified && cache->file_count == cache->count))
+        return;
+
+    header = (struct fontset_cache_header *)cache->buffer;
+    header->magic = FONTSET_CACHE_MAGIC;
+    header->version = FONTSET_CACHE_VERSION;
+    header->size = cache->size;
+    header->file_count = cache->file_count;
+
+    if (!(path = get_fontset_cache_path()))
+        return;
+    if (!(tmp_path = heap_alloc((strlenW(path) + 16) * sizeof(*tmp_path))))
+    {
+        heap_free(path);
+        return;
+    }
+
+    /* Write to a temporary file first, other processes may be reading the cache. */
+    {
+        static const WCHAR fmtW[] = {'%','s','.','%','x',0};
+        sprintfW(tmp_path, fmtW, path, GetCurrentProcessId());
+    }
+
+    file = CreateFileW(tmp_path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL);
+    if (file != INVALID_HANDLE_VALUE)
+    {
+        ret = WriteFile(file, cache->buffer, cache->size, &count, NULL) && count == cache->size;
+        CloseHandle(file);
+        if (!ret || !MoveFileExW(tmp_path, path, MOVEFILE_REPLACE_EXISTING))
+        {
+            WARN("Failed to write font set cache %s.\n", debugstr_w(path));
+            DeleteFileW(tmp_path);
+        }
+        else
+            TRACE("Saved font set cache with %u files.\n", cache->file_count);
+    }
+
+    heap_free(tmp_path);
+    heap_free(path);
+}
+
 HRESULT create_font_collection(IDWriteFactory7 *factory, IDWriteFontFileEnumerator *enumerator, BOOL is_system,
     IDWriteFontCollection3 **ret)
 {
@@ -4246,8 +4811,10 @@ HRESULT create_font_collection(IDWriteFactory7 *factory, IDWriteFontFileEnumerat
     };
     struct fontfile_enum *fileenum, *fileenum2;
     struct dwrite_fontcollection *collection;
+    struct fontset_cache cache;
     struct list scannedfiles;
     BOOL current = FALSE;
+    DWORD start_time = 0;
     HRESULT hr = S_OK;
     size_t i;
 
@@ -4266,13 +4833,28 @@ HRESULT create_font_collection(IDWriteFactory7 *factory, IDWriteFontFileEnumerat
 
     TRACE("building font collection:\n");
 
+    memset(&cache, 0, sizeof(cache));
+    if (is_system)
+    {
+        struct fontset_cache_header header = { 0 };
+
+        start_time = GetTickCount();
+        fontset_cache_load(&cache);
+        /* The header is filled in when the index is saved. */
+        fontset_cache_write(&cache, &header, sizeof(header));
+    }
+
     list_init(&scannedfiles);
     while (hr == S_OK) {
+        const struct fontset_cache_entry *cache_entry = NULL;
         DWRITE_FONT_FACE_TYPE face_type;
         DWRITE_FONT_FILE_TYPE file_type;
         BOOL supported, same = FALSE;
         IDWriteFontFileStream *stream;
+        WCHAR *path = NULL;
+        FILETIME writetime;
         IDWriteFontFile *file;
+        size_t file_offset = 0;
         UINT32 face_count;
 
         current = FALSE;
@@ -4295,7 +4877,37 @@ HRESULT create_font_collection(IDWriteFactory7 *factory, IDWriteFontFileEnumerat
             continue;
         }
 
+        if (is_system && get_local_file_info(file, &path, &writetime))
+            cache_entry = fontset_cache_find_file(&cache, path, &writetime);
+
+        if (cache_entry)
+        {
+            /* Unsupported files are kept in the index without faces. */
+            if (!cache_entry->file->face_count)
+            {
+                heap_free(path);
+                fontset_cache_copy_file(&cache, cache_entry);
+                IDWriteFontFile_Release(file);
+                continue;
+            }
+
+            hr = fontcollection_add_cached_file(collection, &cache, cache_entry, file);
+            if (hr != S_FALSE)
+            {
+                heap_free(path);
+                fileenum = heap_alloc(sizeof(*fileenum));
+                fileenum->file = file;
+                list_add_tail(&scannedfiles, &fileenum->entry);
+                continue;
+            }
+
+            /* Treat a corrupt entry as a miss, the file is analyzed again below. */
+            WARN("Ignoring corrupt font set cache entry for %s.\n", debugstr_w(path));
+            hr = S_OK;
+        }
+
         if (FAILED(get_filestream_from_file(file, &stream))) {
+            heap_free(path);
             IDWriteFontFile_Release(file);
             continue;
         }
@@ -4304,6 +4916,9 @@ HRESULT create_font_collection(IDWriteFactory7 *factory, IDWriteFontFileEnumerat
         hr = opentype_analyze_font(stream, &supported, &file_type, &face_type, &face_count);
         if (FAILED(hr) || !supported || face_count == 0) {
             TRACE("Unsupported font (%p, 0x%08x, %d, %u)\n", file, hr, supported, face_count);
+            if (path)
+                fontset_cache_add_file(&cache, path, &writetime, DWRITE_FONT_FACE_TYPE_UNKNOWN, 0);
+            heap_free(path);
             IDWriteFontFileStream_Release(stream);
             IDWriteFontFile_Release(file);
             hr = S_OK;
@@ -4315,12 +4930,17 @@ HRESULT create_font_collection(IDWriteFactory7 *factory, IDWriteFontFileEnumerat
         fileenum->file = file;
         list_add_tail(&scannedfiles, &fileenum->entry);
 
+        if (path)
+        {
+            file_offset = cache.size;
+            fontset_cache_add_file(&cache, path, &writetime, face_type, 0);
+        }
+
         for (i = 0; i < face_count; ++i)
         {
             struct dwrite_font_data *font_data;
+            struct dwrite_font_props props;
             struct fontface_desc desc;
-            WCHAR familyW[255];
-            UINT32 index;
 
             desc.factory = factory;
             desc.face_type = face_type;
@@ -4332,7 +4952,7 @@ HRESULT create_font_collection(IDWriteFactory7 *factory, IDWriteFontFileEnumerat
             desc.font_data = NULL;
 
             /* Allocate an initialize new font data structure. */
-            hr = init_font_data(&desc, &font_data);
+            hr = init_font_data_props(&desc, &props, &font_data);
             if (FAILED(hr))
             {
                 /* move to next one */
@@ -4340,42 +4960,24 @@ HRESULT create_font_collection(IDWriteFactory7 *factory, IDWriteFontFileEnumerat
                 continue;
             }
 
-            fontstrings_get_en_string(font_data->family_names, familyW, ARRAY_SIZE(familyW));
-
-            /* ignore dot named faces */
-            if (familyW[0] == '.')
-            {
-                WARN("Ignoring face %s\n", debugstr_w(familyW));
-                release_font_data(font_data);
-                continue;
-            }
-
-            index = collection_find_family(collection, familyW);
-            if (index != ~0u)
-                hr = fontfamily_add_font(collection->family_data[index], font_data);
-            else {
-                struct dwrite_fontfamily_data *family_data;
-
-                /* create and init new family */
-                hr = init_fontfamily_data(font_data->family_names, &family_data);
-                if (hr == S_OK) {
-                    /* add font to family, family - to collection */
-                    hr = fontfamily_add_font(family_data, font_data);
-                    if (hr == S_OK)
-                        hr = fontcollection_add_family(collection, family_data);
+            if (path)
+                fontset_cache_add_face(&cache, file_offset, font_data, &props);
 
-                    if (FAILED(hr))
-                        release_fontfamily_data(family_data);
-                }
-            }
-
-            if (FAILED(hr))
+            if (FAILED(hr = fontcollection_add_font_data(collection, font_data)))
                 break;
         }
 
+        heap_free(path);
         IDWriteFontFileStream_Release(stream);
     }
 
+    if (is_system)
+    {
+        fontset_cache_save(&cache);
+        fontset_cache_release(&cache);
+        TRACE("Built system font collection in %u ms.\n", GetTickCount() - start_time);
+    }
+
     LIST_FOR_EACH_ENTRY_SAFE(fileenum, fileenum2, &scannedfiles, struct fontfile_enum, entry) {
         IDWriteFontFile_Release(fileenum->file);
         list_remove(&fileenum->entry);
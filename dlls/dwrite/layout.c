@@ -925,17 +925,72 @@ fatal:
     return hr;
 }
 
+static void layout_init_shaped_run_key(struct dwrite_textlayout *layout, const struct regular_layout_run *run,
+        struct shaped_run_key *key)
+{
+    memset(key, 0, sizeof(*key));
+    key->fontface = run->run.fontFace;
+    key->text = run->descr.string;
+    key->length = run->descr.stringLength;
+    key->locale = run->descr.localeName;
+    key->sa = run->sa;
+    key->is_sideways = run->run.isSideways;
+    key->is_rtl = run->run.bidiLevel & 1;
+    key->emsize = run->run.fontEmSize;
+    if (is_layout_gdi_compatible(layout))
+    {
+        key->gdi_compatible = TRUE;
+        key->use_gdi_natural = layout->measuringmode == DWRITE_MEASURING_MODE_GDI_NATURAL;
+        key->ppdip = layout->ppdip;
+        key->transform = layout->transform;
+    }
+}
+
+static void layout_set_run_glyphs(struct regular_layout_run *run)
+{
+    run->run.glyphIndices = run->glyphs;
+    run->descr.clusterMap = run->clustermap;
+    run->run.glyphAdvances = run->advances;
+    run->run.glyphOffsets = run->offsets;
+
+    /* Special treatment for runs that don't produce visual output, shaping code adds normal glyphs for them,
+       with valid cluster map and potentially with non-zero advances; layout code exposes those as zero
+       width clusters. */
+    if (run->sa.shapes == DWRITE_SCRIPT_SHAPES_NO_VISUAL)
+        run->run.glyphCount = 0;
+    else
+        run->run.glyphCount = run->glyphcount;
+}
+
 static HRESULT layout_shape_run(struct dwrite_textlayout *layout, struct regular_layout_run *run)
 {
     DWRITE_SHAPING_GLYPH_PROPERTIES *glyph_props;
     DWRITE_SHAPING_TEXT_PROPERTIES *text_props;
     IDWriteTextAnalyzer *analyzer;
     struct layout_range *range;
+    struct shaped_run_key key;
+    struct shaped_run shaped;
+    IDWriteFactory7 *factory;
     UINT32 max_count;
     HRESULT hr;
 
     range = get_layout_range_by_pos(layout, run->descr.textPosition);
     run->descr.localeName = range->locale;
+
+    /* Identical runs are often laid out repeatedly, reuse earlier results when possible. */
+    factory = unsafe_impl_from_IDWriteFontFace(run->run.fontFace)->factory;
+    layout_init_shaped_run_key(layout, run, &key);
+    if (factory_get_shaped_run(factory, &key, &shaped))
+    {
+        run->clustermap = shaped.clustermap;
+        run->glyphs = shaped.glyphs;
+        run->advances = shaped.advances;
+        run->offsets = shaped.offsets;
+        run->glyphcount = shaped.glyph_count;
+        layout_set_run_glyphs(run);
+        return S_OK;
+    }
+
     run->clustermap = heap_calloc(run->descr.stringLength, sizeof(*run->clustermap));
 
     max_count = 3 * run->descr.stringLength / 2 + 16;
@@ -1011,17 +1066,17 @@ static HRESULT layout_shape_run(struct dwrite_textlayout *layout, struct regular
         memset(run->offsets, 0, run->glyphcount * sizeof(*run->offsets));
         WARN("%s: failed to get glyph placement info, hr %#x.\n", debugstr_rundescr(&run->descr), hr);
     }
-
-    run->run.glyphAdvances = run->advances;
-    run->run.glyphOffsets = run->offsets;
-
-    /* Special treatment for runs that don't produce visual output, shaping code adds normal glyphs for them,
-       with valid cluster map and potentially with non-zero advances; layout code exposes those as zero
-       width clusters. */
-    if (run->sa.shapes == DWRITE_SCRIPT_SHAPES_NO_VISUAL)
-        run->run.glyphCount = 0;
     else
-        run->run.glyphCount = run->glyphcount;
+    {
+        shaped.clustermap = run->clustermap;
+        shaped.glyphs = run->glyphs;
+        shaped.advances = run->advances;
+        shaped.offsets = run->offsets;
+        shaped.glyph_count = run->glyphcount;
+        factory_cache_shaped_run(factory, &key, &shaped);
+    }
+
+    layout_set_run_glyphs(run);
 
     return S_OK;
 }
@@ -550,6 +550,19 @@ struct fileloader
     IDWriteFontFileLoader *loader;
 };
 
+#define SHAPED_RUN_CACHE_BUCKETS 256
+#define SHAPED_RUN_CACHE_MAX_SIZE (1024 * 1024)
+
+struct shaped_run_entry
+{
+    struct list entry;
+    struct list mru;
+    struct shaped_run_key key;
+    unsigned int hash;
+    size_t size;
+    struct shaped_run run;
+};
+
 struct dwritefactory
 {
     IDWriteFactory7 IDWriteFactory7_iface;
@@ -566,6 +579,15 @@ struct dwritefactory
     struct list collection_loaders;
     struct list file_loaders;
 
+    struct
+    {
+        struct list buckets[SHAPED_RUN_CACHE_BUCKETS];
+        struct list mru;
+        size_t size;
+        unsigned int hits;
+        unsigned int misses;
+    } shaped_runs;
+
     CRITICAL_SECTION cs;
 };
 
@@ -593,15 +615,28 @@ static void release_fileloader(struct fileloader *fileloader)
     heap_free(fileloader);
 }
 
+static void release_shaped_run_entry(struct dwritefactory *factory, struct shaped_run_entry *entry)
+{
+    list_remove(&entry->entry);
+    list_remove(&entry->mru);
+    factory->shaped_runs.size -= entry->size;
+    heap_free(entry);
+}
+
 static void release_dwritefactory(struct dwritefactory *factory)
 {
     struct fileloader *fileloader, *fileloader2;
     struct collectionloader *loader, *loader2;
+    struct shaped_run_entry *entry, *entry2;
 
     EnterCriticalSection(&factory->cs);
     release_fontface_cache(&factory->localfontfaces);
     LeaveCriticalSection(&factory->cs);
 
+    TRACE("Shaped run cache: %u hits, %u misses.\n", factory->shaped_runs.hits, factory->shaped_runs.misses);
+    LIST_FOR_EACH_ENTRY_SAFE(entry, entry2, &factory->shaped_runs.mru, struct shaped_run_entry, mru)
+        release_shaped_run_entry(factory, entry);
+
     LIST_FOR_EACH_ENTRY_SAFE(loader, loader2, &factory->collection_loaders, struct collectionloader, entry) {
         list_remove(&loader->entry);
         IDWriteFontCollectionLoader_Release(loader->loader);
@@ -862,6 +897,173 @@ void factory_unlock(IDWriteFactory7 *iface)
     LeaveCriticalSection(&factory->cs);
 }
 
+static unsigned int shaped_run_key_hash(const struct shaped_run_key *key)
+{
+    unsigned int hash = 2166136261u, i;
+
+    hash = (hash ^ (unsigned int)(ULONG_PTR)key->fontface) * 16777619u;
+    hash = (hash ^ key->length) * 16777619u;
+    for (i = 0; i < key->length; ++i)
+        hash = (hash ^ key->text[i]) * 16777619u;
+    hash = (hash ^ (unsigned int)(key->emsize * 64.0f)) * 16777619u;
+
+    return hash;
+}
+
+static BOOL shaped_run_key_equal(const struct shaped_run_key *key1, const struct shaped_run_key *key2)
+{
+    if (key1->fontface != key2->fontface
+            || key1->length != key2->length
+            || key1->sa.script != key2->sa.script
+            || key1->sa.shapes != key2->sa.shapes
+            || key1->is_sideways != key2->is_sideways
+            || key1->is_rtl != key2->is_rtl
+            || key1->emsize != key2->emsize
+            || key1->gdi_compatible != key2->gdi_compatible)
+        return FALSE;
+
+    if (key1->gdi_compatible && (key1->use_gdi_natural != key2->use_gdi_natural
+            || key1->ppdip != key2->ppdip
+            || memcmp(&key1->transform, &key2->transform, sizeof(key1->transform))))
+        return FALSE;
+
+    if (!key1->locale || !key2->locale)
+    {
+        if (key1->locale != key2->locale)
+            return FALSE;
+    }
+    else if (strcmpW(key1->locale, key2->locale))
+        return FALSE;
+
+    return !memcmp(key1->text, key2->text, key1->length * sizeof(*key1->text));
+}
+
+BOOL factory_get_shaped_run(IDWriteFactory7 *iface, const struct shaped_run_key *key, struct shaped_run *run)
+{
+    struct dwritefactory *factory = impl_from_IDWriteFactory7(iface);
+    unsigned int hash = shaped_run_key_hash(key);
+    struct shaped_run_entry *entry;
+    BOOL ret = FALSE;
+
+    EnterCriticalSection(&factory->cs);
+
+    LIST_FOR_EACH_ENTRY(entry, &factory->shaped_runs.buckets[hash % SHAPED_RUN_CACHE_BUCKETS],
+            struct shaped_run_entry, entry)
+    {
+        if (entry->hash != hash || !shaped_run_key_equal(&entry->key, key))
+            continue;
+
+        run->glyph_count = entry->run.glyph_count;
+        run->clustermap = heap_calloc(key->length, sizeof(*run->clustermap));
+        run->glyphs = heap_calloc(run->glyph_count, sizeof(*run->glyphs));
+        run->advances = heap_calloc(run->glyph_count, sizeof(*run->advances));
+        run->offsets = heap_calloc(run->glyph_count, sizeof(*run->offsets));
+        if (!run->clustermap || !run->glyphs || !run->advances || !run->offsets)
+        {
+            heap_free(run->clustermap);
+            heap_free(run->glyphs);
+            heap_free(run->advances);
+            heap_free(run->offsets);
+            break;
+        }
+
+        memcpy(run->clustermap, entry->run.clustermap, key->length * sizeof(*run->clustermap));
+        memcpy(run->glyphs, entry->run.glyphs, run->glyph_count * sizeof(*run->glyphs));
+        memcpy(run->advances, entry->run.advances, run->glyph_count * sizeof(*run->advances));
+        memcpy(run->offsets, entry->run.offsets, run->glyph_count * sizeof(*run->offsets));
+
+        list_remove(&entry->mru);
+        list_add_head(&factory->shaped_runs.mru, &entry->mru);
+        ret = TRUE;
+        break;
+    }
+
+    if (ret)
+        factory->shaped_runs.hits++;
+    else
+        factory->shaped_runs.misses++;
+
+    LeaveCriticalSection(&factory->cs);
+
+    return ret;
+}
+
+void factory_cache_shaped_run(IDWriteFactory7 *iface, const struct shaped_run_key *key, const struct shaped_run *run)
+{
+    struct dwritefactory *factory = impl_from_IDWriteFactory7(iface);
+    size_t locale_len = key->locale ? strlenW(key->locale) + 1 : 0;
+    struct shaped_run_entry *entry;
+    size_t size;
+    BYTE *ptr;
+
+    /* Variable sized data is stored after the entry, most strictly aligned first. */
+    size = sizeof(*entry) + run->glyph_count * (sizeof(*run->advances) + sizeof(*run->offsets)
+            + sizeof(*run->glyphs)) + key->length * (sizeof(*run->clustermap) + sizeof(*key->text))
+            + locale_len * sizeof(*key->locale);
+
+    if (size > SHAPED_RUN_CACHE_MAX_SIZE / 16)
+        return;
+
+    if (!(entry = heap_alloc(size)))
+        return;
+
+    entry->key = *key;
+    entry->hash = shaped_run_key_hash(key);
+    entry->size = size;
+    entry->run.glyph_count = run->glyph_count;
+
+    ptr = (BYTE *)(entry + 1);
+    entry->run.advances = (float *)ptr;
+    memcpy(ptr, run->advances, run->glyph_count * sizeof(*run->advances));
+    ptr += run->glyph_count * sizeof(*run->advances);
+    entry->run.offsets = (DWRITE_GLYPH_OFFSET *)ptr;
+    memcpy(ptr, run->offsets, run->glyph_count * sizeof(*run->offsets));
+    ptr += run->glyph_count * sizeof(*run->offsets);
+    entry->run.glyphs = (UINT16 *)ptr;
+    memcpy(ptr, run->glyphs, run->glyph_count * sizeof(*run->glyphs));
+    ptr += run->glyph_count * sizeof(*run->glyphs);
+    entry->run.clustermap = (UINT16 *)ptr;
+    memcpy(ptr, run->clustermap, key->length * sizeof(*run->clustermap));
+    ptr += key->length * sizeof(*run->clustermap);
+    entry->key.text = (WCHAR *)ptr;
+    memcpy(ptr, key->text, key->length * sizeof(*key->text));
+    ptr += key->length * sizeof(*key->text);
+    if (key->locale)
+    {
+        entry->key.locale = (WCHAR *)ptr;
+        memcpy(ptr, key->locale, locale_len * sizeof(*key->locale));
+    }
+
+    EnterCriticalSection(&factory->cs);
+
+    while (factory->shaped_runs.size + size > SHAPED_RUN_CACHE_MAX_SIZE)
+        release_shaped_run_entry(factory, LIST_ENTRY(list_tail(&factory->shaped_runs.mru),
+                struct shaped_run_entry, mru));
+
+    list_add_head(&factory->shaped_runs.buckets[entry->hash % SHAPED_RUN_CACHE_BUCKETS], &entry->entry);
+    list_add_head(&factory->shaped_runs.mru, &entry->mru);
+    factory->shaped_runs.size += size;
+
+    LeaveCriticalSection(&factory->cs);
+}
+
+/* Font faces are not referenced by the cache, their entries are removed on release instead. */
+void factory_release_shaped_runs(IDWriteFactory7 *iface, IDWriteFontFace *fontface)
+{
+    struct dwritefactory *factory = impl_from_IDWriteFactory7(iface);
+    struct shaped_run_entry *entry, *entry2;
+
+    EnterCriticalSection(&factory->cs);
+
+    LIST_FOR_EACH_ENTRY_SAFE(entry, entry2, &factory->shaped_runs.mru, struct shaped_run_entry, mru)
+    {
+        if (entry->key.fontface == fontface)
+            release_shaped_run_entry(factory, entry);
+    }
+
+    LeaveCriticalSection(&factory->cs);
+}
+
 HRESULT factory_get_cached_fontface(IDWriteFactory7 *iface, IDWriteFontFile * const *font_files, UINT32 index,
         DWRITE_FONT_SIMULATIONS simulations, struct list **cached_list, REFIID riid, void **obj)
 {
@@ -1872,6 +2074,8 @@ static const struct IDWriteFactory7Vtbl shareddwritefactoryvtbl =
 
 static void init_dwritefactory(struct dwritefactory *factory, DWRITE_FACTORY_TYPE type)
 {
+    unsigned int i;
+
     factory->IDWriteFactory7_iface.lpVtbl = type == DWRITE_FACTORY_TYPE_SHARED ?
             &shareddwritefactoryvtbl : &dwritefactoryvtbl;
     factory->refcount = 1;
@@ -1885,6 +2089,12 @@ static void init_dwritefactory(struct dwritefactory *factory, DWRITE_FACTORY_TYP
     list_init(&factory->file_loaders);
     list_init(&factory->localfontfaces);
 
+    for (i = 0; i < ARRAY_SIZE(factory->shaped_runs.buckets); ++i)
+        list_init(&factory->shaped_runs.buckets[i]);
+    list_init(&factory->shaped_runs.mru);
+    factory->shaped_runs.size = 0;
+    factory->shaped_runs.hits = factory->shaped_runs.misses = 0;
+
     InitializeCriticalSection(&factory->cs);
     factory->cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": dwritefactory.lock");
 }
@@ -466,6 +466,113 @@ static int get_overlap( const dib_info *dst, const RECT *dst_rect,
     return ret;
 }
 
+/* Operations covering at least this many pixels are split into bands of
+ * rows that are processed in parallel on the thread pool. Each band only
+ * touches its own rows, so the results are identical to a serial run. */
+#define MIN_BANDED_PIXELS  (512 * 512)
+#define MIN_BAND_ROWS      32
+#define MAX_BANDS          16
+
+struct band_job
+{
+    void (*func)( const RECT *rect, void *ctx );
+    void *ctx;
+    const RECT *rects;
+    int count;
+    int top, bottom;
+    int band_count;
+    LONG next;
+};
+
+static void process_band( struct band_job *job, int band )
+{
+    int top = job->top + (job->bottom - job->top) * band / job->band_count;
+    int bottom = job->top + (job->bottom - job->top) * (band + 1) / job->band_count;
+    RECT rect;
+    int i;
+
+    for (i = 0; i < job->count; i++)
+    {
+        rect = job->rects[i];
+        rect.top = max( rect.top, top );
+        rect.bottom = min( rect.bottom, bottom );
+        if (rect.top < rect.bottom) job->func( &rect, job->ctx );
+    }
+}
+
+static void CALLBACK band_callback( TP_CALLBACK_INSTANCE *instance, void *ctx, TP_WORK *work )
+{
+    struct band_job *job = ctx;
+    int band;
+
+    while ((band = InterlockedIncrement( &job->next ) - 1) < job->band_count)
+        process_band( job, band );
+}
+
+static void run_banded( const RECT *rects, int count, void (*func)( const RECT *rect, void *ctx ), void *ctx )
+{
+    struct band_job job;
+    SYSTEM_INFO info;
+    SIZE_T pixels = 0;
+    TP_WORK *work;
+    int i;
+
+    job.top = INT_MAX;
+    job.bottom = INT_MIN;
+    for (i = 0; i < count; i++)
+    {
+        pixels += (SIZE_T)(rects[i].right - rects[i].left) * (rects[i].bottom - rects[i].top);
+        job.top = min( job.top, rects[i].top );
+        job.bottom = max( job.bottom, rects[i].bottom );
+    }
+
+    job.band_count = 1;
+    if (pixels >= MIN_BANDED_PIXELS)
+    {
+        GetSystemInfo( &info );
+        job.band_count = min( min( info.dwNumberOfProcessors, MAX_BANDS ), (job.bottom - job.top) / MIN_BAND_ROWS );
+    }
+
+    if (job.band_count < 2 || !(work = CreateThreadpoolWork( band_callback, &job, NULL )))
+    {
+        for (i = 0; i < count; i++) func( &rects[i], ctx );
+        return;
+    }
+
+    TRACE( "splitting %u pixels into %d bands\n", (unsigned int)pixels, job.band_count );
+
+    job.func = func;
+    job.ctx = ctx;
+    job.rects = rects;
+    job.count = count;
+    job.next = 0;
+    for (i = 1; i < job.band_count; i++) SubmitThreadpoolWork( work );
+    band_callback( NULL, &job, work );
+    /* every band has been claimed by now, so callbacks that haven't started have nothing left to do;
+     * cancel them rather than waiting for pool threads that may never start */
+    WaitForThreadpoolWorkCallbacks( work, TRUE );
+    CloseThreadpoolWork( work );
+}
+
+struct copy_rect_params
+{
+    dib_info *dst;
+    const RECT *dst_rect;
+    const dib_info *src;
+    const RECT *src_rect;
+    INT rop2;
+};
+
+static void copy_rect_band( const RECT *rect, void *ctx )
+{
+    const struct copy_rect_params *params = ctx;
+    POINT origin;
+
+    origin.x = params->src_rect->left + rect->left - params->dst_rect->left;
+    origin.y = params->src_rect->top  + rect->top  - params->dst_rect->top;
+    params->dst->funcs->copy_rect( params->dst, rect, params->src, &origin, params->rop2, 0 );
+}
+
 static void copy_rect( dib_info *dst, const RECT *dst_rect, const dib_info *src, const RECT *src_rect,
                         const struct clipped_rects *clipped_rects, INT rop2 )
 {
@@ -541,7 +648,7 @@ static void copy_rect( dib_info *dst, const RECT *dst_rect, const dib_info *src,
             }
         }
     }
-    else  /* left to right, top to bottom */
+    else if (overlap)  /* left to right, top to bottom */
     {
         for (i = 0; i < count; i++)
         {
@@ -550,6 +657,12 @@ static void copy_rect( dib_info *dst, const RECT *dst_rect, const dib_info *src,
             dst->funcs->copy_rect( dst, &rects[i], src, &origin, rop2, overlap );
         }
     }
+    else
+    {
+        struct copy_rect_params params = { dst, dst_rect, src, src_rect, rop2 };
+
+        run_banded( rects, count, copy_rect_band, &params );
+    }
 }
 
 static void mask_rect( dib_info *dst, const RECT *dst_rect, const dib_info *src, const RECT *src_rect,
@@ -581,20 +694,33 @@ static void mask_rect( dib_info *dst, const RECT *dst_rect, const dib_info *src,
     }
 }
 
+struct blend_rect_params
+{
+    dib_info *dst;
+    const RECT *dst_rect;
+    const dib_info *src;
+    const RECT *src_rect;
+    BLENDFUNCTION blend;
+};
+
+static void blend_rect_band( const RECT *rect, void *ctx )
+{
+    const struct blend_rect_params *params = ctx;
+    POINT origin;
+
+    origin.x = params->src_rect->left + rect->left - params->dst_rect->left;
+    origin.y = params->src_rect->top  + rect->top  - params->dst_rect->top;
+    params->dst->funcs->blend_rect( params->dst, rect, params->src, &origin, params->blend );
+}
+
 static DWORD blend_rect( dib_info *dst, const RECT *dst_rect, const dib_info *src, const RECT *src_rect,
                          HRGN clip, BLENDFUNCTION blend )
 {
-    POINT origin;
+    struct blend_rect_params params = { dst, dst_rect, src, src_rect, blend };
     struct clipped_rects clipped_rects;
-    int i;
 
     if (!get_clipped_rects( dst, dst_rect, clip, &clipped_rects )) return ERROR_SUCCESS;
-    for (i = 0; i < clipped_rects.count; i++)
-    {
-        origin.x = src_rect->left + clipped_rects.rects[i].left - dst_rect->left;
-        origin.y = src_rect->top  + clipped_rects.rects[i].top  - dst_rect->top;
-        dst->funcs->blend_rect( dst, &clipped_rects.rects[i], src, &origin, blend );
-    }
+    run_banded( clipped_rects.rects, clipped_rects.count, blend_rect_band, &params );
     free_clipped_rects( &clipped_rects );
     return ERROR_SUCCESS;
 }
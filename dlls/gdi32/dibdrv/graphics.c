@@ -43,10 +43,17 @@ enum glyph_type
 #define GLYPH_CACHE_PAGE_SIZE  0x100
 #define GLYPH_CACHE_PAGES      (0x10000 / GLYPH_CACHE_PAGE_SIZE)
 
+/* Unused fonts are kept around, least recently used first to go, until
+ * there are too many of them or their glyphs take too much memory. */
+#define FONT_CACHE_MIN_UNUSED  5
+#define FONT_CACHE_MAX_UNUSED  256
+#define FONT_CACHE_MAX_SIZE    (16 * 1024 * 1024)
+
 struct cached_font
 {
     struct list           entry;
     LONG                  ref;
+    LONG                  size;  /* total size of the cached glyphs */
     DWORD                 hash;
     LOGFONTW              lf;
     XFORM                 xform;
@@ -554,10 +561,29 @@ static int font_cache_cmp( const struct cached_font *p1, const struct cached_fon
     return ret;
 }
 
+static void free_cached_font( struct cached_font *font )
+{
+    UINT i, j, k;
+
+    for (i = 0; i < GLYPH_NBTYPES; i++)
+    {
+        for (j = 0; j < GLYPH_CACHE_PAGES; j++)
+        {
+            if (!font->glyphs[i][j]) continue;
+            for (k = 0; k < GLYPH_CACHE_PAGE_SIZE; k++)
+                HeapFree( GetProcessHeap(), 0, font->glyphs[i][j][k] );
+            HeapFree( GetProcessHeap(), 0, font->glyphs[i][j] );
+        }
+    }
+    list_remove( &font->entry );
+    HeapFree( GetProcessHeap(), 0, font );
+}
+
 static struct cached_font *add_cached_font( DC *dc, HFONT hfont, UINT aa_flags )
 {
-    struct cached_font font, *ptr, *last_unused = NULL;
-    UINT i = 0, j, k;
+    struct cached_font font, *ptr, *next;
+    UINT unused = 0;
+    SIZE_T size = 0;
 
     GetObjectW( hfont, sizeof(font.lf), &font.lf );
     font.xform = dc->xformWorld2Vport;
@@ -581,29 +607,22 @@ static struct cached_font *add_cached_font( DC *dc, HFONT hfont, UINT aa_flags )
             list_remove( &ptr->entry );
             goto done;
         }
-        if (!ptr->ref)
-        {
-            i++;
-            last_unused = ptr;
-        }
+        if (!ptr->ref) unused++;
+        size += ptr->size;
     }
 
-    if (i > 5)  /* keep at least 5 of the most-recently used fonts around */
+    LIST_FOR_EACH_ENTRY_SAFE_REV( ptr, next, &font_cache, struct cached_font, entry )
     {
-        ptr = last_unused;
-        for (i = 0; i < GLYPH_NBTYPES; i++)
-        {
-            for (j = 0; j < GLYPH_CACHE_PAGES; j++)
-            {
-                if (!ptr->glyphs[i][j]) continue;
-                for (k = 0; k < GLYPH_CACHE_PAGE_SIZE; k++)
-                    HeapFree( GetProcessHeap(), 0, ptr->glyphs[i][j][k] );
-                HeapFree( GetProcessHeap(), 0, ptr->glyphs[i][j] );
-            }
-        }
-        list_remove( &ptr->entry );
+        if (unused <= FONT_CACHE_MIN_UNUSED) break;
+        if (unused <= FONT_CACHE_MAX_UNUSED && size <= FONT_CACHE_MAX_SIZE) break;
+        if (ptr->ref) continue;
+        TRACE( "evicting %p, %d bytes\n", ptr, ptr->size );
+        size -= ptr->size;
+        unused--;
+        free_cached_font( ptr );
     }
-    else if (!(ptr = HeapAlloc( GetProcessHeap(), 0, sizeof(*ptr) )))
+
+    if (!(ptr = HeapAlloc( GetProcessHeap(), 0, sizeof(*ptr) )))
     {
         LeaveCriticalSection( &font_cache_cs );
         return NULL;
@@ -611,6 +630,7 @@ static struct cached_font *add_cached_font( DC *dc, HFONT hfont, UINT aa_flags )
 
     *ptr = font;
     ptr->ref = 1;
+    ptr->size = 0;
     memset( ptr->glyphs, 0, sizeof(ptr->glyphs) );
 done:
     list_add_head( &font_cache, &ptr->entry );
@@ -646,7 +666,11 @@ static struct cached_glyph *add_cached_glyph( struct cached_font *font, UINT ind
             HeapFree( GetProcessHeap(), 0, ptr );
     }
     ret = InterlockedCompareExchangePointer( (void **)&font->glyphs[type][page][entry], glyph, NULL );
-    if (!ret) ret = glyph;
+    if (!ret)
+    {
+        ret = glyph;
+        InterlockedExchangeAdd( &font->size, HeapSize( GetProcessHeap(), 0, glyph ));
+    }
     else HeapFree( GetProcessHeap(), 0, glyph );
     return ret;
 }
@@ -19,6 +19,9 @@
  */
 
 #include <assert.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "gdi_private.h"
 #include "dibdrv.h"
@@ -264,10 +267,38 @@ static inline void memset_16( WORD *start, WORD val, DWORD size )
 #endif
 }
 
+static inline void do_rop_row_32( DWORD *ptr, DWORD and, DWORD xor, int len )
+{
+#ifdef __SSE2__
+    __m128i and_mask = _mm_set1_epi32( and ), xor_mask = _mm_set1_epi32( xor );
+
+    for (; len >= 4; len -= 4, ptr += 4)
+    {
+        __m128i val = _mm_loadu_si128( (const __m128i *)ptr );
+        _mm_storeu_si128( (__m128i *)ptr, _mm_xor_si128( _mm_and_si128( val, and_mask ), xor_mask ));
+    }
+#endif
+    while (len--) do_rop_32( ptr++, and, xor );
+}
+
+static inline void do_rop_row_16( WORD *ptr, WORD and, WORD xor, int len )
+{
+#ifdef __SSE2__
+    __m128i and_mask = _mm_set1_epi16( and ), xor_mask = _mm_set1_epi16( xor );
+
+    for (; len >= 8; len -= 8, ptr += 8)
+    {
+        __m128i val = _mm_loadu_si128( (const __m128i *)ptr );
+        _mm_storeu_si128( (__m128i *)ptr, _mm_xor_si128( _mm_and_si128( val, and_mask ), xor_mask ));
+    }
+#endif
+    while (len--) do_rop_16( ptr++, and, xor );
+}
+
 static void solid_rects_32(const dib_info *dib, int num, const RECT *rc, DWORD and, DWORD xor)
 {
-    DWORD *ptr, *start;
-    int x, y, i;
+    DWORD *start;
+    int y, i;
 
     for(i = 0; i < num; i++, rc++)
     {
@@ -276,8 +307,7 @@ static void solid_rects_32(const dib_info *dib, int num, const RECT *rc, DWORD a
         start = get_pixel_ptr_32(dib, rc->left, rc->top);
         if (and)
             for(y = rc->top; y < rc->bottom; y++, start += dib->stride / 4)
-                for(x = rc->left, ptr = start; x < rc->right; x++)
-                    do_rop_32(ptr++, and, xor);
+                do_rop_row_32( start, and, xor, rc->right - rc->left );
         else
             for(y = rc->top; y < rc->bottom; y++, start += dib->stride / 4)
                 memset_32( start, xor, rc->right - rc->left );
@@ -417,8 +447,8 @@ static void solid_rects_24(const dib_info *dib, int num, const RECT *rc, DWORD a
 
 static void solid_rects_16(const dib_info *dib, int num, const RECT *rc, DWORD and, DWORD xor)
 {
-    WORD *ptr, *start;
-    int x, y, i;
+    WORD *start;
+    int y, i;
 
     for(i = 0; i < num; i++, rc++)
     {
@@ -427,8 +457,7 @@ static void solid_rects_16(const dib_info *dib, int num, const RECT *rc, DWORD a
         start = get_pixel_ptr_16(dib, rc->left, rc->top);
         if (and)
             for(y = rc->top; y < rc->bottom; y++, start += dib->stride / 2)
-                for(x = rc->left, ptr = start; x < rc->right; x++)
-                    do_rop_16(ptr++, and, xor);
+                do_rop_row_16( start, and, xor, rc->right - rc->left );
         else
             for(y = rc->top; y < rc->bottom; y++, start += dib->stride / 2)
                 memset_16( start, xor, rc->right - rc->left );
@@ -4651,32 +4680,122 @@ static inline DWORD blend_rgb( BYTE dst_r, BYTE dst_g, BYTE dst_b, DWORD src, BL
             blend_color( dst_r, src >> 16, blend.SourceConstantAlpha ) << 16);
 }
 
+#ifdef __SSE2__
+
+/* Exact (x + 127) / 255 for each 16-bit lane, x <= 255 * 255. */
+static inline __m128i div255_epu16( __m128i x )
+{
+    x = _mm_add_epi16( x, _mm_set1_epi16( 127 ));
+    return _mm_srli_epi16( _mm_add_epi16( _mm_add_epi16( x, _mm_set1_epi16( 1 )), _mm_srli_epi16( x, 8 )), 8 );
+}
+
+static inline __m128i broadcast_alpha_epi16( __m128i x )
+{
+    x = _mm_shufflelo_epi16( x, _MM_SHUFFLE( 3, 3, 3, 3 ));
+    return _mm_shufflehi_epi16( x, _MM_SHUFFLE( 3, 3, 3, 3 ));
+}
+
+/* Pack the 16-bit channels back into pixels. Channels may exceed 255 when the
+ * source isn't properly premultiplied; the ninth bit then ends up in the next
+ * channel, exactly like the shifts and ors in blend_argb(). */
+static inline __m128i pack_channels_epi16( __m128i lo, __m128i hi )
+{
+    __m128i byte_mask = _mm_set1_epi16( 0xff );
+    __m128i val = _mm_packus_epi16( _mm_and_si128( lo, byte_mask ), _mm_and_si128( hi, byte_mask ));
+    __m128i carry = _mm_packus_epi16( _mm_srli_epi16( lo, 8 ), _mm_srli_epi16( hi, 8 ));
+
+    return _mm_or_si128( val, _mm_slli_epi32( carry, 8 ));
+}
+
+static inline __m128i blend_argb_sse2( __m128i dst, __m128i src, __m128i alpha, BOOL use_alpha )
+{
+    __m128i zero = _mm_setzero_si128(), ff = _mm_set1_epi16( 0xff );
+    __m128i src_lo = _mm_unpacklo_epi8( src, zero ), src_hi = _mm_unpackhi_epi8( src, zero );
+    __m128i dst_lo = _mm_unpacklo_epi8( dst, zero ), dst_hi = _mm_unpackhi_epi8( dst, zero );
+    __m128i inv_lo, inv_hi;
+
+    if (use_alpha)
+    {
+        __m128i alpha_lo = _mm_unpacklo_epi8( alpha, zero ), alpha_hi = _mm_unpackhi_epi8( alpha, zero );
+
+        src_lo = div255_epu16( _mm_mullo_epi16( src_lo, alpha_lo ));
+        src_hi = div255_epu16( _mm_mullo_epi16( src_hi, alpha_hi ));
+    }
+    inv_lo = _mm_sub_epi16( ff, broadcast_alpha_epi16( src_lo ));
+    inv_hi = _mm_sub_epi16( ff, broadcast_alpha_epi16( src_hi ));
+    dst_lo = div255_epu16( _mm_mullo_epi16( dst_lo, inv_lo ));
+    dst_hi = div255_epu16( _mm_mullo_epi16( dst_hi, inv_hi ));
+
+    return pack_channels_epi16( _mm_add_epi16( src_lo, dst_lo ), _mm_add_epi16( src_hi, dst_hi ));
+}
+
+static inline __m128i blend_color_sse2( __m128i dst, __m128i src, __m128i alpha, __m128i inv_alpha )
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_add_epi16( _mm_mullo_epi16( _mm_unpacklo_epi8( src, zero ), alpha ),
+                                _mm_mullo_epi16( _mm_unpacklo_epi8( dst, zero ), inv_alpha ));
+    __m128i hi = _mm_add_epi16( _mm_mullo_epi16( _mm_unpackhi_epi8( src, zero ), alpha ),
+                                _mm_mullo_epi16( _mm_unpackhi_epi8( dst, zero ), inv_alpha ));
+
+    return _mm_packus_epi16( div255_epu16( lo ), div255_epu16( hi ));
+}
+
+/* Blend the first len & ~3 pixels of a row, and return how many were done. */
+static int blend_row_8888_sse2( DWORD *dst, const DWORD *src, int len, BLENDFUNCTION blend, BOOL src_alpha_ff )
+{
+    __m128i alpha = _mm_set1_epi8( blend.SourceConstantAlpha );
+    __m128i inv_alpha = _mm_set1_epi16( 255 - blend.SourceConstantAlpha );
+    __m128i alpha16 = _mm_set1_epi16( blend.SourceConstantAlpha );
+    __m128i alpha_mask = _mm_set1_epi32( src_alpha_ff ? 0xff000000 : 0 );
+    int x;
+
+    for (x = 0; x + 4 <= len; x += 4)
+    {
+        __m128i d = _mm_loadu_si128( (const __m128i *)(dst + x) );
+        __m128i s = _mm_loadu_si128( (const __m128i *)(src + x) );
+
+        if (!(blend.AlphaFormat & AC_SRC_ALPHA))
+            d = blend_color_sse2( d, _mm_or_si128( s, alpha_mask ), alpha16, inv_alpha );
+        else if (blend.SourceConstantAlpha == 255)
+            d = blend_argb_sse2( d, s, alpha, FALSE );
+        else
+            d = blend_argb_sse2( d, s, alpha, TRUE );
+        _mm_storeu_si128( (__m128i *)(dst + x), d );
+    }
+    return x;
+}
+
+#endif
+
 static void blend_rect_8888(const dib_info *dst, const RECT *rc,
                             const dib_info *src, const POINT *origin, BLENDFUNCTION blend)
 {
     DWORD *src_ptr = get_pixel_ptr_32( src, origin->x, origin->y );
     DWORD *dst_ptr = get_pixel_ptr_32( dst, rc->left, rc->top );
-    int x, y;
+    int x, y, start = 0;
 
-    if (blend.AlphaFormat & AC_SRC_ALPHA)
+    for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
     {
-	if (blend.SourceConstantAlpha == 255)
-	    for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-		for (x = 0; x < rc->right - rc->left; x++)
-		    dst_ptr[x] = blend_argb( dst_ptr[x], src_ptr[x] );
+#ifdef __SSE2__
+        start = blend_row_8888_sse2( dst_ptr, src_ptr, rc->right - rc->left, blend,
+                                     src->compression != BI_RGB );
+#endif
+        if (blend.AlphaFormat & AC_SRC_ALPHA)
+        {
+            if (blend.SourceConstantAlpha == 255)
+                for (x = start; x < rc->right - rc->left; x++)
+                    dst_ptr[x] = blend_argb( dst_ptr[x], src_ptr[x] );
+            else
+                for (x = start; x < rc->right - rc->left; x++)
+                    dst_ptr[x] = blend_argb_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
+        }
+        else if (src->compression == BI_RGB)
+            for (x = start; x < rc->right - rc->left; x++)
+                dst_ptr[x] = blend_argb_constant_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
         else
-	    for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-		for (x = 0; x < rc->right - rc->left; x++)
-		    dst_ptr[x] = blend_argb_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
-    }
-    else if (src->compression == BI_RGB)
-	for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-	    for (x = 0; x < rc->right - rc->left; x++)
-		dst_ptr[x] = blend_argb_constant_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
-    else
-	for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-	    for (x = 0; x < rc->right - rc->left; x++)
-		dst_ptr[x] = blend_argb_no_src_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
+            for (x = start; x < rc->right - rc->left; x++)
+                dst_ptr[x] = blend_argb_no_src_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
+    }
 }
 
 static void blend_rect_32(const dib_info *dst, const RECT *rc,
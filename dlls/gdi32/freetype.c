@@ -575,6 +575,7 @@ static const WCHAR wine_fonts_key[] = {'S','o','f','t','w','a','r','e','\\','W',
                                        'F','o','n','t','s',0};
 static const WCHAR wine_fonts_cache_key[] = {'C','a','c','h','e',0};
 static const WCHAR english_name_value[] = {'E','n','g','l','i','s','h',' ','N','a','m','e',0};
+static const WCHAR list_cache_session_value[] = {'L','i','s','t',' ','C','a','c','h','e',' ','S','e','s','s','i','o','n',0};
 static const WCHAR face_index_value[] = {'I','n','d','e','x',0};
 static const WCHAR face_ntmflags_value[] = {'N','t','m','f','l','a','g','s',0};
 static const WCHAR face_version_value[] = {'V','e','r','s','i','o','n',0};
@@ -1867,6 +1868,9 @@ static void add_face_to_cache(Face *face)
     HKEY hkey_family, hkey_face;
     WCHAR *face_key_name;
 
+    /* the font list cache no longer matches the registry cache */
+    RegDeleteValueW( hkey_font_cache, list_cache_session_value );
+
     RegCreateKeyExW( hkey_font_cache, face->family->family_name, 0, NULL, REG_OPTION_VOLATILE,
                      KEY_ALL_ACCESS, NULL, &hkey_family, NULL );
     if (face->family->english_name[0])
@@ -1914,6 +1918,8 @@ static void remove_face_from_cache( Face *face )
 {
     HKEY hkey_family;
 
+    RegDeleteValueW( hkey_font_cache, list_cache_session_value );
+
     RegOpenKeyExW( hkey_font_cache, face->family->family_name, 0, KEY_ALL_ACCESS, &hkey_family );
 
     if (face->scalable)
@@ -4406,6 +4412,349 @@ static void reorder_font_list(void)
     default_sans = set_default( default_sans_list );
 }
 
+/* Binary cache of the font list, much like FNTCACHE.DAT on Windows. It is
+ * mapped read-only by later processes of a session instead of walking the
+ * volatile registry cache. Like the registry cache it is rebuilt by the first
+ * process of every session; the session identifier is stored both in the file
+ * and in the volatile registry key, so a file left over from an earlier
+ * session, or one that no longer matches the registry cache, is ignored. */
+
+#define FONT_LIST_CACHE_MAGIC    0x4c465457  /* "WTFL" */
+#define FONT_LIST_CACHE_VERSION  2
+#define FONT_LIST_CACHE_NO_STRING (~0u)
+
+struct font_list_cache_header
+{
+    DWORD magic;
+    DWORD version;
+    DWORD lcid;
+    DWORD aa_flags;
+    DWORD face_count;
+    DWORD strings_size;
+    ULONGLONG session;
+};
+
+struct font_list_cache_face
+{
+    DWORD family_name;  /* offsets in the string table */
+    DWORD english_name;
+    DWORD style_name;
+    DWORD full_name;
+    DWORD file;
+    DWORD face_index;
+    DWORD ntm_flags;
+    DWORD flags;
+    LONG font_version;
+    DWORD scalable;
+    FONTSIGNATURE fs;
+    SHORT height;
+    SHORT width;
+    SHORT internal_leading;
+    SHORT reserved;
+    LONG size;
+    LONG x_ppem;
+    LONG y_ppem;
+};
+
+struct font_list_cache_strings
+{
+    char *data;
+    DWORD size;
+    DWORD capacity;
+};
+
+static char *get_font_list_cache_path(void)
+{
+    static const WCHAR fntcacheW[] = {'\\','f','n','t','c','a','c','h','e','.','d','a','t',0};
+    WCHAR path[MAX_PATH];
+    UINT len;
+
+    len = GetSystemDirectoryW( path, ARRAY_SIZE(path) );
+    if (!len || len + ARRAY_SIZE(fntcacheW) > ARRAY_SIZE(path)) return NULL;
+    strcatW( path, fntcacheW );
+    return wine_get_unix_file_name( path );
+}
+
+static const WCHAR *get_cache_stringW( const char *strings, DWORD size, DWORD offset )
+{
+    const WCHAR *str;
+    DWORD i;
+
+    if (offset == FONT_LIST_CACHE_NO_STRING || offset >= size || (offset & 1)) return NULL;
+    str = (const WCHAR *)(strings + offset);
+    for (i = 0; i < (size - offset) / sizeof(WCHAR); i++)
+        if (!str[i]) return str;
+    return NULL;
+}
+
+static DWORD add_cache_string( struct font_list_cache_strings *strings, const void *str, DWORD size )
+{
+    DWORD offset = (strings->size + 1) & ~1;
+
+    if (offset + size > strings->capacity)
+    {
+        DWORD new_capacity = max( strings->capacity * 2, offset + size + 4096 );
+        char *new_data;
+
+        if (strings->data) new_data = HeapReAlloc( GetProcessHeap(), 0, strings->data, new_capacity );
+        else new_data = HeapAlloc( GetProcessHeap(), 0, new_capacity );
+        if (!new_data) return FONT_LIST_CACHE_NO_STRING;
+        strings->data = new_data;
+        strings->capacity = new_capacity;
+    }
+    if (offset > strings->size) strings->data[strings->size] = 0;
+    memcpy( strings->data + offset, str, size );
+    strings->size = offset + size;
+    return offset;
+}
+
+static DWORD add_cache_stringW( struct font_list_cache_strings *strings, const WCHAR *str )
+{
+    if (!str) return FONT_LIST_CACHE_NO_STRING;
+    return add_cache_string( strings, str, (strlenW( str ) + 1) * sizeof(WCHAR) );
+}
+
+static void load_face_from_list_cache( const struct font_list_cache_face *entry, Family *family,
+                                       const char *strings, DWORD size )
+{
+    const WCHAR *file, *style_name, *full_name;
+    Face *face;
+
+    file = get_cache_stringW( strings, size, entry->file );
+    style_name = get_cache_stringW( strings, size, entry->style_name );
+    full_name = get_cache_stringW( strings, size, entry->full_name );
+    if (!file || !style_name || !full_name) return;
+
+    if (!(face = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(*face) ))) return;
+    face->refcount = 1;
+    face->file = strdupW( file );
+    face->style_name = strdupW( style_name );
+    face->full_name = strdupW( full_name );
+    face->face_index = entry->face_index;
+    face->ntmFlags = entry->ntm_flags;
+    face->font_version = entry->font_version;
+    face->flags = entry->flags;
+    face->fs = entry->fs;
+    face->scalable = entry->scalable;
+    if (!face->scalable)
+    {
+        face->size.height = entry->height;
+        face->size.width = entry->width;
+        face->size.size = entry->size;
+        face->size.x_ppem = entry->x_ppem;
+        face->size.y_ppem = entry->y_ppem;
+        face->size.internal_leading = entry->internal_leading;
+    }
+
+    if (insert_face_in_family_list( face, family ))
+        TRACE( "Added face %s to family %s\n", debugstr_w(face->full_name), debugstr_w(family->family_name) );
+    release_face( face );
+}
+
+static ULONGLONG get_list_cache_session(void)
+{
+    ULONGLONG session;
+    DWORD type, size = sizeof(session);
+
+    if (RegQueryValueExW( hkey_font_cache, list_cache_session_value, NULL, &type, (BYTE *)&session, &size ) ||
+        type != REG_QWORD || size != sizeof(session))
+        return 0;
+    return session;
+}
+
+static BOOL load_font_list_from_list_cache(void)
+{
+    const struct font_list_cache_header *header;
+    const struct font_list_cache_face *faces;
+    const WCHAR *family_name, *english_name, *prev_name = NULL;
+    Family *family = NULL;
+    ULONGLONG session;
+    const char *strings;
+    BOOL ret = FALSE;
+    struct stat st;
+    char *path;
+    void *data;
+    DWORD i;
+    int fd;
+
+    if (!(session = get_list_cache_session())) return FALSE;
+    if (!(path = get_font_list_cache_path())) return FALSE;
+    fd = open( path, O_RDONLY );
+    HeapFree( GetProcessHeap(), 0, path );
+    if (fd == -1) return FALSE;
+    if (fstat( fd, &st ) == -1 || st.st_size < sizeof(*header) || st.st_size > 0x7fffffff)
+    {
+        close( fd );
+        return FALSE;
+    }
+    data = mmap( NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+    close( fd );
+    if (data == MAP_FAILED) return FALSE;
+
+    header = data;
+    if (header->magic != FONT_LIST_CACHE_MAGIC || header->version != FONT_LIST_CACHE_VERSION ||
+        header->session != session ||
+        header->lcid != GetSystemDefaultLCID() || header->aa_flags != default_aa_flags ||
+        sizeof(*header) + (ULONGLONG)header->face_count * sizeof(*faces) + header->strings_size != st.st_size)
+    {
+        TRACE( "ignoring outdated font list cache\n" );
+        goto done;
+    }
+
+    faces = (const struct font_list_cache_face *)(header + 1);
+    strings = (const char *)(faces + header->face_count);
+
+    TRACE( "loading %u faces from the font list cache\n", header->face_count );
+
+    /* faces are stored grouped by family, in family name order */
+    for (i = 0; i < header->face_count; i++)
+    {
+        if (!(family_name = get_cache_stringW( strings, header->strings_size, faces[i].family_name )))
+            continue;
+
+        if (!prev_name || strcmpW( family_name, prev_name ))
+        {
+            if (family) release_family( family );
+            english_name = get_cache_stringW( strings, header->strings_size, faces[i].english_name );
+            family = create_family( (WCHAR *)family_name, (WCHAR *)english_name );
+            prev_name = family_name;
+
+            if (english_name)
+            {
+                FontSubst *subst = HeapAlloc( GetProcessHeap(), 0, sizeof(*subst) );
+                subst->from.name = strdupW( english_name );
+                subst->from.charset = -1;
+                subst->to.name = strdupW( family_name );
+                subst->to.charset = -1;
+                add_font_subst( &font_subst_list, subst, 0 );
+            }
+        }
+        load_face_from_list_cache( &faces[i], family, strings, header->strings_size );
+    }
+    if (family) release_family( family );
+
+    reorder_vertical_fonts();
+    ret = TRUE;
+
+done:
+    munmap( data, st.st_size );
+    return ret;
+}
+
+static int family_name_cmp( const void *a, const void *b )
+{
+    const Family *f1 = *(const Family * const *)a, *f2 = *(const Family * const *)b;
+
+    return strcmpiW( f1->family_name, f2->family_name );
+}
+
+static void save_font_list_to_list_cache(void)
+{
+    struct font_list_cache_strings strings = {NULL, 0, 0};
+    struct font_list_cache_header header;
+    struct font_list_cache_face *faces = NULL, *entry;
+    unsigned int i, family_count = 0, face_count = 0;
+    Family **families = NULL, *family;
+    char *path = NULL, *tmp_path = NULL;
+    DWORD family_name, english_name;
+    ULARGE_INTEGER session;
+    FILETIME time;
+    BOOL ret = FALSE;
+    Face *face;
+    int fd;
+
+    LIST_FOR_EACH_ENTRY( family, &font_list, Family, entry )
+    {
+        family_count++;
+        LIST_FOR_EACH_ENTRY( face, &family->faces, Face, entry ) face_count++;
+    }
+    if (!(families = HeapAlloc( GetProcessHeap(), 0, family_count * sizeof(*families) ))) goto done;
+    if (!(faces = HeapAlloc( GetProcessHeap(), 0, face_count * sizeof(*faces) ))) goto done;
+
+    i = 0;
+    LIST_FOR_EACH_ENTRY( family, &font_list, Family, entry ) families[i++] = family;
+    qsort( families, family_count, sizeof(*families), family_name_cmp );
+
+    entry = faces;
+    for (i = 0; i < family_count; i++)
+    {
+        family = families[i];
+        family_name = add_cache_stringW( &strings, family->family_name );
+        english_name = family->english_name[0] ? add_cache_stringW( &strings, family->english_name )
+                                               : FONT_LIST_CACHE_NO_STRING;
+
+        LIST_FOR_EACH_ENTRY( face, &family->faces, Face, entry )
+        {
+            if (!(face->flags & ADDFONT_ADD_TO_CACHE) || !face->file) continue;
+
+            memset( entry, 0, sizeof(*entry) );
+            entry->family_name = family_name;
+            entry->english_name = english_name;
+            entry->style_name = add_cache_stringW( &strings, face->style_name );
+            entry->full_name = add_cache_stringW( &strings, face->full_name );
+            entry->file = add_cache_stringW( &strings, face->file );
+            entry->face_index = face->face_index;
+            entry->ntm_flags = face->ntmFlags;
+            entry->flags = face->flags;
+            entry->font_version = face->font_version;
+            entry->scalable = face->scalable;
+            entry->fs = face->fs;
+            if (!face->scalable)
+            {
+                entry->height = face->size.height;
+                entry->width = face->size.width;
+                entry->size = face->size.size;
+                entry->x_ppem = face->size.x_ppem;
+                entry->y_ppem = face->size.y_ppem;
+                entry->internal_leading = face->size.internal_leading;
+            }
+            entry++;
+        }
+    }
+    face_count = entry - faces;
+
+    /* any value unique to this session will do */
+    GetSystemTimeAsFileTime( &time );
+    session.u.LowPart = time.dwLowDateTime ^ GetCurrentProcessId();
+    session.u.HighPart = time.dwHighDateTime | 1;
+
+    header.magic = FONT_LIST_CACHE_MAGIC;
+    header.version = FONT_LIST_CACHE_VERSION;
+    header.lcid = GetSystemDefaultLCID();
+    header.aa_flags = default_aa_flags;
+    header.face_count = face_count;
+    header.strings_size = strings.size;
+    header.session = session.QuadPart;
+
+    /* write to a temporary file first, other processes may have the cache mapped */
+    if (!(path = get_font_list_cache_path())) goto done;
+    if (!(tmp_path = HeapAlloc( GetProcessHeap(), 0, strlen( path ) + 16 ))) goto done;
+    sprintf( tmp_path, "%s.%x", path, GetCurrentProcessId() );
+    if ((fd = open( tmp_path, O_CREAT | O_TRUNC | O_WRONLY, 0644 )) == -1) goto done;
+    ret = write( fd, &header, sizeof(header) ) == sizeof(header) &&
+          write( fd, faces, face_count * sizeof(*faces) ) == face_count * sizeof(*faces) &&
+          write( fd, strings.data, strings.size ) == strings.size;
+    close( fd );
+    if (!ret || rename( tmp_path, path ) == -1)
+    {
+        WARN( "failed to write font list cache %s\n", debugstr_a(path) );
+        unlink( tmp_path );
+    }
+    else
+    {
+        RegSetValueExW( hkey_font_cache, list_cache_session_value, 0, REG_QWORD,
+                        (BYTE *)&session.QuadPart, sizeof(session.QuadPart) );
+        TRACE( "saved %u faces to %s\n", face_count, debugstr_a(path) );
+    }
+
+done:
+    HeapFree( GetProcessHeap(), 0, tmp_path );
+    HeapFree( GetProcessHeap(), 0, path );
+    HeapFree( GetProcessHeap(), 0, faces );
+    HeapFree( GetProcessHeap(), 0, families );
+    HeapFree( GetProcessHeap(), 0, strings.data );
+}
+
 /*************************************************************
  *    WineEngInit
  *
@@ -4453,8 +4802,11 @@ BOOL WineEngInit(void)
     create_font_cache_key(&hkey_font_cache, &disposition);
 
     if(disposition == REG_CREATED_NEW_KEY)
+    {
         init_font_list();
-    else
+        save_font_list_to_list_cache();
+    }
+    else if (!load_font_list_from_list_cache())
         load_font_list_from_cache(hkey_font_cache);
 
     reorder_font_list();
@@ -4304,6 +4304,258 @@ end:
     return retval;
 }
 
+static BOOL is_antialiased(GpGraphics *graphics)
+{
+    return graphics->smoothing != SmoothingModeDefault &&
+        graphics->smoothing != SmoothingModeNone &&
+        graphics->smoothing != SmoothingModeHighSpeed;
+}
+
+/* Coverage accumulation for antialiased fills. Every line of the flattened
+ * path adds the signed area it covers to the cells of the rows it crosses,
+ * and a running sum along each row then gives the winding-weighted coverage
+ * of each pixel. Rows have two extra cells for the area right of the last
+ * pixel. */
+struct coverage_buffer
+{
+    INT width, height;
+    REAL *cells;
+};
+
+static void coverage_add_line(struct coverage_buffer *buffer, REAL x0, REAL y0, REAL x1, REAL y1)
+{
+    REAL dir = 1.0f, dxdy, x, tmp;
+    INT y, y_end;
+
+    if (y0 == y1)
+        return;
+
+    /* Lines are split where they leave the buffer horizontally. The parts
+     * outside are moved onto the edge, which leaves the coverage inside the
+     * buffer unchanged. */
+    if ((x0 < 0.0f && x1 > 0.0f) || (x0 > 0.0f && x1 < 0.0f))
+    {
+        tmp = y0 + (y1 - y0) * -x0 / (x1 - x0);
+        coverage_add_line(buffer, x0, y0, 0.0f, tmp);
+        coverage_add_line(buffer, 0.0f, tmp, x1, y1);
+        return;
+    }
+    if ((x0 < buffer->width && x1 > buffer->width) || (x0 > buffer->width && x1 < buffer->width))
+    {
+        tmp = y0 + (y1 - y0) * (buffer->width - x0) / (x1 - x0);
+        coverage_add_line(buffer, x0, y0, buffer->width, tmp);
+        coverage_add_line(buffer, buffer->width, tmp, x1, y1);
+        return;
+    }
+    x0 = max(0.0f, min(x0, buffer->width));
+    x1 = max(0.0f, min(x1, buffer->width));
+
+    if (y0 > y1)
+    {
+        tmp = x0; x0 = x1; x1 = tmp;
+        tmp = y0; y0 = y1; y1 = tmp;
+        dir = -1.0f;
+    }
+
+    if (y1 <= 0.0f || y0 >= buffer->height)
+        return;
+
+    dxdy = (x1 - x0) / (y1 - y0);
+    x = x0;
+    if (y0 < 0.0f)
+    {
+        x -= y0 * dxdy;
+        y = 0;
+    }
+    else
+        y = floorf(y0);
+    y_end = min(buffer->height, ceilf(y1));
+
+    for (; y < y_end; y++)
+    {
+        REAL *row = buffer->cells + y * (buffer->width + 2);
+        REAL dy = min(y + 1, y1) - max(y, y0);
+        REAL x_next = x + dxdy * dy;
+        REAL d = dy * dir;
+        REAL left = max(0.0f, min(x, x_next)), right = min(buffer->width, max(x, x_next));
+        INT left_i = floorf(left), right_i = ceilf(right);
+
+        if (right_i <= left_i + 1)
+        {
+            /* The line stays within one pixel on this row. */
+            REAL mid = (x + x_next) * 0.5f - left_i;
+
+            row[left_i] += d - d * mid;
+            row[left_i + 1] += d * mid;
+        }
+        else
+        {
+            REAL s = 1.0f / (right - left);
+            REAL left_f = left - left_i, right_f = right - right_i + 1.0f;
+            REAL a0 = 0.5f * s * (1.0f - left_f) * (1.0f - left_f);
+            REAL am = 0.5f * s * right_f * right_f;
+            INT i;
+
+            row[left_i] += d * a0;
+            if (right_i == left_i + 2)
+                row[left_i + 1] += d * (1.0f - a0 - am);
+            else
+            {
+                REAL a1 = s * (1.5f - left_f);
+
+                row[left_i + 1] += d * (a1 - a0);
+                for (i = left_i + 2; i < right_i - 1; i++)
+                    row[i] += d * s;
+                row[right_i - 1] += d * (1.0f - a1 - (right_i - left_i - 3) * s - am);
+            }
+            row[right_i] += d * am;
+        }
+
+        x = x_next;
+    }
+}
+
+static GpStatus SOFTWARE_GdipFillPathAntialiased(GpGraphics *graphics, GpBrush *brush, GpPath *path)
+{
+    struct coverage_buffer buffer;
+    GpRectF graphics_bounds;
+    GpPath *flat_path;
+    GpMatrix transform;
+    GpPointF *points;
+    GpRect fill_area;
+    DWORD *pixel_data;
+    REAL min_x, min_y, max_x, max_y, offset;
+    INT i, x, y, start;
+    GpStatus stat;
+
+    stat = gdi_transform_acquire(graphics);
+    if (stat != Ok)
+        return stat;
+
+    stat = get_graphics_device_bounds(graphics, &graphics_bounds);
+
+    if (stat == Ok)
+        stat = get_graphics_transform(graphics, WineCoordinateSpaceGdiDevice,
+            CoordinateSpaceWorld, &transform);
+
+    if (stat == Ok)
+        stat = GdipClonePath(path, &flat_path);
+
+    if (stat != Ok)
+    {
+        gdi_transform_release(graphics);
+        return stat;
+    }
+
+    stat = GdipFlattenPath(flat_path, &transform, 0.25);
+    if (stat != Ok || !flat_path->pathdata.Count)
+    {
+        GdipDeletePath(flat_path);
+        gdi_transform_release(graphics);
+        return stat;
+    }
+
+    /* Without a pixel offset, pixel centers are at integer coordinates. */
+    if (graphics->pixeloffset == PixelOffsetModeHalf || graphics->pixeloffset == PixelOffsetModeHighQuality)
+        offset = 0.0f;
+    else
+        offset = 0.5f;
+
+    points = flat_path->pathdata.Points;
+    min_x = max_x = points[0].X;
+    min_y = max_y = points[0].Y;
+    for (i = 1; i < flat_path->pathdata.Count; i++)
+    {
+        min_x = min(min_x, points[i].X);
+        max_x = max(max_x, points[i].X);
+        min_y = min(min_y, points[i].Y);
+        max_y = max(max_y, points[i].Y);
+    }
+
+    fill_area.X = max(floorf(min_x + offset), graphics_bounds.X);
+    fill_area.Y = max(floorf(min_y + offset), graphics_bounds.Y);
+    fill_area.Width = min(ceilf(max_x + offset), graphics_bounds.X + graphics_bounds.Width) - fill_area.X;
+    fill_area.Height = min(ceilf(max_y + offset), graphics_bounds.Y + graphics_bounds.Height) - fill_area.Y;
+
+    if (fill_area.Width <= 0 || fill_area.Height <= 0)
+    {
+        GdipDeletePath(flat_path);
+        gdi_transform_release(graphics);
+        return Ok;
+    }
+
+    buffer.width = fill_area.Width;
+    buffer.height = fill_area.Height;
+    buffer.cells = heap_alloc_zero(sizeof(*buffer.cells) * (buffer.width + 2) * buffer.height);
+    pixel_data = heap_alloc_zero(sizeof(*pixel_data) * fill_area.Width * fill_area.Height);
+
+    if (!buffer.cells || !pixel_data)
+    {
+        heap_free(buffer.cells);
+        heap_free(pixel_data);
+        GdipDeletePath(flat_path);
+        gdi_transform_release(graphics);
+        return OutOfMemory;
+    }
+
+    for (i = 0; i < flat_path->pathdata.Count; i++)
+    {
+        points[i].X += offset - fill_area.X;
+        points[i].Y += offset - fill_area.Y;
+    }
+
+    /* Every figure is implicitly closed. */
+    for (start = 0, i = 1; i <= flat_path->pathdata.Count; i++)
+    {
+        if (i == flat_path->pathdata.Count ||
+            (flat_path->pathdata.Types[i] & PathPointTypePathTypeMask) == PathPointTypeStart)
+        {
+            coverage_add_line(&buffer, points[i - 1].X, points[i - 1].Y, points[start].X, points[start].Y);
+            start = i;
+        }
+        else
+            coverage_add_line(&buffer, points[i - 1].X, points[i - 1].Y, points[i].X, points[i].Y);
+    }
+
+    stat = brush_fill_pixels(graphics, brush, pixel_data, &fill_area, fill_area.Width);
+
+    if (stat == Ok)
+    {
+        for (y = 0; y < fill_area.Height; y++)
+        {
+            const REAL *row = buffer.cells + y * (buffer.width + 2);
+            DWORD *pixel = pixel_data + y * fill_area.Width;
+            REAL coverage = 0.0f, c;
+
+            for (x = 0; x < fill_area.Width; x++)
+            {
+                coverage += row[x];
+                c = fabsf(coverage);
+                if (flat_path->fill == FillModeAlternate)
+                {
+                    c = fmodf(c, 2.0f);
+                    if (c > 1.0f) c = 2.0f - c;
+                }
+                else if (c > 1.0f)
+                    c = 1.0f;
+
+                pixel[x] = (pixel[x] & 0xffffff) | ((DWORD)gdip_round((pixel[x] >> 24) * c) << 24);
+            }
+        }
+
+        stat = alpha_blend_pixels(graphics, fill_area.X, fill_area.Y, (BYTE *)pixel_data,
+            fill_area.Width, fill_area.Height, fill_area.Width * 4, PixelFormat32bppARGB);
+    }
+
+    heap_free(buffer.cells);
+    heap_free(pixel_data);
+    GdipDeletePath(flat_path);
+
+    gdi_transform_release(graphics);
+
+    return stat;
+}
+
 static GpStatus SOFTWARE_GdipFillPath(GpGraphics *graphics, GpBrush *brush, GpPath *path)
 {
     GpStatus stat;
@@ -4312,6 +4564,10 @@ static GpStatus SOFTWARE_GdipFillPath(GpGraphics *graphics, GpBrush *brush, GpPa
     if (!brush_can_fill_pixels(brush))
         return NotImplemented;
 
+    /* Blending with partial coverage needs source over compositing. */
+    if (is_antialiased(graphics) && graphics->compmode == CompositingModeSourceOver)
+        return SOFTWARE_GdipFillPathAntialiased(graphics, brush, path);
+
     /* FIXME: This could probably be done more efficiently without regions. */
 
     stat = GdipCreateRegionPath(path, &rgn);
@@ -4344,7 +4600,7 @@ GpStatus WINGDIPAPI GdipFillPath(GpGraphics *graphics, GpBrush *brush, GpPath *p
     if (graphics->image && graphics->image->type == ImageTypeMetafile)
         return METAFILE_FillPath((GpMetafile*)graphics->image, brush, path);
 
-    if (!graphics->image && !graphics->alpha_hdc)
+    if (!graphics->image && !graphics->alpha_hdc && !is_antialiased(graphics))
         stat = GDI32_GdipFillPath(graphics, brush, path);
 
     if (stat == NotImplemented)
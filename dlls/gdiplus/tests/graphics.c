@@ -1591,6 +1591,50 @@ static void test_GdipFillPath(void)
     ReleaseDC(hwnd, hdc);
 }
 
+static void test_GdipFillPath_antialias(void)
+{
+    GpStatus status;
+    GpGraphics *graphics;
+    GpSolidFill *brush;
+    GpBitmap *bitmap;
+    GpPath *path;
+    ARGB color;
+
+    status = GdipCreateBitmapFromScan0(4, 4, 0, PixelFormat32bppARGB, NULL, &bitmap);
+    expect(Ok, status);
+    status = GdipGetImageGraphicsContext((GpImage *)bitmap, &graphics);
+    expect(Ok, status);
+    status = GdipSetSmoothingMode(graphics, SmoothingModeAntiAlias);
+    expect(Ok, status);
+    status = GdipSetPixelOffsetMode(graphics, PixelOffsetModeHalf);
+    expect(Ok, status);
+    status = GdipCreateSolidFill((ARGB)0xff0000ff, &brush);
+    expect(Ok, status);
+    status = GdipCreatePath(FillModeAlternate, &path);
+    expect(Ok, status);
+
+    status = GdipAddPathRectangle(path, 0.0, 0.0, 2.5, 4.0);
+    expect(Ok, status);
+    status = GdipFillPath(graphics, (GpBrush *)brush, path);
+    expect(Ok, status);
+
+    status = GdipBitmapGetPixel(bitmap, 1, 1, &color);
+    expect(Ok, status);
+    expect(0xff0000ff, color);
+    status = GdipBitmapGetPixel(bitmap, 2, 1, &color);
+    expect(Ok, status);
+    ok((color & 0xffffff) == 0xff && (color >> 24) >= 0x70 && (color >> 24) <= 0x90,
+        "Unexpected color %08x.\n", color);
+    status = GdipBitmapGetPixel(bitmap, 3, 1, &color);
+    expect(Ok, status);
+    expect(0, color);
+
+    GdipDeletePath(path);
+    GdipDeleteBrush((GpBrush *)brush);
+    GdipDeleteGraphics(graphics);
+    GdipDisposeImage((GpImage *)bitmap);
+}
+
 static void test_Get_Release_DC(void)
 {
     GpStatus status;
@@ -7092,6 +7136,7 @@ START_TEST(graphics)
     test_GdipFillClosedCurve();
     test_GdipFillClosedCurveI();
     test_GdipFillPath();
+    test_GdipFillPath_antialias();
     test_GdipDrawString();
     test_GdipGetNearestColor();
     test_GdipGetVisibleClipBounds();
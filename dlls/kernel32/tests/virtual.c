@@ -52,6 +52,7 @@ static ULONG  (WINAPI *pRtlRemoveVectoredExceptionHandler)(PVOID);
 static BOOL   (WINAPI *pGetProcessDEPPolicy)(HANDLE, LPDWORD, PBOOL);
 static BOOL   (WINAPI *pIsWow64Process)(HANDLE, PBOOL);
 static NTSTATUS (WINAPI *pNtProtectVirtualMemory)(HANDLE, PVOID *, SIZE_T *, ULONG, ULONG *);
+static BOOL   (WINAPI *pPrefetchVirtualMemory)(HANDLE, ULONG_PTR, PWIN32_MEMORY_RANGE_ENTRY, ULONG);
 
 /* ############################### */
 
@@ -4121,6 +4122,31 @@ static void test_mappings(void)
     test_mapping( INVALID_HANDLE_VALUE, SEC_COMMIT, FALSE );
 }
 
+static void test_PrefetchVirtualMemory(void)
+{
+    WIN32_MEMORY_RANGE_ENTRY entries[2];
+    char *mem;
+    BOOL ret;
+
+    if (!pPrefetchVirtualMemory)
+    {
+        win_skip( "PrefetchVirtualMemory not supported\n" );
+        return;
+    }
+
+    mem = VirtualAlloc( NULL, 0x10000, MEM_COMMIT, PAGE_READWRITE );
+    ok( mem != NULL, "VirtualAlloc failed %u\n", GetLastError() );
+
+    entries[0].VirtualAddress = mem;
+    entries[0].NumberOfBytes = 0x10000;
+    entries[1].VirtualAddress = mem + 0x2010;
+    entries[1].NumberOfBytes = 0x1000;
+    ret = pPrefetchVirtualMemory( GetCurrentProcess(), ARRAY_SIZE(entries), entries, 0 );
+    ok( ret, "PrefetchVirtualMemory failed %u\n", GetLastError() );
+
+    VirtualFree( mem, 0, MEM_RELEASE );
+}
+
 static void test_shared_memory(BOOL is_child)
 {
     HANDLE mapping;
@@ -4255,6 +4281,7 @@ START_TEST(virtual)
     pResetWriteWatch = (void *) GetProcAddress(hkernel32, "ResetWriteWatch");
     pGetProcessDEPPolicy = (void *)GetProcAddress( hkernel32, "GetProcessDEPPolicy" );
     pIsWow64Process = (void *)GetProcAddress( hkernel32, "IsWow64Process" );
+    pPrefetchVirtualMemory = (void *)GetProcAddress( hkernel32, "PrefetchVirtualMemory" );
     pNtAreMappedFilesTheSame = (void *)GetProcAddress( hntdll, "NtAreMappedFilesTheSame" );
     pNtCreateSection = (void *)GetProcAddress( hntdll, "NtCreateSection" );
     pNtMapViewOfSection = (void *)GetProcAddress( hntdll, "NtMapViewOfSection" );
@@ -4284,6 +4311,7 @@ START_TEST(virtual)
     test_IsBadWritePtr();
     test_IsBadCodePtr();
     test_write_watch();
+    test_PrefetchVirtualMemory();
 #if defined(__i386__) || defined(__x86_64__)
     test_stack_commit();
 #endif
@@ -37,6 +37,9 @@ struct memory_buffer
     DWORD max_length;
     DWORD current_length;
 
+    void *allocation;
+    SIZE_T allocation_size;
+
     struct
     {
         BYTE *linear_buffer;
@@ -78,6 +81,95 @@ struct sample
     LONG tracked_refcount;
 };
 
+/* Buffer memory is recycled through a pool of free blocks, grouped in size
+ * classes with four classes per power of two. Media pipelines release and
+ * create buffers of the same size for every sample, reusing blocks avoids
+ * committing fresh pages for each large frame. */
+#define BUFFER_POOL_MIN_SHIFT 12
+#define BUFFER_POOL_MAX_SHIFT 26
+#define BUFFER_POOL_CLASSES   (1 + (BUFFER_POOL_MAX_SHIFT - BUFFER_POOL_MIN_SHIFT) * 4)
+#define BUFFER_POOL_MAX_SIZE  (64 * 1024 * 1024)
+
+struct buffer_pool_block
+{
+    struct buffer_pool_block *next;
+};
+
+static struct buffer_pool_block *buffer_pool[BUFFER_POOL_CLASSES];
+static SIZE_T buffer_pool_size;
+static CRITICAL_SECTION buffer_pool_cs = { NULL, -1, 0, 0, 0, 0 };
+
+/* Rounds size up to its class size, returns ~0u for sizes that are not pooled. */
+static unsigned int buffer_pool_get_class(SIZE_T *size)
+{
+    unsigned int shift = BUFFER_POOL_MIN_SHIFT;
+    SIZE_T step;
+
+    if (*size > ((SIZE_T)1 << BUFFER_POOL_MAX_SHIFT))
+        return ~0u;
+
+    while (((SIZE_T)1 << shift) < *size)
+        ++shift;
+
+    if (shift == BUFFER_POOL_MIN_SHIFT)
+    {
+        *size = (SIZE_T)1 << shift;
+        return 0;
+    }
+
+    step = (SIZE_T)1 << (shift - 3);
+    *size = (*size + step - 1) & ~(step - 1);
+    return 1 + (shift - BUFFER_POOL_MIN_SHIFT - 1) * 4 + (*size >> (shift - 3)) - 5;
+}
+
+static void *buffer_pool_alloc(SIZE_T *size)
+{
+    struct buffer_pool_block *block = NULL;
+    unsigned int index;
+
+    if ((index = buffer_pool_get_class(size)) != ~0u)
+    {
+        EnterCriticalSection(&buffer_pool_cs);
+        if ((block = buffer_pool[index]))
+        {
+            buffer_pool[index] = block->next;
+            buffer_pool_size -= *size;
+        }
+        LeaveCriticalSection(&buffer_pool_cs);
+    }
+
+    if (!block)
+        return heap_alloc_zero(*size);
+
+    memset(block, 0, *size);
+    return block;
+}
+
+static void buffer_pool_free(void *memory, SIZE_T size)
+{
+    struct buffer_pool_block *block = memory;
+    SIZE_T class_size = size;
+    unsigned int index;
+
+    if (!memory)
+        return;
+
+    if ((index = buffer_pool_get_class(&class_size)) != ~0u && class_size == size)
+    {
+        EnterCriticalSection(&buffer_pool_cs);
+        if (buffer_pool_size + size <= BUFFER_POOL_MAX_SIZE)
+        {
+            block->next = buffer_pool[index];
+            buffer_pool[index] = block;
+            buffer_pool_size += size;
+            block = NULL;
+        }
+        LeaveCriticalSection(&buffer_pool_cs);
+    }
+
+    heap_free(block);
+}
+
 static inline struct memory_buffer *impl_from_IMFMediaBuffer(IMFMediaBuffer *iface)
 {
     return CONTAINING_RECORD(iface, struct memory_buffer, IMFMediaBuffer_iface);
@@ -138,7 +230,7 @@ static ULONG WINAPI memory_buffer_Release(IMFMediaBuffer *iface)
     {
         DeleteCriticalSection(&buffer->cs);
         heap_free(buffer->_2d.linear_buffer);
-        heap_free(buffer->data);
+        buffer_pool_free(buffer->allocation, buffer->allocation_size);
         heap_free(buffer);
     }
 
@@ -514,9 +606,11 @@ static const IMF2DBuffer2Vtbl memory_2d_buffer_vtbl =
 static HRESULT memory_buffer_init(struct memory_buffer *buffer, DWORD max_length, DWORD alignment,
         const IMFMediaBufferVtbl *vtbl)
 {
-    buffer->data = heap_alloc_zero(ALIGN_SIZE(max_length, alignment));
-    if (!buffer->data)
+    /* Leave room to align the start of the data as well. */
+    buffer->allocation_size = ALIGN_SIZE(max_length, alignment) + alignment;
+    if (!(buffer->allocation = buffer_pool_alloc(&buffer->allocation_size)))
         return E_OUTOFMEMORY;
+    buffer->data = (BYTE *)(((ULONG_PTR)buffer->allocation + alignment) & ~(ULONG_PTR)alignment);
 
     buffer->IMFMediaBuffer_iface.lpVtbl = vtbl;
     buffer->refcount = 1;
@@ -1719,7 +1719,7 @@ static void test_system_memory_buffer(void)
 {
     IMFMediaBuffer *buffer;
     HRESULT hr;
-    DWORD length, max;
+    DWORD length, max, i;
     BYTE *data, *data2;
 
     hr = MFCreateMemoryBuffer(1024, NULL);
@@ -1830,6 +1830,32 @@ static void test_system_memory_buffer(void)
     ok(hr == S_OK, "Failed to unlock, hr %#x.\n", hr);
 
     IMFMediaBuffer_Release(buffer);
+
+    /* Released storage may be reused, it has to be aligned and cleared again. */
+    hr = MFCreateAlignedMemoryBuffer(1000, MF_64_BYTE_ALIGNMENT, &buffer);
+    ok(hr == S_OK, "Failed to create memory buffer, hr %#x.\n", hr);
+    hr = IMFMediaBuffer_Lock(buffer, &data, &max, &length);
+    ok(hr == S_OK, "Failed to lock, hr %#x.\n", hr);
+    ok(!((ULONG_PTR)data & MF_64_BYTE_ALIGNMENT), "Unexpected data pointer %p.\n", data);
+    memset(data, 0xcc, max);
+    hr = IMFMediaBuffer_Unlock(buffer);
+    ok(hr == S_OK, "Failed to unlock, hr %#x.\n", hr);
+    IMFMediaBuffer_Release(buffer);
+
+    hr = MFCreateAlignedMemoryBuffer(1000, MF_64_BYTE_ALIGNMENT, &buffer);
+    ok(hr == S_OK, "Failed to create memory buffer, hr %#x.\n", hr);
+    hr = IMFMediaBuffer_Lock(buffer, &data2, &max, &length);
+    ok(hr == S_OK, "Failed to lock, hr %#x.\n", hr);
+    ok(data2 == data || broken(data2 != data) /* Windows doesn't have to reuse it */,
+            "Expected the buffer storage to be reused, %p vs %p.\n", data2, data);
+    ok(!((ULONG_PTR)data2 & MF_64_BYTE_ALIGNMENT), "Unexpected data pointer %p.\n", data2);
+    ok(max == 1000, "Unexpected max length %u.\n", max);
+    for (i = 0; i < max; ++i)
+        if (data2[i]) break;
+    ok(i == max, "Unexpected data at %u.\n", i);
+    hr = IMFMediaBuffer_Unlock(buffer);
+    ok(hr == S_OK, "Failed to unlock, hr %#x.\n", hr);
+    IMFMediaBuffer_Release(buffer);
 }
 
 static void test_sample(void)
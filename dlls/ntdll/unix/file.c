@@ -58,6 +58,9 @@
 #ifdef HAVE_SYS_TIME_H
 # include <sys/time.h>
 #endif
+#ifdef HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
 #ifdef HAVE_SYS_ATTR_H
 #include <sys/attr.h>
 #endif
@@ -3822,7 +3825,7 @@ NTSTATUS WINAPI NtQueryInformationFile( HANDLE handle, IO_STATUS_BLOCK *io,
         sizeof(FILE_DISPOSITION_INFORMATION),          /* FileDispositionInformation */
         sizeof(FILE_POSITION_INFORMATION),             /* FilePositionInformation */
         sizeof(FILE_FULL_EA_INFORMATION),              /* FileFullEaInformation */
-        0,                                             /* FileModeInformation */
+        sizeof(FILE_MODE_INFORMATION),                 /* FileModeInformation */
         sizeof(FILE_ALIGNMENT_INFORMATION),            /* FileAlignmentInformation */
         sizeof(FILE_ALL_INFORMATION),                  /* FileAllInformation */
         sizeof(FILE_ALLOCATION_INFORMATION),           /* FileAllocationInformation */
@@ -3934,6 +3937,13 @@ NTSTATUS WINAPI NtQueryInformationFile( HANDLE handle, IO_STATUS_BLOCK *io,
             info->EaSize = 0;
         }
         break;
+    case FileModeInformation:
+        {
+            FILE_MODE_INFORMATION *info = ptr;
+            info->Mode = options & (FILE_WRITE_THROUGH | FILE_SEQUENTIAL_ONLY | FILE_NO_INTERMEDIATE_BUFFERING |
+                                    FILE_SYNCHRONOUS_IO_ALERT | FILE_SYNCHRONOUS_IO_NONALERT);
+        }
+        break;
     case FileEndOfFileInformation:
         if (fd_get_file_info( fd, options, &st, &attr ) == -1) io->u.Status = errno_to_status( errno );
         else fill_file_info( &st, attr, ptr, class );
@@ -5134,6 +5144,55 @@ err:
 }
 
 
+#define MAX_SEGMENT_IOVECS 256
+
+/* fill an iovec array with the remaining parts of a page segment list */
+static int get_segment_iovecs( struct iovec *iov, const FILE_SEGMENT_ELEMENT *segments,
+                               ULONG pos, ULONG length )
+{
+    int count = 0;
+
+    while (length && count < MAX_SEGMENT_IOVECS)
+    {
+        iov[count].iov_base = (char *)segments[count].Buffer + pos;
+        iov[count].iov_len = min( length, page_size - pos );
+        length -= iov[count].iov_len;
+        pos = 0;
+        count++;
+    }
+    return count;
+}
+
+/* read into a page segment list, using a single system call for multiple segments if possible */
+static ssize_t read_segments( int fd, const FILE_SEGMENT_ELEMENT *segments, ULONG pos,
+                              ULONG length, BOOL use_file_pos, off_t offset )
+{
+    struct iovec iov[MAX_SEGMENT_IOVECS];
+    int count = get_segment_iovecs( iov, segments, pos, length );
+
+    if (use_file_pos) return readv( fd, iov, count );
+#ifdef HAVE_PREADV
+    return preadv( fd, iov, count, offset );
+#else
+    return pread( fd, iov[0].iov_base, iov[0].iov_len, offset );
+#endif
+}
+
+/* write from a page segment list, using a single system call for multiple segments if possible */
+static ssize_t write_segments( int fd, const FILE_SEGMENT_ELEMENT *segments, ULONG pos,
+                               ULONG length, BOOL use_file_pos, off_t offset )
+{
+    struct iovec iov[MAX_SEGMENT_IOVECS];
+    int count = get_segment_iovecs( iov, segments, pos, length );
+
+    if (use_file_pos) return writev( fd, iov, count );
+#ifdef HAVE_PWRITEV
+    return pwritev( fd, iov, count, offset );
+#else
+    return pwrite( fd, iov[0].iov_base, iov[0].iov_len, offset );
+#endif
+}
+
 /******************************************************************************
  *              NtReadFileScatter   (NTDLL.@)
  */
@@ -5165,13 +5224,12 @@ NTSTATUS WINAPI NtReadFileScatter( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
         goto error;
     }
 
+    if (offset && offset->QuadPart == FILE_USE_FILE_POINTER_POSITION) offset = NULL;
+
     while (length)
     {
-        if (offset && offset->QuadPart != FILE_USE_FILE_POINTER_POSITION)
-            result = pread( unix_handle, (char *)segments->Buffer + pos,
-                            min( length - pos, page_size - pos ), offset->QuadPart + total );
-        else
-            result = read( unix_handle, (char *)segments->Buffer + pos, min( length - pos, page_size - pos ) );
+        result = read_segments( unix_handle, segments, pos, length,
+                                !offset, offset ? offset->QuadPart + total : 0 );
 
         if (result == -1)
         {
@@ -5182,11 +5240,9 @@ NTSTATUS WINAPI NtReadFileScatter( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
         if (!result) break;
         total += result;
         length -= result;
-        if ((pos += result) == page_size)
-        {
-            pos = 0;
-            segments++;
-        }
+        pos += result;
+        segments += pos / page_size;
+        pos %= page_size;
     }
 
     if (total == 0) status = STATUS_END_OF_FILE;
@@ -5450,6 +5506,7 @@ NTSTATUS WINAPI NtWriteFileGather( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
     enum server_fd_type type;
     ULONG_PTR cvalue = apc ? 0 : (ULONG_PTR)apc_user;
     BOOL send_completion = FALSE;
+    off_t off = 0;
 
     TRACE( "(%p,%p,%p,%p,%p,%p,0x%08x,%p,%p),partial stub!\n",
            file, event, apc, apc_user, io, segments, length, offset, key );
@@ -5468,13 +5525,24 @@ NTSTATUS WINAPI NtWriteFileGather( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
         goto done;
     }
 
+    if (offset && offset->QuadPart == FILE_USE_FILE_POINTER_POSITION) offset = NULL;
+
+    if (offset && offset->QuadPart == FILE_WRITE_TO_END_OF_FILE)
+    {
+        struct stat st;
+
+        if (fstat( unix_handle, &st ) == -1)
+        {
+            status = errno_to_status( errno );
+            goto done;
+        }
+        off = st.st_size;
+    }
+    else if (offset) off = offset->QuadPart;
+
     while (length)
     {
-        if (offset && offset->QuadPart != FILE_USE_FILE_POINTER_POSITION)
-            result = pwrite( unix_handle, (char *)segments->Buffer + pos,
-                             page_size - pos, offset->QuadPart + total );
-        else
-            result = write( unix_handle, (char *)segments->Buffer + pos, page_size - pos );
+        result = write_segments( unix_handle, segments, pos, length, !offset, off + total );
 
         if (result == -1)
         {
@@ -5494,11 +5562,9 @@ NTSTATUS WINAPI NtWriteFileGather( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
         }
         total += result;
         length -= result;
-        if ((pos += result) == page_size)
-        {
-            pos = 0;
-            segments++;
-        }
+        pos += result;
+        segments += pos / page_size;
+        pos %= page_size;
     }
 
     send_completion = cvalue != 0;
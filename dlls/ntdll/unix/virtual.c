@@ -4294,6 +4294,98 @@ NTSTATUS WINAPI NtFlushVirtualMemory( HANDLE process, LPCVOID *addr_ptr,
 }
 
 
+/***********************************************************************
+ *             NtSetInformationVirtualMemory   (NTDLL.@)
+ *             ZwSetInformationVirtualMemory   (NTDLL.@)
+ */
+NTSTATUS WINAPI NtSetInformationVirtualMemory( HANDLE process, VIRTUAL_MEMORY_INFORMATION_CLASS info_class,
+                                               ULONG_PTR count, PMEMORY_RANGE_ENTRY addresses,
+                                               PVOID ptr, ULONG size )
+{
+    MEMORY_RANGE_ENTRY *ranges;
+    struct wine_rb_entry *entry;
+    struct file_view *view;
+    NTSTATUS status = STATUS_SUCCESS;
+    sigset_t sigset;
+    ULONG_PTR i;
+
+    TRACE( "(%p, %d, %lu, %p, %p, %u)\n", process, info_class, count, addresses, ptr, size );
+
+    switch (info_class)
+    {
+    case VmPrefetchInformation:
+        if (!ptr) return STATUS_INVALID_PARAMETER_5;
+        if (size != sizeof(ULONG)) return STATUS_INVALID_PARAMETER_6;
+        if (*(ULONG *)ptr) return STATUS_INVALID_PARAMETER_5;
+        if (!count) return STATUS_INVALID_PARAMETER_3;
+        if (!addresses) return STATUS_ACCESS_VIOLATION;
+
+        if (process != NtCurrentProcess())
+        {
+            FIXME( "prefetching in other process %p not supported\n", process );
+            return STATUS_SUCCESS;
+        }
+
+        /* the caller's array may be invalid, so copy it before taking the lock */
+        if (count > ~(SIZE_T)0 / sizeof(*ranges)) return STATUS_NO_MEMORY;
+        if (!(ranges = malloc( count * sizeof(*ranges) ))) return STATUS_NO_MEMORY;
+        __TRY
+        {
+            memcpy( ranges, addresses, count * sizeof(*ranges) );
+        }
+        __EXCEPT_SYSCALL
+        {
+            status = STATUS_ACCESS_VIOLATION;
+        }
+        __ENDTRY
+        if (status)
+        {
+            free( ranges );
+            return status;
+        }
+
+        /* prefetching is only a hint, the parts of a range that are not mapped are ignored */
+        server_enter_uninterrupted_section( &virtual_mutex, &sigset );
+        for (i = 0; i < count; i++)
+        {
+            char *base = ROUND_ADDR( ranges[i].VirtualAddress, page_mask );
+            char *end = base + ROUND_SIZE( ranges[i].VirtualAddress, ranges[i].NumberOfBytes );
+
+            if (end <= base || !(view = find_view_range( base, end - base ))) continue;
+
+            /* find_view_range() returns any overlapping view, rewind to the first one */
+            while ((entry = wine_rb_prev( &view->entry )))
+            {
+                struct file_view *prev = WINE_RB_ENTRY_VALUE( entry, struct file_view, entry );
+                if ((char *)prev->base + prev->size <= base) break;
+                view = prev;
+            }
+
+            for (;;)
+            {
+#ifdef MADV_WILLNEED
+                char *start = max( base, (char *)view->base );
+                char *stop = min( end, (char *)view->base + view->size );
+
+                madvise( start, stop - start, MADV_WILLNEED );
+#endif
+                if (!(entry = wine_rb_next( &view->entry ))) break;
+                view = WINE_RB_ENTRY_VALUE( entry, struct file_view, entry );
+                if ((char *)view->base >= end) break;
+            }
+        }
+        server_leave_uninterrupted_section( &virtual_mutex, &sigset );
+        free( ranges );
+        return STATUS_SUCCESS;
+
+    default:
+        FIXME( "(%p,info_class=%d,%lu,%p,%p,%u) Unknown information class\n",
+               process, info_class, count, addresses, ptr, size );
+        return STATUS_INVALID_PARAMETER_2;
+    }
+}
+
+
 /***********************************************************************
  *             NtGetWriteWatch   (NTDLL.@)
  *             ZwGetWriteWatch   (NTDLL.@)
@@ -234,7 +234,9 @@ static HRESULT WINAPI BaseMemAllocator_Commit(IMemAllocator * iface)
             hr = S_OK;
         else
         {
-            if (!(This->hSemWaiting = CreateSemaphoreW(NULL, This->props.cBuffers, This->props.cBuffers, NULL)))
+            /* The semaphore is only signalled for threads which found no free
+             * sample, see GetBuffer(). */
+            if (!(This->hSemWaiting = CreateSemaphoreW(NULL, 0, MAXLONG, NULL)))
             {
                 ERR("Couldn't create semaphore (error was %u)\n", GetLastError());
                 hr = HRESULT_FROM_WIN32(GetLastError());
@@ -271,7 +273,9 @@ static HRESULT WINAPI BaseMemAllocator_Decommit(IMemAllocator * iface)
             {
                 This->bDecommitQueued = TRUE;
                 /* notify ALL waiting threads that they cannot be allocated a buffer any more */
-                ReleaseSemaphore(This->hSemWaiting, This->lWaiting, NULL);
+                if (This->lWaiting)
+                    ReleaseSemaphore(This->hSemWaiting, This->lWaiting, NULL);
+                This->lWaiting = 0;
                 
                 hr = S_OK;
             }
@@ -298,7 +302,10 @@ static HRESULT WINAPI BaseMemAllocator_Decommit(IMemAllocator * iface)
 static HRESULT WINAPI BaseMemAllocator_GetBuffer(IMemAllocator * iface, IMediaSample ** pSample, REFERENCE_TIME *pStartTime, REFERENCE_TIME *pEndTime, DWORD dwFlags)
 {
     BaseMemAllocator *This = impl_from_IMemAllocator(iface);
+    BOOL woken = FALSE;
     HRESULT hr = S_OK;
+    HANDLE sem;
+    DWORD ret;
 
     /* NOTE: The pStartTime and pEndTime parameters are not applied to the sample. 
      * The allocator might use these values to determine which buffer it retrieves */
@@ -307,35 +314,25 @@ static HRESULT WINAPI BaseMemAllocator_GetBuffer(IMemAllocator * iface, IMediaSa
 
     *pSample = NULL;
 
+    /* Samples are taken from the free list directly when one is available;
+     * the semaphore is only used to block when all of them are in use, which
+     * saves a pair of server calls per sample in the common case. */
     EnterCriticalSection(This->pCritSect);
-    if (!This->bCommitted || This->bDecommitQueued)
+    for (;;)
     {
-        WARN("Not committed\n");
-        hr = VFW_E_NOT_COMMITTED;
-    }
-    else
-        ++This->lWaiting;
-    LeaveCriticalSection(This->pCritSect);
-    if (FAILED(hr))
-        return hr;
-
-    if (WaitForSingleObject(This->hSemWaiting, (dwFlags & AM_GBF_NOWAIT) ? 0 : INFINITE) != WAIT_OBJECT_0)
-    {
-        EnterCriticalSection(This->pCritSect);
-        --This->lWaiting;
-        LeaveCriticalSection(This->pCritSect);
-        WARN("Timed out\n");
-        return VFW_E_TIMEOUT;
-    }
-
-    EnterCriticalSection(This->pCritSect);
-    {
-        --This->lWaiting;
         if (!This->bCommitted)
+        {
+            WARN("Not committed\n");
             hr = VFW_E_NOT_COMMITTED;
-        else if (This->bDecommitQueued)
-            hr = VFW_E_TIMEOUT;
-        else
+            break;
+        }
+        if (This->bDecommitQueued)
+        {
+            /* Waiting threads are woken up by Decommit() and fail with a timeout. */
+            hr = woken ? VFW_E_TIMEOUT : VFW_E_NOT_COMMITTED;
+            break;
+        }
+        if (!list_empty(&This->free_list))
         {
             StdMediaSample2 *ms;
             struct list * free = list_head(&This->free_list);
@@ -346,7 +343,26 @@ static HRESULT WINAPI BaseMemAllocator_GetBuffer(IMemAllocator * iface, IMediaSa
             assert(ms->ref == 0);
             *pSample = (IMediaSample *)&ms->IMediaSample2_iface;
             IMediaSample_AddRef(*pSample);
+            break;
         }
+        if (dwFlags & AM_GBF_NOWAIT)
+        {
+            hr = VFW_E_TIMEOUT;
+            break;
+        }
+
+        /* The releasing thread removes us from the waiting count. */
+        ++This->lWaiting;
+        sem = This->hSemWaiting;
+        LeaveCriticalSection(This->pCritSect);
+        ret = WaitForSingleObject(sem, INFINITE);
+        EnterCriticalSection(This->pCritSect);
+        if (ret != WAIT_OBJECT_0)
+        {
+            hr = VFW_E_TIMEOUT;
+            break;
+        }
+        woken = TRUE;
     }
     LeaveCriticalSection(This->pCritSect);
 
@@ -377,6 +393,17 @@ static HRESULT WINAPI BaseMemAllocator_ReleaseBuffer(IMemAllocator * iface, IMed
 
         list_add_head(&This->free_list, &pStdSample->listentry);
 
+        /* notify a waiting thread that there is now a free buffer */
+        if (This->lWaiting)
+        {
+            --This->lWaiting;
+            if (!ReleaseSemaphore(This->hSemWaiting, 1, NULL))
+            {
+                ERR("ReleaseSemaphore failed with error %u\n", GetLastError());
+                hr = HRESULT_FROM_WIN32(GetLastError());
+            }
+        }
+
         if (list_empty(&This->used_list) && This->bDecommitQueued && This->bCommitted)
         {
             HRESULT hrfree;
@@ -396,13 +423,6 @@ static HRESULT WINAPI BaseMemAllocator_ReleaseBuffer(IMemAllocator * iface, IMed
     }
     LeaveCriticalSection(This->pCritSect);
 
-    /* notify a waiting thread that there is now a free buffer */
-    if (This->hSemWaiting && !ReleaseSemaphore(This->hSemWaiting, 1, NULL))
-    {
-        ERR("ReleaseSemaphore failed with error %u\n", GetLastError());
-        hr = HRESULT_FROM_WIN32(GetLastError());
-    }
-
     return hr;
 }
 
@@ -171,6 +171,65 @@ static void test_commit(void)
     IMemAllocator_Release(allocator);
 }
 
+static DWORD WINAPI get_buffer_thread(void *arg)
+{
+    IMemAllocator *allocator = arg;
+    IMediaSample *sample;
+    HRESULT hr;
+
+    hr = IMemAllocator_GetBuffer(allocator, &sample, NULL, NULL, 0);
+    ok(hr == S_OK, "Got hr %#x.\n", hr);
+    IMediaSample_Release(sample);
+    return 0;
+}
+
+static void test_get_buffer(void)
+{
+    ALLOCATOR_PROPERTIES req_props = {2, 65536, 1, 0}, ret_props;
+    IMemAllocator *allocator = create_allocator();
+    IMediaSample *sample, *sample2, *sample3;
+    unsigned int i;
+    HANDLE thread;
+    HRESULT hr;
+
+    hr = IMemAllocator_SetProperties(allocator, &req_props, &ret_props);
+    ok(hr == S_OK, "Got hr %#x.\n", hr);
+    hr = IMemAllocator_Commit(allocator);
+    ok(hr == S_OK, "Got hr %#x.\n", hr);
+
+    for (i = 0; i < 100; ++i)
+    {
+        hr = IMemAllocator_GetBuffer(allocator, &sample, NULL, NULL, 0);
+        ok(hr == S_OK, "Got hr %#x.\n", hr);
+        IMediaSample_Release(sample);
+    }
+
+    hr = IMemAllocator_GetBuffer(allocator, &sample, NULL, NULL, 0);
+    ok(hr == S_OK, "Got hr %#x.\n", hr);
+    hr = IMemAllocator_GetBuffer(allocator, &sample2, NULL, NULL, AM_GBF_NOWAIT);
+    ok(hr == S_OK, "Got hr %#x.\n", hr);
+    ok(sample2 != sample, "Expected different samples.\n");
+
+    hr = IMemAllocator_GetBuffer(allocator, &sample3, NULL, NULL, AM_GBF_NOWAIT);
+    ok(hr == VFW_E_TIMEOUT, "Got hr %#x.\n", hr);
+    ok(!sample3, "Got sample %p.\n", sample3);
+
+    thread = CreateThread(NULL, 0, get_buffer_thread, allocator, 0, NULL);
+    ok(WaitForSingleObject(thread, 100) == WAIT_TIMEOUT, "Thread should block.\n");
+    IMediaSample_Release(sample);
+    ok(!WaitForSingleObject(thread, 1000), "Wait timed out.\n");
+    CloseHandle(thread);
+
+    hr = IMemAllocator_GetBuffer(allocator, &sample, NULL, NULL, AM_GBF_NOWAIT);
+    ok(hr == S_OK, "Got hr %#x.\n", hr);
+
+    IMediaSample_Release(sample2);
+    IMediaSample_Release(sample);
+    hr = IMemAllocator_Decommit(allocator);
+    ok(hr == S_OK, "Got hr %#x.\n", hr);
+    IMemAllocator_Release(allocator);
+}
+
 static void test_sample_time(void)
 {
     ALLOCATOR_PROPERTIES req_props = {1, 65536, 1, 0}, ret_props;
@@ -656,6 +715,7 @@ START_TEST(memallocator)
 
     test_properties();
     test_commit();
+    test_get_buffer();
     test_sample_time();
     test_media_time();
     test_sample_properties();
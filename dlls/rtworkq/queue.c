@@ -28,6 +28,7 @@
 #include "wine/list.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(mfplat);
+WINE_DECLARE_DEBUG_CHANNEL(rtwq_stats);
 
 #define FIRST_USER_QUEUE_HANDLE 5
 #define MAX_USER_QUEUE_HANDLES 124
@@ -125,9 +126,11 @@ struct work_item
     IUnknown IUnknown_iface;
     LONG refcount;
     struct list entry;
+    struct list ready_entry;
     IRtwqAsyncResult *result;
     IRtwqAsyncResult *reply_result;
     struct queue *queue;
+    LONGLONG submit_time;
     RTWQWORKITEM_KEY key;
     LONG priority;
     DWORD flags;
@@ -168,12 +171,26 @@ struct queue_desc
     DWORD target_queue;
 };
 
+/* Items ready to run at given priority. Every queued item is matched by one
+   submission of the shared work object. */
+struct ready_list
+{
+    struct queue *queue;
+    struct list items;
+    TP_WORK *work_object;
+};
+
 struct queue
 {
     IRtwqAsyncCallback IRtwqAsyncCallback_iface;
     const struct queue_ops *ops;
     TP_POOL *pool;
     TP_CALLBACK_ENVIRON_V3 envs[ARRAY_SIZE(priorities)];
+    struct ready_list ready[ARRAY_SIZE(priorities)];
+    SRWLOCK ready_lock;
+    LONG depth;
+    LONG max_depth;
+    LONGLONG max_latency;
     CRITICAL_SECTION cs;
     struct list pending_items;
     DWORD id;
@@ -308,6 +325,8 @@ static void CALLBACK standard_queue_cleanup_callback(void *object_data, void *gr
 {
 }
 
+static void CALLBACK standard_queue_worker(TP_CALLBACK_INSTANCE *instance, void *context, TP_WORK *work);
+
 static HRESULT pool_queue_init(const struct queue_desc *desc, struct queue *queue)
 {
     TP_CALLBACK_ENVIRON_V3 env;
@@ -330,6 +349,24 @@ static HRESULT pool_queue_init(const struct queue_desc *desc, struct queue *queu
     list_init(&queue->pending_items);
     InitializeCriticalSection(&queue->cs);
 
+    InitializeSRWLock(&queue->ready_lock);
+    for (i = 0; i < ARRAY_SIZE(queue->ready); ++i)
+    {
+        queue->ready[i].queue = queue;
+        list_init(&queue->ready[i].items);
+        if (!(queue->ready[i].work_object = CreateThreadpoolWork(standard_queue_worker, &queue->ready[i],
+                (TP_CALLBACK_ENVIRON *)&queue->envs[i])))
+        {
+            WARN("Failed to create work object, error %u.\n", GetLastError());
+            CloseThreadpoolCleanupGroupMembers(env.CleanupGroup, FALSE, NULL);
+            CloseThreadpoolCleanupGroup(env.CleanupGroup);
+            CloseThreadpool(queue->pool);
+            queue->pool = NULL;
+            DeleteCriticalSection(&queue->cs);
+            return E_OUTOFMEMORY;
+        }
+    }
+
     max_thread = (desc->queue_type == RTWQ_STANDARD_WORKQUEUE || desc->queue_type == RTWQ_WINDOW_WORKQUEUE) ? 1 : 4;
 
     SetThreadpoolThreadMinimum(queue->pool, 1);
@@ -343,6 +380,9 @@ static HRESULT pool_queue_init(const struct queue_desc *desc, struct queue *queu
 
 static BOOL pool_queue_shutdown(struct queue *queue)
 {
+    struct work_item *item, *item2;
+    unsigned int i;
+
     if (!queue->pool)
         return FALSE;
 
@@ -350,13 +390,71 @@ static BOOL pool_queue_shutdown(struct queue *queue)
     CloseThreadpool(queue->pool);
     queue->pool = NULL;
 
+    /* Release items whose submissions were cancelled. */
+    for (i = 0; i < ARRAY_SIZE(queue->ready); ++i)
+    {
+        LIST_FOR_EACH_ENTRY_SAFE(item, item2, &queue->ready[i].items, struct work_item, ready_entry)
+        {
+            list_remove(&item->ready_entry);
+            IUnknown_Release(&item->IUnknown_iface);
+        }
+    }
+
+    TRACE_(rtwq_stats)("queue %#x, max depth %u, max latency %s us.\n", queue->id, queue->max_depth,
+            wine_dbgstr_longlong(queue->max_latency));
+
     return TRUE;
 }
 
+static LONGLONG get_time_us(void)
+{
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+
+    if (!frequency.QuadPart)
+        QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+
+    return counter.QuadPart * 1000000 / frequency.QuadPart;
+}
+
+static void pool_queue_update_stats(struct queue *queue, struct work_item *item, LONG depth)
+{
+    LONGLONG latency, max_latency;
+    LONG max_depth;
+
+    /* Statistics are only gathered when the channel is enabled at submission time. */
+    if (!item->submit_time)
+        return;
+
+    latency = get_time_us() - item->submit_time;
+
+    while ((max_depth = queue->max_depth) < depth)
+        if (InterlockedCompareExchange(&queue->max_depth, depth, max_depth) == max_depth) break;
+    while ((max_latency = queue->max_latency) < latency)
+        if (InterlockedCompareExchange64(&queue->max_latency, latency, max_latency) == max_latency) break;
+
+    TRACE_(rtwq_stats)("queue %#x, priority %d, depth %u, latency %s us.\n", queue->id, item->priority, depth,
+            wine_dbgstr_longlong(latency));
+}
+
 static void CALLBACK standard_queue_worker(TP_CALLBACK_INSTANCE *instance, void *context, TP_WORK *work)
 {
-    struct work_item *item = context;
-    RTWQASYNCRESULT *result = (RTWQASYNCRESULT *)item->result;
+    struct ready_list *ready = context;
+    struct queue *queue = ready->queue;
+    RTWQASYNCRESULT *result;
+    struct work_item *item;
+    LONG depth;
+
+    AcquireSRWLockExclusive(&queue->ready_lock);
+    item = LIST_ENTRY(list_head(&ready->items), struct work_item, ready_entry);
+    list_remove(&item->ready_entry);
+    ReleaseSRWLockExclusive(&queue->ready_lock);
+
+    depth = InterlockedDecrement(&queue->depth) + 1;
+    pool_queue_update_stats(queue, item, depth);
+
+    result = (RTWQASYNCRESULT *)item->result;
 
     TRACE("result object %p.\n", result);
 
@@ -366,14 +464,15 @@ static void CALLBACK standard_queue_worker(TP_CALLBACK_INSTANCE *instance, void
 
     IRtwqAsyncCallback_Invoke(result->pCallback, item->reply_result ? item->reply_result : item->result);
 
+    if (item->finalization_callback)
+        item->finalization_callback(instance, item);
+
     IUnknown_Release(&item->IUnknown_iface);
 }
 
 static void pool_queue_submit(struct queue *queue, struct work_item *item)
 {
     TP_CALLBACK_PRIORITY callback_priority;
-    TP_CALLBACK_ENVIRON_V3 env;
-    TP_WORK *work_object;
 
     if (item->priority == 0)
         callback_priority = TP_CALLBACK_PRIORITY_NORMAL;
@@ -382,14 +481,20 @@ static void pool_queue_submit(struct queue *queue, struct work_item *item)
     else
         callback_priority = TP_CALLBACK_PRIORITY_HIGH;
 
-    env = queue->envs[callback_priority];
-    env.FinalizationCallback = item->finalization_callback;
-    /* Worker pool callback will release one reference. Grab one more to keep object alive when
+    /* Worker will release one reference. Grab one more to keep object alive when
        we need finalization callback. */
     if (item->finalization_callback)
         IUnknown_AddRef(&item->IUnknown_iface);
-    work_object = CreateThreadpoolWork(standard_queue_worker, item, (TP_CALLBACK_ENVIRON *)&env);
-    SubmitThreadpoolWork(work_object);
+
+    /* Work objects are shared per priority, instead of creating a new one for every item. */
+    item->submit_time = TRACE_ON(rtwq_stats) ? get_time_us() : 0;
+    InterlockedIncrement(&queue->depth);
+
+    AcquireSRWLockExclusive(&queue->ready_lock);
+    list_add_tail(&queue->ready[callback_priority].items, &item->ready_entry);
+    ReleaseSRWLockExclusive(&queue->ready_lock);
+
+    SubmitThreadpoolWork(queue->ready[callback_priority].work_object);
 
     TRACE("dispatched %p.\n", item->result);
 }
@@ -572,7 +677,8 @@ static struct work_item * alloc_work_item(struct queue *queue, LONG priority, IR
     DWORD flags = 0, queue_id = 0;
     struct work_item *item;
 
-    item = heap_alloc_zero(sizeof(*item));
+    if (!(item = heap_alloc_zero(sizeof(*item))))
+        return NULL;
 
     item->IUnknown_iface.lpVtbl = &work_item_vtbl;
     item->result = result;
@@ -580,6 +686,7 @@ static struct work_item * alloc_work_item(struct queue *queue, LONG priority, IR
     item->refcount = 1;
     item->queue = queue;
     list_init(&item->entry);
+    list_init(&item->ready_entry);
     item->priority = priority;
 
     if (SUCCEEDED(IRtwqAsyncCallback_GetParameters(async_result->pCallback, &flags, &queue_id)))
@@ -588,16 +695,23 @@ static struct work_item * alloc_work_item(struct queue *queue, LONG priority, IR
     return item;
 }
 
-static void init_work_queue(const struct queue_desc *desc, struct queue *queue)
+static HRESULT init_work_queue(const struct queue_desc *desc, struct queue *queue)
 {
+    HRESULT hr;
+
     assert(desc->ops != NULL);
 
     queue->ops = desc->ops;
-    if (SUCCEEDED(queue->ops->init(desc, queue)))
+    if (FAILED(hr = queue->ops->init(desc, queue)))
     {
-        list_init(&queue->pending_items);
-        InitializeCriticalSection(&queue->cs);
+        queue->ops = NULL;
+        return hr;
     }
+
+    list_init(&queue->pending_items);
+    InitializeCriticalSection(&queue->cs);
+
+    return S_OK;
 }
 
 static HRESULT grab_queue(DWORD queue_id, struct queue **ret)
@@ -619,6 +733,7 @@ static HRESULT grab_queue(DWORD queue_id, struct queue **ret)
     else if (queue)
     {
         struct queue_desc desc;
+        HRESULT hr;
 
         EnterCriticalSection(&queues_section);
         switch (queue_id)
@@ -635,10 +750,10 @@ static HRESULT grab_queue(DWORD queue_id, struct queue **ret)
         desc.queue_type = queue_type;
         desc.ops = &pool_queue_ops;
         desc.target_queue = 0;
-        init_work_queue(&desc, queue);
+        if (SUCCEEDED(hr = init_work_queue(&desc, queue)))
+            *ret = queue;
         LeaveCriticalSection(&queues_section);
-        *ret = queue;
-        return S_OK;
+        return hr;
     }
 
     /* Handles user queues. */
@@ -890,6 +1005,7 @@ static HRESULT alloc_user_queue(const struct queue_desc *desc, DWORD *queue_id)
     struct queue_handle *entry;
     struct queue *queue;
     unsigned int idx;
+    HRESULT hr;
 
     *queue_id = RTWQ_CALLBACK_QUEUE_UNDEFINED;
 
@@ -900,7 +1016,11 @@ static HRESULT alloc_user_queue(const struct queue_desc *desc, DWORD *queue_id)
     if (!queue)
         return E_OUTOFMEMORY;
 
-    init_work_queue(desc, queue);
+    if (FAILED(hr = init_work_queue(desc, queue)))
+    {
+        heap_free(queue);
+        return hr;
+    }
 
     EnterCriticalSection(&queues_section);
 
@@ -1140,7 +1260,8 @@ static void init_system_queues(void)
     desc.queue_type = RTWQ_STANDARD_WORKQUEUE;
     desc.ops = &pool_queue_ops;
     desc.target_queue = 0;
-    init_work_queue(&desc, &system_queues[SYS_QUEUE_STANDARD]);
+    if (FAILED(hr = init_work_queue(&desc, &system_queues[SYS_QUEUE_STANDARD])))
+        WARN("Failed to initialize standard queue, hr %#x.\n", hr);
 
     LeaveCriticalSection(&queues_section);
 }
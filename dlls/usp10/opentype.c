@@ -730,12 +730,18 @@ static WORD OT_get_glyph_class(const void *table, WORD glyph)
     else if (GET_BE_WORD(cf1->ClassFormat) == 2)
     {
         const OT_ClassDefFormat2 *cf2 = table;
-        int i, top;
-        top = GET_BE_WORD(cf2->ClassRangeCount);
-        for (i = 0; i < top; i++)
+        int min = 0, max = GET_BE_WORD(cf2->ClassRangeCount) - 1;
+
+        /* Class ranges are sorted by start glyph. */
+        while (min <= max)
         {
-            if (glyph >= GET_BE_WORD(cf2->ClassRangeRecord[i].Start) &&
-                glyph <= GET_BE_WORD(cf2->ClassRangeRecord[i].End))
+            int i = (min + max) / 2;
+
+            if (glyph < GET_BE_WORD(cf2->ClassRangeRecord[i].Start))
+                max = i - 1;
+            else if (glyph > GET_BE_WORD(cf2->ClassRangeRecord[i].End))
+                min = i + 1;
+            else
             {
                 class = GET_BE_WORD(cf2->ClassRangeRecord[i].Class);
                 break;
@@ -822,35 +828,46 @@ static int GSUB_is_glyph_covered(const void *table, unsigned int glyph)
 
     cf1 = table;
 
+    /* Glyph arrays and range records are sorted by glyph id, so both
+     * formats can be searched with a binary search. */
     if (GET_BE_WORD(cf1->CoverageFormat) == 1)
     {
-        int count = GET_BE_WORD(cf1->GlyphCount);
-        int i;
-        TRACE("Coverage Format 1, %i glyphs\n",count);
-        for (i = 0; i < count; i++)
-            if (glyph == GET_BE_WORD(cf1->GlyphArray[i]))
+        int min = 0, max = GET_BE_WORD(cf1->GlyphCount) - 1;
+        TRACE("Coverage Format 1, %i glyphs\n",max + 1);
+        while (min <= max)
+        {
+            int i = (min + max) / 2;
+            unsigned int g = GET_BE_WORD(cf1->GlyphArray[i]);
+
+            if (glyph < g)
+                max = i - 1;
+            else if (glyph > g)
+                min = i + 1;
+            else
                 return i;
+        }
         return -1;
     }
     else if (GET_BE_WORD(cf1->CoverageFormat) == 2)
     {
         const OT_CoverageFormat2* cf2;
-        int i;
-        int count;
+        int min, max;
         cf2 = (const OT_CoverageFormat2*)cf1;
 
-        count = GET_BE_WORD(cf2->RangeCount);
-        TRACE("Coverage Format 2, %i ranges\n",count);
-        for (i = 0; i < count; i++)
+        min = 0;
+        max = GET_BE_WORD(cf2->RangeCount) - 1;
+        TRACE("Coverage Format 2, %i ranges\n",max + 1);
+        while (min <= max)
         {
+            int i = (min + max) / 2;
+
             if (glyph < GET_BE_WORD(cf2->RangeRecord[i].Start))
-                return -1;
-            if ((glyph >= GET_BE_WORD(cf2->RangeRecord[i].Start)) &&
-                (glyph <= GET_BE_WORD(cf2->RangeRecord[i].End)))
-            {
+                max = i - 1;
+            else if (glyph > GET_BE_WORD(cf2->RangeRecord[i].End))
+                min = i + 1;
+            else
                 return (GET_BE_WORD(cf2->RangeRecord[i].StartCoverageIndex) +
                     glyph - GET_BE_WORD(cf2->RangeRecord[i].Start));
-            }
         }
         return -1;
     }
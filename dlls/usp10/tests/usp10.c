@@ -2088,6 +2088,54 @@ static void test_ScriptShape(HDC hdc)
     ScriptFreeCache(&sc);
 }
 
+static void test_ScriptShape_repeated(HDC hdc)
+{
+    static const WCHAR test1[] = {'w', 'i', 'n', 'e', 0};
+    WORD glyphs[4], glyphs2[4], logclust[4], logclust2[4];
+    SCRIPT_VISATTR attrs[4], attrs2[4];
+    SCRIPT_CACHE sc = NULL;
+    SCRIPT_ITEM items[2];
+    SCRIPT_ANALYSIS sa;
+    HRESULT hr;
+    int nb, nb2, i;
+
+    hr = ScriptItemize(test1, 4, 2, NULL, NULL, items, NULL);
+    ok(hr == S_OK, "Unexpected hr %#x.\n", hr);
+
+    hr = ScriptShape(hdc, &sc, test1, 4, 4, &items[0].a, glyphs, logclust, attrs, &nb);
+    ok(hr == S_OK, "Unexpected hr %#x.\n", hr);
+    ok(nb == 4, "Unexpected glyph count %d.\n", nb);
+
+    /* Shaping the same run again gives the same results. */
+    memset(glyphs2, 0xcc, sizeof(glyphs2));
+    memset(logclust2, 0xcc, sizeof(logclust2));
+    memset(attrs2, 0xcc, sizeof(attrs2));
+    hr = ScriptShape(hdc, &sc, test1, 4, 4, &items[0].a, glyphs2, logclust2, attrs2, &nb2);
+    ok(hr == S_OK, "Unexpected hr %#x.\n", hr);
+    ok(nb2 == nb, "Unexpected glyph count %d.\n", nb2);
+    ok(!memcmp(glyphs, glyphs2, sizeof(glyphs)), "Unexpected glyphs.\n");
+    ok(!memcmp(logclust, logclust2, sizeof(logclust)), "Unexpected clusters.\n");
+    ok(!memcmp(attrs, attrs2, sizeof(attrs)), "Unexpected attributes.\n");
+
+    /* Same text with a different analysis. */
+    sa = items[0].a;
+    sa.fRTL = 1;
+    hr = ScriptShape(hdc, &sc, test1, 4, 4, &sa, glyphs2, logclust2, attrs2, &nb2);
+    ok(hr == S_OK, "Unexpected hr %#x.\n", hr);
+    ok(nb2 == 4, "Unexpected glyph count %d.\n", nb2);
+    for (i = 0; i < 4; ++i)
+    {
+        ok(logclust2[i] == 3 - i, "Unexpected cluster %u at %d.\n", logclust2[i], i);
+        ok(glyphs2[i] == glyphs[3 - i], "Unexpected glyph %#x at %d.\n", glyphs2[i], i);
+    }
+
+    /* Too small output buffer. */
+    hr = ScriptShape(hdc, &sc, test1, 4, 3, &items[0].a, glyphs2, logclust2, attrs2, &nb2);
+    ok(hr == E_OUTOFMEMORY, "Unexpected hr %#x.\n", hr);
+
+    ScriptFreeCache(&sc);
+}
+
 static void test_ScriptPlace(HDC hdc)
 {
     static const WCHAR test1[] = {'t', 'e', 's', 't',0};
@@ -4224,6 +4272,7 @@ START_TEST(usp10)
     test_ScriptGetGlyphABCWidth(hdc);
     test_ScriptShape(hdc);
     test_ScriptShapeOpenType(hdc);
+    test_ScriptShape_repeated(hdc);
     test_ScriptPlace(hdc);
 
     test_ScriptGetFontProperties(hdc);
@@ -860,6 +860,106 @@ static inline BOOL set_cache_glyph_widths(SCRIPT_CACHE *psc, WORD glyph, ABC *ab
     return TRUE;
 }
 
+/* Results of ScriptShapeOpenType() for recently shaped runs, keyed by text,
+ * analysis and tags. Each script cache holds a direct mapped table, a new run
+ * replaces the one stored in its slot. */
+struct shaped_run
+{
+    unsigned int hash;
+    SCRIPT_ANALYSIS sa;
+    OPENTYPE_TAG script;
+    OPENTYPE_TAG language;
+    int char_count;
+    int glyph_count;
+    WCHAR *chars;
+    WORD *log_clust;
+    SCRIPT_CHARPROP *char_props;
+    WORD *glyphs;
+    SCRIPT_GLYPHPROP *glyph_props;
+};
+
+static unsigned int hash_shaped_run(const SCRIPT_ANALYSIS *sa, OPENTYPE_TAG script, OPENTYPE_TAG language,
+        const WCHAR *chars, int count)
+{
+    const BYTE *data = (const BYTE *)sa;
+    unsigned int hash = 2166136261u;
+    int i;
+
+    for (i = 0; i < sizeof(*sa); ++i)
+        hash = (hash ^ data[i]) * 16777619u;
+    hash = (hash ^ script) * 16777619u;
+    hash = (hash ^ language) * 16777619u;
+    for (i = 0; i < count; ++i)
+        hash = (hash ^ chars[i]) * 16777619u;
+
+    return hash;
+}
+
+static BOOL get_cache_shaped_run(ScriptCache *sc, unsigned int hash, const SCRIPT_ANALYSIS *sa,
+        OPENTYPE_TAG script, OPENTYPE_TAG language, const WCHAR *chars, int char_count, int max_glyphs,
+        WORD *log_clust, SCRIPT_CHARPROP *char_props, WORD *glyphs, SCRIPT_GLYPHPROP *glyph_props, int *glyph_count)
+{
+    struct shaped_run *run;
+    BOOL ret = FALSE;
+
+    EnterCriticalSection(&cs_script_cache);
+    run = sc->shaped_runs[hash % SHAPED_RUN_CACHE_SIZE];
+    if (run && run->hash == hash && run->char_count == char_count && run->glyph_count <= max_glyphs
+            && run->script == script && run->language == language && !memcmp(&run->sa, sa, sizeof(*sa))
+            && !memcmp(run->chars, chars, char_count * sizeof(*chars)))
+    {
+        memcpy(log_clust, run->log_clust, char_count * sizeof(*log_clust));
+        memcpy(char_props, run->char_props, char_count * sizeof(*char_props));
+        memcpy(glyphs, run->glyphs, run->glyph_count * sizeof(*glyphs));
+        memcpy(glyph_props, run->glyph_props, run->glyph_count * sizeof(*glyph_props));
+        *glyph_count = run->glyph_count;
+        ret = TRUE;
+    }
+    LeaveCriticalSection(&cs_script_cache);
+
+    return ret;
+}
+
+static void set_cache_shaped_run(ScriptCache *sc, unsigned int hash, const SCRIPT_ANALYSIS *sa,
+        OPENTYPE_TAG script, OPENTYPE_TAG language, const WCHAR *chars, int char_count, const WORD *log_clust,
+        const SCRIPT_CHARPROP *char_props, const WORD *glyphs, const SCRIPT_GLYPHPROP *glyph_props, int glyph_count)
+{
+    struct shaped_run *run, *old;
+    SIZE_T size;
+
+    size = sizeof(*run) + char_count * (sizeof(*chars) + sizeof(*log_clust) + sizeof(*char_props))
+            + glyph_count * (sizeof(*glyphs) + sizeof(*glyph_props));
+    if (!(run = heap_alloc(size)))
+        return;
+
+    run->hash = hash;
+    run->sa = *sa;
+    run->script = script;
+    run->language = language;
+    run->char_count = char_count;
+    run->glyph_count = glyph_count;
+
+    /* Arrays are laid out by decreasing alignment. */
+    run->glyph_props = (SCRIPT_GLYPHPROP *)(run + 1);
+    run->char_props = (SCRIPT_CHARPROP *)(run->glyph_props + glyph_count);
+    run->chars = (WCHAR *)(run->char_props + char_count);
+    run->log_clust = run->chars + char_count;
+    run->glyphs = run->log_clust + char_count;
+
+    memcpy(run->glyph_props, glyph_props, glyph_count * sizeof(*glyph_props));
+    memcpy(run->char_props, char_props, char_count * sizeof(*char_props));
+    memcpy(run->chars, chars, char_count * sizeof(*chars));
+    memcpy(run->log_clust, log_clust, char_count * sizeof(*log_clust));
+    memcpy(run->glyphs, glyphs, glyph_count * sizeof(*glyphs));
+
+    EnterCriticalSection(&cs_script_cache);
+    old = sc->shaped_runs[hash % SHAPED_RUN_CACHE_SIZE];
+    sc->shaped_runs[hash % SHAPED_RUN_CACHE_SIZE] = run;
+    LeaveCriticalSection(&cs_script_cache);
+
+    heap_free(old);
+}
+
 static HRESULT init_script_cache(const HDC hdc, SCRIPT_CACHE *psc)
 {
     ScriptCache *sc;
@@ -1126,6 +1226,8 @@ HRESULT WINAPI ScriptFreeCache(SCRIPT_CACHE *psc)
             heap_free(((ScriptCache *)*psc)->scripts[n].languages);
         }
         heap_free(((ScriptCache *)*psc)->scripts);
+        for (i = 0; i < SHAPED_RUN_CACHE_SIZE; i++)
+            heap_free(((ScriptCache *)*psc)->shaped_runs[i]);
         heap_free(((ScriptCache *)*psc)->otm);
         heap_free(*psc);
         *psc = NULL;
@@ -3128,10 +3230,10 @@ HRESULT WINAPI ScriptShapeOpenType( HDC hdc, SCRIPT_CACHE *psc,
                                     SCRIPT_CHARPROP *pCharProps, WORD *pwOutGlyphs,
                                     SCRIPT_GLYPHPROP *pOutGlyphProps, int *pcGlyphs)
 {
+    BOOL rtl, cache_run = FALSE;
+    unsigned int g, hash = 0;
     HRESULT hr;
     int i;
-    unsigned int g;
-    BOOL rtl;
     int cluster;
     static int once = 0;
 
@@ -3159,6 +3261,17 @@ HRESULT WINAPI ScriptShapeOpenType( HDC hdc, SCRIPT_CACHE *psc,
     ((ScriptCache *)*psc)->userScript = tagScript;
     ((ScriptCache *)*psc)->userLang = tagLangSys;
 
+    /* Runs using ranges are not cached, their properties could change without
+     * any of the arguments changing. */
+    if (psa && !psa->fNoGlyphIndex && ((ScriptCache *)*psc)->sfnt && !cRanges && cChars <= SHAPED_RUN_MAX_CHARS)
+    {
+        hash = hash_shaped_run(psa, tagScript, tagLangSys, pwcChars, cChars);
+        if (get_cache_shaped_run(*psc, hash, psa, tagScript, tagLangSys, pwcChars, cChars, cMaxGlyphs,
+                pwLogClust, pCharProps, pwOutGlyphs, pOutGlyphProps, pcGlyphs))
+            return S_OK;
+        cache_run = TRUE;
+    }
+
     /* Initialize a SCRIPT_VISATTR and LogClust for each char in this run */
     for (i = 0; i < cChars; i++)
     {
@@ -3255,6 +3368,10 @@ HRESULT WINAPI ScriptShapeOpenType( HDC hdc, SCRIPT_CACHE *psc,
             }
         }
         heap_free(rChars);
+
+        if (cache_run)
+            set_cache_shaped_run(*psc, hash, psa, tagScript, tagLangSys, pwcChars, cChars, pwLogClust,
+                    pCharProps, pwOutGlyphs, pOutGlyphProps, *pcGlyphs);
     }
     else
     {
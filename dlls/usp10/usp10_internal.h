@@ -133,6 +133,9 @@ enum usp10_script
 
 #define NUM_PAGES         17
 
+#define SHAPED_RUN_CACHE_SIZE 256
+#define SHAPED_RUN_MAX_CHARS  256
+
 #define GSUB_E_NOFEATURE -20
 #define GSUB_E_NOGLYPH -10
 
@@ -185,6 +188,8 @@ typedef struct {
     WORD *glyphs[GLYPH_MAX / GLYPH_BLOCK_SIZE];
 } CacheGlyphPage;
 
+struct shaped_run;
+
 typedef struct {
     struct list entry;
     DWORD refcount;
@@ -204,6 +209,7 @@ typedef struct {
     LoadedScript *scripts;
     SIZE_T scripts_size;
     SIZE_T script_count;
+    struct shaped_run *shaped_runs[SHAPED_RUN_CACHE_SIZE];
 
     OPENTYPE_TAG userScript;
     OPENTYPE_TAG userLang;
@@ -21,6 +21,9 @@
 
 #include <stdarg.h>
 #include <math.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #define COBJMACROS
 
@@ -952,6 +955,60 @@ static HRESULT copypixels_to_32bppRGB(struct FormatConverter *This, const WICRec
     }
 }
 
+/* Premultiply 32bpp pixels with alpha in the last byte; the color channel
+ * order does not matter. */
+static void premultiply_alpha(BYTE *bits, UINT width, UINT height, UINT stride)
+{
+    UINT x, y;
+
+    for (y = 0; y < height; y++)
+    {
+        BYTE *pixel = bits + stride * y;
+
+        x = 0;
+#ifdef __SSE2__
+        {
+            const __m128i zero = _mm_setzero_si128(), one = _mm_set1_epi16(1);
+            const __m128i color_mask = _mm_set_epi16(0, ~0, ~0, ~0, 0, ~0, ~0, ~0);
+            const __m128i alpha_mask = _mm_set_epi16(0xff, 0, 0, 0, 0xff, 0, 0, 0);
+
+            for (; x + 4 <= width; x += 4, pixel += 16)
+            {
+                __m128i src = _mm_loadu_si128((const __m128i *)pixel), lo, hi, a;
+
+                lo = _mm_unpacklo_epi8(src, zero);
+                hi = _mm_unpackhi_epi8(src, zero);
+
+                /* Multiply the alpha channel by 255 so that it is preserved. */
+                a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, 0xff), 0xff);
+                a = _mm_or_si128(_mm_and_si128(a, color_mask), alpha_mask);
+                lo = _mm_add_epi16(_mm_mullo_epi16(lo, a), one);
+
+                a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, 0xff), 0xff);
+                a = _mm_or_si128(_mm_and_si128(a, color_mask), alpha_mask);
+                hi = _mm_add_epi16(_mm_mullo_epi16(hi, a), one);
+
+                /* Exact division by 255 for products of two bytes. */
+                lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+                hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+
+                _mm_storeu_si128((__m128i *)pixel, _mm_packus_epi16(lo, hi));
+            }
+        }
+#endif
+        for (; x < width; x++, pixel += 4)
+        {
+            BYTE alpha = pixel[3];
+            if (alpha != 255)
+            {
+                pixel[0] = pixel[0] * alpha / 255;
+                pixel[1] = pixel[1] * alpha / 255;
+                pixel[2] = pixel[2] * alpha / 255;
+            }
+        }
+    }
+}
+
 static HRESULT copypixels_to_32bppPBGRA(struct FormatConverter *This, const WICRect *prc,
     UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer, enum pixelformat source_format)
 {
@@ -966,21 +1023,7 @@ static HRESULT copypixels_to_32bppPBGRA(struct FormatConverter *This, const WICR
     default:
         hr = copypixels_to_32bppBGRA(This, prc, cbStride, cbBufferSize, pbBuffer, source_format);
         if (SUCCEEDED(hr) && prc)
-        {
-            INT x, y;
-
-            for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                {
-                    BYTE alpha = pbBuffer[cbStride*y+4*x+3];
-                    if (alpha != 255)
-                    {
-                        pbBuffer[cbStride*y+4*x] = pbBuffer[cbStride*y+4*x] * alpha / 255;
-                        pbBuffer[cbStride*y+4*x+1] = pbBuffer[cbStride*y+4*x+1] * alpha / 255;
-                        pbBuffer[cbStride*y+4*x+2] = pbBuffer[cbStride*y+4*x+2] * alpha / 255;
-                    }
-                }
-        }
+            premultiply_alpha(pbBuffer, prc->Width, prc->Height, cbStride);
         return hr;
     }
 }
@@ -999,21 +1042,7 @@ static HRESULT copypixels_to_32bppPRGBA(struct FormatConverter *This, const WICR
     default:
         hr = copypixels_to_32bppRGBA(This, prc, cbStride, cbBufferSize, pbBuffer, source_format);
         if (SUCCEEDED(hr) && prc)
-        {
-            INT x, y;
-
-            for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                {
-                    BYTE alpha = pbBuffer[cbStride*y+4*x+3];
-                    if (alpha != 255)
-                    {
-                        pbBuffer[cbStride*y+4*x] = pbBuffer[cbStride*y+4*x] * alpha / 255;
-                        pbBuffer[cbStride*y+4*x+1] = pbBuffer[cbStride*y+4*x+1] * alpha / 255;
-                        pbBuffer[cbStride*y+4*x+2] = pbBuffer[cbStride*y+4*x+2] * alpha / 255;
-                    }
-                }
-        }
+            premultiply_alpha(pbBuffer, prc->Width, prc->Height, cbStride);
         return hr;
     }
 }
@@ -20,6 +20,9 @@
 #include "config.h"
 
 #include <stdarg.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #define COBJMACROS
 
@@ -33,6 +36,16 @@
 
 WINE_DEFAULT_DEBUG_CHANNEL(wincodecs);
 
+/* Filter weights have 14 fractional bits and sum to 1 << FILTER_BITS. */
+#define FILTER_BITS 14
+
+struct scaler_filter
+{
+    UINT taps;
+    UINT *start;
+    USHORT *weights;
+};
+
 typedef struct BitmapScaler {
     IWICBitmapScaler IWICBitmapScaler_iface;
     LONG ref;
@@ -44,6 +57,8 @@ typedef struct BitmapScaler {
     UINT bpp;
     void (*fn_get_required_source_rect)(struct BitmapScaler*,UINT,UINT,WICRect*);
     void (*fn_copy_scanline)(struct BitmapScaler*,UINT,UINT,UINT,BYTE**,UINT,UINT,BYTE*);
+    struct scaler_filter filter_x, filter_y;
+    UINT *row;
     CRITICAL_SECTION lock; /* must be held when initialized */
 } BitmapScaler;
 
@@ -108,6 +123,11 @@ static ULONG WINAPI BitmapScaler_Release(IWICBitmapScaler *iface)
         This->lock.DebugInfo->Spare[0] = 0;
         DeleteCriticalSection(&This->lock);
         if (This->source) IWICBitmapSource_Release(This->source);
+        HeapFree(GetProcessHeap(), 0, This->filter_x.start);
+        HeapFree(GetProcessHeap(), 0, This->filter_x.weights);
+        HeapFree(GetProcessHeap(), 0, This->filter_y.start);
+        HeapFree(GetProcessHeap(), 0, This->filter_y.weights);
+        HeapFree(GetProcessHeap(), 0, This->row);
         HeapFree(GetProcessHeap(), 0, This);
     }
 
@@ -205,6 +225,197 @@ static void NearestNeighbor_CopyScanline(BitmapScaler *This,
     }
 }
 
+/* Build the weights for one axis. When shrinking with the box filter, each
+ * destination pixel averages the source pixels it covers, weighted by the
+ * covered area. Otherwise the two source pixels nearest to the destination
+ * pixel centre are interpolated linearly. */
+static BOOL init_scaler_filter(struct scaler_filter *filter, UINT src_size, UINT dst_size, BOOL box)
+{
+    UINT i, j, taps;
+
+    if (box)
+        taps = min((src_size + dst_size - 1) / dst_size + 1, src_size);
+    else
+        taps = min(2, src_size);
+
+    filter->taps = taps;
+    filter->start = HeapAlloc(GetProcessHeap(), 0, dst_size * sizeof(*filter->start));
+    filter->weights = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, dst_size * taps * sizeof(*filter->weights));
+    if (!filter->start || !filter->weights)
+        return FALSE;
+
+    for (i = 0; i < dst_size; i++)
+    {
+        USHORT *weights = filter->weights + i * taps;
+        UINT start, sum = 0, largest = 0;
+
+        if (box)
+        {
+            /* Positions are in units of 1 / dst_size source pixels. */
+            ULONGLONG lo = (ULONGLONG)i * src_size, hi = lo + src_size;
+
+            start = min(lo / dst_size, src_size - taps);
+            for (j = 0; j < taps; j++)
+            {
+                ULONGLONG pixel_lo = (ULONGLONG)(start + j) * dst_size;
+                ULONGLONG pixel_hi = pixel_lo + dst_size;
+
+                if (min(hi, pixel_hi) > max(lo, pixel_lo))
+                    weights[j] = ((min(hi, pixel_hi) - max(lo, pixel_lo)) << FILTER_BITS) / src_size;
+            }
+        }
+        else
+        {
+            /* Positions are in units of 1 / (2 * dst_size) source pixels. */
+            LONGLONG pos = (LONGLONG)(2 * i + 1) * src_size - dst_size;
+            UINT frac;
+
+            if (pos < 0) pos = 0;
+            start = pos / (2 * dst_size);
+            frac = ((pos % (2 * dst_size)) << FILTER_BITS) / (2 * dst_size);
+            if (taps == 1)
+                frac = 0;
+            else if (start + taps > src_size)
+            {
+                start = src_size - taps;
+                frac = 1 << FILTER_BITS;
+            }
+            weights[0] = (1 << FILTER_BITS) - frac;
+            if (taps > 1) weights[1] = frac;
+        }
+
+        /* Hand the rounding error to the heaviest tap. */
+        for (j = 0; j < taps; j++)
+        {
+            sum += weights[j];
+            if (weights[j] > weights[largest]) largest = j;
+        }
+        weights[largest] += (1 << FILTER_BITS) - sum;
+        filter->start[i] = start;
+    }
+
+    return TRUE;
+}
+
+static void Filter_GetRequiredSourceRect(BitmapScaler *This,
+    UINT x, UINT y, WICRect *src_rect)
+{
+    src_rect->X = This->filter_x.start[x];
+    src_rect->Y = This->filter_y.start[y];
+    src_rect->Width = This->filter_x.taps;
+    src_rect->Height = This->filter_y.taps;
+}
+
+/* Vertical pass, keeping 8 fractional bits in the intermediate row. */
+static void filter_columns(UINT *row, BYTE **src_rows, UINT offset, UINT count,
+    const USHORT *weights, UINT taps)
+{
+    UINT i = 0, t;
+
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128(), round = _mm_set1_epi32(1 << 5);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i lo = round, hi = round;
+
+        for (t = 0; t < taps; t += 2)
+        {
+            __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(src_rows[t] + offset + i)), zero);
+            __m128i b = zero, w;
+
+            if (t + 1 < taps)
+            {
+                b = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(src_rows[t + 1] + offset + i)), zero);
+                w = _mm_set1_epi32(weights[t] | (weights[t + 1] << 16));
+            }
+            else
+                w = _mm_set1_epi32(weights[t]);
+
+            lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w));
+            hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), w));
+        }
+
+        _mm_storeu_si128((__m128i *)(row + i), _mm_srli_epi32(lo, 6));
+        _mm_storeu_si128((__m128i *)(row + i + 4), _mm_srli_epi32(hi, 6));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        UINT acc = 1 << 5;
+
+        for (t = 0; t < taps; t++)
+            acc += weights[t] * src_rows[t][offset + i];
+        row[i] = acc >> 6;
+    }
+}
+
+static void Filter_CopyScanline(BitmapScaler *This,
+    UINT dst_x, UINT dst_y, UINT dst_width,
+    BYTE **src_data, UINT src_data_x, UINT src_data_y, BYTE *pbBuffer)
+{
+    const struct scaler_filter *filter_x = &This->filter_x, *filter_y = &This->filter_y;
+    UINT channels = This->bpp / 8;
+    UINT first = filter_x->start[dst_x];
+    UINT last = filter_x->start[dst_x + dst_width - 1] + filter_x->taps;
+    UINT i, j, t;
+
+    filter_columns(This->row, src_data + filter_y->start[dst_y] - src_data_y,
+        (first - src_data_x) * channels, (last - first) * channels,
+        filter_y->weights + dst_y * filter_y->taps, filter_y->taps);
+
+    for (i = 0; i < dst_width; i++)
+    {
+        const USHORT *weights = filter_x->weights + (dst_x + i) * filter_x->taps;
+        const UINT *src = This->row + (filter_x->start[dst_x + i] - first) * channels;
+
+        for (j = 0; j < channels; j++)
+        {
+            UINT acc = 1 << (2 * FILTER_BITS - 6 - 1);
+
+            for (t = 0; t < filter_x->taps; t++)
+                acc += weights[t] * src[t * channels + j];
+            *pbBuffer++ = min(acc >> (2 * FILTER_BITS - 6), 255);
+        }
+    }
+}
+
+/* Formats where every byte is an independent channel can be filtered. */
+static BOOL is_filterable_format(const WICPixelFormatGUID *format)
+{
+    return IsEqualGUID(format, &GUID_WICPixelFormat8bppGray) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat24bppBGR) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat24bppRGB) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat32bppBGR) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat32bppBGRA) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat32bppPBGRA) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat32bppRGBA) ||
+           IsEqualGUID(format, &GUID_WICPixelFormat32bppPRGBA);
+}
+
+static HRESULT init_filters(BitmapScaler *This)
+{
+    BOOL box = This->mode != WICBitmapInterpolationModeLinear;
+
+    if (!init_scaler_filter(&This->filter_x, This->src_width, This->width, box && This->src_width > This->width) ||
+        !init_scaler_filter(&This->filter_y, This->src_height, This->height, box && This->src_height > This->height) ||
+        !(This->row = HeapAlloc(GetProcessHeap(), 0, This->src_width * (This->bpp / 8) * sizeof(*This->row))))
+    {
+        HeapFree(GetProcessHeap(), 0, This->filter_x.start);
+        HeapFree(GetProcessHeap(), 0, This->filter_x.weights);
+        HeapFree(GetProcessHeap(), 0, This->filter_y.start);
+        HeapFree(GetProcessHeap(), 0, This->filter_y.weights);
+        memset(&This->filter_x, 0, sizeof(This->filter_x));
+        memset(&This->filter_y, 0, sizeof(This->filter_y));
+        return E_OUTOFMEMORY;
+    }
+
+    This->fn_get_required_source_rect = Filter_GetRequiredSourceRect;
+    This->fn_copy_scanline = Filter_CopyScanline;
+    return S_OK;
+}
+
 static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
     const WICRect *prc, UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
 {
@@ -356,6 +567,20 @@ static HRESULT WINAPI BitmapScaler_Initialize(IWICBitmapScaler *iface,
         default:
             FIXME("unsupported mode %i\n", mode);
             /* fall-through */
+        case WICBitmapInterpolationModeLinear:
+        case WICBitmapInterpolationModeCubic:
+        case WICBitmapInterpolationModeFant:
+            if (is_filterable_format(&src_pixelformat))
+            {
+                if (SUCCEEDED(hr = init_filters(This)))
+                {
+                    IWICBitmapSource_AddRef(pISource);
+                    This->source = pISource;
+                }
+                break;
+            }
+            FIXME("filtering not implemented for format %s\n", debugstr_guid(&src_pixelformat));
+            /* fall-through */
         case WICBitmapInterpolationModeNearestNeighbor:
             if ((This->bpp % 8) == 0)
             {
@@ -529,6 +754,9 @@ HRESULT BitmapScaler_Create(IWICBitmapScaler **scaler)
     This->src_height = 0;
     This->mode = 0;
     This->bpp = 0;
+    memset(&This->filter_x, 0, sizeof(This->filter_x));
+    memset(&This->filter_y, 0, sizeof(This->filter_y));
+    This->row = NULL;
     InitializeCriticalSection(&This->lock);
     This->lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": BitmapScaler.lock");
 
@@ -1312,6 +1312,40 @@ static void test_bitmap_scaler(void)
     IWICBitmap_Release(bitmap);
 }
 
+static void test_bitmap_scaler_filter(void)
+{
+    static const BYTE src[] =
+    {
+        0x10, 0x20, 0x30, 0x40, 0x10, 0x20, 0x30, 0x40, 0x90, 0xa0, 0xb0, 0xc0, 0x90, 0xa0, 0xb0, 0xc0,
+        0x10, 0x20, 0x30, 0x40, 0x10, 0x20, 0x30, 0x40, 0x90, 0xa0, 0xb0, 0xc0, 0x90, 0xa0, 0xb0, 0xc0,
+    };
+    static const BYTE expected[] = {0x10, 0x20, 0x30, 0x40, 0x90, 0xa0, 0xb0, 0xc0};
+    IWICBitmapScaler *scaler;
+    IWICBitmap *bitmap;
+    BYTE buf[8];
+    HRESULT hr;
+
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 4, 2, &GUID_WICPixelFormat32bppBGRA,
+        16, sizeof(src), (BYTE *)src, &bitmap);
+    ok(hr == S_OK, "Failed to create a bitmap, hr %#x.\n", hr);
+
+    hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+    ok(hr == S_OK, "Failed to create bitmap scaler, hr %#x.\n", hr);
+
+    hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, 2, 1,
+        WICBitmapInterpolationModeFant);
+    ok(hr == S_OK, "Failed to initialize bitmap scaler, hr %#x.\n", hr);
+
+    memset(buf, 0, sizeof(buf));
+    hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 8, sizeof(buf), buf);
+    ok(hr == S_OK, "Failed to copy pixels, hr %#x.\n", hr);
+    ok(!memcmp(buf, expected, sizeof(expected)), "Unexpected data %02x %02x %02x %02x %02x %02x %02x %02x.\n",
+        buf[0], buf[1], buf[2], buf[3], buf[4], buf[5], buf[6], buf[7]);
+
+    IWICBitmapScaler_Release(scaler);
+    IWICBitmap_Release(bitmap);
+}
+
 static LONG obj_refcount(void *obj)
 {
     IUnknown_AddRef((IUnknown *)obj);
@@ -1482,6 +1516,7 @@ START_TEST(bitmap)
     test_CreateBitmapFromHBITMAP();
     test_clipper();
     test_bitmap_scaler();
+    test_bitmap_scaler_filter();
 
     IWICImagingFactory_Release(factory);
 
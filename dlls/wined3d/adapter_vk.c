@@ -480,6 +480,75 @@ done:
     return success;
 }
 
+static void wined3d_pipeline_cache_vk_get_key(struct wined3d_shader_cache_key *key)
+{
+    static const char name[] = "VkPipelineCache";
+
+    wined3d_shader_cache_key_init(key);
+    wined3d_shader_cache_key_update(key, name, sizeof(name));
+}
+
+static void wined3d_device_vk_create_pipeline_cache(struct wined3d_device_vk *device_vk,
+        const struct wined3d_adapter_vk *adapter_vk)
+{
+    const struct wined3d_vk_info *vk_info = &device_vk->vk_info;
+    VkPipelineCacheCreateInfo cache_info;
+    VkPhysicalDeviceProperties properties;
+    struct wined3d_shader_cache_key key;
+    void *data = NULL;
+    size_t size = 0;
+    VkResult vr;
+
+    /* The pipeline cache UUID changes whenever the driver's cache format
+     * does; implementations also validate the initial data themselves. */
+    VK_CALL(vkGetPhysicalDeviceProperties(adapter_vk->physical_device, &properties));
+    if (wined3d_shader_cache_init(&device_vk->pipeline_cache, "vulkan",
+            properties.pipelineCacheUUID, sizeof(properties.pipelineCacheUUID)))
+    {
+        wined3d_pipeline_cache_vk_get_key(&key);
+        data = wined3d_shader_cache_get(&device_vk->pipeline_cache, &key, &size);
+    }
+
+    cache_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cache_info.pNext = NULL;
+    cache_info.flags = 0;
+    cache_info.initialDataSize = data ? size : 0;
+    cache_info.pInitialData = data;
+    if ((vr = VK_CALL(vkCreatePipelineCache(device_vk->vk_device,
+            &cache_info, NULL, &device_vk->vk_pipeline_cache))) < 0)
+    {
+        WARN("Failed to create Vulkan pipeline cache, vr %s.\n", wined3d_debug_vkresult(vr));
+        device_vk->vk_pipeline_cache = VK_NULL_HANDLE;
+    }
+    heap_free(data);
+}
+
+static void wined3d_device_vk_destroy_pipeline_cache(struct wined3d_device_vk *device_vk, bool store)
+{
+    const struct wined3d_vk_info *vk_info = &device_vk->vk_info;
+    struct wined3d_shader_cache_key key;
+    size_t size = 0;
+    void *data;
+
+    if (!device_vk->vk_pipeline_cache)
+        return;
+
+    if (store && device_vk->pipeline_cache.enabled
+            && VK_CALL(vkGetPipelineCacheData(device_vk->vk_device, device_vk->vk_pipeline_cache, &size, NULL)) >= 0
+            && size && (data = heap_alloc(size)))
+    {
+        if (VK_CALL(vkGetPipelineCacheData(device_vk->vk_device, device_vk->vk_pipeline_cache, &size, data)) >= 0)
+        {
+            wined3d_pipeline_cache_vk_get_key(&key);
+            wined3d_shader_cache_put(&device_vk->pipeline_cache, &key, data, size);
+        }
+        heap_free(data);
+    }
+
+    VK_CALL(vkDestroyPipelineCache(device_vk->vk_device, device_vk->vk_pipeline_cache, NULL));
+    device_vk->vk_pipeline_cache = VK_NULL_HANDLE;
+}
+
 static HRESULT adapter_vk_create_device(struct wined3d *wined3d, const struct wined3d_adapter *adapter,
         enum wined3d_device_type device_type, HWND focus_window, unsigned int flags, BYTE surface_alignment,
         const enum wined3d_feature_level *levels, unsigned int level_count,
@@ -589,10 +658,13 @@ static HRESULT adapter_vk_create_device(struct wined3d *wined3d, const struct wi
         goto fail;
     }
 
+    wined3d_device_vk_create_pipeline_cache(device_vk, adapter_vk);
+
     if (FAILED(hr = wined3d_device_init(&device_vk->d, wined3d, adapter->ordinal, device_type, focus_window,
             flags, surface_alignment, levels, level_count, vk_info->supported, device_parent)))
     {
         WARN("Failed to initialize device, hr %#x.\n", hr);
+        wined3d_device_vk_destroy_pipeline_cache(device_vk, false);
         wined3d_allocator_cleanup(&device_vk->allocator);
         goto fail;
     }
@@ -613,6 +685,7 @@ static void adapter_vk_destroy_device(struct wined3d_device *device)
     const struct wined3d_vk_info *vk_info = &device_vk->vk_info;
 
     wined3d_device_cleanup(&device_vk->d);
+    wined3d_device_vk_destroy_pipeline_cache(device_vk, true);
     wined3d_allocator_cleanup(&device_vk->allocator);
     VK_CALL(vkDestroyDevice(device_vk->vk_device, NULL));
     heap_free(device_vk);
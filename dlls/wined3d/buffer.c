@@ -1234,6 +1234,37 @@ void wined3d_buffer_upload_data(struct wined3d_buffer *buffer, struct wined3d_co
     buffer->buffer_ops->buffer_upload_ranges(buffer, context, data, range.offset, 1, &range);
 }
 
+/* Context activation is done by the caller. */
+void wined3d_buffer_replace_data(struct wined3d_buffer *buffer, struct wined3d_context *context, const void *data)
+{
+    struct wined3d_range range = {0, buffer->resource.size};
+    struct wined3d_bo_address addr;
+
+    TRACE("buffer %p, context %p, data %p.\n", buffer, context, data);
+
+    if ((buffer->flags & WINED3D_BUFFER_USE_BO) && !(buffer->flags & WINED3D_BUFFER_PIN_SYSMEM)
+            && !buffer->conversion_map && wined3d_buffer_prepare_location(buffer, context, WINED3D_LOCATION_BUFFER))
+    {
+        buffer->buffer_ops->buffer_upload_ranges(buffer, context, data, 0, 1, &range);
+        wined3d_buffer_validate_location(buffer, WINED3D_LOCATION_BUFFER);
+        wined3d_buffer_invalidate_location(buffer, ~WINED3D_LOCATION_BUFFER);
+        return;
+    }
+
+    /* Converted and pinned buffers are uploaded from system memory when
+     * they are next used. */
+    if (!wined3d_buffer_prepare_location(buffer, context, WINED3D_LOCATION_SYSMEM))
+    {
+        ERR("Failed to prepare system memory location.\n");
+        return;
+    }
+
+    wined3d_buffer_get_memory(buffer, &addr, WINED3D_LOCATION_SYSMEM);
+    memcpy(addr.addr, data, buffer->resource.size);
+    wined3d_buffer_validate_location(buffer, WINED3D_LOCATION_SYSMEM);
+    wined3d_buffer_invalidate_location(buffer, ~WINED3D_LOCATION_SYSMEM);
+}
+
 static void wined3d_buffer_init_data(struct wined3d_buffer *buffer,
         struct wined3d_device *device, const struct wined3d_sub_resource_data *data)
 {
@@ -1497,6 +1528,15 @@ static void wined3d_buffer_gl_upload_ranges(struct wined3d_buffer *buffer, struc
 
     wined3d_buffer_gl_bind(buffer_gl, context_gl);
 
+    /* When the whole buffer is replaced, orphan the old buffer storage
+     * instead of waiting for the GPU to finish with it. This can't be done
+     * while the buffer is mapped through the buffer object. */
+    if (range_count == 1 && !ranges->offset && ranges->size == buffer->resource.size && !buffer->map_ptr)
+    {
+        GL_EXTCALL(glBufferData(buffer_gl->bo.binding, buffer->resource.size, NULL, buffer_gl->buffer_object_usage));
+        checkGLcall("glBufferData");
+    }
+
     while (range_count--)
     {
         range = &ranges[range_count];
@@ -2666,7 +2666,7 @@ static VkPipeline wined3d_context_vk_get_graphics_pipeline(struct wined3d_contex
     pipeline_vk->key = *key;
 
     if ((vr = VK_CALL(vkCreateGraphicsPipelines(device_vk->vk_device,
-            VK_NULL_HANDLE, 1, &key->pipeline_desc, NULL, &pipeline_vk->vk_pipeline))) < 0)
+            device_vk->vk_pipeline_cache, 1, &key->pipeline_desc, NULL, &pipeline_vk->vk_pipeline))) < 0)
     {
         WARN("Failed to create graphics pipeline, vr %s.\n", wined3d_debug_vkresult(vr));
         heap_free(pipeline_vk);
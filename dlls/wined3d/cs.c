@@ -21,6 +21,7 @@
 #include "wined3d_private.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(d3d);
+WINE_DECLARE_DEBUG_CHANNEL(d3d_perf);
 WINE_DECLARE_DEBUG_CHANNEL(fps);
 
 #define WINED3D_INITIAL_CS_SIZE 4096
@@ -70,6 +71,7 @@ enum wined3d_cs_op
     WINED3D_CS_OP_UNMAP,
     WINED3D_CS_OP_BLT_SUB_RESOURCE,
     WINED3D_CS_OP_UPDATE_SUB_RESOURCE,
+    WINED3D_CS_OP_UPLOAD_BUFFER,
     WINED3D_CS_OP_ADD_DIRTY_TEXTURE_REGION,
     WINED3D_CS_OP_CLEAR_UNORDERED_ACCESS_VIEW,
     WINED3D_CS_OP_COPY_UAV_COUNTER,
@@ -413,6 +415,13 @@ struct wined3d_cs_update_sub_resource
     struct wined3d_sub_resource_data data;
 };
 
+struct wined3d_cs_upload_buffer
+{
+    enum wined3d_cs_op opcode;
+    struct wined3d_resource *resource;
+    BYTE data[1];
+};
+
 struct wined3d_cs_add_dirty_texture_region
 {
     enum wined3d_cs_op opcode;
@@ -505,6 +514,7 @@ static const char *debug_cs_op(enum wined3d_cs_op op)
         WINED3D_TO_STR(WINED3D_CS_OP_UNMAP);
         WINED3D_TO_STR(WINED3D_CS_OP_BLT_SUB_RESOURCE);
         WINED3D_TO_STR(WINED3D_CS_OP_UPDATE_SUB_RESOURCE);
+        WINED3D_TO_STR(WINED3D_CS_OP_UPLOAD_BUFFER);
         WINED3D_TO_STR(WINED3D_CS_OP_ADD_DIRTY_TEXTURE_REGION);
         WINED3D_TO_STR(WINED3D_CS_OP_CLEAR_UNORDERED_ACCESS_VIEW);
         WINED3D_TO_STR(WINED3D_CS_OP_COPY_UAV_COUNTER);
@@ -2455,6 +2465,37 @@ void wined3d_cs_emit_update_sub_resource(struct wined3d_cs *cs, struct wined3d_r
     wined3d_cs_finish(cs, WINED3D_CS_QUEUE_MAP);
 }
 
+static void wined3d_cs_exec_upload_buffer(struct wined3d_cs *cs, const void *data)
+{
+    const struct wined3d_cs_upload_buffer *op = data;
+    struct wined3d_resource *resource = op->resource;
+    struct wined3d_context *context;
+
+    context = context_acquire(cs->device, NULL, 0);
+    wined3d_buffer_replace_data(buffer_from_resource(resource), context, op->data);
+    context_release(context);
+
+    wined3d_resource_release(resource);
+}
+
+void wined3d_cs_emit_upload_buffer(struct wined3d_cs *cs, struct wined3d_resource *resource, const void *data)
+{
+    struct wined3d_cs_upload_buffer *op;
+
+    /* Unlike update_sub_resource, this goes through the default queue. The
+     * new contents replace the whole buffer, so they must not become visible
+     * to draws that were queued before the buffer was mapped. */
+    op = wined3d_cs_require_space(cs, FIELD_OFFSET(struct wined3d_cs_upload_buffer, data[resource->size]),
+            WINED3D_CS_QUEUE_DEFAULT);
+    op->opcode = WINED3D_CS_OP_UPLOAD_BUFFER;
+    op->resource = resource;
+    memcpy(op->data, data, resource->size);
+
+    wined3d_resource_acquire(resource);
+
+    wined3d_cs_submit(cs, WINED3D_CS_QUEUE_DEFAULT);
+}
+
 static void wined3d_cs_exec_add_dirty_texture_region(struct wined3d_cs *cs, const void *data)
 {
     const struct wined3d_cs_add_dirty_texture_region *op = data;
@@ -2626,6 +2667,7 @@ static void (* const wined3d_cs_op_handlers[])(struct wined3d_cs *cs, const void
     /* WINED3D_CS_OP_UNMAP                       */ wined3d_cs_exec_unmap,
     /* WINED3D_CS_OP_BLT_SUB_RESOURCE            */ wined3d_cs_exec_blt_sub_resource,
     /* WINED3D_CS_OP_UPDATE_SUB_RESOURCE         */ wined3d_cs_exec_update_sub_resource,
+    /* WINED3D_CS_OP_UPLOAD_BUFFER               */ wined3d_cs_exec_upload_buffer,
     /* WINED3D_CS_OP_ADD_DIRTY_TEXTURE_REGION    */ wined3d_cs_exec_add_dirty_texture_region,
     /* WINED3D_CS_OP_CLEAR_UNORDERED_ACCESS_VIEW */ wined3d_cs_exec_clear_unordered_access_view,
     /* WINED3D_CS_OP_COPY_UAV_COUNTER            */ wined3d_cs_exec_copy_uav_counter,
@@ -2707,7 +2749,7 @@ static void wined3d_cs_queue_submit(struct wined3d_cs_queue *queue, struct wined
     InterlockedExchange(&queue->head, (queue->head + packet_size) & (WINED3D_CS_QUEUE_SIZE - 1));
 
     if (InterlockedCompareExchange(&cs->waiting_for_event, FALSE, TRUE))
-        SetEvent(cs->event);
+        RtlWakeAddressSingle(&cs->waiting_for_event);
 }
 
 static void wined3d_cs_mt_submit(struct wined3d_cs *cs, enum wined3d_cs_queue_id queue_id)
@@ -2820,8 +2862,57 @@ static void poll_queries(struct wined3d_cs *cs)
     }
 }
 
-static void wined3d_cs_wait_event(struct wined3d_cs *cs)
+struct wined3d_cs_stats
+{
+    LARGE_INTEGER frequency;
+    LONGLONG report_time;
+    LONGLONG wait_time;
+    unsigned int wait_count;
+    struct
+    {
+        unsigned int count;
+        LONGLONG time;
+    } ops[WINED3D_CS_OP_STOP];
+};
+
+static LONGLONG wined3d_cs_stats_get_time(void)
+{
+    LARGE_INTEGER counter;
+
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart;
+}
+
+static void wined3d_cs_stats_report(struct wined3d_cs *cs, struct wined3d_cs_stats *stats, LONGLONG time)
+{
+    double scale = 1000.0 / stats->frequency.QuadPart;
+    unsigned int i;
+
+    /* Every 1.5 seconds, like the fps channel. */
+    if (time - stats->report_time < stats->frequency.QuadPart * 3 / 2)
+        return;
+
+    TRACE_(d3d_perf)("%p: %.3f ms spent waiting for commands in %u waits.\n",
+            cs, stats->wait_time * scale, stats->wait_count);
+    for (i = 0; i < ARRAY_SIZE(stats->ops); ++i)
+    {
+        if (!stats->ops[i].count)
+            continue;
+        TRACE_(d3d_perf)("%p: %s, %u calls, %.3f ms.\n",
+                cs, debug_cs_op(i), stats->ops[i].count, stats->ops[i].time * scale);
+    }
+
+    memset(stats->ops, 0, sizeof(stats->ops));
+    stats->wait_time = 0;
+    stats->wait_count = 0;
+    stats->report_time = time;
+}
+
+/* Returns TRUE if the CS thread actually went to sleep. */
+static BOOL wined3d_cs_wait_event(struct wined3d_cs *cs)
 {
+    static const LONG waiting = TRUE;
+
     InterlockedExchange(&cs->waiting_for_event, TRUE);
 
     /* The main thread might have enqueued a command and blocked on it after
@@ -2829,29 +2920,40 @@ static void wined3d_cs_wait_event(struct wined3d_cs *cs)
      * "waiting_for_event" was set.
      *
      * Likewise, we can race with the main thread when resetting
-     * "waiting_for_event", in which case we would need to call
-     * WaitForSingleObject() because the main thread called SetEvent(). */
+     * "waiting_for_event". That's harmless though; RtlWaitOnAddress()
+     * returns immediately once "waiting_for_event" no longer matches. */
     if (!(wined3d_cs_queue_is_empty(cs, &cs->queue[WINED3D_CS_QUEUE_DEFAULT])
             && wined3d_cs_queue_is_empty(cs, &cs->queue[WINED3D_CS_QUEUE_MAP]))
             && InterlockedCompareExchange(&cs->waiting_for_event, FALSE, TRUE))
-        return;
+        return FALSE;
 
-    WaitForSingleObject(cs->event, INFINITE);
+    while (*(volatile LONG *)&cs->waiting_for_event)
+        RtlWaitOnAddress(&cs->waiting_for_event, &waiting, sizeof(waiting), NULL);
+
+    return TRUE;
 }
 
 static DWORD WINAPI wined3d_cs_run(void *ctx)
 {
+    unsigned int spin_count = 0, spin_limit = WINED3D_CS_SPIN_COUNT_MIN;
+    struct wined3d_cs_stats *stats = NULL;
     struct wined3d_cs_packet *packet;
     struct wined3d_cs_queue *queue;
-    unsigned int spin_count = 0;
     struct wined3d_cs *cs = ctx;
     enum wined3d_cs_op opcode;
     HMODULE wined3d_module;
+    LONGLONG start_time = 0;
     unsigned int poll = 0;
     LONG tail;
 
     TRACE("Started.\n");
 
+    if (TRACE_ON(d3d_perf) && (stats = heap_alloc_zero(sizeof(*stats))))
+    {
+        QueryPerformanceFrequency(&stats->frequency);
+        stats->report_time = wined3d_cs_stats_get_time();
+    }
+
     /* Copy the module handle to a local variable to avoid racing with the
      * thread freeing "cs" before the FreeLibraryAndExitThread() call. */
     wined3d_module = cs->wined3d_module;
@@ -2872,11 +2974,28 @@ static DWORD WINAPI wined3d_cs_run(void *ctx)
             queue = &cs->queue[WINED3D_CS_QUEUE_DEFAULT];
             if (wined3d_cs_queue_is_empty(cs, queue))
             {
-                if (++spin_count >= WINED3D_CS_SPIN_COUNT && list_empty(&cs->query_poll_list))
-                    wined3d_cs_wait_event(cs);
+                if (++spin_count >= spin_limit && list_empty(&cs->query_poll_list))
+                {
+                    if (stats)
+                        start_time = wined3d_cs_stats_get_time();
+                    /* Spinning didn't pay off this time; spin for less
+                     * before going to sleep next time. */
+                    if (wined3d_cs_wait_event(cs))
+                        spin_limit = max(spin_limit / 2, WINED3D_CS_SPIN_COUNT_MIN);
+                    if (stats)
+                    {
+                        stats->wait_time += wined3d_cs_stats_get_time() - start_time;
+                        ++stats->wait_count;
+                    }
+                    spin_count = 0;
+                }
                 continue;
             }
         }
+        /* New commands arrived late in the spin window; spin for longer next
+         * time, so that slightly later commands don't cost a sleep. */
+        if (spin_count > spin_limit / 2)
+            spin_limit = min(spin_limit * 2, WINED3D_CS_SPIN_COUNT_MAX);
         spin_count = 0;
 
         tail = queue->tail;
@@ -2893,7 +3012,18 @@ static DWORD WINAPI wined3d_cs_run(void *ctx)
                 break;
             }
 
-            wined3d_cs_op_handlers[opcode](cs, packet->data);
+            if (stats)
+            {
+                start_time = wined3d_cs_stats_get_time();
+                wined3d_cs_op_handlers[opcode](cs, packet->data);
+                ++stats->ops[opcode].count;
+                stats->ops[opcode].time += wined3d_cs_stats_get_time() - start_time;
+                wined3d_cs_stats_report(cs, stats, start_time);
+            }
+            else
+            {
+                wined3d_cs_op_handlers[opcode](cs, packet->data);
+            }
             TRACE("%s executed.\n", debug_cs_op(opcode));
         }
 
@@ -2904,6 +3034,7 @@ static DWORD WINAPI wined3d_cs_run(void *ctx)
 
     cs->queue[WINED3D_CS_QUEUE_MAP].tail = cs->queue[WINED3D_CS_QUEUE_MAP].head;
     cs->queue[WINED3D_CS_QUEUE_DEFAULT].tail = cs->queue[WINED3D_CS_QUEUE_DEFAULT].head;
+    heap_free(stats);
     TRACE("Stopped.\n");
     FreeLibraryAndExitThread(wined3d_module, 0);
 }
@@ -2930,18 +3061,10 @@ struct wined3d_cs *wined3d_cs_create(struct wined3d_device *device)
     {
         cs->ops = &wined3d_cs_mt_ops;
 
-        if (!(cs->event = CreateEventW(NULL, FALSE, FALSE, NULL)))
-        {
-            ERR("Failed to create command stream event.\n");
-            heap_free(cs->data);
-            goto fail;
-        }
-
         if (!(GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS,
                 (const WCHAR *)wined3d_cs_run, &cs->wined3d_module)))
         {
             ERR("Failed to get wined3d module handle.\n");
-            CloseHandle(cs->event);
             heap_free(cs->data);
             goto fail;
         }
@@ -2950,7 +3073,6 @@ struct wined3d_cs *wined3d_cs_create(struct wined3d_device *device)
         {
             ERR("Failed to create wined3d command stream thread.\n");
             FreeLibrary(cs->wined3d_module);
-            CloseHandle(cs->event);
             heap_free(cs->data);
             goto fail;
         }
@@ -2970,8 +3092,6 @@ void wined3d_cs_destroy(struct wined3d_cs *cs)
     {
         wined3d_cs_emit_stop(cs);
         CloseHandle(cs->thread);
-        if (!CloseHandle(cs->event))
-            ERR("Closing event failed.\n");
     }
 
     state_cleanup(&cs->state);
@@ -144,6 +144,9 @@ struct shader_glsl_priv
     struct wine_rb_tree ffp_fragment_shaders;
     BOOL ffp_proj_control;
     BOOL legacy_lighting;
+
+    struct wined3d_shader_cache program_cache;
+    BOOL program_cache_initialised;
 };
 
 struct glsl_vs_program
@@ -642,6 +645,150 @@ void shader_glsl_validate_link(const struct wined3d_gl_info *gl_info, GLuint pro
     print_glsl_info_log(gl_info, program, TRUE);
 }
 
+/* Context activation is done by the caller. */
+static BOOL shader_glsl_init_program_cache(struct shader_glsl_priv *priv, const struct wined3d_gl_info *gl_info)
+{
+    static const GLenum names[] = {GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION_ARB};
+    struct wined3d_string_buffer *driver_id;
+    GLint format_count = 0;
+    const char *str;
+    unsigned int i;
+
+    if (priv->program_cache_initialised)
+        return priv->program_cache.enabled;
+    priv->program_cache_initialised = TRUE;
+
+    if (!gl_info->supported[ARB_GET_PROGRAM_BINARY])
+        return FALSE;
+
+    gl_info->gl_ops.gl.p_glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+    if (!format_count)
+    {
+        TRACE("No program binary formats supported.\n");
+        return FALSE;
+    }
+
+    if (!(driver_id = string_buffer_get(&priv->string_buffers)))
+        return FALSE;
+    for (i = 0; i < ARRAY_SIZE(names); ++i)
+    {
+        if ((str = (const char *)gl_info->gl_ops.gl.p_glGetString(names[i])))
+            shader_addline(driver_id, "%s\n", str);
+    }
+    wined3d_shader_cache_init(&priv->program_cache, "glsl", driver_id->buffer, driver_id->content_size);
+    string_buffer_release(&priv->string_buffers, driver_id);
+
+    return priv->program_cache.enabled;
+}
+
+/* The generated GLSL already reflects the shader byte code, its compile
+ * arguments and the settings that affect code generation, and the attribute,
+ * fragment data and transform feedback bindings are derived from the same
+ * shaders. Hashing the attached sources is therefore enough to identify a
+ * linked program. */
+/* Context activation is done by the caller. */
+static BOOL shader_glsl_get_program_cache_key(const struct wined3d_gl_info *gl_info,
+        GLuint program, struct wined3d_shader_cache_key *key)
+{
+    GLuint shaders[WINED3D_SHADER_TYPE_COUNT];
+    GLint i, source_size = 0;
+    GLsizei shader_count = 0;
+    GLsizei hashed = 0;
+    char *source = NULL;
+    GLsizei length;
+
+    GL_EXTCALL(glGetAttachedShaders(program, ARRAY_SIZE(shaders), &shader_count, shaders));
+    wined3d_shader_cache_key_init(key);
+    for (i = 0; i < shader_count; ++i)
+    {
+        GLint tmp;
+
+        GL_EXTCALL(glGetShaderiv(shaders[i], GL_SHADER_SOURCE_LENGTH, &tmp));
+        if (tmp <= 0)
+        {
+            WARN("Shader %u has no source.\n", shaders[i]);
+            continue;
+        }
+        if (source_size < tmp)
+        {
+            heap_free(source);
+            if (!(source = heap_alloc(tmp)))
+                return FALSE;
+            source_size = tmp;
+        }
+
+        length = 0;
+        GL_EXTCALL(glGetShaderSource(shaders[i], source_size, &length, source));
+        if (!length)
+            continue;
+        wined3d_shader_cache_key_update(key, source, length + 1);
+        ++hashed;
+    }
+    heap_free(source);
+    checkGLcall("get program cache key");
+
+    /* A program with unhashed shaders can't be identified by its key. */
+    return hashed && hashed == shader_count;
+}
+
+/* Context activation is done by the caller. */
+static void shader_glsl_link_program(struct shader_glsl_priv *priv,
+        const struct wined3d_gl_info *gl_info, GLuint program_id)
+{
+    struct wined3d_shader_cache_key key;
+    GLint status = 0, length = 0;
+    GLenum format;
+    size_t size;
+    BYTE *data;
+
+    TRACE("Linking GLSL shader program %u.\n", program_id);
+
+    if (!shader_glsl_init_program_cache(priv, gl_info)
+            || !shader_glsl_get_program_cache_key(gl_info, program_id, &key))
+    {
+        GL_EXTCALL(glLinkProgram(program_id));
+        shader_glsl_validate_link(gl_info, program_id);
+        return;
+    }
+
+    if ((data = wined3d_shader_cache_get(&priv->program_cache, &key, &size)))
+    {
+        if (size > sizeof(format))
+        {
+            memcpy(&format, data, sizeof(format));
+            GL_EXTCALL(glProgramBinary(program_id, format, data + sizeof(format), size - sizeof(format)));
+            GL_EXTCALL(glGetProgramiv(program_id, GL_LINK_STATUS, &status));
+        }
+        heap_free(data);
+
+        if (status)
+        {
+            TRACE("Loaded program %u from the program cache.\n", program_id);
+            return;
+        }
+        /* Drivers are free to reject binaries, e.g. after an update that
+         * didn't change the version string. Link the program again and
+         * replace the entry. */
+        WARN("Failed to load cached program binary.\n");
+    }
+
+    GL_EXTCALL(glProgramParameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+    GL_EXTCALL(glLinkProgram(program_id));
+    shader_glsl_validate_link(gl_info, program_id);
+
+    GL_EXTCALL(glGetProgramiv(program_id, GL_LINK_STATUS, &status));
+    if (status)
+        GL_EXTCALL(glGetProgramiv(program_id, GL_PROGRAM_BINARY_LENGTH, &length));
+    if (length <= 0 || !(data = heap_alloc(sizeof(format) + length)))
+        return;
+
+    GL_EXTCALL(glGetProgramBinary(program_id, length, &length, &format, data + sizeof(format)));
+    checkGLcall("glGetProgramBinary");
+    memcpy(data, &format, sizeof(format));
+    wined3d_shader_cache_put(&priv->program_cache, &key, data, sizeof(format) + length);
+    heap_free(data);
+}
+
 static BOOL shader_glsl_use_layout_qualifier(const struct wined3d_gl_info *gl_info)
 {
     /* Layout qualifiers were introduced in GLSL 1.40. The Nvidia Legacy GPU
@@ -10114,9 +10261,7 @@ static HRESULT shader_glsl_compile_compute_shader(struct shader_glsl_priv *priv,
 
     list_add_head(&shader->linked_programs, &entry->cs.shader_entry);
 
-    TRACE("Linking GLSL shader program %u.\n", program_id);
-    GL_EXTCALL(glLinkProgram(program_id));
-    shader_glsl_validate_link(gl_info, program_id);
+    shader_glsl_link_program(priv, gl_info, program_id);
 
     GL_EXTCALL(glUseProgram(program_id));
     checkGLcall("glUseProgram");
@@ -10446,10 +10591,7 @@ static void set_glsl_shader_program(const struct wined3d_context_gl *context_gl,
         list_add_head(ps_list, &entry->ps.shader_entry);
     }
 
-    /* Link the program */
-    TRACE("Linking GLSL shader program %u.\n", program_id);
-    GL_EXTCALL(glLinkProgram(program_id));
-    shader_glsl_validate_link(gl_info, program_id);
+    shader_glsl_link_program(priv, gl_info, program_id);
 
     shader_glsl_init_vs_uniform_locations(gl_info, priv, program_id, &entry->vs,
             vshader ? vshader->limits->constant_float : 0);
@@ -229,11 +229,35 @@ HRESULT resource_init(struct wined3d_resource *resource, struct wined3d_device *
     return WINED3D_OK;
 }
 
+static void *wined3d_resource_alloc_aligned(SIZE_T size)
+{
+    void **p;
+    SIZE_T align = RESOURCE_ALIGNMENT - 1 + sizeof(*p);
+    void *mem;
+
+    if (!(mem = heap_alloc_zero(size + align)))
+        return NULL;
+
+    p = (void **)(((ULONG_PTR)mem + align) & ~(RESOURCE_ALIGNMENT - 1)) - 1;
+    *p = mem;
+
+    return ++p;
+}
+
+static void wined3d_resource_free_aligned(void *mem)
+{
+    void **p = mem;
+
+    if (p)
+        heap_free(*(--p));
+}
+
 static void wined3d_resource_destroy_object(void *object)
 {
     struct wined3d_resource *resource = object;
 
     wined3d_resource_free_sysmem(resource);
+    wined3d_resource_free_aligned(resource->upload_data);
     context_resource_released(resource->device, resource);
     wined3d_resource_release(resource);
 }
@@ -346,6 +370,37 @@ static DWORD wined3d_resource_sanitise_map_flags(const struct wined3d_resource *
     return flags;
 }
 
+/* Discard maps of small dynamic buffers are handled on the client side. The
+ * application writes to staging memory, and the new contents are copied into
+ * the command stream on unmap, so neither the map nor the unmap has to wait
+ * for the CS thread. */
+static BOOL wined3d_resource_map_upload(struct wined3d_resource *resource, unsigned int sub_resource_idx,
+        struct wined3d_map_desc *map_desc, const struct wined3d_box *box, DWORD flags)
+{
+    if (!resource->upload_map_count)
+    {
+        if (resource->type != WINED3D_RTYPE_BUFFER || sub_resource_idx
+                || !(flags & WINED3D_MAP_DISCARD) || !resource->device->cs->thread
+                || resource->map_count || resource->size > WINED3D_CS_MAX_UPLOAD_SIZE)
+            return FALSE;
+
+        if (!resource->upload_data && !(resource->upload_data = wined3d_resource_alloc_aligned(resource->size)))
+            return FALSE;
+    }
+    else if (sub_resource_idx)
+    {
+        return FALSE;
+    }
+
+    TRACE("Mapping client-side upload memory %p.\n", resource->upload_data);
+
+    ++resource->upload_map_count;
+    map_desc->row_pitch = map_desc->slice_pitch = resource->size;
+    map_desc->data = (BYTE *)resource->upload_data + (box ? box->left : 0);
+
+    return TRUE;
+}
+
 HRESULT CDECL wined3d_resource_map(struct wined3d_resource *resource, unsigned int sub_resource_idx,
         struct wined3d_map_desc *map_desc, const struct wined3d_box *box, DWORD flags)
 {
@@ -371,6 +426,10 @@ HRESULT CDECL wined3d_resource_map(struct wined3d_resource *resource, unsigned i
     }
 
     flags = wined3d_resource_sanitise_map_flags(resource, flags);
+
+    if (wined3d_resource_map_upload(resource, sub_resource_idx, map_desc, box, flags))
+        return WINED3D_OK;
+
     wined3d_resource_wait_idle(resource);
 
     return wined3d_cs_map(resource->device->cs, resource, sub_resource_idx, map_desc, box, flags);
@@ -380,6 +439,19 @@ HRESULT CDECL wined3d_resource_unmap(struct wined3d_resource *resource, unsigned
 {
     TRACE("resource %p, sub_resource_idx %u.\n", resource, sub_resource_idx);
 
+    if (resource->upload_map_count)
+    {
+        if (sub_resource_idx)
+        {
+            WARN("Invalid sub_resource_idx %u.\n", sub_resource_idx);
+            return E_INVALIDARG;
+        }
+
+        if (!--resource->upload_map_count)
+            wined3d_cs_emit_upload_buffer(resource->device->cs, resource, resource->upload_data);
+        return WINED3D_OK;
+    }
+
     return wined3d_cs_unmap(resource->device->cs, resource, sub_resource_idx);
 }
 
@@ -390,21 +462,12 @@ void CDECL wined3d_resource_preload(struct wined3d_resource *resource)
 
 static BOOL wined3d_resource_allocate_sysmem(struct wined3d_resource *resource)
 {
-    void **p;
-    SIZE_T align = RESOURCE_ALIGNMENT - 1 + sizeof(*p);
-    void *mem;
-
-    if (!(mem = heap_alloc_zero(resource->size + align)))
+    if (!(resource->heap_memory = wined3d_resource_alloc_aligned(resource->size)))
     {
         ERR("Failed to allocate system memory.\n");
         return FALSE;
     }
 
-    p = (void **)(((ULONG_PTR)mem + align) & ~(RESOURCE_ALIGNMENT - 1)) - 1;
-    *p = mem;
-
-    resource->heap_memory = ++p;
-
     return TRUE;
 }
 
@@ -418,12 +481,7 @@ BOOL wined3d_resource_prepare_sysmem(struct wined3d_resource *resource)
 
 void wined3d_resource_free_sysmem(struct wined3d_resource *resource)
 {
-    void **p = resource->heap_memory;
-
-    if (!p)
-        return;
-
-    heap_free(*(--p));
+    wined3d_resource_free_aligned(resource->heap_memory);
     resource->heap_memory = NULL;
 }
 
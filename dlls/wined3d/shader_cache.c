@@ -0,0 +1,282 @@
+/*
+ * Persistent shader cache
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ *
+ */
+
+#include "config.h"
+#include "wine/port.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "wined3d_private.h"
+
+WINE_DEFAULT_DEBUG_CHANNEL(d3d_shader);
+
+#define WINED3D_SHADER_CACHE_MAGIC      0x43533357u /* "W3SC" */
+#define WINED3D_SHADER_CACHE_VERSION    1
+
+struct wined3d_shader_cache_header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t check;
+    uint64_t size;
+};
+
+struct wined3d_shader_cache_file
+{
+    char name[MAX_PATH];
+    FILETIME time;
+    uint64_t size;
+};
+
+void wined3d_shader_cache_key_init(struct wined3d_shader_cache_key *key)
+{
+    key->hash = 0xcbf29ce484222325ull;
+    key->check = 0x6a09e667f3bcc909ull;
+}
+
+void wined3d_shader_cache_key_update(struct wined3d_shader_cache_key *key, const void *data, size_t size)
+{
+    const uint8_t *p = data;
+
+    while (size--)
+    {
+        key->hash = (key->hash ^ *p) * 0x100000001b3ull;
+        key->check = (key->check + *p++) * 0x9e3779b97f4a7c15ull;
+        key->check ^= key->check >> 29;
+    }
+}
+
+static void wined3d_shader_cache_get_file_name(const struct wined3d_shader_cache *cache,
+        const struct wined3d_shader_cache_key *key, const char *extension, char *name)
+{
+    snprintf(name, MAX_PATH, "%s\\%08x%08x.%s", cache->path,
+            (unsigned int)(key->hash >> 32), (unsigned int)key->hash, extension);
+}
+
+static uint64_t wined3d_shader_cache_get_size(const struct wined3d_shader_cache *cache)
+{
+    WIN32_FIND_DATAA data;
+    char pattern[MAX_PATH];
+    uint64_t size = 0;
+    HANDLE find;
+
+    snprintf(pattern, sizeof(pattern), "%s\\*.bin", cache->path);
+    if ((find = FindFirstFileA(pattern, &data)) == INVALID_HANDLE_VALUE)
+        return 0;
+    do
+    {
+        size += ((uint64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+    } while (FindNextFileA(find, &data));
+    FindClose(find);
+
+    return size;
+}
+
+static int wined3d_shader_cache_file_compare(const void *a, const void *b)
+{
+    const struct wined3d_shader_cache_file *f1 = a, *f2 = b;
+
+    return CompareFileTime(&f1->time, &f2->time);
+}
+
+/* Remove the least recently used entries until the cache is back below three
+ * quarters of its maximum size. Entries are touched on every load, so their
+ * modification time doubles as the access time. */
+static void wined3d_shader_cache_evict(struct wined3d_shader_cache *cache)
+{
+    struct wined3d_shader_cache_file *files = NULL, *new_files;
+    size_t count = 0, capacity = 0, i;
+    WIN32_FIND_DATAA data;
+    char pattern[MAX_PATH];
+    uint64_t size = 0;
+    HANDLE find;
+
+    snprintf(pattern, sizeof(pattern), "%s\\*.bin", cache->path);
+    if ((find = FindFirstFileA(pattern, &data)) == INVALID_HANDLE_VALUE)
+    {
+        cache->size = 0;
+        return;
+    }
+    do
+    {
+        if (count == capacity)
+        {
+            capacity = max(capacity * 2, 64);
+            if (!(new_files = heap_realloc(files, capacity * sizeof(*files))))
+                break;
+            files = new_files;
+        }
+        snprintf(files[count].name, MAX_PATH, "%s\\%s", cache->path, data.cFileName);
+        files[count].time = data.ftLastWriteTime;
+        files[count].size = ((uint64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+        size += files[count++].size;
+    } while (FindNextFileA(find, &data));
+    FindClose(find);
+
+    qsort(files, count, sizeof(*files), wined3d_shader_cache_file_compare);
+    for (i = 0; i < count && size > cache->max_size / 4 * 3; ++i)
+    {
+        TRACE("Evicting %s.\n", debugstr_a(files[i].name));
+        if (DeleteFileA(files[i].name))
+            size -= files[i].size;
+    }
+    heap_free(files);
+
+    cache->size = size;
+}
+
+BOOL wined3d_shader_cache_init(struct wined3d_shader_cache *cache, const char *name,
+        const void *driver_id, size_t driver_id_size)
+{
+    struct wined3d_shader_cache_key key;
+    char base[MAX_PATH];
+    DWORD len;
+
+    memset(cache, 0, sizeof(*cache));
+
+    if (!wined3d_settings.shader_cache_size)
+        return FALSE;
+
+    len = GetEnvironmentVariableA("LOCALAPPDATA", base, sizeof(base));
+    if (!len || len >= sizeof(base) - 64)
+    {
+        WARN("Failed to get the local application data directory.\n");
+        return FALSE;
+    }
+
+    /* Caches from different drivers, or different versions of the same
+     * driver, are kept apart. */
+    wined3d_shader_cache_key_init(&key);
+    wined3d_shader_cache_key_update(&key, driver_id, driver_id_size);
+
+    strcat(base, "\\wined3d");
+    CreateDirectoryA(base, NULL);
+    snprintf(cache->path, sizeof(cache->path), "%s\\%s-%08x%08x", base, name,
+            (unsigned int)(key.hash >> 32), (unsigned int)key.hash);
+    if (!CreateDirectoryA(cache->path, NULL) && GetLastError() != ERROR_ALREADY_EXISTS)
+    {
+        WARN("Failed to create shader cache directory %s.\n", debugstr_a(cache->path));
+        return FALSE;
+    }
+
+    cache->max_size = (uint64_t)wined3d_settings.shader_cache_size << 20;
+    cache->size = wined3d_shader_cache_get_size(cache);
+    cache->enabled = TRUE;
+
+    TRACE("Using shader cache %s, size %s.\n", debugstr_a(cache->path), wine_dbgstr_longlong(cache->size));
+
+    return TRUE;
+}
+
+void *wined3d_shader_cache_get(struct wined3d_shader_cache *cache,
+        const struct wined3d_shader_cache_key *key, size_t *size)
+{
+    struct wined3d_shader_cache_header header;
+    LARGE_INTEGER file_size;
+    char name[MAX_PATH];
+    FILETIME time;
+    void *data;
+    HANDLE file;
+    DWORD count;
+
+    if (!cache->enabled)
+        return NULL;
+
+    wined3d_shader_cache_get_file_name(cache, key, "bin", name);
+    if ((file = CreateFileA(name, GENERIC_READ | FILE_WRITE_ATTRIBUTES,
+            FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, 0, NULL)) == INVALID_HANDLE_VALUE)
+        return NULL;
+
+    /* The entry has to contain exactly the data announced by its header,
+     * and can't be larger than anything the cache would have stored. */
+    if (!GetFileSizeEx(file, &file_size)
+            || !ReadFile(file, &header, sizeof(header), &count, NULL) || count != sizeof(header)
+            || header.magic != WINED3D_SHADER_CACHE_MAGIC || header.version != WINED3D_SHADER_CACHE_VERSION
+            || header.check != key->check || !header.size || header.size > ~0u
+            || header.size + sizeof(header) > cache->max_size
+            || header.size != (uint64_t)file_size.QuadPart - sizeof(header))
+    {
+        WARN("Ignoring invalid shader cache entry %s.\n", debugstr_a(name));
+        CloseHandle(file);
+        return NULL;
+    }
+
+    if (!(data = heap_alloc(header.size)))
+    {
+        CloseHandle(file);
+        return NULL;
+    }
+
+    if (!ReadFile(file, data, header.size, &count, NULL) || count != header.size)
+    {
+        WARN("Failed to read shader cache entry %s.\n", debugstr_a(name));
+        CloseHandle(file);
+        heap_free(data);
+        return NULL;
+    }
+
+    GetSystemTimeAsFileTime(&time);
+    SetFileTime(file, NULL, NULL, &time);
+    CloseHandle(file);
+
+    *size = header.size;
+    return data;
+}
+
+void wined3d_shader_cache_put(struct wined3d_shader_cache *cache,
+        const struct wined3d_shader_cache_key *key, const void *data, size_t size)
+{
+    struct wined3d_shader_cache_header header;
+    char name[MAX_PATH], tmp_name[MAX_PATH];
+    DWORD count;
+    HANDLE file;
+    BOOL ret;
+
+    if (!cache->enabled || size + sizeof(header) > cache->max_size)
+        return;
+
+    header.magic = WINED3D_SHADER_CACHE_MAGIC;
+    header.version = WINED3D_SHADER_CACHE_VERSION;
+    header.check = key->check;
+    header.size = size;
+
+    /* Write to a temporary file first, so that other processes sharing the
+     * cache never see partially written entries. */
+    wined3d_shader_cache_get_file_name(cache, key, "bin", name);
+    snprintf(tmp_name, sizeof(tmp_name), "%s.%x", name, GetCurrentProcessId());
+    if ((file = CreateFileA(tmp_name, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL)) == INVALID_HANDLE_VALUE)
+    {
+        WARN("Failed to create shader cache entry %s.\n", debugstr_a(tmp_name));
+        return;
+    }
+    ret = WriteFile(file, &header, sizeof(header), &count, NULL) && count == sizeof(header)
+            && WriteFile(file, data, size, &count, NULL) && count == size;
+    CloseHandle(file);
+
+    if (!ret || !MoveFileExA(tmp_name, name, MOVEFILE_REPLACE_EXISTING))
+    {
+        WARN("Failed to write shader cache entry %s.\n", debugstr_a(name));
+        DeleteFileA(tmp_name);
+        return;
+    }
+
+    if ((cache->size += size + sizeof(header)) > cache->max_size)
+        wined3d_shader_cache_evict(cache);
+}
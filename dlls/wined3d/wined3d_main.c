@@ -119,6 +119,7 @@ struct wined3d_settings wined3d_settings =
     ~0u,            /* No CS shader model limit by default. */
     WINED3D_RENDERER_AUTO,
     WINED3D_SHADER_BACKEND_AUTO,
+    0,              /* No persistent shader cache by default. */
 };
 
 struct wined3d * CDECL wined3d_create(DWORD flags)
@@ -374,6 +375,8 @@ static BOOL wined3d_dll_init(HINSTANCE hInstDLL)
             TRACE("Limiting PS shader model to %u.\n", wined3d_settings.max_sm_ps);
         if (!get_config_key_dword(hkey, appkey, "MaxShaderModelCS", &wined3d_settings.max_sm_cs))
             TRACE("Limiting CS shader model to %u.\n", wined3d_settings.max_sm_cs);
+        if (!get_config_key_dword(hkey, appkey, "ShaderCacheSize", &wined3d_settings.shader_cache_size))
+            TRACE("Using a %u MiB persistent shader cache.\n", wined3d_settings.shader_cache_size);
         if (!get_config_key(hkey, appkey, "renderer", buffer, size))
         {
             if (!strcmp(buffer, "vulkan"))
@@ -439,6 +439,7 @@ struct wined3d_settings
     unsigned int max_sm_cs;
     enum wined3d_renderer renderer;
     enum wined3d_shader_backend shader_backend;
+    unsigned int shader_cache_size;
 };
 
 extern struct wined3d_settings wined3d_settings DECLSPEC_HIDDEN;
@@ -1472,6 +1473,30 @@ struct wined3d_shader_backend_ops
     BOOL (*shader_has_ffp_proj_control)(void *shader_priv);
 };
 
+struct wined3d_shader_cache_key
+{
+    uint64_t hash;
+    uint64_t check;
+};
+
+struct wined3d_shader_cache
+{
+    char path[MAX_PATH];
+    uint64_t size;
+    uint64_t max_size;
+    BOOL enabled;
+};
+
+void wined3d_shader_cache_key_init(struct wined3d_shader_cache_key *key) DECLSPEC_HIDDEN;
+void wined3d_shader_cache_key_update(struct wined3d_shader_cache_key *key,
+        const void *data, size_t size) DECLSPEC_HIDDEN;
+BOOL wined3d_shader_cache_init(struct wined3d_shader_cache *cache, const char *name,
+        const void *driver_id, size_t driver_id_size) DECLSPEC_HIDDEN;
+void *wined3d_shader_cache_get(struct wined3d_shader_cache *cache,
+        const struct wined3d_shader_cache_key *key, size_t *size) DECLSPEC_HIDDEN;
+void wined3d_shader_cache_put(struct wined3d_shader_cache *cache,
+        const struct wined3d_shader_cache_key *key, const void *data, size_t size) DECLSPEC_HIDDEN;
+
 extern const struct wined3d_shader_backend_ops glsl_shader_backend DECLSPEC_HIDDEN;
 extern const struct wined3d_shader_backend_ops arb_program_shader_backend DECLSPEC_HIDDEN;
 extern const struct wined3d_shader_backend_ops none_shader_backend DECLSPEC_HIDDEN;
@@ -3880,6 +3905,9 @@ struct wined3d_device_vk
     struct wined3d_null_views_vk null_views_vk;
 
     struct wined3d_allocator allocator;
+
+    VkPipelineCache vk_pipeline_cache;
+    struct wined3d_shader_cache pipeline_cache;
 };
 
 static inline struct wined3d_device_vk *wined3d_device_vk(struct wined3d_device *device)
@@ -3949,6 +3977,10 @@ struct wined3d_resource
     DWORD priority;
     void *heap_memory;
 
+    /* Client-side staging memory for discard maps, see wined3d_resource_map(). */
+    void *upload_data;
+    unsigned int upload_map_count;
+
     void *parent;
     const struct wined3d_parent_ops *parent_ops;
     const struct wined3d_resource_ops *resource_ops;
@@ -4539,7 +4571,9 @@ enum wined3d_push_constants
 
 #define WINED3D_CS_QUERY_POLL_INTERVAL  10u
 #define WINED3D_CS_QUEUE_SIZE           0x100000u
-#define WINED3D_CS_SPIN_COUNT           10000000u
+#define WINED3D_CS_MAX_UPLOAD_SIZE      0x10000u
+#define WINED3D_CS_SPIN_COUNT_MIN       0x400u
+#define WINED3D_CS_SPIN_COUNT_MAX       10000000u
 
 struct wined3d_cs_queue
 {
@@ -4571,8 +4605,7 @@ struct wined3d_cs
     struct list query_poll_list;
     BOOL queries_flushed;
 
-    HANDLE event;
-    BOOL waiting_for_event;
+    LONG waiting_for_event;
     LONG pending_presents;
 };
 
@@ -4661,6 +4694,8 @@ void wined3d_cs_emit_set_vertex_declaration(struct wined3d_cs *cs,
         struct wined3d_vertex_declaration *declaration) DECLSPEC_HIDDEN;
 void wined3d_cs_emit_set_viewports(struct wined3d_cs *cs, unsigned int viewport_count, const struct wined3d_viewport *viewports) DECLSPEC_HIDDEN;
 void wined3d_cs_emit_unload_resource(struct wined3d_cs *cs, struct wined3d_resource *resource) DECLSPEC_HIDDEN;
+void wined3d_cs_emit_upload_buffer(struct wined3d_cs *cs, struct wined3d_resource *resource,
+        const void *data) DECLSPEC_HIDDEN;
 void wined3d_cs_emit_update_sub_resource(struct wined3d_cs *cs, struct wined3d_resource *resource,
         unsigned int sub_resource_idx, const struct wined3d_box *box, const void *data, unsigned int row_pitch,
         unsigned int slice_pitch) DECLSPEC_HIDDEN;
@@ -4755,6 +4790,8 @@ BOOL wined3d_buffer_load_location(struct wined3d_buffer *buffer,
 BYTE *wined3d_buffer_load_sysmem(struct wined3d_buffer *buffer, struct wined3d_context *context) DECLSPEC_HIDDEN;
 BOOL wined3d_buffer_prepare_location(struct wined3d_buffer *buffer,
         struct wined3d_context *context, unsigned int location) DECLSPEC_HIDDEN;
+void wined3d_buffer_replace_data(struct wined3d_buffer *buffer, struct wined3d_context *context,
+        const void *data) DECLSPEC_HIDDEN;
 void wined3d_buffer_upload_data(struct wined3d_buffer *buffer, struct wined3d_context *context,
         const struct wined3d_box *box, const void *data) DECLSPEC_HIDDEN;
 
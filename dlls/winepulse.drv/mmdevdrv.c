@@ -57,6 +57,7 @@
 #include "audiopolicy.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(pulse);
+WINE_DECLARE_DEBUG_CHANNEL(pulse_timing);
 
 #define NULL_PTR_ERR MAKE_HRESULT(SEVERITY_ERROR, FACILITY_WIN32, RPC_X_NULL_REF_POINTER)
 
@@ -183,6 +184,10 @@ struct ACImpl {
     BOOL please_quit, just_started, just_underran;
     pa_usec_t last_time, mmdev_period_usec;
 
+    /* timer thread statistics, reported on +pulse_timing */
+    UINT32 timing_periods, timing_underruns;
+    INT64 timing_jitter_sum, timing_jitter_max;
+
     pa_stream *stream;
     pa_sample_spec ss;
     pa_channel_map map;
@@ -712,18 +717,17 @@ static void silence_buffer(pa_sample_format_t format, BYTE *buffer, UINT32 bytes
     memset(buffer, format == PA_SAMPLE_U8 ? 0x80 : 0, bytes);
 }
 
-static int write_buffer(const ACImpl *This, BYTE *buffer, UINT32 bytes)
+static void adjust_volume(const ACImpl *This, BYTE *buffer, UINT32 bytes)
 {
     float vol[PA_CHANNELS_MAX];
     BOOL adjust = FALSE;
     UINT32 i, channels;
     BYTE *end;
 
-    if (!bytes) return 0;
     if (This->session->mute)
     {
         silence_buffer(This->ss.format, buffer, bytes);
-        goto write;
+        return;
     }
 
     /* Adjust the buffer based on the volume for each channel */
@@ -733,7 +737,7 @@ static int write_buffer(const ACImpl *This, BYTE *buffer, UINT32 bytes)
         vol[i] = This->vol[i] * This->session->master_vol * This->session->channel_vols[i];
         adjust |= vol[i] != 1.0f;
     }
-    if (!adjust) goto write;
+    if (!adjust) return;
 
     end = buffer + bytes;
     switch (This->ss.format)
@@ -845,9 +849,62 @@ static int write_buffer(const ACImpl *This, BYTE *buffer, UINT32 bytes)
         TRACE("Unhandled format %i, not adjusting volume.\n", This->ss.format);
         break;
     }
+}
+
+/* Data is copied straight into memory blocks allocated by PulseAudio, and
+ * the volume is applied there, so that pa_stream_write() doesn't need to copy
+ * it again. If no block can be obtained the local buffer is written as is. */
+static int write_buffer(const ACImpl *This, const BYTE *buffer, UINT32 bytes)
+{
+    size_t frame_size = pa_frame_size(&This->ss);
+    int ret = 0;
+
+    while (bytes && !ret)
+    {
+        size_t size = bytes;
+        void *dst;
+
+        if (pa_stream_begin_write(This->stream, &dst, &size) < 0)
+            break;
+        size = min(size, bytes);
+        size -= size % frame_size;
+        if (!size)
+        {
+            pa_stream_cancel_write(This->stream);
+            break;
+        }
+
+        if (buffer)
+        {
+            memcpy(dst, buffer, size);
+            adjust_volume(This, dst, size);
+            buffer += size;
+        }
+        else
+            silence_buffer(This->ss.format, dst, size);
+
+        ret = pa_stream_write(This->stream, dst, size, NULL, 0, PA_SEEK_RELATIVE);
+        bytes -= size;
+    }
+
+    if (bytes && !ret)
+    {
+        BYTE *copy;
+
+        if (!(copy = HeapAlloc(GetProcessHeap(), 0, bytes)))
+            return -PA_ERR_INTERNAL;
+        if (buffer)
+        {
+            memcpy(copy, buffer, bytes);
+            adjust_volume(This, copy, bytes);
+        }
+        else
+            silence_buffer(This->ss.format, copy, bytes);
+        ret = pa_stream_write(This->stream, copy, bytes, NULL, 0, PA_SEEK_RELATIVE);
+        HeapFree(GetProcessHeap(), 0, copy);
+    }
 
-write:
-    return pa_stream_write(This->stream, buffer, bytes, NULL, 0, PA_SEEK_RELATIVE);
+    return ret;
 }
 
 static void dump_attr(const pa_buffer_attr *attr) {
@@ -883,9 +940,7 @@ static void pulse_write(ACImpl *This)
             to_write = bytes - This->pa_held_bytes;
             TRACE("prebuffering %u frames of silence\n",
                     (int)(to_write / pa_frame_size(&This->ss)));
-            buf = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, to_write);
-            pa_stream_write(This->stream, buf, to_write, NULL, 0, PA_SEEK_RELATIVE);
-            HeapFree(GetProcessHeap(), 0, buf);
+            write_buffer(This, NULL, to_write);
         }
 
         This->just_underran = FALSE;
@@ -919,6 +974,7 @@ static void pulse_underflow_callback(pa_stream *s, void *userdata)
     ACImpl *This = userdata;
     WARN("%p: Underflow\n", userdata);
     This->just_underran = TRUE;
+    This->timing_underruns++;
     /* re-sync */
     This->pa_offs_bytes = This->lcl_offs_bytes;
     This->pa_held_bytes = This->held_bytes;
@@ -1019,11 +1075,41 @@ static void pulse_read(ACImpl *This)
     }
 }
 
+/* Record how late the timer thread woke up compared to the requested delay,
+ * and report it about once a second. */
+static void update_timing_stats(ACImpl *This, DWORD delay, LARGE_INTEGER *last_wakeup)
+{
+    LARGE_INTEGER now, freq;
+    INT64 jitter;
+
+    if (!TRACE_ON(pulse_timing))
+        return;
+
+    QueryPerformanceCounter(&now);
+    QueryPerformanceFrequency(&freq);
+    jitter = (now.QuadPart - last_wakeup->QuadPart) * 1000000 / freq.QuadPart - (INT64)delay * 1000;
+    *last_wakeup = now;
+
+    This->timing_jitter_sum += jitter < 0 ? -jitter : jitter;
+    This->timing_jitter_max = max(This->timing_jitter_max, jitter < 0 ? -jitter : jitter);
+
+    if (++This->timing_periods * This->mmdev_period_usec >= 1000000)
+    {
+        TRACE_(pulse_timing)("%p: %u periods, jitter avg %s us max %s us, %u underruns, held %u frames\n",
+                This, This->timing_periods, wine_dbgstr_longlong(This->timing_jitter_sum / This->timing_periods),
+                wine_dbgstr_longlong(This->timing_jitter_max), This->timing_underruns,
+                (int)(This->held_bytes / pa_frame_size(&This->ss)));
+        This->timing_periods = This->timing_underruns = 0;
+        This->timing_jitter_sum = This->timing_jitter_max = 0;
+    }
+}
+
 static DWORD WINAPI pulse_timer_cb(void *user)
 {
     DWORD delay;
     UINT32 adv_bytes;
     ACImpl *This = user;
+    LARGE_INTEGER last_wakeup;
     int success;
     pa_operation *o;
 
@@ -1032,6 +1118,8 @@ static DWORD WINAPI pulse_timer_cb(void *user)
     pa_stream_get_time(This->stream, &This->last_time);
     pthread_mutex_unlock(&pulse_lock);
 
+    QueryPerformanceCounter(&last_wakeup);
+
     while(!This->please_quit){
         pa_usec_t now, adv_usec = 0;
         int err;
@@ -1040,6 +1128,8 @@ static DWORD WINAPI pulse_timer_cb(void *user)
 
         pthread_mutex_lock(&pulse_lock);
 
+        update_timing_stats(This, delay, &last_wakeup);
+
         delay = This->mmdev_period_usec / 1000;
 
         o = pa_stream_update_timing_info(This->stream, pulse_op_cb, &success);
@@ -51,6 +51,7 @@
 #include "wine/debug.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(bitblt);
+WINE_DECLARE_DEBUG_CHANNEL(fps);
 
 
 #define DST 0   /* Destination drawable */
@@ -1572,7 +1573,14 @@ struct x11drv_window_surface
     void                 *bits;
 #ifdef HAVE_LIBXXSHM
     XShmSegmentInfo       shminfo;
+    XImage               *back_image;     /* second shm image when double buffering */
+    XShmSegmentInfo       back_shminfo;
+    unsigned long         put_serial;     /* serial of the last put from image */
+    unsigned long         back_put_serial;
 #endif
+    DWORD                 fps_time;
+    unsigned int          fps_frames;
+    ULONGLONG             fps_bytes;
     CRITICAL_SECTION      crit;
     BITMAPINFO            info;   /* variable size, must be last */
 };
@@ -1812,8 +1820,63 @@ failed:
     XDestroyImage( image );
     return NULL;
 }
+
+static void destroy_shm_image( XImage *image, XShmSegmentInfo *shminfo )
+{
+    XShmDetach( gdi_display, shminfo );
+    shmdt( shminfo->shmaddr );
+    image->data = NULL;
+    XDestroyImage( image );
+}
+
+/* The server is done reading a shm image once it has processed the put
+ * request; with two images alternating this rarely needs a round trip. */
+static void wait_for_shm_image( struct x11drv_window_surface *surface )
+{
+    if ((long)(LastKnownRequestProcessed( gdi_display ) - surface->put_serial) < 0)
+        XSync( gdi_display, False );
+}
+
+static void swap_shm_images( struct x11drv_window_surface *surface )
+{
+    XImage *image = surface->image;
+    XShmSegmentInfo shminfo = surface->shminfo;
+    unsigned long serial = surface->put_serial;
+
+    surface->image = surface->back_image;
+    surface->shminfo = surface->back_shminfo;
+    surface->put_serial = surface->back_put_serial;
+    surface->back_image = image;
+    surface->back_shminfo = shminfo;
+    surface->back_put_serial = serial;
+}
 #endif /* HAVE_LIBXXSHM */
 
+static inline BOOL has_back_image( const struct x11drv_window_surface *surface )
+{
+#ifdef HAVE_LIBXXSHM
+    return surface->back_image != NULL;
+#else
+    return FALSE;
+#endif
+}
+
+/* copy the dirty part of the rows, when neither byte swapping nor mapping is needed */
+static void copy_surface_rect( const struct x11drv_window_surface *surface, const unsigned char *src,
+                               unsigned char *dst, const RECT *rect )
+{
+    int bpp = surface->image->bits_per_pixel, stride = surface->image->bytes_per_line;
+    int left = rect->left * bpp / 8, width = (rect->right * bpp + 7) / 8 - left;
+    int x, y;
+
+    for (y = rect->top; y < rect->bottom; y++, src += stride, dst += stride)
+    {
+        memcpy( dst + left, src + left, width );
+        if (surface->alpha_bits)
+            for (x = rect->left; x < rect->right; x++) ((ULONG *)dst)[x] |= surface->alpha_bits;
+    }
+}
+
 /***********************************************************************
  *           x11drv_surface_lock
  */
@@ -1893,7 +1956,7 @@ static void x11drv_surface_flush( struct window_surface *window_surface )
 {
     struct x11drv_window_surface *surface = get_x11_surface( window_surface );
     unsigned char *src = surface->bits;
-    unsigned char *dst = (unsigned char *)surface->image->data;
+    unsigned char *dst;
     struct bitblt_coords coords;
 
     window_surface->funcs->lock( window_surface );
@@ -1910,6 +1973,10 @@ static void x11drv_surface_flush( struct window_surface *window_surface )
 
         if (surface->is_argb || surface->color_key != CLR_INVALID) update_surface_region( surface );
 
+#ifdef HAVE_LIBXXSHM
+        if (surface->back_image) wait_for_shm_image( surface );
+#endif
+        dst = (unsigned char *)surface->image->data;
         if (src != dst)
         {
             int map[256], *mapping = get_window_surface_mapping( surface->image->bits_per_pixel, map );
@@ -1917,9 +1984,12 @@ static void x11drv_surface_flush( struct window_surface *window_surface )
 
             src += coords.visrect.top * width_bytes;
             dst += coords.visrect.top * width_bytes;
-            copy_image_byteswap( &surface->info, src, dst, width_bytes, width_bytes,
-                                 coords.visrect.bottom - coords.visrect.top,
-                                 surface->byteswap, mapping, ~0u, surface->alpha_bits );
+            if (!surface->byteswap && !mapping)
+                copy_surface_rect( surface, src, dst, &coords.visrect );
+            else
+                copy_image_byteswap( &surface->info, src, dst, width_bytes, width_bytes,
+                                     coords.visrect.bottom - coords.visrect.top,
+                                     surface->byteswap, mapping, ~0u, surface->alpha_bits );
         }
         else if (surface->alpha_bits)
         {
@@ -1933,12 +2003,20 @@ static void x11drv_surface_flush( struct window_surface *window_surface )
 
 #ifdef HAVE_LIBXXSHM
         if (surface->shminfo.shmid != -1)
+        {
             XShmPutImage( gdi_display, surface->window, surface->gc, surface->image,
                           coords.visrect.left, coords.visrect.top,
                           surface->header.rect.left + coords.visrect.left,
                           surface->header.rect.top + coords.visrect.top,
                           coords.visrect.right - coords.visrect.left,
                           coords.visrect.bottom - coords.visrect.top, False );
+            if (surface->back_image)
+            {
+                /* other threads may have sent requests since, which only makes this conservative */
+                surface->put_serial = NextRequest( gdi_display ) - 1;
+                swap_shm_images( surface );
+            }
+        }
         else
 #endif
         XPutImage( gdi_display, surface->window, surface->gc, surface->image,
@@ -1948,6 +2026,25 @@ static void x11drv_surface_flush( struct window_surface *window_surface )
                    coords.visrect.right - coords.visrect.left,
                    coords.visrect.bottom - coords.visrect.top );
         XFlush( gdi_display );
+
+        if (TRACE_ON(fps))
+        {
+            DWORD time = GetTickCount();
+
+            surface->fps_frames++;
+            surface->fps_bytes += (ULONGLONG)(coords.visrect.bottom - coords.visrect.top) *
+                                  (coords.visrect.right - coords.visrect.left) * surface->image->bits_per_pixel / 8;
+            /* every 1.5 seconds */
+            if (time - surface->fps_time > 1500)
+            {
+                TRACE_(fps)( "%p @ approx %.2ffps, %.1f KiB/s\n", surface,
+                             1000.0 * surface->fps_frames / (time - surface->fps_time),
+                             1000.0 / 1024.0 * surface->fps_bytes / (time - surface->fps_time) );
+                surface->fps_time = time;
+                surface->fps_frames = 0;
+                surface->fps_bytes = 0;
+            }
+        }
     }
     reset_bounds( &surface->bounds );
     window_surface->funcs->unlock( window_surface );
@@ -1966,16 +2063,16 @@ static void x11drv_surface_destroy( struct window_surface *window_surface )
     {
         if (surface->image->data != surface->bits) HeapFree( GetProcessHeap(), 0, surface->bits );
 #ifdef HAVE_LIBXXSHM
+        if (surface->back_image) destroy_shm_image( surface->back_image, &surface->back_shminfo );
         if (surface->shminfo.shmid != -1)
-        {
-            XShmDetach( gdi_display, &surface->shminfo );
-            shmdt( surface->shminfo.shmaddr );
-        }
+            destroy_shm_image( surface->image, &surface->shminfo );
         else
 #endif
-        HeapFree( GetProcessHeap(), 0, surface->image->data );
-        surface->image->data = NULL;
-        XDestroyImage( surface->image );
+        {
+            HeapFree( GetProcessHeap(), 0, surface->image->data );
+            surface->image->data = NULL;
+            XDestroyImage( surface->image );
+        }
     }
     surface->crit.DebugInfo->Spare[0] = 0;
     DeleteCriticalSection( &surface->crit );
@@ -2028,8 +2125,10 @@ struct window_surface *create_surface( Window window, const XVisualInfo *vis, co
     reset_bounds( &surface->bounds );
 
 #ifdef HAVE_LIBXXSHM
-    surface->image = create_shm_image( vis, width, height, &surface->shminfo );
-    if (!surface->image)
+    /* with two images, the application never draws into memory the server is reading from */
+    if ((surface->image = create_shm_image( vis, width, height, &surface->shminfo )))
+        surface->back_image = create_shm_image( vis, width, height, &surface->back_shminfo );
+    else
 #endif
     {
         surface->image = XCreateImage( gdi_display, vis->visual, vis->depth, ZPixmap, 0, NULL,
@@ -2046,9 +2145,9 @@ struct window_surface *create_surface( Window window, const XVisualInfo *vis, co
     if (vis->depth == 32 && !surface->is_argb)
         surface->alpha_bits = ~(vis->red_mask | vis->green_mask | vis->blue_mask);
 
-    if (surface->byteswap || format->bits_per_pixel == 4 || format->bits_per_pixel == 8)
+    if (surface->byteswap || format->bits_per_pixel == 4 || format->bits_per_pixel == 8 || has_back_image( surface ))
     {
-        /* allocate separate surface bits if byte swapping or palette mapping is required */
+        /* allocate separate surface bits if byte swapping, palette mapping or double buffering is required */
         if (!(surface->bits  = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY,
                                           surface->info.bmiHeader.biSizeImage )))
             goto failed;
@@ -173,6 +173,7 @@ static void test_simple_streaming(IXAudio2 *xa)
     WAVEFORMATEX fmt;
     XAUDIO2_BUFFER buf, buf2;
     XAUDIO2_VOICE_STATE state;
+    XAUDIO2_PERFORMANCE_DATA perf;
     XAUDIO2_EFFECT_DESCRIPTOR effect;
     XAUDIO2_EFFECT_CHAIN chain;
     DWORD chmask;
@@ -323,6 +324,14 @@ static void test_simple_streaming(IXAudio2 *xa)
 
     ok(state.SamplesPlayed == 22050, "Got wrong samples played\n");
 
+    XA2CALL_V(GetPerformanceData, &perf);
+    ok(perf.AudioCyclesSinceLastQuery > 0, "Got no audio cycles.\n");
+    ok(perf.MaximumCyclesPerQuantum > 0, "Got no cycles per quantum.\n");
+    ok(perf.AudioCyclesSinceLastQuery <= perf.TotalCyclesSinceLastQuery, "Got audio cycles %s, total cycles %s.\n",
+            wine_dbgstr_longlong(perf.AudioCyclesSinceLastQuery), wine_dbgstr_longlong(perf.TotalCyclesSinceLastQuery));
+    ok(perf.MinimumCyclesPerQuantum <= perf.MaximumCyclesPerQuantum, "Got minimum %u, maximum %u.\n",
+            perf.MinimumCyclesPerQuantum, perf.MaximumCyclesPerQuantum);
+
     HeapFree(GetProcessHeap(), 0, (void*)buf.pAudioData);
     HeapFree(GetProcessHeap(), 0, (void*)buf2.pAudioData);
 
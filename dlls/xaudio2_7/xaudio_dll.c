@@ -1703,6 +1703,13 @@ void engine_cb(FAudioEngineCallEXT proc, FAudio *faudio, float *stream, void *us
 DWORD WINAPI engine_thread(void *user)
 {
     XA2VoiceImpl *This = user;
+    LARGE_INTEGER now;
+
+    pthread_mutex_lock(&This->stats_lock);
+    QueryPerformanceCounter(&now);
+    memset(&This->engine_stats, 0, sizeof(This->engine_stats));
+    This->engine_stats.last_query = now.QuadPart;
+    pthread_mutex_unlock(&This->stats_lock);
 
     pthread_mutex_lock(&This->engine_lock);
 
@@ -1712,7 +1719,22 @@ DWORD WINAPI engine_thread(void *user)
         pthread_cond_wait(&This->engine_ready, &This->engine_lock);
 
         if(This->engine_params.proc){
+            LARGE_INTEGER start, end;
+            UINT32 elapsed;
+
+            QueryPerformanceCounter(&start);
             This->engine_params.proc(This->engine_params.faudio, This->engine_params.stream);
+            QueryPerformanceCounter(&end);
+
+            elapsed = min(end.QuadPart - start.QuadPart, ~0u);
+            pthread_mutex_lock(&This->stats_lock);
+            This->engine_stats.audio_time += elapsed;
+            if(!This->engine_stats.quanta++ || elapsed < This->engine_stats.min_quantum)
+                This->engine_stats.min_quantum = elapsed;
+            if(elapsed > This->engine_stats.max_quantum)
+                This->engine_stats.max_quantum = elapsed;
+            pthread_mutex_unlock(&This->stats_lock);
+
             This->engine_params.proc = NULL;
             pthread_cond_broadcast(&This->engine_done);
         }
@@ -1813,10 +1835,34 @@ static void WINAPI IXAudio2Impl_GetPerformanceData(IXAudio2 *iface,
         XAUDIO2_PERFORMANCE_DATA *pPerfData)
 {
     IXAudio2Impl *This = impl_from_IXAudio2(iface);
+    LARGE_INTEGER now;
 
     TRACE("(%p)->(%p)\n", This, pPerfData);
 
     FAudio_GetPerformanceData(This->faudio, (FAudioPerformanceData *)pPerfData);
+
+    /* FAudio doesn't measure processing time; report the time spent in engine
+     * passes, using performance counter ticks as cycles. */
+    pthread_mutex_lock(&This->mst.stats_lock);
+
+    QueryPerformanceCounter(&now);
+    if(This->mst.engine_stats.last_query)
+        pPerfData->TotalCyclesSinceLastQuery = now.QuadPart - This->mst.engine_stats.last_query;
+    if(This->mst.engine_stats.quanta){
+        pPerfData->AudioCyclesSinceLastQuery = This->mst.engine_stats.audio_time;
+        pPerfData->MinimumCyclesPerQuantum = This->mst.engine_stats.min_quantum;
+        pPerfData->MaximumCyclesPerQuantum = This->mst.engine_stats.max_quantum;
+    }
+
+    TRACE("%u quanta, audio time %s, total time %s, min %u, max %u.\n", This->mst.engine_stats.quanta,
+            wine_dbgstr_longlong(pPerfData->AudioCyclesSinceLastQuery),
+            wine_dbgstr_longlong(pPerfData->TotalCyclesSinceLastQuery),
+            pPerfData->MinimumCyclesPerQuantum, pPerfData->MaximumCyclesPerQuantum);
+
+    memset(&This->mst.engine_stats, 0, sizeof(This->mst.engine_stats));
+    This->mst.engine_stats.last_query = now.QuadPart;
+
+    pthread_mutex_unlock(&This->mst.stats_lock);
 }
 
 static void WINAPI IXAudio2Impl_SetDebugConfiguration(IXAudio2 *iface,
@@ -1944,6 +1990,7 @@ static HRESULT WINAPI XAudio2CF_CreateInstance(IClassFactory *iface, IUnknown *p
     object->mst.lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": XA2MasteringVoice.lock");
 
     pthread_mutex_init(&object->mst.engine_lock, NULL);
+    pthread_mutex_init(&object->mst.stats_lock, NULL);
     pthread_cond_init(&object->mst.engine_done, NULL);
     pthread_cond_init(&object->mst.engine_ready, NULL);
 
@@ -101,6 +101,16 @@ typedef struct _XA2VoiceImpl {
     pthread_cond_t engine_done, engine_ready;
     pthread_mutex_t engine_lock;
 
+    /* Engine pass timing, in performance counter ticks, since the last
+     * GetPerformanceData() call. This has its own lock, since engine_lock is
+     * held while application callbacks run. */
+    pthread_mutex_t stats_lock;
+    struct {
+        LONGLONG last_query;
+        ULONGLONG audio_time;
+        UINT32 quanta, min_quantum, max_quantum;
+    } engine_stats;
+
     struct list entry;
 } XA2VoiceImpl;
 
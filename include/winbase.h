@@ -528,6 +528,11 @@ typedef enum _MEMORY_RESOURCE_NOTIFICATION_TYPE {
     HighMemoryResourceNotification
 } MEMORY_RESOURCE_NOTIFICATION_TYPE;
 
+typedef struct _WIN32_MEMORY_RANGE_ENTRY {
+    PVOID  VirtualAddress;
+    SIZE_T NumberOfBytes;
+} WIN32_MEMORY_RANGE_ENTRY, *PWIN32_MEMORY_RANGE_ENTRY;
+
 #ifndef _SYSTEMTIME_
 #define _SYSTEMTIME_
 typedef struct _SYSTEMTIME{
@@ -2544,6 +2549,7 @@ WINBASEAPI VOID        WINAPI OutputDebugStringW(LPCWSTR);
 #define                       OutputDebugString WINELIB_NAME_AW(OutputDebugString)
 WINBASEAPI BOOL        WINAPI PeekNamedPipe(HANDLE,PVOID,DWORD,PDWORD,PDWORD,PDWORD);
 WINBASEAPI BOOL        WINAPI PostQueuedCompletionStatus(HANDLE,DWORD,ULONG_PTR,LPOVERLAPPED);
+WINBASEAPI BOOL        WINAPI PrefetchVirtualMemory(HANDLE,ULONG_PTR,PWIN32_MEMORY_RANGE_ENTRY,ULONG);
 WINBASEAPI DWORD       WINAPI PrepareTape(HANDLE,DWORD,BOOL);
 WINBASEAPI BOOL        WINAPI ProcessIdToSessionId(DWORD,DWORD*);
 WINADVAPI  BOOL        WINAPI PrivilegeCheck(HANDLE,PPRIVILEGE_SET,LPBOOL);
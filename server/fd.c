@@ -21,6 +21,7 @@
 
 #include "config.h"
 #include "wine/port.h"
+#include "wine/rbtree.h"
 
 #include <assert.h>
 #include <dirent.h>
@@ -159,6 +160,7 @@ static inline int epoll_wait( int epfd, struct epoll_event *events, int maxevent
 /* Because of the stupid Posix locking semantics, we need to keep
  * track of all file descriptors referencing a given file, and not
  * close a single one until all the locks are gone (sigh).
+ * This is not needed when open file description locks are available.
  */
 
 /* file descriptor object */
@@ -274,7 +276,7 @@ struct inode
     struct device      *device;     /* device containing this inode */
     ino_t               ino;        /* inode number */
     struct list         open;       /* list of open file descriptors */
-    struct list         locks;      /* list of file locks */
+    struct wine_rb_tree locks;      /* tree of file locks sorted by start offset */
     struct list         closed;     /* list of file descriptors to close at destroy time */
 };
 
@@ -311,16 +313,18 @@ struct file_lock
     struct object       obj;         /* object header */
     struct fd          *fd;          /* fd owning this lock */
     struct list         fd_entry;    /* entry in list of locks on a given fd */
-    struct list         inode_entry; /* entry in inode list of locks */
+    struct wine_rb_entry inode_entry; /* entry in inode tree of locks */
     int                 shared;      /* shared lock? */
     file_pos_t          start;       /* locked region is interval [start;end) */
     file_pos_t          end;
+    file_pos_t          max_end;     /* max end of the locks in the inode subtree of this lock */
     struct process     *process;     /* process owning this lock */
     struct list         proc_entry;  /* entry in list of locks owned by the process */
 };
 
 static void file_lock_dump( struct object *obj, int verbose );
 static int file_lock_signaled( struct object *obj, struct wait_queue_entry *entry );
+static int compare_locks( const void *key, const struct wine_rb_entry *entry );
 
 static const struct object_ops file_lock_ops =
 {
@@ -351,6 +355,9 @@ static const struct object_ops file_lock_ops =
 
 static file_pos_t max_unix_offset = OFF_T_MAX;
 
+/* do we use open file description locks instead of process-wide locks? -1 if not checked yet */
+static int ofd_locks = -1;
+
 #define DUMP_LONG_LONG(val) do { \
     if (sizeof(val) > sizeof(unsigned long) && (val) > ~0UL) \
         fprintf( stderr, "%lx%08lx", (unsigned long)((unsigned long long)(val) >> 32), (unsigned long)(val) ); \
@@ -1134,7 +1141,7 @@ static void inode_destroy( struct object *obj )
     struct list *ptr;
 
     assert( list_empty(&inode->open) );
-    assert( list_empty(&inode->locks) );
+    assert( !inode->locks.root );
 
     list_remove( &inode->entry );
 
@@ -1183,7 +1190,7 @@ static struct inode *get_inode( dev_t dev, ino_t ino, int unix_fd )
         inode->device = device;
         inode->ino    = ino;
         list_init( &inode->open );
-        list_init( &inode->locks );
+        wine_rb_init( &inode->locks, compare_locks );
         list_init( &inode->closed );
         list_add_head( &device->inode_hash[hash], &inode->entry );
     }
@@ -1195,7 +1202,7 @@ static struct inode *get_inode( dev_t dev, ino_t ino, int unix_fd )
 /* add fd to the inode list of file descriptors to close */
 static void inode_add_closed_fd( struct inode *inode, struct closed_fd *fd )
 {
-    if (!list_empty( &inode->locks ))
+    if (inode->locks.root && ofd_locks != 1)
     {
         list_add_head( &inode->closed, &fd->entry );
     }
@@ -1235,12 +1242,133 @@ static int file_lock_signaled( struct object *obj, struct wait_queue_entry *entr
     return !lock->process;
 }
 
+/* lock tree ordering: sort by start offset, then by address */
+static int compare_locks( const void *key, const struct wine_rb_entry *entry )
+{
+    const struct file_lock *lock = key;
+    const struct file_lock *other = WINE_RB_ENTRY_VALUE( entry, const struct file_lock, inode_entry );
+
+    if (lock->start != other->start) return lock->start < other->start ? -1 : 1;
+    if (lock != other) return lock < other ? -1 : 1;
+    return 0;
+}
+
+/* max of two lock end offsets, where 0 means end of file */
+static inline file_pos_t max_lock_end( file_pos_t end1, file_pos_t end2 )
+{
+    if (!end1 || !end2) return 0;
+    return max( end1, end2 );
+}
+
+/* recompute the max end offset of a lock tree node from its children */
+static void update_lock_max_end( struct wine_rb_entry *entry )
+{
+    struct file_lock *lock = WINE_RB_ENTRY_VALUE( entry, struct file_lock, inode_entry );
+    file_pos_t end = lock->end;
+
+    if (entry->left)
+        end = max_lock_end( end, WINE_RB_ENTRY_VALUE( entry->left, struct file_lock, inode_entry )->max_end );
+    if (entry->right)
+        end = max_lock_end( end, WINE_RB_ENTRY_VALUE( entry->right, struct file_lock, inode_entry )->max_end );
+    lock->max_end = end;
+}
+
+/* update the max end offsets after the tree has been modified below the given node */
+/* rebalancing only moves nodes along that path or right next to it */
+static void update_lock_tree( struct wine_rb_entry *entry )
+{
+    for ( ; entry; entry = entry->parent)
+    {
+        if (entry->left) update_lock_max_end( entry->left );
+        if (entry->right) update_lock_max_end( entry->right );
+        update_lock_max_end( entry );
+    }
+}
+
+/* add a lock to the inode lock tree */
+static void insert_lock( struct inode *inode, struct file_lock *lock )
+{
+    wine_rb_put( &inode->locks, lock, &lock->inode_entry );
+    update_lock_tree( &lock->inode_entry );
+}
+
+/* remove a lock from the inode lock tree */
+static void erase_lock( struct inode *inode, struct file_lock *lock )
+{
+    struct wine_rb_entry *entry = &lock->inode_entry, *parent;
+
+    /* find the lowest node whose subtree is changed by the removal */
+    if (entry->left && entry->right)
+    {
+        parent = wine_rb_head( entry->right );
+        if (parent->parent != entry) parent = parent->parent;
+    }
+    else parent = entry->parent;
+
+    wine_rb_remove( &inode->locks, entry );
+    update_lock_tree( parent );
+}
+
+/* check if interval [start;end) overlaps the lock */
+static inline int lock_overlaps( struct file_lock *lock, file_pos_t start, file_pos_t end )
+{
+    if (lock->end && start >= lock->end) return 0;
+    if (end && lock->start >= end) return 0;
+    return 1;
+}
+
+/* call a function for all the locks of a subtree overlapping [start;end), in start order */
+/* stops and returns the current lock when the function returns non-zero */
+static struct file_lock *find_overlapping_lock( struct wine_rb_entry *entry, file_pos_t start, file_pos_t end,
+                                                int (*func)( struct file_lock *, void * ), void *arg )
+{
+    struct file_lock *lock, *found;
+
+    while (entry)
+    {
+        lock = WINE_RB_ENTRY_VALUE( entry, struct file_lock, inode_entry );
+        if (lock->max_end && start >= lock->max_end) break;  /* the whole subtree is before the area */
+        if ((found = find_overlapping_lock( entry->left, start, end, func, arg ))) return found;
+        if (end && lock->start >= end) break;  /* this lock and the right subtree are after the area */
+        if (lock_overlaps( lock, start, end ) && func( lock, arg )) return lock;
+        entry = entry->right;
+    }
+    return NULL;
+}
+
+/* check whether we can use open file description locks */
+static int use_ofd_locks( int unix_fd )
+{
+#ifdef F_OFD_GETLK
+    if (ofd_locks == -1)
+    {
+        struct flock fl;
+
+        memset( &fl, 0, sizeof(fl) );
+        fl.l_type   = F_RDLCK;
+        fl.l_whence = SEEK_SET;
+        ofd_locks = fcntl( unix_fd, F_OFD_GETLK, &fl ) != -1;
+    }
+#else
+    ofd_locks = 0;
+#endif
+    return ofd_locks;
+}
+
 /* set (or remove) a Unix lock if possible for the given range */
 static int set_unix_lock( struct fd *fd, file_pos_t start, file_pos_t end, int type )
 {
     struct flock fl;
+    int setlk = F_SETLK, getlk = F_GETLK;
 
     if (!fd->fs_locks) return 1;  /* no fs locks possible for this fd */
+#ifdef F_OFD_SETLK
+    if (use_ofd_locks( fd->unix_fd ))
+    {
+        setlk = F_OFD_SETLK;
+        getlk = F_OFD_GETLK;
+    }
+#endif
     for (;;)
     {
         if (start == end) return 1;  /* can't set zero-byte lock */
@@ -1248,15 +1376,16 @@ static int set_unix_lock( struct fd *fd, file_pos_t start, file_pos_t end, int t
         fl.l_type   = type;
         fl.l_whence = SEEK_SET;
         fl.l_start  = start;
+        fl.l_pid    = 0;
         if (!end || end > max_unix_offset) fl.l_len = 0;
         else fl.l_len = end - start;
-        if (fcntl( fd->unix_fd, F_SETLK, &fl ) != -1) return 1;
+        if (fcntl( fd->unix_fd, setlk, &fl ) != -1) return 1;
 
         switch(errno)
         {
         case EACCES:
             /* check whether locks work at all on this file system */
-            if (fcntl( fd->unix_fd, F_GETLK, &fl ) != -1)
+            if (fcntl( fd->unix_fd, getlk, &fl ) != -1)
             {
                 set_error( STATUS_FILE_LOCK_CONFLICT );
                 return 0;
@@ -1300,27 +1429,91 @@ static int set_unix_lock( struct fd *fd, file_pos_t start, file_pos_t end, int t
     }
 }
 
-/* check if interval [start;end) overlaps the lock */
-static inline int lock_overlaps( struct file_lock *lock, file_pos_t start, file_pos_t end )
+/* list of unlocked holes in an area whose Unix locks are being removed */
+struct hole
 {
-    if (lock->end && start >= lock->end) return 0;
-    if (end && lock->start >= end) return 0;
-    return 1;
+    struct hole *next;
+    struct hole *prev;
+    file_pos_t   start;
+    file_pos_t   end;
+};
+
+struct hole_list
+{
+    struct fd   *fd;     /* fd whose Unix locks are removed */
+    int          count;  /* number of locks overlapping the area */
+    struct hole *first;  /* first hole in sorted list */
+    struct hole *next;   /* next free hole entry */
+};
+
+/* check if a lock holds Unix locks that may overlap the ones of a given fd */
+static inline int shares_unix_locks( struct file_lock *lock, struct fd *fd )
+{
+    if (lock->start == lock->end) return 0;
+    /* open file description locks are not shared with other fds */
+    return ofd_locks != 1 || lock->fd == fd;
 }
 
-/* remove Unix locks for all bytes in the specified area that are no longer locked */
-static void remove_unix_locks( struct fd *fd, file_pos_t start, file_pos_t end )
+static int count_unix_lock( struct file_lock *lock, void *arg )
+{
+    struct hole_list *holes = arg;
+
+    if (shares_unix_locks( lock, holes->fd )) holes->count++;
+    return 0;
+}
+
+/* remove the area covered by a lock from the list of holes */
+static int fill_hole( struct file_lock *lock, void *arg )
 {
-    struct hole
+    struct hole_list *holes = arg;
+    struct hole *cur, *next = holes->next;
+
+    if (!shares_unix_locks( lock, holes->fd )) return 0;
+
+    /* go through all the holes touched by this lock */
+    for (cur = holes->first; cur; cur = cur->next)
     {
-        struct hole *next;
-        struct hole *prev;
-        file_pos_t   start;
-        file_pos_t   end;
-    } *first, *cur, *next, *buffer;
+        if (cur->end <= lock->start) continue; /* hole is before start of lock */
+        if (lock->end && cur->start >= lock->end) break;  /* hole is after end of lock */
 
-    struct list *ptr;
-    int count = 0;
+        /* now we know that lock is overlapping hole */
+
+        if (cur->start >= lock->start)  /* lock starts before hole, shrink from start */
+        {
+            cur->start = lock->end;
+            if (cur->start && cur->start < cur->end) break;  /* done with this lock */
+            /* now hole is empty, remove it */
+            if (cur->next) cur->next->prev = cur->prev;
+            if (cur->prev) cur->prev->next = cur->next;
+            else if (!(holes->first = cur->next)) return 1;  /* no more holes at all */
+        }
+        else if (!lock->end || cur->end <= lock->end)  /* lock larger than hole, shrink from end */
+        {
+            cur->end = lock->start;
+            assert( cur->start < cur->end );
+        }
+        else  /* lock is in the middle of hole, split hole in two */
+        {
+            next->prev = cur;
+            next->next = cur->next;
+            cur->next = next;
+            next->start = lock->end;
+            next->end = cur->end;
+            cur->end = lock->start;
+            assert( next->start < next->end );
+            assert( cur->end < next->start );
+            holes->next = next + 1;
+            break;  /* done with this lock */
+        }
+    }
+    return 0;
+}
+
+/* remove Unix locks for all bytes in the specified area that are no longer locked */
+static void remove_unix_locks( struct fd *fd, file_pos_t start, file_pos_t end )
+{
+    struct hole_list holes;
+    struct hole *cur, *buffer;
 
     if (!fd->inode) return;
     if (!fd->fs_locks) return;
@@ -1329,14 +1522,11 @@ static void remove_unix_locks( struct fd *fd, file_pos_t start, file_pos_t end )
 
     /* count the number of locks overlapping the specified area */
 
-    LIST_FOR_EACH( ptr, &fd->inode->locks )
-    {
-        struct file_lock *lock = LIST_ENTRY( ptr, struct file_lock, inode_entry );
-        if (lock->start == lock->end) continue;
-        if (lock_overlaps( lock, start, end )) count++;
-    }
+    holes.fd = fd;
+    holes.count = 0;
+    find_overlapping_lock( fd->inode->locks.root, start, end, count_unix_lock, &holes );
 
-    if (!count)  /* no locks at all, we can unlock everything */
+    if (!holes.count)  /* no locks at all, we can unlock everything */
     {
         set_unix_lock( fd, start, end, F_UNLCK );
         return;
@@ -1345,66 +1535,23 @@ static void remove_unix_locks( struct fd *fd, file_pos_t start, file_pos_t end )
     /* allocate space for the list of holes */
     /* max. number of holes is number of locks + 1 */
 
-    if (!(buffer = malloc( sizeof(*buffer) * (count+1) ))) return;
-    first = buffer;
-    first->next  = NULL;
-    first->prev  = NULL;
-    first->start = start;
-    first->end   = end;
-    next = first + 1;
+    if (!(buffer = malloc( sizeof(*buffer) * (holes.count + 1) ))) return;
+    holes.first = buffer;
+    holes.first->next  = NULL;
+    holes.first->prev  = NULL;
+    holes.first->start = start;
+    holes.first->end   = end;
+    holes.next = holes.first + 1;
 
     /* build a sorted list of unlocked holes in the specified area */
 
-    LIST_FOR_EACH( ptr, &fd->inode->locks )
-    {
-        struct file_lock *lock = LIST_ENTRY( ptr, struct file_lock, inode_entry );
-        if (lock->start == lock->end) continue;
-        if (!lock_overlaps( lock, start, end )) continue;
-
-        /* go through all the holes touched by this lock */
-        for (cur = first; cur; cur = cur->next)
-        {
-            if (cur->end <= lock->start) continue; /* hole is before start of lock */
-            if (lock->end && cur->start >= lock->end) break;  /* hole is after end of lock */
-
-            /* now we know that lock is overlapping hole */
-
-            if (cur->start >= lock->start)  /* lock starts before hole, shrink from start */
-            {
-                cur->start = lock->end;
-                if (cur->start && cur->start < cur->end) break;  /* done with this lock */
-                /* now hole is empty, remove it */
-                if (cur->next) cur->next->prev = cur->prev;
-                if (cur->prev) cur->prev->next = cur->next;
-                else if (!(first = cur->next)) goto done;  /* no more holes at all */
-            }
-            else if (!lock->end || cur->end <= lock->end)  /* lock larger than hole, shrink from end */
-            {
-                cur->end = lock->start;
-                assert( cur->start < cur->end );
-            }
-            else  /* lock is in the middle of hole, split hole in two */
-            {
-                next->prev = cur;
-                next->next = cur->next;
-                cur->next = next;
-                next->start = lock->end;
-                next->end = cur->end;
-                cur->end = lock->start;
-                assert( next->start < next->end );
-                assert( cur->end < next->start );
-                next++;
-                break;  /* done with this lock */
-            }
-        }
-    }
+    find_overlapping_lock( fd->inode->locks.root, start, end, fill_hole, &holes );
 
     /* clear Unix locks for all the holes */
 
-    for (cur = first; cur; cur = cur->next)
+    for (cur = holes.first; cur; cur = cur->next)
         set_unix_lock( fd, cur->start, cur->end, F_UNLCK );
 
- done:
     free( buffer );
 }
 
@@ -1427,7 +1574,7 @@ static struct file_lock *add_lock( struct fd *fd, int shared, file_pos_t start,
         return NULL;
     }
     list_add_tail( &fd->locks, &lock->fd_entry );
-    list_add_tail( &fd->inode->locks, &lock->inode_entry );
+    insert_lock( fd->inode, lock );
     list_add_tail( &lock->process->locks, &lock->proc_entry );
     return lock;
 }
@@ -1438,10 +1585,10 @@ static void remove_lock( struct file_lock *lock, int remove_unix )
     struct inode *inode = lock->fd->inode;
 
     list_remove( &lock->fd_entry );
-    list_remove( &lock->inode_entry );
+    erase_lock( inode, lock );
     list_remove( &lock->proc_entry );
     if (remove_unix) remove_unix_locks( lock->fd, lock->start, lock->end );
-    if (list_empty( &inode->locks )) inode_close_pending( inode, 1 );
+    if (!inode->locks.root) inode_close_pending( inode, 1 );
     lock->process = NULL;
     wake_up( &lock->obj, 0 );
     release_object( lock );
@@ -1475,11 +1622,23 @@ static void remove_fd_locks( struct fd *fd )
     if (start < end) remove_unix_locks( fd, start, end + 1 );
 }
 
+/* check if an existing lock conflicts with a new shared lock on the given fd */
+static int conflicts_with_shared_lock( struct file_lock *lock, void *fd )
+{
+    return !lock->shared && lock->fd != fd;
+}
+
+/* any existing lock conflicts with a new exclusive lock */
+static int conflicts_with_exclusive_lock( struct file_lock *lock, void *fd )
+{
+    return 1;
+}
+
 /* add a lock on an fd */
 /* returns handle to wait on */
 obj_handle_t lock_fd( struct fd *fd, file_pos_t start, file_pos_t count, int shared, int wait )
 {
-    struct list *ptr;
+    struct file_lock *lock;
     file_pos_t end = start + count;
 
     if (!fd->inode)  /* not a regular file */
@@ -1496,11 +1655,10 @@ obj_handle_t lock_fd( struct fd *fd, file_pos_t start, file_pos_t count, int sha
     }
 
     /* check if another lock on that file overlaps the area */
-    LIST_FOR_EACH( ptr, &fd->inode->locks )
+    if ((lock = find_overlapping_lock( fd->inode->locks.root, start, end,
+                                       shared ? conflicts_with_shared_lock : conflicts_with_exclusive_lock,
+                                       fd )))
     {
-        struct file_lock *lock = LIST_ENTRY( ptr, struct file_lock, inode_entry );
-        if (!lock_overlaps( lock, start, end )) continue;
-        if (shared && (lock->shared || lock->fd == fd)) continue;
         /* found one */
         if (!wait)
         {
@@ -1524,17 +1682,33 @@ obj_handle_t lock_fd( struct fd *fd, file_pos_t start, file_pos_t count, int sha
 /* remove a lock on an fd */
 void unlock_fd( struct fd *fd, file_pos_t start, file_pos_t count )
 {
-    struct list *ptr;
+    struct wine_rb_entry *entry, *first = NULL;
     file_pos_t end = start + count;
 
-    /* find an existing lock with the exact same parameters */
-    LIST_FOR_EACH( ptr, &fd->locks )
+    if (fd->inode)
     {
-        struct file_lock *lock = LIST_ENTRY( ptr, struct file_lock, fd_entry );
-        if ((lock->start == start) && (lock->end == end))
+        /* find the first lock starting at the specified offset */
+        for (entry = fd->inode->locks.root; entry; )
         {
-            remove_lock( lock, 1 );
-            return;
+            struct file_lock *lock = WINE_RB_ENTRY_VALUE( entry, struct file_lock, inode_entry );
+            if (lock->start < start) entry = entry->right;
+            else
+            {
+                if (lock->start == start) first = entry;
+                entry = entry->left;
+            }
+        }
+
+        /* find an existing lock with the exact same parameters */
+        for (entry = first; entry; entry = wine_rb_next( entry ))
+        {
+            struct file_lock *lock = WINE_RB_ENTRY_VALUE( entry, struct file_lock, inode_entry );
+            if (lock->start != start) break;
+            if ((lock->fd == fd) && (lock->end == end))
+            {
+                remove_lock( lock, 1 );
+                return;
+            }
         }
     }
     set_error( STATUS_FILE_LOCK_CONFLICT );
@@ -1764,6 +1938,8 @@ struct fd *dup_fd_object( struct fd *orig, unsigned int access, unsigned int sha
         closed->unlink = 0;
         closed->unix_name = fd->unix_name;
         fd->closed = closed;
+        /* the duplicated fd shares the open file description locks of the original */
+        if (use_ofd_locks( fd->unix_fd )) fd->fs_locks = 0;
         fd->inode = (struct inode *)grab_object( orig->inode );
         list_add_head( &fd->inode->open, &fd->inode_entry );
         if ((err = check_sharing( fd, access, sharing, 0, options )))
@@ -1967,6 +2143,16 @@ struct fd *open_fd( struct fd *root, const char *name, int flags, mode_t *mode,
             }
             ftruncate( fd->unix_fd, 0 );
         }
+#ifdef HAVE_POSIX_FADVISE
+        /* pass access pattern hints on to the kernel page cache */
+        if (S_ISREG(st.st_mode))
+        {
+            if (options & FILE_SEQUENTIAL_ONLY)
+                posix_fadvise( fd->unix_fd, 0, 0, POSIX_FADV_SEQUENTIAL );
+            else if (options & FILE_RANDOM_ACCESS)
+                posix_fadvise( fd->unix_fd, 0, 0, POSIX_FADV_RANDOM );
+        }
+#endif
     }
     else  /* special file */
     {
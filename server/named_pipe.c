@@ -63,6 +63,7 @@ struct pipe_end
     process_id_t         client_pid; /* process that created the client */
     process_id_t         server_pid; /* process that created the server */
     data_size_t          buffer_size;/* size of buffered data that doesn't block caller */
+    data_size_t          queued_size;/* size of unread data in the message queue */
     struct list          message_queue;
     struct async_queue   read_q;     /* read queue */
     struct async_queue   write_q;    /* write queue */
@@ -360,6 +361,7 @@ static struct pipe_message *queue_message( struct pipe_end *pipe_end, struct ios
     message->async = NULL;
     message->read_pos = 0;
     list_add_tail( &pipe_end->message_queue, &message->entry );
+    pipe_end->queued_size += iosb->in_size;
     return message;
 }
 
@@ -376,10 +378,11 @@ static void wake_message( struct pipe_message *message, data_size_t result )
     release_object( async );
 }
 
-static void free_message( struct pipe_message *message )
+static void free_message( struct pipe_end *pipe_end, struct pipe_message *message )
 {
+    pipe_end->queued_size -= message->iosb->in_size - message->read_pos;
     list_remove( &message->entry );
-    if (message->iosb) release_object( message->iosb );
+    release_object( message->iosb );
     free( message );
 }
 
@@ -398,7 +401,7 @@ static void pipe_end_disconnect( struct pipe_end *pipe_end, unsigned int status
     LIST_FOR_EACH_ENTRY_SAFE( message, next, &pipe_end->message_queue, struct pipe_message, entry )
     {
         async = message->async;
-        if (async || status == STATUS_PIPE_DISCONNECTED) free_message( message );
+        if (async || status == STATUS_PIPE_DISCONNECTED) free_message( pipe_end, message );
         if (!async) continue;
         async_terminate( async, status );
         release_object( async );
@@ -423,7 +426,7 @@ static void pipe_end_destroy( struct object *obj )
     {
         message = LIST_ENTRY( list_head(&pipe_end->message_queue), struct pipe_message, entry );
         assert( !message->async );
-        free_message( message );
+        free_message( pipe_end, message );
     }
 
     free_async_queue( &pipe_end->read_q );
@@ -734,13 +737,7 @@ static void message_queue_read( struct pipe_end *pipe_end, struct iosb *iosb )
     }
     else
     {
-        data_size_t avail = 0;
-        LIST_FOR_EACH_ENTRY( message, &pipe_end->message_queue, struct pipe_message, entry )
-        {
-            avail += message->iosb->in_size - message->read_pos;
-            if (avail >= iosb->out_size) break;
-        }
-        iosb->out_size = min( iosb->out_size, avail );
+        iosb->out_size = min( iosb->out_size, pipe_end->queued_size );
         iosb->status = STATUS_SUCCESS;
     }
 
@@ -750,7 +747,7 @@ static void message_queue_read( struct pipe_end *pipe_end, struct iosb *iosb )
         iosb->out_data = message->iosb->in_data;
         message->iosb->in_data = NULL;
         wake_message( message, message->iosb->in_size );
-        free_message( message );
+        free_message( pipe_end, message );
     }
     else
     {
@@ -771,10 +768,11 @@ static void message_queue_read( struct pipe_end *pipe_end, struct iosb *iosb )
             if (writing) memcpy( buf + write_pos, (const char *)message->iosb->in_data + message->read_pos, writing );
             write_pos += writing;
             message->read_pos += writing;
+            pipe_end->queued_size -= writing;
             if (message->read_pos == message->iosb->in_size)
             {
                 wake_message(message, message->iosb->in_size);
-                free_message(message);
+                free_message(pipe_end, message);
             }
         } while (write_pos < iosb->out_size);
     }
@@ -829,7 +827,7 @@ static void reselect_write_queue( struct pipe_end *pipe_end )
         {
             release_object( message->async );
             message->async = NULL;
-            free_message( message );
+            free_message( reader, message );
         }
         else
         {
@@ -841,7 +839,7 @@ static void reselect_write_queue( struct pipe_end *pipe_end )
             else if (message->async && (pipe_end->flags & NAMED_PIPE_NONBLOCKING_MODE))
             {
                 wake_message( message, message->read_pos );
-                free_message( message );
+                free_message( reader, message );
             }
         }
     }
@@ -938,7 +936,7 @@ static int pipe_end_peek( struct pipe_end *pipe_end )
     unsigned reply_size = get_reply_max_size();
     FILE_PIPE_PEEK_BUFFER *buffer;
     struct pipe_message *message;
-    data_size_t avail = 0;
+    data_size_t avail = pipe_end->queued_size;
     data_size_t message_length = 0;
 
     if (reply_size < offsetof( FILE_PIPE_PEEK_BUFFER, Data ))
@@ -961,8 +959,6 @@ static int pipe_end_peek( struct pipe_end *pipe_end )
         return 0;
     }
 
-    LIST_FOR_EACH_ENTRY( message, &pipe_end->message_queue, struct pipe_message, entry )
-        avail += message->iosb->in_size - message->read_pos;
     reply_size = min( reply_size, avail );
 
     if (avail && pipe_end->pipe->message_mode)
@@ -1177,6 +1173,7 @@ static void init_pipe_end( struct pipe_end *pipe_end, struct named_pipe *pipe,
     pipe_end->flags = pipe_flags;
     pipe_end->connection = NULL;
     pipe_end->buffer_size = buffer_size;
+    pipe_end->queued_size = 0;
     init_async_queue( &pipe_end->read_q );
     init_async_queue( &pipe_end->write_q );
     list_init( &pipe_end->message_queue );